@@ -0,0 +1,190 @@
+// Throughput of the synchronization.hpp locks against their std:: peers
+// as the number of contending threads grows.
+//
+//   lock_contention [max_threads] [ops_per_thread] [outside_work]
+//
+// Each thread repeatedly takes the lock, increments a shared counter and
+// releases it, then spins for outside_work iterations before the next
+// acquisition (0 means back-to-back). Thread counts double from 1 up to
+// max_threads (default: the number of CPUs). The shared_mutex runs are
+// reader-heavy: one operation in write_every is a write. The latch and
+// barrier runs time rounds of ops_per_thread / 100 in which every thread
+// arrives and waits for the others.
+//
+// Prints nanoseconds per operation across all threads, i.e. the inverse
+// of total throughput, and for latch and barrier nanoseconds per round;
+// lower is better.
+
+#include <mystl/synchronization.hpp>
+
+#include <algorithm>
+#include <barrier>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct options {
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  long ops = 200000;
+  unsigned outside_work = 0;
+};
+
+void spin(unsigned n) {
+  // The fence keeps the compiler from folding the loop away.
+  for (unsigned i = 0; i < n; ++i) std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+// Runs body(thread_index) on threads threads, released together, and
+// returns the wall time in nanoseconds.
+template <class Body>
+double run_threads(unsigned threads, Body body) {
+  std::atomic<unsigned> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      body(t);
+    });
+  }
+  while (ready.load() != threads) std::this_thread::yield();
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& w : workers) w.join();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class Lock>
+struct exclusive {
+  static void with(Lock& m, long& counter) {
+    std::lock_guard<Lock> g(m);
+    ++counter;
+  }
+};
+
+template <>
+struct exclusive<mystl::mcs_lock> {
+  static void with(mystl::mcs_lock& m, long& counter) {
+    mystl::mcs_lock::guard g(m);
+    ++counter;
+  }
+};
+
+template <class Lock>
+void bench_exclusive(const char* name, const options& opt) {
+  for (unsigned threads = 1; threads <= opt.max_threads; threads *= 2) {
+    Lock m;
+    long counter = 0;
+    const double ns = run_threads(threads, [&](unsigned) {
+      for (long i = 0; i < opt.ops; ++i) {
+        exclusive<Lock>::with(m, counter);
+        spin(opt.outside_work);
+      }
+    });
+    if (counter != opt.ops * threads) {
+      std::fprintf(stderr, "%s: lost updates\n", name);
+      std::exit(1);
+    }
+    std::printf("%-26s %7u %10.1f\n", name, threads, ns / static_cast<double>(opt.ops * threads));
+  }
+}
+
+template <class SharedLock>
+void bench_shared(const char* name, long write_every, const options& opt) {
+  const std::string label = std::string(name) + " 1/" + std::to_string(write_every) + "w";
+  for (unsigned threads = 1; threads <= opt.max_threads; threads *= 2) {
+    SharedLock m;
+    long value = 0;
+    std::atomic<long> reads{0};
+    const double ns = run_threads(threads, [&](unsigned) {
+      long seen = 0;
+      for (long i = 0; i < opt.ops; ++i) {
+        if (i % write_every == 0) {
+          std::unique_lock<SharedLock> g(m);
+          ++value;
+        } else {
+          std::shared_lock<SharedLock> g(m);
+          seen += value;
+        }
+        spin(opt.outside_work);
+      }
+      reads.fetch_add(seen, std::memory_order_relaxed);
+    });
+    std::printf("%-26s %7u %10.1f\n", label.c_str(), threads,
+                ns / static_cast<double>(opt.ops * threads));
+  }
+}
+
+long rounds_of(const options& opt) { return std::max(1L, opt.ops / 100); }
+
+template <class Barrier>
+void bench_barrier(const char* name, const options& opt) {
+  const long rounds = rounds_of(opt);
+  for (unsigned threads = 1; threads <= opt.max_threads; threads *= 2) {
+    Barrier b(static_cast<std::ptrdiff_t>(threads));
+    const double ns = run_threads(threads, [&](unsigned) {
+      for (long i = 0; i < rounds; ++i) {
+        b.arrive_and_wait();
+        spin(opt.outside_work);
+      }
+    });
+    std::printf("%-26s %7u %10.1f\n", name, threads, ns / static_cast<double>(rounds));
+  }
+}
+
+// A latch is single-use, so each round counts down and waits on a fresh
+// one, all built before the clock starts.
+template <class Latch>
+void bench_latch(const char* name, const options& opt) {
+  const long rounds = rounds_of(opt);
+  for (unsigned threads = 1; threads <= opt.max_threads; threads *= 2) {
+    std::vector<std::unique_ptr<Latch>> latches;
+    latches.reserve(static_cast<std::size_t>(rounds));
+    for (long i = 0; i < rounds; ++i) {
+      latches.push_back(std::make_unique<Latch>(static_cast<std::ptrdiff_t>(threads)));
+    }
+    const double ns = run_threads(threads, [&](unsigned) {
+      for (const auto& l : latches) {
+        l->count_down();
+        l->wait();
+        spin(opt.outside_work);
+      }
+    });
+    std::printf("%-26s %7u %10.1f\n", name, threads, ns / static_cast<double>(rounds));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  options opt;
+  if (argc > 1) opt.max_threads = static_cast<unsigned>(std::max(1, std::atoi(argv[1])));
+  if (argc > 2) opt.ops = std::max(1L, std::atol(argv[2]));
+  if (argc > 3) opt.outside_work = static_cast<unsigned>(std::max(0, std::atoi(argv[3])));
+
+  std::printf("%-26s %7s %10s\n", "lock", "threads", "ns/op");
+  bench_exclusive<mystl::adaptive_mutex>("adaptive_mutex", opt);
+  bench_exclusive<std::mutex>("std::mutex", opt);
+  bench_exclusive<mystl::ticket_lock>("ticket_lock", opt);
+  bench_exclusive<mystl::mcs_lock>("mcs_lock", opt);
+  for (long write_every : {1000L, 10L}) {
+    bench_shared<mystl::shared_mutex>("shared_mutex", write_every, opt);
+    bench_shared<std::shared_mutex>("std::shared_mutex", write_every, opt);
+  }
+  bench_latch<mystl::latch>("latch", opt);
+  bench_latch<std::latch>("std::latch", opt);
+  bench_barrier<mystl::barrier<>>("barrier", opt);
+  bench_barrier<std::barrier<>>("std::barrier", opt);
+}
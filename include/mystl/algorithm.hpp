@@ -0,0 +1,149 @@
+#pragma once
+
+// Sorting algorithms usable both at run time and in constant expressions.
+//
+// sort is an introsort: median-of-three quicksort that falls back to heap
+// sort past 2*log2(n) levels of recursion, finished by a single insertion
+// sort pass over the nearly-sorted range.
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
+#include "config.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Ranges at or below this length are left for the final insertion sort.
+inline constexpr std::ptrdiff_t sort_threshold = 16;
+
+template <class It, class Compare>
+constexpr void sift_down(It first, std::iter_difference_t<It> hole, std::iter_difference_t<It> len,
+                         Compare& comp) {
+  auto value = std::move(first[hole]);
+  for (;;) {
+    auto child = 2 * hole + 1;
+    if (child >= len) break;
+    if (child + 1 < len && comp(first[child], first[child + 1])) ++child;
+    if (!comp(value, first[child])) break;
+    first[hole] = std::move(first[child]);
+    hole = child;
+  }
+  first[hole] = std::move(value);
+}
+
+template <class It, class Compare>
+constexpr void move_median_to_first(It result, It a, It b, It c, Compare& comp) {
+  if (comp(*a, *b)) {
+    if (comp(*b, *c)) {
+      std::iter_swap(result, b);
+    } else if (comp(*a, *c)) {
+      std::iter_swap(result, c);
+    } else {
+      std::iter_swap(result, a);
+    }
+  } else if (comp(*a, *c)) {
+    std::iter_swap(result, a);
+  } else if (comp(*b, *c)) {
+    std::iter_swap(result, c);
+  } else {
+    std::iter_swap(result, b);
+  }
+}
+
+// Hoare partition around *pivot; the median-of-three guarantees sentinels
+// on both sides, so the inner loops need no bounds checks.
+template <class It, class Compare>
+constexpr It unguarded_partition(It first, It last, It pivot, Compare& comp) {
+  for (;;) {
+    while (comp(*first, *pivot)) ++first;
+    --last;
+    while (comp(*pivot, *last)) --last;
+    if (!(first < last)) return first;
+    std::iter_swap(first, last);
+    ++first;
+  }
+}
+
+}  // namespace detail
+
+template <std::random_access_iterator It, class Compare = std::less<>>
+constexpr void insertion_sort(It first, It last, Compare comp = {}) {
+  if (first == last) return;
+  for (It i = first + 1; i != last; ++i) {
+    auto value = std::move(*i);
+    It j = i;
+    for (; j != first && comp(value, *(j - 1)); --j) *j = std::move(*(j - 1));
+    *j = std::move(value);
+  }
+}
+
+template <std::random_access_iterator It, class Compare = std::less<>>
+constexpr void make_heap(It first, It last, Compare comp = {}) {
+  const auto len = last - first;
+  for (auto i = len / 2; i-- > 0;) detail::sift_down(first, i, len, comp);
+}
+
+template <std::random_access_iterator It, class Compare = std::less<>>
+constexpr void heap_sort(It first, It last, Compare comp = {}) {
+  mystl::make_heap(first, last, comp);
+  for (auto len = last - first; len > 1; --len) {
+    std::iter_swap(first, first + (len - 1));
+    detail::sift_down(first, decltype(len){0}, len - 1, comp);
+  }
+}
+
+namespace detail {
+
+template <class It, class Compare>
+constexpr void introsort_loop(It first, It last, int depth_limit, Compare& comp) {
+  while (last - first > sort_threshold) {
+    if (depth_limit == 0) {
+      mystl::heap_sort(first, last, comp);
+      return;
+    }
+    --depth_limit;
+    It mid = first + (last - first) / 2;
+    move_median_to_first(first, first + 1, mid, last - 1, comp);
+    It cut = unguarded_partition(first + 1, last, first, comp);
+    introsort_loop(cut, last, depth_limit, comp);
+    last = cut;
+  }
+}
+
+}  // namespace detail
+
+template <std::random_access_iterator It, class Compare = std::less<>>
+constexpr void sort(It first, It last, Compare comp = {}) {
+  const auto n = static_cast<std::size_t>(last - first);
+  if (n < 2) return;
+  detail::introsort_loop(first, last, 2 * static_cast<int>(std::bit_width(n)), comp);
+  mystl::insertion_sort(first, last, comp);
+}
+
+template <std::ranges::random_access_range R, class Compare = std::less<>>
+constexpr void sort(R&& r, Compare comp = {}) {
+  mystl::sort(std::ranges::begin(r), std::ranges::end(r), comp);
+}
+
+template <std::forward_iterator It, class Compare = std::less<>>
+constexpr bool is_sorted(It first, It last, Compare comp = {}) {
+  if (first == last) return true;
+  for (It next = std::next(first); next != last; first = next, ++next) {
+    if (comp(*next, *first)) return false;
+  }
+  return true;
+}
+
+template <std::ranges::forward_range R, class Compare = std::less<>>
+constexpr bool is_sorted(R&& r, Compare comp = {}) {
+  return mystl::is_sorted(std::ranges::begin(r), std::ranges::end(r), comp);
+}
+
+}  // namespace mystl
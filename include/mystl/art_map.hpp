@@ -0,0 +1,1096 @@
+#pragma once
+
+// Adaptive radix tree (Leis, Kemper and Neumann, ICDE 2013): an ordered map
+// over string or integer keys that compares key bytes at most once each.
+//
+//   mystl::art_map<std::string, route> routes;
+//   routes.try_emplace("10.1.0.0/16", r1);
+//   if (route* r = routes.find("10.1.0.0/16")) use(*r);
+//   routes.for_each_prefix("10.1.", [](const auto& kv) { print(kv.first); });
+//   for (auto it = routes.lower_bound("10.2"); it != routes.end(); ++it) ...
+//
+// Keys are sequences of bytes in radix order: strings as they are, integers
+// big-endian with the sign bit flipped, so iteration is in std::less order
+// for both. Every inner node branches on one byte and comes in four sizes,
+// grown and shrunk as children come and go: Node4 and Node16 (sorted key
+// bytes, Node16 searched with one SSE2 compare), Node48 (a 256-byte index
+// into 48 children) and Node256 (direct). Chains of single-child nodes
+// are compressed into a prefix stored in the node; the first max_prefix
+// bytes are kept inline and longer prefixes are skipped optimistically and
+// confirmed against the leaf. A key that ends at an inner node, such as
+// "ab" next to "abc", is kept in the node's value slot.
+//
+// Lookups cost O(key length) independent of the number of keys. find_batch
+// walks a group of lookups down the tree in lockstep and prefetches each
+// one's next node, so their cache misses overlap. References to values
+// stay valid until their key is erased; iterators are invalidated by any
+// insertion or erasure.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "config.hpp"
+
+namespace mystl {
+
+// Maps a key to its bytes in radix order. Specialise for other key types;
+// bytes() may write to buf, which holds max_size bytes.
+template <class Key>
+struct art_key;
+
+template <class Key>
+  requires std::is_integral_v<Key>
+struct art_key<Key> {
+  static constexpr std::size_t max_size = sizeof(Key);
+  static std::string_view bytes(Key key, char* buf) noexcept {
+    using U = std::make_unsigned_t<Key>;
+    U u = static_cast<U>(key);
+    if constexpr (std::is_signed_v<Key>) u ^= U{1} << (8 * sizeof(Key) - 1);
+    for (std::size_t i = 0; i < sizeof(Key); ++i) {
+      buf[i] = static_cast<char>(u >> (8 * (sizeof(Key) - 1 - i)));
+    }
+    return {buf, sizeof(Key)};
+  }
+};
+
+template <class Key>
+  requires std::is_convertible_v<const Key&, std::string_view>
+struct art_key<Key> {
+  static constexpr std::size_t max_size = 1;
+  static std::string_view bytes(std::string_view key, char*) noexcept { return key; }
+};
+
+template <class Key, class T>
+class art_map {
+  struct leaf;
+  struct node;
+  using ref = std::uintptr_t;  // tagged child: leaf pointers have the low bit set
+  template <bool Const>
+  class basic_iterator;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+  // What lookups take: std::string_view for string keys, Key otherwise.
+  using key_arg = std::conditional_t<std::is_convertible_v<const Key&, std::string_view>,
+                                     std::string_view, Key>;
+
+  static constexpr std::size_t max_prefix = 12;
+
+  art_map() noexcept = default;
+  art_map(std::initializer_list<value_type> init) {
+    for (const value_type& kv : init) try_emplace(kv.first, kv.second);
+  }
+  art_map(const art_map& other) : root_(clone(other.root_)), size_(other.size_) {}
+  art_map(art_map&& other) noexcept
+      : root_(std::exchange(other.root_, 0)), size_(std::exchange(other.size_, 0)) {}
+  art_map& operator=(const art_map& other) {
+    if (this != &other) art_map(other).swap(*this);
+    return *this;
+  }
+  art_map& operator=(art_map&& other) noexcept {
+    art_map(std::move(other)).swap(*this);
+    return *this;
+  }
+  ~art_map() { destroy(root_); }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  void clear() noexcept {
+    destroy(std::exchange(root_, 0));
+    size_ = 0;
+  }
+  void swap(art_map& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+  }
+
+  // ----- lookup -----
+
+  // Pointer to the value for key, or nullptr.
+  T* find(const key_arg& key) noexcept {
+    char buf[art_key<Key>::max_size];
+    leaf* l = find_leaf(art_key<Key>::bytes(key, buf));
+    return l ? &l->kv.second : nullptr;
+  }
+  const T* find(const key_arg& key) const noexcept { return const_cast<art_map*>(this)->find(key); }
+  bool contains(const key_arg& key) const noexcept { return find(key) != nullptr; }
+  T& at(const key_arg& key) {
+    if (T* v = find(key)) return *v;
+    throw std::out_of_range("art_map::at");
+  }
+  const T& at(const key_arg& key) const { return const_cast<art_map*>(this)->at(key); }
+
+  // Looks up every key and writes a pointer to its value (or nullptr) to
+  // the matching element of out; returns the number of keys found. Groups
+  // of batch_group_size lookups descend one level per round, each
+  // prefetching its next node, so the cache misses of independent lookups
+  // overlap.
+  size_type find_batch(std::span<const Key> keys, std::span<T*> out) noexcept {
+    return batch_lookup(keys, [&](size_type i, leaf* l) { out[i] = l ? &l->kv.second : nullptr; });
+  }
+  size_type find_batch(std::span<const Key> keys, std::span<const T*> out) const noexcept {
+    return const_cast<art_map*>(this)->batch_lookup(
+        keys, [&](size_type i, leaf* l) { out[i] = l ? &l->kv.second : nullptr; });
+  }
+
+  // ----- modifiers -----
+
+  template <class... Args>
+  std::pair<T*, bool> try_emplace(const key_arg& key, Args&&... args) {
+    char buf[art_key<Key>::max_size];
+    auto [l, inserted] = emplace_leaf(art_key<Key>::bytes(key, buf), [&] {
+      return new leaf(std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    });
+    return {&l->kv.second, inserted};
+  }
+
+  template <class M>
+  std::pair<T*, bool> insert_or_assign(const key_arg& key, M&& value) {
+    auto r = try_emplace(key, std::forward<M>(value));
+    if (!r.second) *r.first = std::forward<M>(value);
+    return r;
+  }
+
+  T& operator[](const key_arg& key) { return *try_emplace(key).first; }
+
+  // True if key was present.
+  bool erase(const key_arg& key) noexcept {
+    char buf[art_key<Key>::max_size];
+    return erase_leaf(art_key<Key>::bytes(key, buf));
+  }
+
+  // ----- ordered access -----
+
+  iterator begin() noexcept {
+    iterator it;
+    it.enter(root_);
+    return it;
+  }
+  iterator end() noexcept { return iterator(); }
+  const_iterator begin() const noexcept { return const_cast<art_map*>(this)->begin(); }
+  const_iterator end() const noexcept { return const_iterator(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // First element whose key is not less than key.
+  iterator lower_bound(const key_arg& key) noexcept {
+    char buf[art_key<Key>::max_size];
+    return lower_bound_bytes(art_key<Key>::bytes(key, buf));
+  }
+  const_iterator lower_bound(const key_arg& key) const noexcept {
+    return const_cast<art_map*>(this)->lower_bound(key);
+  }
+
+  // Calls f(const value_type&) for every element, in key order.
+  template <class F>
+  void for_each(F&& f) const {
+    visit(root_, f);
+  }
+
+  // Calls f(const value_type&), in key order, for every element whose key
+  // bytes start with prefix (for string keys, the string prefix).
+  template <class F>
+  void for_each_prefix(std::string_view prefix, F&& f) const {
+    ref r = root_;
+    std::size_t depth = 0;
+    char buf[art_key<Key>::max_size];
+    while (r != 0) {
+      if (is_leaf(r)) {
+        if (leaf_key(as_leaf(r), buf).starts_with(prefix)) f(std::as_const(as_leaf(r)->kv));
+        return;
+      }
+      const node* n = as_node(r);
+      if (n->prefix_len != 0) {
+        const std::string_view path = full_prefix(n, depth, buf);
+        const std::size_t m = std::min(path.size(), prefix.size() - depth);
+        if (path.substr(0, m) != prefix.substr(depth, m)) return;
+        depth += path.size();
+        if (depth >= prefix.size()) break;
+      }
+      if (depth == prefix.size()) break;
+      const ref* c = find_child(n, static_cast<unsigned char>(prefix[depth]));
+      if (c == nullptr) return;
+      r = *c;
+      ++depth;
+    }
+    visit(r, f);
+  }
+
+ private:
+  struct leaf {
+    template <class... Args>
+    explicit leaf(Args&&... args) : kv(std::forward<Args>(args)...) {}
+    value_type kv;
+  };
+
+  enum class kind : std::uint8_t { n4, n16, n48, n256 };
+
+  struct node {
+    explicit node(kind k) noexcept : type(k) {}
+    kind type;
+    std::uint16_t count = 0;
+    std::uint32_t prefix_len = 0;                // bytes of compressed path
+    unsigned char prefix[max_prefix] = {};       // the first of them
+    leaf* value = nullptr;                       // key ending at this node
+  };
+  struct node4 : node {
+    node4() noexcept : node(kind::n4) {}
+    unsigned char keys[4] = {};
+    ref children[4] = {};
+  };
+  struct node16 : node {
+    node16() noexcept : node(kind::n16) {}
+    unsigned char keys[16] = {};
+    ref children[16] = {};
+  };
+  struct node48 : node {
+    node48() noexcept : node(kind::n48) {}
+    unsigned char index[256] = {};  // slot + 1, or 0
+    ref children[48] = {};
+  };
+  struct node256 : node {
+    node256() noexcept : node(kind::n256) {}
+    ref children[256] = {};
+  };
+
+  static bool is_leaf(ref r) noexcept { return (r & 1) != 0; }
+  static leaf* as_leaf(ref r) noexcept { return reinterpret_cast<leaf*>(r & ~ref{1}); }
+  static node* as_node(ref r) noexcept { return reinterpret_cast<node*>(r); }
+  static ref of(leaf* l) noexcept { return reinterpret_cast<ref>(l) | 1; }
+  static ref of(node* n) noexcept { return reinterpret_cast<ref>(n); }
+
+  static std::string_view leaf_key(const leaf* l, char* buf) noexcept {
+    return art_key<Key>::bytes(l->kv.first, buf);
+  }
+  static bool leaf_matches(const leaf* l, std::string_view kb) noexcept {
+    char buf[art_key<Key>::max_size];
+    return leaf_key(l, buf) == kb;
+  }
+
+  // ----- node operations -----
+
+  static ref* find_child(node* n, unsigned char b) noexcept {
+    switch (n->type) {
+      case kind::n4: {
+        auto* x = static_cast<node4*>(n);
+        for (unsigned i = 0; i < x->count; ++i) {
+          if (x->keys[i] == b) return &x->children[i];
+        }
+        return nullptr;
+      }
+      case kind::n16: {
+        auto* x = static_cast<node16*>(n);
+#if defined(__SSE2__)
+        const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x->keys));
+        const __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(b)), keys);
+        const unsigned hits = static_cast<unsigned>(_mm_movemask_epi8(eq)) & ((1u << x->count) - 1);
+        return hits != 0 ? &x->children[std::countr_zero(hits)] : nullptr;
+#else
+        for (unsigned i = 0; i < x->count; ++i) {
+          if (x->keys[i] == b) return &x->children[i];
+        }
+        return nullptr;
+#endif
+      }
+      case kind::n48: {
+        auto* x = static_cast<node48*>(n);
+        return x->index[b] != 0 ? &x->children[x->index[b] - 1] : nullptr;
+      }
+      case kind::n256: {
+        auto* x = static_cast<node256*>(n);
+        return x->children[b] != 0 ? &x->children[b] : nullptr;
+      }
+    }
+    return nullptr;
+  }
+  static const ref* find_child(const node* n, unsigned char b) noexcept {
+    return find_child(const_cast<node*>(n), b);
+  }
+
+  // Index of the first key byte greater than b in a sorted node.
+  template <class N>
+  static unsigned upper_index(const N* x, unsigned char b) noexcept {
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<N, node16>) {
+      // Unsigned compare via the signed one with the sign bits flipped.
+      const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+      const __m128i keys =
+          _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x->keys)), flip);
+      const __m128i gt =
+          _mm_cmpgt_epi8(keys, _mm_xor_si128(_mm_set1_epi8(static_cast<char>(b)), flip));
+      const unsigned hits = static_cast<unsigned>(_mm_movemask_epi8(gt)) & ((1u << x->count) - 1);
+      return hits != 0 ? static_cast<unsigned>(std::countr_zero(hits)) : x->count;
+    }
+#endif
+    unsigned i = 0;
+    while (i < x->count && x->keys[i] <= b) ++i;
+    return i;
+  }
+
+  template <class N>
+  static void insert_sorted(N* x, unsigned char b, ref child) noexcept {
+    const unsigned i = upper_index(x, b);
+    std::memmove(x->keys + i + 1, x->keys + i, x->count - i);
+    std::memmove(x->children + i + 1, x->children + i, (x->count - i) * sizeof(ref));
+    x->keys[i] = b;
+    x->children[i] = child;
+    ++x->count;
+  }
+
+  static void copy_header(node* to, const node* from) noexcept {
+    to->count = from->count;
+    to->prefix_len = from->prefix_len;
+    std::memcpy(to->prefix, from->prefix, max_prefix);
+    to->value = from->value;
+  }
+
+  // Adds child under byte b to the node in slot, growing it if full.
+  static void add_child(ref& slot, unsigned char b, ref child) {
+    node* n = as_node(slot);
+    switch (n->type) {
+      case kind::n4: {
+        auto* x = static_cast<node4*>(n);
+        if (x->count < 4) return insert_sorted(x, b, child);
+        auto* g = new node16;
+        copy_header(g, x);
+        std::copy_n(x->keys, 4, g->keys);
+        std::copy_n(x->children, 4, g->children);
+        slot = of(g);
+        delete x;
+        return insert_sorted(g, b, child);
+      }
+      case kind::n16: {
+        auto* x = static_cast<node16*>(n);
+        if (x->count < 16) return insert_sorted(x, b, child);
+        auto* g = new node48;
+        copy_header(g, x);
+        for (unsigned i = 0; i < 16; ++i) {
+          g->index[x->keys[i]] = static_cast<unsigned char>(i + 1);
+          g->children[i] = x->children[i];
+        }
+        slot = of(g);
+        delete x;
+        return add_child(slot, b, child);
+      }
+      case kind::n48: {
+        auto* x = static_cast<node48*>(n);
+        if (x->count < 48) {
+          unsigned i = 0;
+          while (x->children[i] != 0) ++i;
+          x->children[i] = child;
+          x->index[b] = static_cast<unsigned char>(i + 1);
+          ++x->count;
+          return;
+        }
+        auto* g = new node256;
+        copy_header(g, x);
+        for (unsigned c = 0; c < 256; ++c) {
+          if (x->index[c] != 0) g->children[c] = x->children[x->index[c] - 1];
+        }
+        slot = of(g);
+        delete x;
+        return add_child(slot, b, child);
+      }
+      case kind::n256: {
+        auto* x = static_cast<node256*>(n);
+        x->children[b] = child;
+        ++x->count;
+        return;
+      }
+    }
+  }
+
+  // Removes the child under byte b from the node in slot and shrinks the
+  // node when it falls well below the next smaller size. Shrinking is
+  // skipped if the smaller node cannot be allocated.
+  static void remove_child(ref& slot, unsigned char b) noexcept {
+    node* n = as_node(slot);
+    switch (n->type) {
+      case kind::n4:
+      case kind::n16: {
+        auto remove = [b](auto* x) {
+          unsigned i = 0;
+          while (x->keys[i] != b) ++i;
+          std::memmove(x->keys + i, x->keys + i + 1, x->count - i - 1);
+          std::memmove(x->children + i, x->children + i + 1, (x->count - i - 1) * sizeof(ref));
+          --x->count;
+        };
+        if (n->type == kind::n4) {
+          remove(static_cast<node4*>(n));
+          return;
+        }
+        auto* x = static_cast<node16*>(n);
+        remove(x);
+        if (x->count > 3) return;
+        auto* s = new (std::nothrow) node4;
+        if (s == nullptr) return;
+        copy_header(s, x);
+        std::copy_n(x->keys, x->count, s->keys);
+        std::copy_n(x->children, x->count, s->children);
+        slot = of(s);
+        delete x;
+        return;
+      }
+      case kind::n48: {
+        auto* x = static_cast<node48*>(n);
+        x->children[x->index[b] - 1] = 0;
+        x->index[b] = 0;
+        --x->count;
+        if (x->count > 12) return;
+        auto* s = new (std::nothrow) node16;
+        if (s == nullptr) return;
+        copy_header(s, x);
+        unsigned j = 0;
+        for (unsigned c = 0; c < 256; ++c) {
+          if (x->index[c] == 0) continue;
+          s->keys[j] = static_cast<unsigned char>(c);
+          s->children[j++] = x->children[x->index[c] - 1];
+        }
+        slot = of(s);
+        delete x;
+        return;
+      }
+      case kind::n256: {
+        auto* x = static_cast<node256*>(n);
+        x->children[b] = 0;
+        --x->count;
+        if (x->count > 36) return;
+        auto* s = new (std::nothrow) node48;
+        if (s == nullptr) return;
+        copy_header(s, x);
+        unsigned j = 0;
+        for (unsigned c = 0; c < 256; ++c) {
+          if (x->children[c] == 0) continue;
+          s->children[j] = x->children[c];
+          s->index[c] = static_cast<unsigned char>(++j);
+        }
+        slot = of(s);
+        delete x;
+        return;
+      }
+    }
+  }
+
+  // After an erase: a Node4 left without children becomes its value leaf,
+  // and one left with a single child and no value is merged into it.
+  static void collapse(ref& slot) noexcept {
+    node* n = as_node(slot);
+    if (n->type != kind::n4) return;
+    auto* x = static_cast<node4*>(n);
+    if (x->count == 0) {
+      slot = x->value != nullptr ? of(x->value) : 0;
+      delete x;
+      return;
+    }
+    if (x->count != 1 || x->value != nullptr) return;
+    const ref child = x->children[0];
+    if (!is_leaf(child)) {
+      node* c = as_node(child);
+      unsigned char merged[max_prefix];
+      std::size_t len = std::min<std::size_t>(x->prefix_len, max_prefix);
+      std::memcpy(merged, x->prefix, len);
+      if (len < max_prefix) merged[len++] = x->keys[0];
+      const std::size_t more = std::min<std::size_t>({c->prefix_len, max_prefix, max_prefix - len});
+      std::memcpy(merged + len, c->prefix, more);
+      std::memcpy(c->prefix, merged, len + more);
+      c->prefix_len += x->prefix_len + 1;
+    }
+    slot = child;
+    delete x;
+  }
+
+  // ----- paths -----
+
+  // Some leaf below n; all of them agree on n's compressed path.
+  static const leaf* any_leaf(const node* n) noexcept {
+    for (;;) {
+      if (n->value != nullptr) return n->value;
+      const ref r = child_at(n, next_pos(n, -1));
+      if (is_leaf(r)) return as_leaf(r);
+      n = as_node(r);
+    }
+  }
+
+  // n's compressed path, which starts at key byte depth.
+  static std::string_view full_prefix(const node* n, std::size_t depth, char* buf) noexcept {
+    if (n->prefix_len <= max_prefix) {
+      return {reinterpret_cast<const char*>(n->prefix), n->prefix_len};
+    }
+    return leaf_key(any_leaf(n), buf).substr(depth, n->prefix_len);
+  }
+
+  static void set_prefix(node* n, std::string_view path) noexcept {
+    n->prefix_len = static_cast<std::uint32_t>(path.size());
+    std::memmove(n->prefix, path.data(), std::min(path.size(), max_prefix));
+  }
+
+  // Optimistic check of n's path against kb from depth: only the inline
+  // bytes are compared, the rest is confirmed at the leaf.
+  static bool prefix_may_match(const node* n, std::string_view kb, std::size_t depth) noexcept {
+    if (kb.size() - depth < n->prefix_len) return false;
+    const std::size_t stored = std::min<std::size_t>(n->prefix_len, max_prefix);
+    return std::memcmp(n->prefix, kb.data() + depth, stored) == 0;
+  }
+
+  leaf* find_leaf(std::string_view kb) const noexcept {
+    ref r = root_;
+    std::size_t depth = 0;
+    while (r != 0) {
+      if (is_leaf(r)) return leaf_matches(as_leaf(r), kb) ? as_leaf(r) : nullptr;
+      const node* n = as_node(r);
+      if (n->prefix_len != 0) {
+        if (!prefix_may_match(n, kb, depth)) return nullptr;
+        depth += n->prefix_len;
+      }
+      if (depth == kb.size()) {
+        return n->value != nullptr && leaf_matches(n->value, kb) ? n->value : nullptr;
+      }
+      const ref* c = find_child(n, static_cast<unsigned char>(kb[depth]));
+      if (c == nullptr) return nullptr;
+      r = *c;
+      ++depth;
+    }
+    return nullptr;
+  }
+
+  template <class Report>
+  size_type batch_lookup(std::span<const Key> keys, Report&& report) noexcept {
+    struct cursor {
+      std::string_view kb;
+      ref r;
+      std::size_t depth;
+      char buf[art_key<Key>::max_size];
+    };
+    cursor cur[batch_group_size];
+    std::uint32_t active[batch_group_size];
+    size_type found = 0;
+    for (size_type base = 0; base < keys.size(); base += batch_group_size) {
+      const size_type g = std::min(batch_group_size, keys.size() - base);
+      for (size_type i = 0; i < g; ++i) {
+        cur[i].kb = art_key<Key>::bytes(keys[base + i], cur[i].buf);
+        cur[i].r = root_;
+        cur[i].depth = 0;
+        active[i] = static_cast<std::uint32_t>(i);
+      }
+      size_type live = g;
+      auto finish = [&](size_type i, leaf* l) {
+        report(base + i, l);
+        found += l != nullptr;
+      };
+      while (live != 0) {
+        size_type next = 0;
+        for (size_type a = 0; a < live; ++a) {
+          cursor& c = cur[active[a]];
+          const size_type i = active[a];
+          if (c.r == 0) {
+            finish(i, nullptr);
+            continue;
+          }
+          if (is_leaf(c.r)) {
+            finish(i, leaf_matches(as_leaf(c.r), c.kb) ? as_leaf(c.r) : nullptr);
+            continue;
+          }
+          const node* n = as_node(c.r);
+          if (n->prefix_len != 0) {
+            if (!prefix_may_match(n, c.kb, c.depth)) {
+              finish(i, nullptr);
+              continue;
+            }
+            c.depth += n->prefix_len;
+          }
+          if (c.depth == c.kb.size()) {
+            finish(i, n->value != nullptr && leaf_matches(n->value, c.kb) ? n->value : nullptr);
+            continue;
+          }
+          const ref* child = find_child(n, static_cast<unsigned char>(c.kb[c.depth]));
+          if (child == nullptr) {
+            finish(i, nullptr);
+            continue;
+          }
+          c.r = *child;
+          ++c.depth;
+          MYSTL_PREFETCH(reinterpret_cast<const void*>(c.r & ~ref{1}));
+          active[next++] = static_cast<std::uint32_t>(i);
+        }
+        live = next;
+      }
+    }
+    return found;
+  }
+
+  template <class Make>
+  std::pair<leaf*, bool> emplace_leaf(std::string_view kb, Make&& make) {
+    ref* slot = &root_;
+    std::size_t depth = 0;
+    char buf[art_key<Key>::max_size];
+    for (;;) {
+      const ref r = *slot;
+      if (r == 0) {
+        leaf* l = make();
+        *slot = of(l);
+        ++size_;
+        return {l, true};
+      }
+      if (is_leaf(r)) {
+        leaf* old = as_leaf(r);
+        const std::string_view ok = leaf_key(old, buf);
+        if (ok == kb) return {old, false};
+        // Split where the two keys part.
+        std::size_t p = depth;
+        while (p < ok.size() && p < kb.size() && ok[p] == kb[p]) ++p;
+        auto* n = new node4;
+        leaf* l;
+        try {
+          l = make();
+        } catch (...) {
+          delete n;
+          throw;
+        }
+        set_prefix(n, kb.substr(depth, p - depth));
+        for (auto [k, x] : {std::pair{ok, old}, std::pair{kb, l}}) {
+          if (p == k.size()) {
+            n->value = x;
+          } else {
+            insert_sorted(n, static_cast<unsigned char>(k[p]), of(x));
+          }
+        }
+        *slot = of(n);
+        ++size_;
+        return {l, true};
+      }
+      node* n = as_node(r);
+      if (n->prefix_len != 0) {
+        const std::string_view path = full_prefix(n, depth, buf);
+        std::size_t p = 0;
+        while (p < path.size() && depth + p < kb.size() && path[p] == kb[depth + p]) ++p;
+        if (p < path.size()) {
+          // The key leaves n's path after p bytes: put a Node4 above n.
+          auto* up = new node4;
+          leaf* l;
+          try {
+            l = make();
+          } catch (...) {
+            delete up;
+            throw;
+          }
+          set_prefix(up, path.substr(0, p));
+          insert_sorted(up, static_cast<unsigned char>(path[p]), r);
+          const std::size_t rest = path.size() - p - 1;
+          std::memmove(n->prefix, path.data() + p + 1, std::min(rest, max_prefix));
+          n->prefix_len = static_cast<std::uint32_t>(rest);
+          if (depth + p == kb.size()) {
+            up->value = l;
+          } else {
+            insert_sorted(up, static_cast<unsigned char>(kb[depth + p]), of(l));
+          }
+          *slot = of(up);
+          ++size_;
+          return {l, true};
+        }
+        depth += n->prefix_len;
+      }
+      if (depth == kb.size()) {
+        if (n->value != nullptr) return {n->value, false};
+        n->value = make();
+        ++size_;
+        return {n->value, true};
+      }
+      const auto b = static_cast<unsigned char>(kb[depth]);
+      if (ref* c = find_child(n, b)) {
+        slot = c;
+        ++depth;
+        continue;
+      }
+      leaf* l = make();
+      try {
+        add_child(*slot, b, of(l));
+      } catch (...) {
+        delete l;
+        throw;
+      }
+      ++size_;
+      return {l, true};
+    }
+  }
+
+  bool erase_leaf(std::string_view kb) noexcept {
+    if (root_ == 0) return false;
+    if (is_leaf(root_)) {
+      if (!leaf_matches(as_leaf(root_), kb)) return false;
+      delete as_leaf(std::exchange(root_, 0));
+      --size_;
+      return true;
+    }
+    ref* slot = &root_;
+    std::size_t depth = 0;
+    for (;;) {
+      node* n = as_node(*slot);
+      if (n->prefix_len != 0) {
+        if (!prefix_may_match(n, kb, depth)) return false;
+        depth += n->prefix_len;
+      }
+      if (depth == kb.size()) {
+        if (n->value == nullptr || !leaf_matches(n->value, kb)) return false;
+        delete std::exchange(n->value, nullptr);
+        break;
+      }
+      const auto b = static_cast<unsigned char>(kb[depth]);
+      ref* c = find_child(n, b);
+      if (c == nullptr) return false;
+      if (is_leaf(*c)) {
+        if (!leaf_matches(as_leaf(*c), kb)) return false;
+        delete as_leaf(*c);
+        remove_child(*slot, b);
+        break;
+      }
+      slot = c;
+      ++depth;
+    }
+    collapse(*slot);
+    --size_;
+    return true;
+  }
+
+  // ----- traversal -----
+
+  static constexpr int npos = 256;
+
+  // Next position after pos (-1 for the start) that holds a child, or npos.
+  // Positions are slots in Node4/16 and key bytes in Node48/256.
+  static int next_pos(const node* n, int pos) noexcept {
+    switch (n->type) {
+      case kind::n4:
+      case kind::n16:
+        return pos + 1 < n->count ? pos + 1 : npos;
+      case kind::n48: {
+        auto* x = static_cast<const node48*>(n);
+        for (int c = pos + 1; c < 256; ++c) {
+          if (x->index[c] != 0) return c;
+        }
+        return npos;
+      }
+      case kind::n256: {
+        auto* x = static_cast<const node256*>(n);
+        for (int c = pos + 1; c < 256; ++c) {
+          if (x->children[c] != 0) return c;
+        }
+        return npos;
+      }
+    }
+    return npos;
+  }
+
+  static ref child_at(const node* n, int pos) noexcept {
+    switch (n->type) {
+      case kind::n4:
+        return static_cast<const node4*>(n)->children[pos];
+      case kind::n16:
+        return static_cast<const node16*>(n)->children[pos];
+      case kind::n48: {
+        auto* x = static_cast<const node48*>(n);
+        return x->children[x->index[pos] - 1];
+      }
+      case kind::n256:
+        return static_cast<const node256*>(n)->children[pos];
+    }
+    return 0;
+  }
+
+  static unsigned char byte_at(const node* n, int pos) noexcept {
+    switch (n->type) {
+      case kind::n4:
+        return static_cast<const node4*>(n)->keys[pos];
+      case kind::n16:
+        return static_cast<const node16*>(n)->keys[pos];
+      default:
+        return static_cast<unsigned char>(pos);
+    }
+  }
+
+  // First position whose key byte is >= b, or npos.
+  static int lower_pos(const node* n, unsigned char b) noexcept {
+    // Scan the concrete type: through byte_at, GCC hoists the shared keys[i]
+    // load and then bounds the loop by node4's four keys.
+    auto scan = [b](const auto* x) {
+      for (int i = 0; i < x->count; ++i) {
+        if (x->keys[i] >= b) return i;
+      }
+      return npos;
+    };
+    switch (n->type) {
+      case kind::n4:
+        return scan(static_cast<const node4*>(n));
+      case kind::n16:
+        return scan(static_cast<const node16*>(n));
+      default:
+        return next_pos(n, static_cast<int>(b) - 1);
+    }
+  }
+
+  template <class F>
+  static void visit(ref r, F& f) {
+    if (r == 0) return;
+    if (is_leaf(r)) {
+      f(std::as_const(as_leaf(r)->kv));
+      return;
+    }
+    const node* n = as_node(r);
+    if (n->value != nullptr) f(std::as_const(n->value->kv));
+    for (int p = next_pos(n, -1); p != npos; p = next_pos(n, p)) visit(child_at(n, p), f);
+  }
+
+  iterator lower_bound_bytes(std::string_view kb) noexcept {
+    iterator it;
+    ref r = root_;
+    std::size_t depth = 0;
+    char buf[art_key<Key>::max_size];
+    while (r != 0) {
+      if (is_leaf(r)) {
+        if (leaf_key(as_leaf(r), buf) >= kb) {
+          it.leaf_ = as_leaf(r);
+        } else {
+          it.advance();
+        }
+        return it;
+      }
+      const node* n = as_node(r);
+      if (n->prefix_len != 0) {
+        const std::string_view path = full_prefix(n, depth, buf);
+        const int cmp = path.compare(0, path.size(), kb.substr(depth, path.size()));
+        if (cmp > 0 || (cmp == 0 && kb.size() - depth < path.size())) {
+          it.enter(r);  // everything below n is greater
+          return it;
+        }
+        if (cmp < 0) {
+          it.advance();  // everything below n is smaller
+          return it;
+        }
+        depth += path.size();
+      }
+      if (depth == kb.size()) {
+        it.enter(r);
+        return it;
+      }
+      const auto b = static_cast<unsigned char>(kb[depth]);
+      const int p = lower_pos(n, b);
+      if (p == npos) {
+        it.advance();
+        return it;
+      }
+      it.stack_.push_back({n, p});
+      r = child_at(n, p);
+      if (byte_at(n, p) != b) {
+        it.enter_child(r);
+        return it;
+      }
+      ++depth;
+    }
+    return it;
+  }
+
+  struct frame {
+    const node* n;
+    int pos;  // child being visited, -1 while on the value
+  };
+
+  // In-order iterator: a stack of inner nodes with the position of the
+  // child being visited in each.
+  template <bool Const>
+  class basic_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = art_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    basic_iterator() = default;
+    template <bool C = Const>
+      requires C
+    basic_iterator(const basic_iterator<false>& other) : stack_(other.stack_), leaf_(other.leaf_) {}
+
+    reference operator*() const noexcept { return leaf_->kv; }
+    pointer operator->() const noexcept { return &leaf_->kv; }
+
+    basic_iterator& operator++() {
+      advance();
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      basic_iterator t = *this;
+      advance();
+      return t;
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept {
+      return a.leaf_ == b.leaf_;
+    }
+
+   private:
+    friend class art_map;
+    template <bool>
+    friend class basic_iterator;
+
+    // Positions on the first element at or below r.
+    void enter(ref r) {
+      if (r == 0) return;
+      if (is_leaf(r)) {
+        leaf_ = as_leaf(r);
+        return;
+      }
+      enter_child(r);
+    }
+
+    // Like enter(), for an r that already has its position on the stack.
+    void enter_child(ref r) {
+      if (is_leaf(r)) {
+        leaf_ = as_leaf(r);
+        return;
+      }
+      const node* n = as_node(r);
+      stack_.push_back({n, -1});
+      if (n->value != nullptr) {
+        leaf_ = n->value;
+      } else {
+        advance();
+      }
+    }
+
+    void advance() {
+      while (!stack_.empty()) {
+        frame& f = stack_.back();
+        const int p = next_pos(f.n, f.pos);
+        if (p == npos) {
+          stack_.pop_back();
+          continue;
+        }
+        f.pos = p;
+        const ref c = child_at(f.n, p);
+        if (is_leaf(c)) {
+          leaf_ = as_leaf(c);
+          return;
+        }
+        const node* n = as_node(c);
+        stack_.push_back({n, -1});
+        if (n->value != nullptr) {
+          leaf_ = n->value;
+          return;
+        }
+      }
+      leaf_ = nullptr;
+    }
+
+    std::vector<frame> stack_;
+    leaf* leaf_ = nullptr;
+  };
+
+  // ----- ownership -----
+
+  static void destroy(ref r) noexcept {
+    if (r == 0) return;
+    if (is_leaf(r)) {
+      delete as_leaf(r);
+      return;
+    }
+    node* n = as_node(r);
+    for (int p = next_pos(n, -1); p != npos; p = next_pos(n, p)) destroy(child_at(n, p));
+    delete n->value;
+    switch (n->type) {
+      case kind::n4:
+        delete static_cast<node4*>(n);
+        break;
+      case kind::n16:
+        delete static_cast<node16*>(n);
+        break;
+      case kind::n48:
+        delete static_cast<node48*>(n);
+        break;
+      case kind::n256:
+        delete static_cast<node256*>(n);
+        break;
+    }
+  }
+
+  // Deep copy. A partly built copy is released if an allocation throws.
+  static ref clone(ref r) {
+    if (r == 0) return 0;
+    if (is_leaf(r)) return of(new leaf(as_leaf(r)->kv));
+    const node* n = as_node(r);
+    node* c = nullptr;
+    switch (n->type) {
+      case kind::n4:
+        c = new node4(*static_cast<const node4*>(n));
+        break;
+      case kind::n16:
+        c = new node16(*static_cast<const node16*>(n));
+        break;
+      case kind::n48:
+        c = new node48(*static_cast<const node48*>(n));
+        break;
+      case kind::n256:
+        c = new node256(*static_cast<const node256*>(n));
+        break;
+    }
+    // Detach the copied pointers, then fill them in one by one.
+    c->value = nullptr;
+    for (int p = next_pos(n, -1); p != npos; p = next_pos(n, p)) child_slot(c, p) = 0;
+    const std::uint16_t count = c->count;
+    if (n->type == kind::n4 || n->type == kind::n16) c->count = 0;
+    try {
+      if (n->value != nullptr) c->value = new leaf(n->value->kv);
+      for (int p = next_pos(n, -1); p != npos; p = next_pos(n, p)) {
+        child_slot(c, p) = clone(child_at(n, p));
+        if (n->type == kind::n4 || n->type == kind::n16) ++c->count;
+      }
+    } catch (...) {
+      destroy(of(c));
+      throw;
+    }
+    c->count = count;
+    return of(c);
+  }
+
+  static ref& child_slot(node* n, int pos) noexcept {
+    switch (n->type) {
+      case kind::n4:
+        return static_cast<node4*>(n)->children[pos];
+      case kind::n16:
+        return static_cast<node16*>(n)->children[pos];
+      case kind::n48: {
+        auto* x = static_cast<node48*>(n);
+        return x->children[x->index[pos] - 1];
+      }
+      default:
+        return static_cast<node256*>(n)->children[pos];
+    }
+  }
+
+  ref root_ = 0;
+  size_type size_ = 0;
+};
+
+}  // namespace mystl
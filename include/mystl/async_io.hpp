@@ -0,0 +1,582 @@
+#pragma once
+
+// Asynchronous positional file I/O for coroutine tasks, on io_uring with a
+// thread-pool fallback.
+//
+//   mystl::io_context io;
+//   mystl::task<std::size_t> copy_block(mystl::io_context& io, int in, int out,
+//                                       std::span<std::byte> buf, std::uint64_t off) {
+//     const std::size_t n = co_await mystl::async_read(io, in, buf, off);
+//     co_return co_await mystl::async_write(io, out, buf.first(n), off);
+//   }
+//   io.block_on(copy_block(io, in, out, buf, 0));
+//
+// io_context is a single-threaded event loop, driven by run() or block_on(),
+// which owns an io_uring instance set up through the raw syscalls, so no
+// liburing is needed. An operation awaited on the loop thread only writes a
+// submission queue entry. Every entry prepared during one loop iteration
+// goes to the kernel in a single io_uring_enter, which also reaps
+// completions. Operations awaited on other threads are handed to the loop
+// first. Buffers registered with register_buffers() can be used with
+// async_read_fixed/async_write_fixed to skip per-I/O page pinning.
+//
+// If io_uring is unavailable (old kernel, seccomp, containers that disable
+// it), or if backend thread_pool is requested, operations run as blocking
+// pread/pwrite on a small pool of worker threads instead. Either way the
+// awaiting coroutine resumes on the loop thread, and a failed operation
+// throws std::system_error.
+//
+// The operations are awaitables rather than tasks, so an I/O never
+// allocates.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "config.hpp"
+#include "executor.hpp"
+#include "task.hpp"
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define MYSTL_HAS_IO_URING 1
+#else
+#include <unistd.h>
+#define MYSTL_HAS_IO_URING 0
+#endif
+
+namespace mystl {
+
+enum class io_backend {
+  io_uring,
+  thread_pool,
+};
+
+class io_context;
+
+namespace detail {
+
+enum class io_opcode : std::uint8_t { read, write, read_fixed, write_fixed };
+
+// One in-flight read or write. It lives in the awaiting coroutine's frame
+// and is queued intrusively, both on the loop and on the fallback pool.
+struct io_operation : work_item {
+  io_context* ctx;
+  io_opcode op;
+  int fd;
+  void* buf;
+  std::size_t len;
+  std::uint64_t offset;
+  unsigned buf_index;
+  std::int64_t result = 0;
+  std::coroutine_handle<> h;
+};
+
+#if MYSTL_HAS_IO_URING
+// Raw io_uring: the rings are mapped straight from the kernel and accessed
+// with the acquire/release protocol the kernel expects on head and tail.
+class uring {
+ public:
+  bool setup(unsigned entries) noexcept {
+    io_uring_params p{};
+    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    if (fd_ < 0) return false;
+
+    sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+
+    sq_ptr_ = ::mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                     IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) return fail();
+    cq_ptr_ = single ? sq_ptr_
+                     : ::mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              fd_, IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) return fail();
+    sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) return fail();
+
+    auto* sq = static_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    auto* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return true;
+  }
+
+  ~uring() { close(); }
+
+  // True if the kernel implements every opcode in ops. Rings from before
+  // 5.6 cannot be probed, and lack IORING_OP_READ and IORING_OP_WRITE too.
+  bool supports(std::initializer_list<std::uint8_t> ops) const noexcept {
+    constexpr unsigned max_ops = 256;
+    alignas(io_uring_probe) unsigned char buf[sizeof(io_uring_probe) +
+                                              max_ops * sizeof(io_uring_probe_op)] = {};
+    auto* probe = reinterpret_cast<io_uring_probe*>(buf);
+    if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+      return false;
+    }
+    for (const std::uint8_t op : ops) {
+      if (op >= probe->ops_len || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+    }
+    return true;
+  }
+
+  bool valid() const noexcept { return fd_ >= 0; }
+  int fd() const noexcept { return fd_; }
+
+  // Returns a zeroed entry, flushing the queue to the kernel first if it
+  // is full. Returns nullptr if the queue stays full because the kernel
+  // refused more work (completion queue overflow); reap and retry.
+  io_uring_sqe* next_sqe() noexcept {
+    if (sq_full()) {
+      enter(0);
+      if (sq_full()) return nullptr;
+    }
+    const unsigned i = sq_tail_local_ & sq_mask_;
+    sq_array_[i] = i;
+    io_uring_sqe* sqe = &sqes_[i];
+    *sqe = io_uring_sqe{};
+    ++sq_tail_local_;
+    ++pending_;
+    return sqe;
+  }
+
+  // Submits everything prepared so far and waits for at least
+  // min_complete completions. Returns false if the kernel refused, e.g.
+  // with EBUSY/EAGAIN while the completion queue is full; the caller reaps
+  // before trying again.
+  bool enter(unsigned min_complete) noexcept {
+    std::atomic_ref<unsigned>(*sq_tail_).store(sq_tail_local_, std::memory_order_release);
+    for (;;) {
+      const long r = ::syscall(__NR_io_uring_enter, fd_, pending_, min_complete,
+                               min_complete ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+      if (r >= 0) {
+        pending_ -= static_cast<unsigned>(r);
+        return true;
+      }
+      if (errno != EINTR) return false;
+    }
+  }
+
+  template <class Fn>
+  unsigned reap(Fn on_completion) noexcept {
+    std::atomic_ref<unsigned> head_ref(*cq_head_);
+    unsigned head = head_ref.load(std::memory_order_relaxed);
+    const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+    const unsigned n = tail - head;
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      on_completion(cqe.user_data, cqe.res);
+    }
+    head_ref.store(head, std::memory_order_release);
+    return n;
+  }
+
+  unsigned pending() const noexcept { return pending_; }
+
+  void close() noexcept { fail(); }
+
+ private:
+  bool sq_full() const noexcept {
+    const unsigned head = std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+    return sq_tail_local_ - head == sq_entries_;
+  }
+
+  bool fail() noexcept {
+    if (sqes_ && sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_len_);
+    if (cq_ptr_ && cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_len_);
+    if (sq_ptr_ && sq_ptr_ != MAP_FAILED) ::munmap(sq_ptr_, sq_len_);
+    if (fd_ >= 0) ::close(fd_);
+    sqes_ = nullptr;
+    sq_ptr_ = cq_ptr_ = nullptr;
+    fd_ = -1;
+    return false;
+  }
+
+  int fd_ = -1;
+  void* sq_ptr_ = nullptr;
+  void* cq_ptr_ = nullptr;
+  std::size_t sq_len_ = 0, cq_len_ = 0, sqes_len_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0, sq_entries_ = 0, sq_tail_local_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned pending_ = 0;
+};
+#endif
+
+}  // namespace detail
+
+class io_context {
+ public:
+  // entries sizes the submission queue. The fallback pool has
+  // fallback_threads workers.
+  explicit io_context(io_backend preferred = io_backend::io_uring, unsigned entries = 256,
+                      std::size_t fallback_threads = 4) {
+#if MYSTL_HAS_IO_URING
+    // Kernels 5.1 to 5.5 have io_uring but only its vectored and fixed
+    // reads and writes; they get the pool.
+    if (preferred == io_backend::io_uring && ring_.setup(entries) &&
+        ring_.supports({IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED,
+                        IORING_OP_WRITE_FIXED})) {
+      event_fd_ = ::eventfd(0, EFD_CLOEXEC);
+      if (event_fd_ >= 0) {
+        arm_wakeup();
+        return;
+      }
+    }
+    ring_.close();
+#else
+    (void)preferred;
+    (void)entries;
+#endif
+    pool_ = std::make_unique<thread_pool>(fallback_threads);
+  }
+
+  io_context(const io_context&) = delete;
+  io_context& operator=(const io_context&) = delete;
+
+  ~io_context() {
+    pool_.reset();
+#if MYSTL_HAS_IO_URING
+    if (event_fd_ >= 0) ::close(event_fd_);
+#endif
+  }
+
+  io_backend backend() const noexcept {
+    return pool_ ? io_backend::thread_pool : io_backend::io_uring;
+  }
+
+  // Awaiting the result continues the coroutine on the loop thread.
+  [[nodiscard]] detail::schedule_awaiter<io_context> schedule() noexcept {
+    return detail::schedule_awaiter<io_context>(*this);
+  }
+
+  // Queues w to run on the loop thread; callable from any thread.
+  void enqueue(detail::work_item* w) noexcept {
+    remote_.push(w);
+    if (sleeping_.exchange(false)) wake();
+  }
+
+  // Runs the loop on the calling thread until finish() has been called and
+  // no work or I/O is outstanding.
+  void run() {
+    loop_thread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    for (;;) {
+      while (detail::work_item* w = remote_.try_pop()) w->execute(w);
+      if (stopping_.load(std::memory_order_acquire) && in_flight_ == 0 && remote_.empty()) break;
+      // sleeping_ is raised before the final check so that enqueue() and
+      // finish() either see it and wake the loop, or are seen here.
+      sleeping_.store(true);
+      const bool idle = remote_.empty() && (!stopping_.load() || in_flight_ != 0);
+#if MYSTL_HAS_IO_URING
+      if (!pool_) {
+        // One syscall submits everything prepared this iteration. It blocks
+        // only when idle; the eventfd read that is always armed completes
+        // when new work arrives. Deferred submissions keep it from blocking.
+        const bool deferred = deferred_head_ || wakeup_deferred_;
+        ring_.enter(idle && !deferred ? 1 : 0);
+        sleeping_.store(false);
+        reap();
+        retry_deferred();
+        continue;
+      }
+#endif
+      if (idle) {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait(lock, [&] { return signalled_; });
+        signalled_ = false;
+      }
+      sleeping_.store(false);
+    }
+    stopping_.store(false, std::memory_order_relaxed);
+    loop_thread_.store(std::thread::id(), std::memory_order_relaxed);
+  }
+
+  void finish() noexcept {
+    stopping_.store(true, std::memory_order_release);
+    if (sleeping_.exchange(false)) wake();
+  }
+
+  // Runs t on the calling thread, driving the loop until t completes.
+  template <class T>
+  T block_on(task<T> t) {
+    loop_thread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    return detail::drive_to_completion(std::move(t), [this](detail::sync_wait_task& w) {
+      w.start([](void* self) noexcept { static_cast<io_context*>(self)->finish(); }, this);
+      run();
+    });
+  }
+
+  // Registers buffers with the kernel for the *_fixed operations. Returns
+  // false under the fallback backend, where fixed operations behave like
+  // plain ones. Must not be called with I/O in flight.
+  bool register_buffers(std::span<const ::iovec> buffers) noexcept {
+#if MYSTL_HAS_IO_URING
+    if (!pool_) {
+      return ::syscall(__NR_io_uring_register, ring_.fd(), IORING_REGISTER_BUFFERS, buffers.data(),
+                       static_cast<unsigned>(buffers.size())) == 0;
+    }
+#endif
+    (void)buffers;
+    return false;
+  }
+  void unregister_buffers() noexcept {
+#if MYSTL_HAS_IO_URING
+    if (!pool_) {
+      ::syscall(__NR_io_uring_register, ring_.fd(), IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    }
+#endif
+  }
+
+  // Called by io operations from await_suspend.
+  void submit(detail::io_operation* op) noexcept {
+    if (pool_) {
+      ++in_flight_;
+      op->execute = [](detail::work_item* w) noexcept {
+        auto* o = static_cast<detail::io_operation*>(w);
+        o->result = blocking_io(*o);
+        o->execute = [](detail::work_item* w2) noexcept {
+          auto* o2 = static_cast<detail::io_operation*>(w2);
+          --o2->ctx->in_flight_;
+          o2->h.resume();
+        };
+        o->ctx->enqueue(o);
+      };
+      pool_->enqueue(op);
+      return;
+    }
+#if MYSTL_HAS_IO_URING
+    if (std::this_thread::get_id() == loop_thread_.load(std::memory_order_relaxed)) {
+      prepare(op);
+    } else {
+      op->execute = [](detail::work_item* w) noexcept {
+        auto* o = static_cast<detail::io_operation*>(w);
+        o->ctx->prepare(o);
+      };
+      enqueue(op);
+    }
+#endif
+  }
+
+ private:
+  static std::int64_t blocking_io(const detail::io_operation& o) noexcept {
+    for (;;) {
+      const ::ssize_t r =
+          o.op == detail::io_opcode::read || o.op == detail::io_opcode::read_fixed
+              ? ::pread(o.fd, o.buf, o.len, static_cast<::off_t>(o.offset))
+              : ::pwrite(o.fd, o.buf, o.len, static_cast<::off_t>(o.offset));
+      if (r >= 0) return r;
+      if (errno != EINTR) return -errno;
+    }
+  }
+
+#if MYSTL_HAS_IO_URING
+  static constexpr std::uint64_t wakeup_tag = 0;
+
+  void prepare(detail::io_operation* op) noexcept {
+    ++in_flight_;
+    if (!try_prepare(op)) defer(op);
+  }
+
+  bool try_prepare(detail::io_operation* op) noexcept {
+    io_uring_sqe* sqe = ring_.next_sqe();
+    if (!sqe) return false;
+    switch (op->op) {
+      case detail::io_opcode::read: sqe->opcode = IORING_OP_READ; break;
+      case detail::io_opcode::write: sqe->opcode = IORING_OP_WRITE; break;
+      case detail::io_opcode::read_fixed: sqe->opcode = IORING_OP_READ_FIXED; break;
+      case detail::io_opcode::write_fixed: sqe->opcode = IORING_OP_WRITE_FIXED; break;
+    }
+    sqe->fd = op->fd;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(op->buf);
+    // Larger requests complete short, as pread(2) and pwrite(2) do.
+    sqe->len = static_cast<std::uint32_t>(std::min<std::size_t>(op->len, 0x7ffff000));
+    sqe->off = op->offset;
+    sqe->buf_index = static_cast<std::uint16_t>(op->buf_index);
+    sqe->user_data = reinterpret_cast<std::uintptr_t>(op);
+    return true;
+  }
+
+  // Operations that found the submission queue full wait here, in order,
+  // until a later loop iteration has reaped completions.
+  void defer(detail::io_operation* op) noexcept {
+    op->next = nullptr;
+    if (deferred_tail_) {
+      deferred_tail_->next = op;
+    } else {
+      deferred_head_ = op;
+    }
+    deferred_tail_ = op;
+  }
+
+  void retry_deferred() noexcept {
+    if (wakeup_deferred_) arm_wakeup();
+    while (deferred_head_) {
+      auto* op = static_cast<detail::io_operation*>(deferred_head_);
+      if (!try_prepare(op)) return;
+      deferred_head_ = op->next;
+      if (!deferred_head_) deferred_tail_ = nullptr;
+    }
+  }
+
+  void arm_wakeup() noexcept {
+    io_uring_sqe* sqe = ring_.next_sqe();
+    wakeup_deferred_ = !sqe;
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = event_fd_;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(&event_buf_);
+    sqe->len = sizeof(event_buf_);
+    sqe->user_data = wakeup_tag;
+  }
+
+  void reap() noexcept {
+    ring_.reap([&](std::uint64_t tag, std::int32_t res) {
+      if (tag == wakeup_tag) {
+        arm_wakeup();
+        return;
+      }
+      auto* op = reinterpret_cast<detail::io_operation*>(static_cast<std::uintptr_t>(tag));
+      op->result = res;
+      --in_flight_;
+      op->h.resume();
+    });
+  }
+#endif
+
+  void wake() noexcept {
+#if MYSTL_HAS_IO_URING
+    if (!pool_) {
+      const std::uint64_t one = 1;
+      [[maybe_unused]] const auto r = ::write(event_fd_, &one, sizeof(one));
+      return;
+    }
+#endif
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      signalled_ = true;
+    }
+    wake_cv_.notify_one();
+  }
+
+#if MYSTL_HAS_IO_URING
+  detail::uring ring_;
+  int event_fd_ = -1;
+  std::uint64_t event_buf_ = 0;
+  detail::work_item* deferred_head_ = nullptr;
+  detail::work_item* deferred_tail_ = nullptr;
+  bool wakeup_deferred_ = false;
+#endif
+  std::unique_ptr<thread_pool> pool_;
+  detail::work_queue remote_;
+  std::atomic<std::thread::id> loop_thread_{};
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> stopping_{false};
+  std::atomic<std::size_t> in_flight_{0};
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  bool signalled_ = false;
+};
+
+namespace detail {
+
+class io_awaiter {
+ public:
+  io_awaiter(io_context& ctx, io_opcode op, int fd, void* buf, std::size_t len,
+             std::uint64_t offset, unsigned buf_index = 0) noexcept {
+    op_.ctx = &ctx;
+    op_.op = op;
+    op_.fd = fd;
+    op_.buf = buf;
+    op_.len = len;
+    op_.offset = offset;
+    op_.buf_index = buf_index;
+  }
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) noexcept {
+    op_.h = h;
+    op_.ctx->submit(&op_);
+  }
+  std::size_t await_resume() const {
+    if (op_.result < 0) {
+      throw std::system_error(static_cast<int>(-op_.result), std::system_category(),
+                              op_.op == io_opcode::read || op_.op == io_opcode::read_fixed
+                                  ? "async_read"
+                                  : "async_write");
+    }
+    return static_cast<std::size_t>(op_.result);
+  }
+
+ private:
+  io_operation op_;
+};
+
+}  // namespace detail
+
+// Reads up to buf.size() bytes at offset and returns the count read. As
+// with pread(2), the count can be short: at end of file, on pipes and
+// sockets, and for requests over 0x7ffff000 bytes, the most the kernel
+// transfers in one call. Writes likewise.
+[[nodiscard]] inline detail::io_awaiter async_read(io_context& ctx, int fd,
+                                                   std::span<std::byte> buf,
+                                                   std::uint64_t offset) noexcept {
+  return {ctx, detail::io_opcode::read, fd, buf.data(), buf.size(), offset};
+}
+
+[[nodiscard]] inline detail::io_awaiter async_write(io_context& ctx, int fd,
+                                                    std::span<const std::byte> buf,
+                                                    std::uint64_t offset) noexcept {
+  return {ctx, detail::io_opcode::write, fd, const_cast<std::byte*>(buf.data()), buf.size(),
+          offset};
+}
+
+// As above, with buf inside registered buffer buf_index.
+[[nodiscard]] inline detail::io_awaiter async_read_fixed(io_context& ctx, int fd,
+                                                         std::span<std::byte> buf,
+                                                         unsigned buf_index,
+                                                         std::uint64_t offset) noexcept {
+  return {ctx, detail::io_opcode::read_fixed, fd, buf.data(), buf.size(), offset, buf_index};
+}
+
+[[nodiscard]] inline detail::io_awaiter async_write_fixed(io_context& ctx, int fd,
+                                                          std::span<const std::byte> buf,
+                                                          unsigned buf_index,
+                                                          std::uint64_t offset) noexcept {
+  return {ctx, detail::io_opcode::write_fixed, fd, const_cast<std::byte*>(buf.data()), buf.size(),
+          offset, buf_index};
+}
+
+}  // namespace mystl
@@ -0,0 +1,384 @@
+#pragma once
+
+// Approximate membership filters with no false negatives.
+//
+//  - bloom_filter: classic k-probe filter over one bit array.
+//  - blocked_bloom_filter: split-block Bloom filter. Every key maps to one
+//    256-bit block (never straddling a cache line) and sets one bit in each
+//    of its eight 32-bit words, so a query touches exactly one cache line and
+//    is a handful of SIMD instructions (AVX2 when available).
+//  - counting_bloom_filter: the same blocked layout with 4-bit saturating
+//    counters in place of bits, so keys can also be erased.
+//
+// Hash is any callable (const Key&) -> std::uint64_t; the default is
+// seeded_hash<Key>. Batch APIs hash a group of keys, prefetch their cache
+// lines and only then probe, so the misses of a group overlap.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Expected false-positive rate of a blocked filter whose blocks hold on
+// average lambda keys, each key setting one of slots_per_lane slots in each
+// of eight lanes. Sums over the Poisson distribution of block loads.
+inline double blocked_filter_fpp(double lambda, double slots_per_lane) {
+  const double miss = 1.0 - 1.0 / slots_per_lane;
+  const int limit = static_cast<int>(lambda * 6 + 64);
+  double p = std::exp(-lambda), sum = 0.0;
+  for (int l = 0; l < limit; ++l) {
+    if (l > 0) p *= lambda / l;
+    sum += p * std::pow(1.0 - std::pow(miss, l), 8);
+  }
+  return sum;
+}
+
+// Number of blocks needed to hold n keys at the target false-positive rate.
+inline std::size_t blocked_filter_blocks(std::size_t n, double fpp, double slots_per_lane) {
+  if (!(fpp > 0.0 && fpp < 1.0)) throw std::invalid_argument("filter: fpp must be in (0, 1)");
+  double lo = 1e-3, hi = 8 * slots_per_lane;
+  for (int it = 0; it < 60; ++it) {
+    const double mid = (lo + hi) / 2;
+    (blocked_filter_fpp(mid, slots_per_lane) <= fpp ? lo : hi) = mid;
+  }
+  return std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(static_cast<double>(n) / lo)));
+}
+
+// Odd multipliers from the split-block Bloom filter of Impala / Parquet; each
+// selects one bit of a 32-bit lane from the top five bits of h * salt.
+alignas(32) inline constexpr std::uint32_t bloom_salts[8] = {
+    0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+    0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u};
+
+}  // namespace detail
+
+// ---------------------------------------------------------------------------
+// bloom_filter
+// ---------------------------------------------------------------------------
+
+template <class Key, class Hash = seeded_hash<Key>>
+class bloom_filter {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  // Sized for expected_items keys at false-positive rate fpp.
+  bloom_filter(std::size_t expected_items, double fpp, const Hash& hash = Hash()) : hash_(hash) {
+    if (!(fpp > 0.0 && fpp < 1.0)) {
+      throw std::invalid_argument("bloom_filter: fpp must be in (0, 1)");
+    }
+    const double ln2 = std::log(2.0);
+    const double n = static_cast<double>(std::max<std::size_t>(1, expected_items));
+    const double bits = std::ceil(-n * std::log(fpp) / (ln2 * ln2));
+    bits_ = std::max<std::uint64_t>(64, static_cast<std::uint64_t>(bits));
+    const long k = std::lround(static_cast<double>(bits_) / n * ln2);
+    k_ = std::clamp(static_cast<unsigned>(k), 1u, 32u);
+    words_.assign((bits_ + 63) / 64, 0);
+  }
+
+  void insert(const Key& key) noexcept { insert_hash(hash_(key)); }
+  bool contains(const Key& key) const noexcept { return contains_hash(hash_(key)); }
+
+  void insert_hash(std::uint64_t h) noexcept {
+    const std::uint64_t h2 = mix64(h) | 1;
+    for (unsigned i = 0; i < k_; ++i, h += h2) {
+      const std::uint64_t bit = fastrange64(h, bits_);
+      words_[bit >> 6] |= std::uint64_t{1} << (bit & 63);
+    }
+  }
+
+  bool contains_hash(std::uint64_t h) const noexcept {
+    const std::uint64_t h2 = mix64(h) | 1;
+    for (unsigned i = 0; i < k_; ++i, h += h2) {
+      const std::uint64_t bit = fastrange64(h, bits_);
+      if (!((words_[bit >> 6] >> (bit & 63)) & 1)) return false;
+    }
+    return true;
+  }
+
+  void insert_batch(std::span<const Key> keys) noexcept {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH_WRITE(&words_[fastrange64(hs[i], bits_) >> 6]);
+      }
+      for (std::size_t i = 0; i < g; ++i) insert_hash(hs[i]);
+    }
+  }
+
+  // Writes one result per key and returns the number of positives.
+  std::size_t contains_batch(std::span<const Key> keys, std::span<bool> out) const noexcept {
+    std::uint64_t hs[batch_group_size];
+    std::size_t hits = 0;
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH(&words_[fastrange64(hs[i], bits_) >> 6]);
+      }
+      for (std::size_t i = 0; i < g; ++i) hits += out[base + i] = contains_hash(hs[i]);
+    }
+    return hits;
+  }
+
+  // Union with a filter of identical geometry.
+  void merge(const bloom_filter& other) {
+    if (other.bits_ != bits_ || other.k_ != k_) {
+      throw std::invalid_argument("bloom_filter::merge: geometry mismatch");
+    }
+    for (std::size_t i = 0; i < words_.size(); ++i) words_[i] |= other.words_[i];
+  }
+
+  void clear() noexcept { std::fill(words_.begin(), words_.end(), 0); }
+
+  std::uint64_t bit_count() const noexcept { return bits_; }
+  unsigned hash_count() const noexcept { return k_; }
+  std::size_t memory_usage() const noexcept { return words_.size() * sizeof(std::uint64_t); }
+
+ private:
+  std::vector<std::uint64_t> words_;
+  std::uint64_t bits_ = 0;
+  unsigned k_ = 0;
+  [[no_unique_address]] Hash hash_{};
+};
+
+// ---------------------------------------------------------------------------
+// blocked_bloom_filter
+// ---------------------------------------------------------------------------
+
+template <class Key, class Hash = seeded_hash<Key>>
+class blocked_bloom_filter {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  struct alignas(32) block {
+    std::uint32_t words[8];
+  };
+
+  // Sized for expected_items keys at false-positive rate fpp.
+  blocked_bloom_filter(std::size_t expected_items, double fpp, const Hash& hash = Hash())
+      : blocks_(detail::blocked_filter_blocks(expected_items, fpp, 32)), hash_(hash) {}
+
+  void insert(const Key& key) noexcept { insert_hash(hash_(key)); }
+  bool contains(const Key& key) const noexcept { return contains_hash(hash_(key)); }
+
+  void insert_hash(std::uint64_t h) noexcept {
+    block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+#if defined(__AVX2__)
+    __m256i* p = reinterpret_cast<__m256i*>(b.words);
+    _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), make_mask(lo)));
+#else
+    for (int i = 0; i < 8; ++i) {
+      b.words[i] |= std::uint32_t{1} << ((lo * detail::bloom_salts[i]) >> 27);
+    }
+#endif
+  }
+
+  bool contains_hash(std::uint64_t h) const noexcept {
+    const block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+#if defined(__AVX2__)
+    const __m256i* p = reinterpret_cast<const __m256i*>(b.words);
+    return _mm256_testc_si256(_mm256_load_si256(p), make_mask(lo));
+#else
+    std::uint32_t missing = 0;
+    for (int i = 0; i < 8; ++i) {
+      missing |= ~b.words[i] & (std::uint32_t{1} << ((lo * detail::bloom_salts[i]) >> 27));
+    }
+    return missing == 0;
+#endif
+  }
+
+  void insert_batch(std::span<const Key> keys) noexcept {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH_WRITE(&blocks_[block_index(hs[i])]);
+      }
+      for (std::size_t i = 0; i < g; ++i) insert_hash(hs[i]);
+    }
+  }
+
+  // Writes one result per key and returns the number of positives.
+  std::size_t contains_batch(std::span<const Key> keys, std::span<bool> out) const noexcept {
+    std::uint64_t hs[batch_group_size];
+    std::size_t hits = 0;
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH(&blocks_[block_index(hs[i])]);
+      }
+      for (std::size_t i = 0; i < g; ++i) hits += out[base + i] = contains_hash(hs[i]);
+    }
+    return hits;
+  }
+
+  void merge(const blocked_bloom_filter& other) {
+    if (other.blocks_.size() != blocks_.size()) {
+      throw std::invalid_argument("blocked_bloom_filter::merge: geometry mismatch");
+    }
+    for (std::size_t i = 0; i < blocks_.size(); ++i) {
+      for (int w = 0; w < 8; ++w) blocks_[i].words[w] |= other.blocks_[i].words[w];
+    }
+  }
+
+  void clear() noexcept { std::fill(blocks_.begin(), blocks_.end(), block{}); }
+
+  std::size_t block_count() const noexcept { return blocks_.size(); }
+  std::size_t memory_usage() const noexcept { return blocks_.size() * sizeof(block); }
+
+ private:
+  // The block comes from the high bits of h, the bit pattern from the low 32.
+  std::size_t block_index(std::uint64_t h) const noexcept {
+    return static_cast<std::size_t>(fastrange64(h, blocks_.size()));
+  }
+
+#if defined(__AVX2__)
+  static __m256i make_mask(std::uint32_t lo) noexcept {
+    const __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(detail::bloom_salts));
+    const __m256i product = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(lo)), salts);
+    const __m256i bits = _mm256_srli_epi32(product, 27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+  }
+#endif
+
+  std::vector<block> blocks_;
+  [[no_unique_address]] Hash hash_{};
+};
+
+// ---------------------------------------------------------------------------
+// counting_bloom_filter
+// ---------------------------------------------------------------------------
+
+// Blocked filter of 4-bit counters: a key maps to one 64-byte block of eight
+// 64-bit lanes and bumps one of the sixteen counters in each lane. Counters
+// saturate at 15 and then stay put, so erasing never produces a false
+// negative, at the cost of such counters never returning to zero.
+template <class Key, class Hash = seeded_hash<Key>>
+class counting_bloom_filter {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  struct alignas(64) block {
+    std::uint64_t lanes[8];
+  };
+
+  counting_bloom_filter(std::size_t expected_items, double fpp, const Hash& hash = Hash())
+      : blocks_(std::max<std::size_t>(1, detail::blocked_filter_blocks(expected_items, fpp, 16))),
+        hash_(hash) {}
+
+  void insert(const Key& key) noexcept { insert_hash(hash_(key)); }
+  bool contains(const Key& key) const noexcept { return contains_hash(hash_(key)); }
+
+  // Erasing a key that was never inserted may introduce false negatives
+  // for other keys.
+  void erase(const Key& key) noexcept { erase_hash(hash_(key)); }
+
+  void insert_hash(std::uint64_t h) noexcept {
+    block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+    for (int i = 0; i < 8; ++i) {
+      const unsigned shift = counter_shift(lo, i);
+      if (((b.lanes[i] >> shift) & 0xF) != 0xF) b.lanes[i] += std::uint64_t{1} << shift;
+    }
+  }
+
+  void erase_hash(std::uint64_t h) noexcept {
+    block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+    for (int i = 0; i < 8; ++i) {
+      const unsigned shift = counter_shift(lo, i);
+      const std::uint64_t c = (b.lanes[i] >> shift) & 0xF;
+      if (c != 0 && c != 0xF) b.lanes[i] -= std::uint64_t{1} << shift;
+    }
+  }
+
+  bool contains_hash(std::uint64_t h) const noexcept {
+    const block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+    bool all = true;
+    for (int i = 0; i < 8; ++i) all &= ((b.lanes[i] >> counter_shift(lo, i)) & 0xF) != 0;
+    return all;
+  }
+
+  // Smallest counter among the key's eight: an upper bound on how many times
+  // it was inserted (saturating at 15).
+  unsigned count_estimate(const Key& key) const noexcept {
+    const std::uint64_t h = hash_(key);
+    const block& b = blocks_[block_index(h)];
+    const auto lo = static_cast<std::uint32_t>(h);
+    unsigned m = 15;
+    for (int i = 0; i < 8; ++i) {
+      m = std::min<unsigned>(m, static_cast<unsigned>((b.lanes[i] >> counter_shift(lo, i)) & 0xF));
+    }
+    return m;
+  }
+
+  void insert_batch(std::span<const Key> keys) noexcept {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH_WRITE(&blocks_[block_index(hs[i])]);
+      }
+      for (std::size_t i = 0; i < g; ++i) insert_hash(hs[i]);
+    }
+  }
+
+  std::size_t contains_batch(std::span<const Key> keys, std::span<bool> out) const noexcept {
+    std::uint64_t hs[batch_group_size];
+    std::size_t hits = 0;
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        MYSTL_PREFETCH(&blocks_[block_index(hs[i])]);
+      }
+      for (std::size_t i = 0; i < g; ++i) hits += out[base + i] = contains_hash(hs[i]);
+    }
+    return hits;
+  }
+
+  void clear() noexcept { std::fill(blocks_.begin(), blocks_.end(), block{}); }
+
+  std::size_t block_count() const noexcept { return blocks_.size(); }
+  std::size_t memory_usage() const noexcept { return blocks_.size() * sizeof(block); }
+
+ private:
+  std::size_t block_index(std::uint64_t h) const noexcept {
+    return static_cast<std::size_t>(fastrange64(h, blocks_.size()));
+  }
+
+  static unsigned counter_shift(std::uint32_t lo, int lane) noexcept {
+    return ((lo * detail::bloom_salts[lane]) >> 28) * 4;
+  }
+
+  std::vector<block> blocks_;
+  [[no_unique_address]] Hash hash_{};
+};
+
+}  // namespace mystl
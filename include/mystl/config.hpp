@@ -0,0 +1,72 @@
+#pragma once
+
+// Compiler portability macros and library-wide constants shared by every
+// header in mystl.
+
+#include <cstddef>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MYSTL_RESTRICT __restrict__
+#define MYSTL_LIKELY(x) __builtin_expect(!!(x), 1)
+#define MYSTL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define MYSTL_ALWAYS_INLINE inline __attribute__((always_inline))
+#define MYSTL_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#define MYSTL_PREFETCH_WRITE(addr) __builtin_prefetch((addr), 1, 3)
+#elif defined(_MSC_VER)
+#define MYSTL_RESTRICT __restrict
+#define MYSTL_LIKELY(x) (x)
+#define MYSTL_UNLIKELY(x) (x)
+#define MYSTL_ALWAYS_INLINE __forceinline
+#define MYSTL_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#define MYSTL_PREFETCH_WRITE(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define MYSTL_RESTRICT
+#define MYSTL_LIKELY(x) (x)
+#define MYSTL_UNLIKELY(x) (x)
+#define MYSTL_ALWAYS_INLINE inline
+#define MYSTL_PREFETCH(addr) ((void)(addr))
+#define MYSTL_PREFETCH_WRITE(addr) ((void)(addr))
+#endif
+
+// Spin-wait hint: lets the sibling hyperthread run and saves power while
+// polling a contended cache line.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MYSTL_CPU_RELAX() __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define MYSTL_CPU_RELAX() __asm__ __volatile__("yield")
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define MYSTL_CPU_RELAX() _mm_pause()
+#else
+#define MYSTL_CPU_RELAX() ((void)0)
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define MYSTL_HAS_INT128 1
+#else
+#define MYSTL_HAS_INT128 0
+#endif
+
+namespace mystl {
+
+// Assumed size of a destructive-interference unit. Hard-coded rather than
+// taken from std::hardware_destructive_interference_size so that the value
+// is stable across translation units and compiler flags.
+inline constexpr std::size_t cache_line_size = 64;
+
+// Number of independent lookups a batch API keeps in flight: keys are
+// hashed and their cache lines prefetched one group at a time, then probed.
+inline constexpr std::size_t batch_group_size = 16;
+
+namespace detail {
+
+#if MYSTL_HAS_INT128
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+}  // namespace detail
+
+}  // namespace mystl
@@ -0,0 +1,171 @@
+#pragma once
+
+// Count-min sketch: approximate per-key counts of a stream in fixed memory.
+//
+//   mystl::count_min_sketch<std::string> hits(1e-5, 1e-3);  // error 1e-5 * N w.p. 0.999
+//   hits.add(url);
+//   if (hits.estimate(url) > threshold) report_heavy_hitter(url);
+//
+// Estimates never undercount. With probability 1 - delta they overcount by
+// at most epsilon * total_count(). Updates are conservative (Estan and
+// Varghese): a key raises only those of its counters that are below its new
+// estimate, which keeps the overcount well below the classic bound on
+// skewed streams. Conservative updates cannot be undone, so there is no
+// remove().
+//
+// Row widths are powers of two and each row is a contiguous array, so a key
+// costs one masked add per row. The batch APIs hash a group of keys and
+// prefetch all of their counters before touching any, overlapping the cache
+// misses. Counters saturate instead of wrapping.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+template <class Key, class Hash = seeded_hash<Key>, std::unsigned_integral Counter = std::uint32_t>
+class count_min_sketch {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+  using counter_type = Counter;
+
+  static constexpr std::size_t max_depth = 16;
+
+  // Sized so that estimates exceed the true count by at most
+  // epsilon * total_count() with probability 1 - delta.
+  count_min_sketch(double epsilon, double delta, const Hash& hash = Hash()) : hash_(hash) {
+    if (!(epsilon > 0.0 && epsilon < 1.0)) {
+      throw std::invalid_argument("count_min_sketch: epsilon must be in (0, 1)");
+    }
+    if (!(delta > 0.0 && delta < 1.0)) {
+      throw std::invalid_argument("count_min_sketch: delta must be in (0, 1)");
+    }
+    width_ = std::bit_ceil(static_cast<std::size_t>(std::ceil(std::exp(1.0) / epsilon)));
+    const auto depth = static_cast<std::size_t>(std::ceil(std::log(1.0 / delta)));
+    depth_ = std::clamp<std::size_t>(depth, 1, max_depth);
+    counters_.assign(width_ * depth_, 0);
+  }
+
+  void add(const Key& key, Counter count = 1) noexcept { add_hash(hash_(key), count); }
+  Counter estimate(const Key& key) const noexcept { return estimate_hash(hash_(key)); }
+
+  void add_hash(std::uint64_t h, Counter count = 1) noexcept {
+    std::size_t pos[max_depth];
+    positions(h, pos);
+    Counter low = std::numeric_limits<Counter>::max();
+    for (std::size_t r = 0; r < depth_; ++r) low = std::min(low, counters_[pos[r]]);
+    const Counter target = saturating_add(low, count);
+    for (std::size_t r = 0; r < depth_; ++r) {
+      counters_[pos[r]] = std::max(counters_[pos[r]], target);
+    }
+    total_ += count;
+  }
+
+  Counter estimate_hash(std::uint64_t h) const noexcept {
+    std::size_t pos[max_depth];
+    positions(h, pos);
+    Counter low = std::numeric_limits<Counter>::max();
+    for (std::size_t r = 0; r < depth_; ++r) low = std::min(low, counters_[pos[r]]);
+    return low;
+  }
+
+  void add_batch(std::span<const Key> keys) noexcept {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        prefetch(hs[i], true);
+      }
+      for (std::size_t i = 0; i < g; ++i) add_hash(hs[i]);
+    }
+  }
+
+  // Writes one estimate per key.
+  void estimate_batch(std::span<const Key> keys, std::span<Counter> out) const noexcept {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        prefetch(hs[i], false);
+      }
+      for (std::size_t i = 0; i < g; ++i) out[base + i] = estimate_hash(hs[i]);
+    }
+  }
+
+  // Sketch of the concatenated streams. Requires identical geometry and
+  // hash; the result keeps the no-undercount guarantee.
+  void merge(const count_min_sketch& other) {
+    if (other.width_ != width_ || other.depth_ != depth_) {
+      throw std::invalid_argument("count_min_sketch::merge: geometry mismatch");
+    }
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+      counters_[i] = saturating_add(counters_[i], other.counters_[i]);
+    }
+    total_ += other.total_;
+  }
+
+  void clear() noexcept {
+    std::fill(counters_.begin(), counters_.end(), 0);
+    total_ = 0;
+  }
+
+  // Sum of all counts added.
+  std::uint64_t total_count() const noexcept { return total_; }
+  // Additive error that estimates stay within with probability 1 - delta.
+  double error_bound() const noexcept {
+    return std::exp(1.0) / static_cast<double>(width_) * static_cast<double>(total_);
+  }
+
+  std::size_t width() const noexcept { return width_; }
+  std::size_t depth() const noexcept { return depth_; }
+  std::size_t memory_usage() const noexcept { return counters_.size() * sizeof(Counter); }
+
+ private:
+  static Counter saturating_add(Counter a, Counter b) noexcept {
+    const Counter sum = static_cast<Counter>(a + b);
+    return sum < a ? std::numeric_limits<Counter>::max() : sum;
+  }
+
+  // Column of row r is h + r * h2 (Kirsch and Mitzenmacher), masked.
+  void positions(std::uint64_t h, std::size_t* pos) const noexcept {
+    const std::uint64_t h2 = mix64(h) | 1;
+    const std::uint64_t mask = width_ - 1;
+    for (std::size_t r = 0; r < depth_; ++r, h += h2) {
+      pos[r] = r * width_ + static_cast<std::size_t>(h & mask);
+    }
+  }
+
+  void prefetch(std::uint64_t h, bool for_write) const noexcept {
+    std::size_t pos[max_depth];
+    positions(h, pos);
+    for (std::size_t r = 0; r < depth_; ++r) {
+      if (for_write) {
+        MYSTL_PREFETCH_WRITE(&counters_[pos[r]]);
+      } else {
+        MYSTL_PREFETCH(&counters_[pos[r]]);
+      }
+    }
+  }
+
+  std::vector<Counter> counters_;
+  std::size_t width_ = 0;
+  std::size_t depth_ = 0;
+  std::uint64_t total_ = 0;
+  [[no_unique_address]] Hash hash_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,219 @@
+#pragma once
+
+// Cuckoo filter (Fan et al.): approximate membership with deletion.
+//
+// Keys are reduced to 16-bit fingerprints stored in a power-of-two array of
+// 4-slot buckets, one 64-bit word per bucket. A fingerprint lives in one of
+// two buckets, i and i ^ mix(fp), so a query reads at most two words and
+// compares all four slots of each with a SWAR test. False-positive rate is
+// about 8 / 2^16 (0.012%) at 95% load.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+template <class Key, class Hash = seeded_hash<Key>>
+class cuckoo_filter {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  static constexpr std::size_t slots_per_bucket = 4;
+
+  // Room for at least capacity keys at a load factor of 0.95.
+  explicit cuckoo_filter(std::size_t capacity, const Hash& hash = Hash())
+      : buckets_(bucket_count(capacity)),
+        mask_(buckets_.size() - 1),
+        hash_(hash) {}
+
+  // Returns false if the filter is too full to place the key.
+  bool insert(const Key& key) noexcept { return insert_hash(hash_(key)); }
+  bool contains(const Key& key) const noexcept { return contains_hash(hash_(key)); }
+
+  // Removes one copy of the key. Erasing a key that was never inserted may
+  // remove another key with the same fingerprint.
+  bool erase(const Key& key) noexcept { return erase_hash(hash_(key)); }
+
+  bool insert_hash(std::uint64_t h) noexcept {
+    if (victim_used_) return false;
+    std::uint16_t fp = fingerprint(h);
+    std::size_t i = index(h);
+    if (try_put(i, fp) || try_put(alt_index(i, fp), fp)) {
+      ++size_;
+      return true;
+    }
+    // Evict a random resident and move it to its other bucket.
+    if (rng_ & 1) i = alt_index(i, fp);
+    for (int kick = 0; kick < max_kicks; ++kick) {
+      rng_ ^= rng_ << 13;
+      rng_ ^= rng_ >> 7;
+      rng_ ^= rng_ << 17;
+      const unsigned shift = static_cast<unsigned>(rng_ % slots_per_bucket) * 16;
+      const auto evicted = static_cast<std::uint16_t>(buckets_[i] >> shift);
+      buckets_[i] = (buckets_[i] & ~(std::uint64_t{0xFFFF} << shift)) | std::uint64_t{fp} << shift;
+      fp = evicted;
+      i = alt_index(i, fp);
+      if (try_put(i, fp)) {
+        ++size_;
+        return true;
+      }
+    }
+    // Keep the last homeless fingerprint so no inserted key is lost.
+    victim_used_ = true;
+    victim_index_ = i;
+    victim_fp_ = fp;
+    ++size_;
+    return true;
+  }
+
+  bool contains_hash(std::uint64_t h) const noexcept {
+    const std::uint16_t fp = fingerprint(h);
+    const std::size_t i1 = index(h), i2 = alt_index(i1, fp);
+    if (find_lane(buckets_[i1], fp) | find_lane(buckets_[i2], fp)) return true;
+    return victim_used_ && victim_fp_ == fp && (victim_index_ == i1 || victim_index_ == i2);
+  }
+
+  bool erase_hash(std::uint64_t h) noexcept {
+    const std::uint16_t fp = fingerprint(h);
+    const std::size_t i1 = index(h), i2 = alt_index(i1, fp);
+    if (!clear_lane(i1, fp) && !clear_lane(i2, fp)) {
+      if (!(victim_used_ && victim_fp_ == fp && (victim_index_ == i1 || victim_index_ == i2))) {
+        return false;
+      }
+      victim_used_ = false;
+      --size_;
+      return true;
+    }
+    --size_;
+    if (victim_used_) {
+      // A slot was freed; give the stashed fingerprint another chance.
+      victim_used_ = false;
+      --size_;
+      insert_fingerprint(victim_index_, victim_fp_);
+    }
+    return true;
+  }
+
+  // Returns the number of keys inserted; stops early once the filter is full.
+  std::size_t insert_batch(std::span<const Key> keys) noexcept {
+    std::uint64_t hs[batch_group_size];
+    std::size_t inserted = 0;
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      prefetch_group(keys.subspan(base, g), hs);
+      for (std::size_t i = 0; i < g; ++i) {
+        if (!insert_hash(hs[i])) return inserted;
+        ++inserted;
+      }
+    }
+    return inserted;
+  }
+
+  // Writes one result per key and returns the number of positives.
+  std::size_t contains_batch(std::span<const Key> keys, std::span<bool> out) const noexcept {
+    std::uint64_t hs[batch_group_size];
+    std::size_t hits = 0;
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      prefetch_group(keys.subspan(base, g), hs);
+      for (std::size_t i = 0; i < g; ++i) hits += out[base + i] = contains_hash(hs[i]);
+    }
+    return hits;
+  }
+
+  void clear() noexcept {
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    size_ = 0;
+    victim_used_ = false;
+  }
+
+  std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  std::size_t slot_count() const noexcept { return buckets_.size() * slots_per_bucket; }
+  double load_factor() const noexcept {
+    return static_cast<double>(size_) / static_cast<double>(slot_count());
+  }
+  std::size_t memory_usage() const noexcept { return buckets_.size() * sizeof(std::uint64_t); }
+
+ private:
+  static constexpr int max_kicks = 500;
+  static constexpr std::uint64_t lane_ones = 0x0001000100010001ull;
+  static constexpr std::uint64_t lane_highs = 0x8000800080008000ull;
+
+  // Enough buckets for capacity items at 95% occupancy, as a power of two.
+  static std::size_t bucket_count(std::size_t capacity) noexcept {
+    const double buckets = static_cast<double>(capacity) / (slots_per_bucket * 0.95);
+    return std::bit_ceil(std::max<std::size_t>(1, static_cast<std::size_t>(buckets) + 1));
+  }
+
+  // Fingerprints come from the top 16 bits, bucket indices from the low
+  // bits; 0 marks an empty slot.
+  static std::uint16_t fingerprint(std::uint64_t h) noexcept {
+    const auto fp = static_cast<std::uint16_t>(h >> 48);
+    return fp == 0 ? 1 : fp;
+  }
+  std::size_t index(std::uint64_t h) const noexcept { return static_cast<std::size_t>(h) & mask_; }
+  std::size_t alt_index(std::size_t i, std::uint16_t fp) const noexcept {
+    return (i ^ static_cast<std::size_t>(mix64(fp))) & mask_;
+  }
+
+  // High bit of every 16-bit lane of word that equals fp. Exact for the
+  // lowest such lane, which is the only one the callers use.
+  static std::uint64_t find_lane(std::uint64_t word, std::uint16_t fp) noexcept {
+    const std::uint64_t x = word ^ (lane_ones * fp);
+    return (x - lane_ones) & ~x & lane_highs;
+  }
+
+  bool try_put(std::size_t i, std::uint16_t fp) noexcept {
+    const std::uint64_t empty = find_lane(buckets_[i], 0);
+    if (empty == 0) return false;
+    buckets_[i] |= std::uint64_t{fp} << (std::countr_zero(empty) - 15);
+    return true;
+  }
+
+  bool clear_lane(std::size_t i, std::uint16_t fp) noexcept {
+    const std::uint64_t hit = find_lane(buckets_[i], fp);
+    if (hit == 0) return false;
+    buckets_[i] &= ~(std::uint64_t{0xFFFF} << (std::countr_zero(hit) - 15));
+    return true;
+  }
+
+  void insert_fingerprint(std::size_t i, std::uint16_t fp) noexcept {
+    if (try_put(i, fp) || try_put(alt_index(i, fp), fp)) {
+      ++size_;
+    } else {
+      victim_used_ = true;
+      victim_index_ = i;
+      victim_fp_ = fp;
+      ++size_;
+    }
+  }
+
+  void prefetch_group(std::span<const Key> keys, std::uint64_t* hs) const noexcept {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      hs[i] = hash_(keys[i]);
+      const std::size_t i1 = index(hs[i]);
+      MYSTL_PREFETCH(&buckets_[i1]);
+      MYSTL_PREFETCH(&buckets_[alt_index(i1, fingerprint(hs[i]))]);
+    }
+  }
+
+  std::vector<std::uint64_t> buckets_;
+  std::size_t mask_ = 0;
+  std::size_t size_ = 0;
+  std::uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+  std::size_t victim_index_ = 0;
+  std::uint16_t victim_fp_ = 0;
+  bool victim_used_ = false;
+  [[no_unique_address]] Hash hash_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,896 @@
+#pragma once
+
+// Minimal senders and receivers in the style of std::execution (P2300).
+//
+//   namespace ex = mystl::execution;
+//   mystl::thread_pool pool(8);
+//   auto work = ex::schedule(ex::thread_pool_scheduler(pool))
+//             | ex::then([&] { return load(); })
+//             | ex::bulk(n, [](std::size_t i, data& d) { d.process(i); })
+//             | ex::then([](const data& d) { return d.sum(); });
+//   auto [a, b] = ex::sync_wait(ex::when_all(std::move(work), ex::just(1)));
+//
+// A sender describes work. connect() binds it to a receiver and yields an
+// operation state, and start() runs it. A pipeline's operation state is one
+// object whose type is fixed at compile time, with each stage's state
+// nested inside the next. Starting it and running it allocate nothing;
+// schedulers queue the operation state itself (see executor.hpp).
+//
+// The model is cut down from the standard:
+//  - A sender completes with exactly one value signature, given by its
+//    value_types member (a value_list of decayed types), or with an error
+//    as std::exception_ptr. There is no stopped channel.
+//  - A receiver is any object with noexcept set_value(Args&&...) and
+//    set_error(std::exception_ptr) members, and each is called at most
+//    once. Exceptions thrown by user callables become set_error.
+//  - bulk runs its callable in parallel when the predecessor is known to
+//    complete on a thread_pool_scheduler, and inline otherwise.
+//  - when_all completes with the concatenated values of its children, or
+//    with the first error to arrive once every child has finished.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "executor.hpp"
+
+namespace mystl::execution {
+
+template <class... Ts>
+struct value_list {
+  template <template <class...> class F>
+  using apply = F<Ts...>;
+};
+
+template <class S>
+concept sender = requires { typename std::remove_cvref_t<S>::value_types; };
+
+template <class R>
+concept receiver = std::move_constructible<R> && requires(R& r, std::exception_ptr e) {
+  { r.set_error(std::move(e)) } noexcept;
+};
+
+template <class S>
+using value_types_of_t = typename std::remove_cvref_t<S>::value_types;
+
+template <class S, class R>
+using connect_result_t =
+    decltype(std::declval<std::remove_cvref_t<S>>().connect(std::declval<R>()));
+
+template <class Sch>
+concept scheduler = std::copy_constructible<Sch> && requires(const Sch& s) {
+  { s.schedule() } -> sender;
+};
+
+// Set on senders whose values are delivered on a known scheduler.
+template <class S>
+concept has_completion_scheduler = requires(const std::remove_cvref_t<S>& s) {
+  { s.completion_scheduler() } -> scheduler;
+};
+
+template <class Executor>
+class executor_scheduler;
+
+// Upper bound on the workers one parallel bulk uses, which sizes its
+// operation state.
+inline constexpr std::size_t bulk_max_parallelism = 64;
+
+}  // namespace mystl::execution
+
+namespace mystl::detail {
+
+template <class A, class B>
+struct value_list_concat;
+template <class... As, class... Bs>
+struct value_list_concat<execution::value_list<As...>, execution::value_list<Bs...>> {
+  using type = execution::value_list<As..., Bs...>;
+};
+
+template <class... Lists>
+struct value_list_join {
+  using type = execution::value_list<>;
+};
+template <class First, class... Rest>
+struct value_list_join<First, Rest...> {
+  using type = typename value_list_concat<First, typename value_list_join<Rest...>::type>::type;
+};
+
+template <class S>
+using stored_values_t = typename execution::value_types_of_t<S>::template apply<std::tuple>;
+
+// Storage for an operation state that is connected after its parent has
+// been constructed. Operation states cannot move, so the object is built in
+// place from the prvalue that make() returns.
+template <class T>
+class manual_lifetime {
+ public:
+  manual_lifetime() noexcept {}
+  manual_lifetime(const manual_lifetime&) = delete;
+  manual_lifetime& operator=(const manual_lifetime&) = delete;
+
+  template <class Make>
+  T& construct(Make&& make) {
+    return *::new (static_cast<void*>(&storage_)) T(std::forward<Make>(make)());
+  }
+  void destroy() noexcept { std::launder(reinterpret_cast<T*>(&storage_))->~T(); }
+  T& get() noexcept { return *std::launder(reinterpret_cast<T*>(&storage_)); }
+
+ private:
+  alignas(T) std::byte storage_[sizeof(T)];
+};
+
+// Adaptor bound to all of its arguments except the predecessor sender, for
+// use on the right of operator|.
+template <class Adaptor, class... Args>
+class sender_adaptor_closure {
+ public:
+  explicit sender_adaptor_closure(Args... args) : args_(std::move(args)...) {}
+
+  template <execution::sender S>
+  friend auto operator|(S&& s, sender_adaptor_closure c) {
+    return std::apply([&](Args&... a) { return Adaptor{}(std::forward<S>(s), std::move(a)...); },
+                      c.args_);
+  }
+
+ private:
+  std::tuple<Args...> args_;
+};
+
+// just
+
+template <class R, class... Ts>
+class just_op {
+ public:
+  just_op(std::tuple<Ts...>&& values, R r) : values_(std::move(values)), r_(std::move(r)) {}
+  just_op(const just_op&) = delete;
+  just_op& operator=(const just_op&) = delete;
+
+  void start() noexcept {
+    std::apply([&](Ts&... v) { r_.set_value(std::move(v)...); }, values_);
+  }
+
+ private:
+  std::tuple<Ts...> values_;
+  R r_;
+};
+
+template <class... Ts>
+class just_sender {
+ public:
+  using value_types = execution::value_list<Ts...>;
+
+  template <class... Us>
+  explicit just_sender(std::in_place_t, Us&&... vs) : values_(std::forward<Us>(vs)...) {}
+
+  template <execution::receiver R>
+  just_op<R, Ts...> connect(R r) && {
+    return just_op<R, Ts...>(std::move(values_), std::move(r));
+  }
+
+ private:
+  std::tuple<Ts...> values_;
+};
+
+// then
+
+template <class F, class R>
+struct then_receiver {
+  template <class... As>
+  void set_value(As&&... as) noexcept {
+    using result = std::invoke_result_t<F, As...>;
+    if constexpr (std::is_nothrow_invocable_v<F, As...>) {
+      if constexpr (std::is_void_v<result>) {
+        std::invoke(std::move(f), std::forward<As>(as)...);
+        r.set_value();
+      } else {
+        r.set_value(std::invoke(std::move(f), std::forward<As>(as)...));
+      }
+    } else if constexpr (std::is_void_v<result>) {
+      try {
+        std::invoke(std::move(f), std::forward<As>(as)...);
+      } catch (...) {
+        r.set_error(std::current_exception());
+        return;
+      }
+      r.set_value();
+    } else {
+      // The call may throw but the downstream set_value may not, so the
+      // result is produced first and delivered outside the try. A reference
+      // result is copied, as then_values already advertises it decayed.
+      std::optional<std::decay_t<result>> v;
+      try {
+        v.emplace(std::invoke(std::move(f), std::forward<As>(as)...));
+      } catch (...) {
+        r.set_error(std::current_exception());
+        return;
+      }
+      r.set_value(std::move(*v));
+    }
+  }
+  void set_error(std::exception_ptr e) noexcept { r.set_error(std::move(e)); }
+
+  F f;
+  R r;
+};
+
+template <class F, class Values>
+struct then_values;
+template <class F, class... Ts>
+struct then_values<F, execution::value_list<Ts...>> {
+  using result = std::invoke_result_t<F, Ts...>;
+  using type = std::conditional_t<std::is_void_v<result>, execution::value_list<>,
+                                  execution::value_list<std::decay_t<result>>>;
+};
+
+template <class S, class F>
+class then_sender {
+ public:
+  using value_types = typename then_values<F, execution::value_types_of_t<S>>::type;
+
+  then_sender(S s, F f) : s_(std::move(s)), f_(std::move(f)) {}
+
+  template <execution::receiver R>
+  execution::connect_result_t<S, then_receiver<F, R>> connect(R r) && {
+    return std::move(s_).connect(then_receiver<F, R>{std::move(f_), std::move(r)});
+  }
+
+  // f runs where the predecessor completes.
+  auto completion_scheduler() const
+    requires execution::has_completion_scheduler<S>
+  {
+    return s_.completion_scheduler();
+  }
+
+ private:
+  S s_;
+  F f_;
+};
+
+// let_value
+
+template <class F, class Values>
+struct let_value_sender_of;
+template <class F, class... Ts>
+struct let_value_sender_of<F, execution::value_list<Ts...>> {
+  using type = std::decay_t<std::invoke_result_t<F&, Ts&...>>;
+};
+
+template <class S, class F, class R>
+class let_value_op {
+  using second_sender = typename let_value_sender_of<F, execution::value_types_of_t<S>>::type;
+
+  struct first_receiver {
+    template <class... As>
+    void set_value(As&&... as) noexcept {
+      op->on_value(std::forward<As>(as)...);
+    }
+    void set_error(std::exception_ptr e) noexcept { op->r_.set_error(std::move(e)); }
+
+    let_value_op* op;
+  };
+
+  // Forwards to r_, which stays in place so that a failed connect can
+  // still report its error there.
+  struct second_receiver {
+    template <class... As>
+    void set_value(As&&... as) noexcept {
+      op->r_.set_value(std::forward<As>(as)...);
+    }
+    void set_error(std::exception_ptr e) noexcept { op->r_.set_error(std::move(e)); }
+
+    let_value_op* op;
+  };
+
+ public:
+  let_value_op(S&& s, F f, R r)
+      : f_(std::move(f)), r_(std::move(r)), first_(std::move(s).connect(first_receiver{this})) {}
+  let_value_op(const let_value_op&) = delete;
+  let_value_op& operator=(const let_value_op&) = delete;
+  ~let_value_op() {
+    if (second_started_) second_.destroy();
+  }
+
+  void start() noexcept { first_.start(); }
+
+ private:
+  template <class... As>
+  void on_value(As&&... as) noexcept {
+    // The values stay alive in this operation state, so the sender that f
+    // returns may refer to them.
+    try {
+      values_.emplace(std::forward<As>(as)...);
+      second_.construct([&] {
+        return std::apply([&](auto&... v) { return std::invoke(f_, v...); }, *values_)
+            .connect(second_receiver{this});
+      });
+    } catch (...) {
+      r_.set_error(std::current_exception());
+      return;
+    }
+    second_started_ = true;
+    second_.get().start();
+  }
+
+  F f_;
+  R r_;
+  std::optional<stored_values_t<S>> values_;
+  manual_lifetime<execution::connect_result_t<second_sender, second_receiver>> second_;
+  bool second_started_ = false;
+  execution::connect_result_t<S, first_receiver> first_;
+};
+
+template <class S, class F>
+class let_value_sender {
+ public:
+  using value_types = execution::value_types_of_t<
+      typename let_value_sender_of<F, execution::value_types_of_t<S>>::type>;
+
+  let_value_sender(S s, F f) : s_(std::move(s)), f_(std::move(f)) {}
+
+  template <execution::receiver R>
+  let_value_op<S, F, R> connect(R r) && {
+    return let_value_op<S, F, R>(std::move(s_), std::move(f_), std::move(r));
+  }
+
+ private:
+  S s_;
+  F f_;
+};
+
+// bulk
+
+template <class S>
+concept completes_on_thread_pool =
+    execution::has_completion_scheduler<S> &&
+    std::same_as<decltype(std::declval<const S&>().completion_scheduler()),
+                 execution::executor_scheduler<thread_pool>>;
+
+template <class S, class Shape, class F, class R>
+class bulk_op {
+  static constexpr bool parallel = completes_on_thread_pool<S>;
+
+  struct inner_receiver {
+    template <class... As>
+    void set_value(As&&... as) noexcept {
+      op->on_value(std::forward<As>(as)...);
+    }
+    void set_error(std::exception_ptr e) noexcept { op->r_.set_error(std::move(e)); }
+
+    bulk_op* op;
+  };
+
+  struct helper : work_item {
+    bulk_op* op;
+  };
+
+ public:
+  bulk_op(S&& s, Shape n, F f, R r)
+      : n_(n),
+        f_(std::move(f)),
+        r_(std::move(r)),
+        pool_(pool_of(s)),
+        inner_(std::move(s).connect(inner_receiver{this})) {}
+  bulk_op(const bulk_op&) = delete;
+  bulk_op& operator=(const bulk_op&) = delete;
+
+  void start() noexcept { inner_.start(); }
+
+ private:
+  static thread_pool* pool_of(const S& s) noexcept {
+    if constexpr (parallel) {
+      return &s.completion_scheduler().executor();
+    } else {
+      return nullptr;
+    }
+  }
+
+  template <class... As>
+  void on_value(As&&... as) noexcept {
+    try {
+      values_.emplace(std::forward<As>(as)...);
+    } catch (...) {
+      r_.set_error(std::current_exception());
+      return;
+    }
+    if constexpr (parallel) {
+      if (n_ > 1 && pool_->thread_count() > 1) {
+        run_parallel();
+        return;
+      }
+    }
+    try {
+      for (Shape i = 0; i < n_; ++i) call(i);
+    } catch (...) {
+      r_.set_error(std::current_exception());
+      return;
+    }
+    complete();
+  }
+
+  void call(Shape i) {
+    std::apply([&](auto&... v) { std::invoke(f_, i, v...); }, *values_);
+  }
+
+  void complete() noexcept {
+    std::apply([&](auto&... v) { r_.set_value(std::move(v)...); }, *values_);
+  }
+
+  // The completing thread and up to bulk_max_parallelism - 1 queued
+  // helpers claim chunks of indices from a shared counter; the last one to
+  // finish completes the operation.
+  void run_parallel() noexcept {
+    const auto n = static_cast<std::size_t>(n_);
+    const std::size_t workers =
+        std::min({pool_->thread_count(), n, execution::bulk_max_parallelism});
+    grain_ = std::max<std::size_t>(1, n / (workers * 4));
+    next_.store(0, std::memory_order_relaxed);
+    remaining_.store(workers, std::memory_order_relaxed);
+    for (std::size_t k = 0; k + 1 < workers; ++k) {
+      helpers_[k].op = this;
+      helpers_[k].execute = [](work_item* w) noexcept { static_cast<helper*>(w)->op->work(); };
+      pool_->enqueue(&helpers_[k]);
+    }
+    work();
+  }
+
+  void work() noexcept {
+    const auto n = static_cast<std::size_t>(n_);
+    for (;;) {
+      const std::size_t begin = next_.fetch_add(grain_, std::memory_order_relaxed);
+      if (begin >= n || failed_.load(std::memory_order_relaxed)) break;
+      try {
+        for (std::size_t i = begin, end = std::min(n, begin + grain_); i < end; ++i) {
+          call(static_cast<Shape>(i));
+        }
+      } catch (...) {
+        if (!failed_.exchange(true, std::memory_order_relaxed)) error_ = std::current_exception();
+        break;
+      }
+    }
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      if (failed_.load(std::memory_order_relaxed)) {
+        r_.set_error(std::move(error_));
+      } else {
+        complete();
+      }
+    }
+  }
+
+  Shape n_;
+  F f_;
+  R r_;
+  thread_pool* pool_;
+  std::optional<stored_values_t<S>> values_;
+  std::size_t grain_ = 1;
+  std::atomic<std::size_t> next_{0};
+  std::atomic<std::size_t> remaining_{0};
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+  std::array<helper, parallel ? execution::bulk_max_parallelism - 1 : 0> helpers_;
+  execution::connect_result_t<S, inner_receiver> inner_;
+};
+
+template <class S, class Shape, class F>
+class bulk_sender {
+ public:
+  using value_types = execution::value_types_of_t<S>;
+
+  bulk_sender(S s, Shape n, F f) : s_(std::move(s)), n_(n), f_(std::move(f)) {}
+
+  template <execution::receiver R>
+  bulk_op<S, Shape, F, R> connect(R r) && {
+    return bulk_op<S, Shape, F, R>(std::move(s_), n_, std::move(f_), std::move(r));
+  }
+
+  auto completion_scheduler() const
+    requires execution::has_completion_scheduler<S>
+  {
+    return s_.completion_scheduler();
+  }
+
+ private:
+  S s_;
+  Shape n_;
+  F f_;
+};
+
+// when_all
+
+template <class Parent, std::size_t I>
+struct when_all_sender_receiver {
+  template <class... As>
+  void set_value(As&&... as) noexcept {
+    parent->template on_value<I>(std::forward<As>(as)...);
+  }
+  void set_error(std::exception_ptr e) noexcept { parent->on_error(std::move(e)); }
+
+  Parent* parent;
+};
+
+template <class Parent, std::size_t I, class S>
+struct when_all_sender_child {
+  when_all_sender_child(S&& s, Parent* parent)
+      : op(std::move(s).connect(when_all_sender_receiver<Parent, I>{parent})) {}
+
+  execution::connect_result_t<S, when_all_sender_receiver<Parent, I>> op;
+};
+
+template <class R, class Indices, class... Ss>
+class when_all_sender_op;
+
+template <class R, std::size_t... I, class... Ss>
+class when_all_sender_op<R, std::index_sequence<I...>, Ss...>
+    : when_all_sender_child<when_all_sender_op<R, std::index_sequence<I...>, Ss...>, I, Ss>... {
+  template <class, std::size_t>
+  friend struct when_all_sender_receiver;
+
+ public:
+  when_all_sender_op(std::tuple<Ss...>&& senders, R r)
+      : when_all_sender_child<when_all_sender_op, I, Ss>(std::move(std::get<I>(senders)), this)...,
+        r_(std::move(r)) {}
+  when_all_sender_op(const when_all_sender_op&) = delete;
+  when_all_sender_op& operator=(const when_all_sender_op&) = delete;
+
+  void start() noexcept {
+    if constexpr (sizeof...(Ss) == 0) {
+      r_.set_value();
+    } else {
+      remaining_.store(sizeof...(Ss), std::memory_order_relaxed);
+      (static_cast<when_all_sender_child<when_all_sender_op, I, Ss>&>(*this).op.start(), ...);
+    }
+  }
+
+ private:
+  template <std::size_t J, class... As>
+  void on_value(As&&... as) noexcept {
+    try {
+      std::get<J>(values_).emplace(std::forward<As>(as)...);
+    } catch (...) {
+      on_error(std::current_exception());
+      return;
+    }
+    arrive();
+  }
+
+  void on_error(std::exception_ptr e) noexcept {
+    if (!failed_.exchange(true, std::memory_order_relaxed)) error_ = std::move(e);
+    arrive();
+  }
+
+  void arrive() noexcept {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (failed_.load(std::memory_order_relaxed)) {
+      r_.set_error(std::move(error_));
+    } else {
+      std::apply([&](auto&&... v) { r_.set_value(std::move(v)...); },
+                 std::tuple_cat(std::move(*std::get<I>(values_))...));
+    }
+  }
+
+  R r_;
+  std::tuple<std::optional<stored_values_t<Ss>>...> values_;
+  std::atomic<std::size_t> remaining_{0};
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+};
+
+template <class... Ss>
+class when_all_sender {
+ public:
+  using value_types = typename value_list_join<execution::value_types_of_t<Ss>...>::type;
+
+  explicit when_all_sender(Ss... ss) : senders_(std::move(ss)...) {}
+
+  template <execution::receiver R>
+  when_all_sender_op<R, std::index_sequence_for<Ss...>, Ss...> connect(R r) && {
+    return when_all_sender_op<R, std::index_sequence_for<Ss...>, Ss...>(std::move(senders_),
+                                                                         std::move(r));
+  }
+
+ private:
+  std::tuple<Ss...> senders_;
+};
+
+// schedule_on
+
+template <class Sch, class S, class R>
+class schedule_on_op {
+  struct schedule_receiver {
+    void set_value() noexcept { op->inner_.start(); }
+    void set_error(std::exception_ptr e) noexcept { op->r_.set_error(std::move(e)); }
+
+    schedule_on_op* op;
+  };
+
+  struct inner_receiver {
+    template <class... As>
+    void set_value(As&&... as) noexcept {
+      op->r_.set_value(std::forward<As>(as)...);
+    }
+    void set_error(std::exception_ptr e) noexcept { op->r_.set_error(std::move(e)); }
+
+    schedule_on_op* op;
+  };
+
+  using schedule_sender = decltype(std::declval<const Sch&>().schedule());
+
+ public:
+  schedule_on_op(const Sch& sch, S&& s, R r)
+      : r_(std::move(r)),
+        schedule_(sch.schedule().connect(schedule_receiver{this})),
+        inner_(std::move(s).connect(inner_receiver{this})) {}
+  schedule_on_op(const schedule_on_op&) = delete;
+  schedule_on_op& operator=(const schedule_on_op&) = delete;
+
+  void start() noexcept { schedule_.start(); }
+
+ private:
+  R r_;
+  execution::connect_result_t<schedule_sender, schedule_receiver> schedule_;
+  execution::connect_result_t<S, inner_receiver> inner_;
+};
+
+template <class Sch, class S>
+class schedule_on_sender {
+ public:
+  using value_types = execution::value_types_of_t<S>;
+
+  schedule_on_sender(Sch sch, S s) : sch_(std::move(sch)), s_(std::move(s)) {}
+
+  template <execution::receiver R>
+  schedule_on_op<Sch, S, R> connect(R r) && {
+    return schedule_on_op<Sch, S, R>(sch_, std::move(s_), std::move(r));
+  }
+
+  auto completion_scheduler() const
+    requires execution::has_completion_scheduler<S>
+  {
+    return s_.completion_scheduler();
+  }
+
+ private:
+  Sch sch_;
+  S s_;
+};
+
+// sync_wait
+
+template <class Values>
+struct sync_wait_result;
+template <>
+struct sync_wait_result<execution::value_list<>> {
+  using type = void;
+};
+template <class T>
+struct sync_wait_result<execution::value_list<T>> {
+  using type = T;
+};
+template <class... Ts>
+struct sync_wait_result<execution::value_list<Ts...>> {
+  using type = std::tuple<Ts...>;
+};
+
+template <class Values>
+struct sync_wait_state {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  std::optional<typename Values::template apply<std::tuple>> values;
+  std::exception_ptr error;
+};
+
+// Signals under the lock: once the waiter sees done it may destroy the
+// state, so nothing can touch it after the mutex is released.
+template <class Values>
+struct sync_wait_receiver {
+  template <class... As>
+  void set_value(As&&... as) noexcept {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    try {
+      state->values.emplace(std::forward<As>(as)...);
+    } catch (...) {
+      state->error = std::current_exception();
+    }
+    state->done = true;
+    state->cv.notify_one();
+  }
+  void set_error(std::exception_ptr e) noexcept {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->error = std::move(e);
+    state->done = true;
+    state->cv.notify_one();
+  }
+
+  sync_wait_state<Values>* state;
+};
+
+}  // namespace mystl::detail
+
+namespace mystl::execution {
+
+// Completes inline, on the thread that starts it.
+class inline_scheduler {
+ public:
+  template <class R>
+  class op {
+   public:
+    explicit op(R r) : r_(std::move(r)) {}
+    op(const op&) = delete;
+    op& operator=(const op&) = delete;
+
+    void start() noexcept { r_.set_value(); }
+
+   private:
+    R r_;
+  };
+
+  class sender {
+   public:
+    using value_types = value_list<>;
+
+    template <receiver R>
+    op<R> connect(R r) && {
+      return op<R>(std::move(r));
+    }
+    inline_scheduler completion_scheduler() const noexcept { return {}; }
+  };
+
+  sender schedule() const noexcept { return {}; }
+
+  friend bool operator==(inline_scheduler, inline_scheduler) noexcept { return true; }
+};
+
+// Completes on an executor from executor.hpp (thread_pool, run_loop) or
+// any other type with enqueue(detail::work_item*). The operation state is
+// the queue node.
+template <class Executor>
+class executor_scheduler {
+ public:
+  template <class R>
+  class op : detail::work_item {
+   public:
+    op(Executor* ex, R r) : ex_(ex), r_(std::move(r)) {}
+    op(const op&) = delete;
+    op& operator=(const op&) = delete;
+
+    void start() noexcept {
+      execute = [](detail::work_item* w) noexcept { static_cast<op*>(w)->r_.set_value(); };
+      ex_->enqueue(this);
+    }
+
+   private:
+    Executor* ex_;
+    R r_;
+  };
+
+  class sender {
+   public:
+    using value_types = value_list<>;
+
+    explicit sender(Executor* ex) noexcept : ex_(ex) {}
+
+    template <receiver R>
+    op<R> connect(R r) && {
+      return op<R>(ex_, std::move(r));
+    }
+    executor_scheduler completion_scheduler() const noexcept { return executor_scheduler(*ex_); }
+
+   private:
+    Executor* ex_;
+  };
+
+  explicit executor_scheduler(Executor& ex) noexcept : ex_(&ex) {}
+
+  sender schedule() const noexcept { return sender(ex_); }
+  Executor& executor() const noexcept { return *ex_; }
+
+  friend bool operator==(executor_scheduler a, executor_scheduler b) noexcept {
+    return a.ex_ == b.ex_;
+  }
+
+ private:
+  Executor* ex_;
+};
+
+using thread_pool_scheduler = executor_scheduler<thread_pool>;
+using run_loop_scheduler = executor_scheduler<run_loop>;
+
+template <scheduler Sch>
+auto schedule(const Sch& sch) {
+  return sch.schedule();
+}
+
+template <class... Ts>
+detail::just_sender<std::decay_t<Ts>...> just(Ts&&... vs) {
+  return detail::just_sender<std::decay_t<Ts>...>(std::in_place, std::forward<Ts>(vs)...);
+}
+
+// then(s, f): completes with f(values...).
+struct then_t {
+  template <sender S, class F>
+  detail::then_sender<std::remove_cvref_t<S>, std::decay_t<F>> operator()(S&& s, F&& f) const {
+    return {std::forward<S>(s), std::forward<F>(f)};
+  }
+  template <class F>
+  detail::sender_adaptor_closure<then_t, std::decay_t<F>> operator()(F&& f) const {
+    return detail::sender_adaptor_closure<then_t, std::decay_t<F>>(std::forward<F>(f));
+  }
+};
+inline constexpr then_t then{};
+
+// let_value(s, f): f(values&...) returns a sender, which is started in
+// place; its completion is that of the whole operation.
+struct let_value_t {
+  template <sender S, class F>
+  detail::let_value_sender<std::remove_cvref_t<S>, std::decay_t<F>> operator()(S&& s, F&& f) const {
+    return {std::forward<S>(s), std::forward<F>(f)};
+  }
+  template <class F>
+  detail::sender_adaptor_closure<let_value_t, std::decay_t<F>> operator()(F&& f) const {
+    return detail::sender_adaptor_closure<let_value_t, std::decay_t<F>>(std::forward<F>(f));
+  }
+};
+inline constexpr let_value_t let_value{};
+
+// bulk(s, n, f): calls f(i, values&...) for every i in [0, n), then
+// completes with the values.
+struct bulk_t {
+  template <sender S, std::integral Shape, class F>
+  detail::bulk_sender<std::remove_cvref_t<S>, Shape, std::decay_t<F>> operator()(S&& s, Shape n,
+                                                                                  F&& f) const {
+    return {std::forward<S>(s), n, std::forward<F>(f)};
+  }
+  template <std::integral Shape, class F>
+  detail::sender_adaptor_closure<bulk_t, Shape, std::decay_t<F>> operator()(Shape n, F&& f) const {
+    return detail::sender_adaptor_closure<bulk_t, Shape, std::decay_t<F>>(n, std::forward<F>(f));
+  }
+};
+inline constexpr bulk_t bulk{};
+
+template <sender... Ss>
+detail::when_all_sender<std::remove_cvref_t<Ss>...> when_all(Ss&&... ss) {
+  return detail::when_all_sender<std::remove_cvref_t<Ss>...>(std::forward<Ss>(ss)...);
+}
+
+// Starts s on sch.
+template <scheduler Sch, sender S>
+detail::schedule_on_sender<Sch, std::remove_cvref_t<S>> schedule_on(Sch sch, S&& s) {
+  return {std::move(sch), std::forward<S>(s)};
+}
+
+// Runs s and blocks until it completes. Returns nothing, the single value,
+// or a tuple of the values; an error is rethrown.
+template <sender S>
+typename detail::sync_wait_result<value_types_of_t<S>>::type sync_wait(S&& s) {
+  using values = value_types_of_t<S>;
+  detail::sync_wait_state<values> state;
+  auto op = std::remove_cvref_t<S>(std::forward<S>(s))
+                .connect(detail::sync_wait_receiver<values>{&state});
+  op.start();
+  {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&] { return state.done; });
+  }
+  if (state.error) std::rethrow_exception(state.error);
+  if constexpr (!std::is_void_v<typename detail::sync_wait_result<values>::type>) {
+    if constexpr (std::tuple_size_v<typename values::template apply<std::tuple>> == 1) {
+      return std::get<0>(std::move(*state.values));
+    } else {
+      return std::move(*state.values);
+    }
+  }
+}
+
+}  // namespace mystl::execution
@@ -0,0 +1,235 @@
+#pragma once
+
+// Executors for coroutine tasks: a single-threaded run_loop and a
+// fixed-size thread_pool.
+//
+//   mystl::thread_pool pool(8);
+//   mystl::task<int> work(mystl::thread_pool& p) {
+//     co_await p.schedule();  // continues on a pool thread
+//     co_return compute();
+//   }
+//   int v = mystl::sync_wait(work(pool));
+//
+//   mystl::run_loop loop;
+//   int w = loop.block_on(work_on(loop));  // everything runs on this thread
+//
+// Work is queued intrusively: a schedule() awaiter lives in the suspended
+// coroutine's frame and is itself the queue node, so scheduling never
+// allocates. Other components enqueue their own detail::work_item nodes
+// the same way.
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "task.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+struct work_item {
+  work_item* next = nullptr;
+  void (*execute)(work_item*) noexcept = nullptr;
+};
+
+// Intrusive FIFO shared by producers and consumers under one mutex.
+class work_queue {
+ public:
+  void push(work_item* w) noexcept {
+    w->next = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (tail_) {
+        tail_->next = w;
+      } else {
+        head_ = w;
+      }
+      tail_ = w;
+    }
+    cv_.notify_one();
+  }
+
+  work_item* try_pop() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pop_locked();
+  }
+
+  bool empty() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return head_ == nullptr;
+  }
+
+  // Blocks until an item is available; returns null once the queue has
+  // been closed and drained.
+  work_item* pop_wait() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return head_ || closed_; });
+    return pop_locked();
+  }
+
+  void close() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  void reopen() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+  }
+
+ private:
+  work_item* pop_locked() noexcept {
+    work_item* w = head_;
+    if (w) {
+      head_ = w->next;
+      if (!head_) tail_ = nullptr;
+    }
+    return w;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  work_item* head_ = nullptr;
+  work_item* tail_ = nullptr;
+  bool closed_ = false;
+};
+
+template <class Executor>
+class schedule_awaiter : work_item {
+ public:
+  explicit schedule_awaiter(Executor& ex) noexcept : ex_(&ex) {}
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) noexcept {
+    h_ = h;
+    execute = [](work_item* w) noexcept { static_cast<schedule_awaiter*>(w)->h_.resume(); };
+    ex_->enqueue(this);
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  Executor* ex_;
+  std::coroutine_handle<> h_;
+};
+
+}  // namespace detail
+
+// Runs queued work on whichever thread calls run(). Work may be enqueued
+// from any thread.
+class run_loop {
+ public:
+  run_loop() = default;
+  run_loop(const run_loop&) = delete;
+  run_loop& operator=(const run_loop&) = delete;
+
+  // Awaiting the result continues the coroutine inside run().
+  [[nodiscard]] detail::schedule_awaiter<run_loop> schedule() noexcept {
+    return detail::schedule_awaiter<run_loop>(*this);
+  }
+
+  void enqueue(detail::work_item* w) noexcept { queue_.push(w); }
+
+  // Processes work until finish() has been called and the queue is empty.
+  void run() noexcept {
+    while (detail::work_item* w = queue_.pop_wait()) w->execute(w);
+  }
+
+  // Processes the work that is queued now, without blocking.
+  std::size_t poll() noexcept {
+    std::size_t n = 0;
+    for (detail::work_item* w; (w = queue_.try_pop()); ++n) w->execute(w);
+    return n;
+  }
+
+  void finish() noexcept { queue_.close(); }
+
+  // Runs t on the calling thread, processing the loop until t completes,
+  // and returns its result. The loop can be reused afterwards.
+  template <class T>
+  T block_on(task<T> t) {
+    return detail::drive_to_completion(std::move(t), [this](detail::sync_wait_task& w) {
+      w.start([](void* self) noexcept { static_cast<run_loop*>(self)->finish(); }, this);
+      run();
+      queue_.reopen();
+    });
+  }
+
+ private:
+  detail::work_queue queue_;
+};
+
+// Fixed set of worker threads sharing one queue. The destructor runs all
+// work queued so far, then joins the workers.
+class thread_pool {
+ public:
+  explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency()) {
+    threads = std::max<std::size_t>(1, threads);
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] {
+        while (detail::work_item* w = queue_.pop_wait()) w->execute(w);
+      });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    queue_.close();
+    for (std::thread& t : workers_) t.join();
+  }
+
+  // Awaiting the result continues the coroutine on a pool thread.
+  [[nodiscard]] detail::schedule_awaiter<thread_pool> schedule() noexcept {
+    return detail::schedule_awaiter<thread_pool>(*this);
+  }
+
+  void enqueue(detail::work_item* w) noexcept { queue_.push(w); }
+
+  std::size_t thread_count() const noexcept { return workers_.size(); }
+
+ private:
+  detail::work_queue queue_;
+  std::vector<std::thread> workers_;
+};
+
+namespace detail {
+
+struct detached_task {
+  struct promise_type {
+    detached_task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+template <class Executor>
+detached_task run_detached(Executor& ex, task<void> t) {
+  co_await ex.schedule();
+  co_await std::move(t);
+}
+
+}  // namespace detail
+
+// Starts t on ex without waiting for it. t must not throw; an escaping
+// exception terminates the program.
+template <class Executor>
+void spawn(Executor& ex, task<void> t) {
+  detail::run_detached(ex, std::move(t));
+}
+
+}  // namespace mystl
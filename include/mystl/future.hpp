@@ -0,0 +1,558 @@
+#pragma once
+
+// future/promise with continuations, pooled shared state and no locks.
+//
+//   mystl::promise<int> p;
+//   mystl::future<std::string> f = p.get_future()
+//       .then([](int v) { return v * 2; })
+//       .then([](int v) { return std::to_string(v); });
+//   p.set_value(21);
+//   std::string s = f.get();  // "42"
+//
+//   auto both = mystl::when_all(fetch(a), fetch(b)).then([](auto t) { ... });
+//
+// Compared with std::future:
+//  - The shared state is a block from fixed_size_pool (object_pool.hpp), so
+//    a promise costs a thread-local pop, not a heap allocation.
+//  - make_ready_future() and continuations on an already-ready future need
+//    no shared state at all; the value is held inline in the future.
+//  - A future has one consumer. then() installs a single continuation,
+//    stored inline in the shared state unless it is larger than
+//    future_inline_continuation bytes.
+//  - Completion is one atomic exchange. get() waits on the atomic itself
+//    (a futex on Linux), with no mutex or condition variable.
+//
+// then(f) calls f with the value, or with no arguments for future<void>,
+// and yields a future of f's result; a future returned by f is unwrapped.
+// If the antecedent failed, f is skipped and the exception propagates.
+// f runs on the thread that completes the promise, or on the calling
+// thread if the value is already there; then(executor, f) runs it on an
+// executor from executor.hpp instead. Errors from std::future_error are
+// reused for broken promises and misuse.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "config.hpp"
+#include "executor.hpp"
+#include "object_pool.hpp"
+#include "task.hpp"
+
+namespace mystl {
+
+template <class T>
+class future;
+template <class T>
+class promise;
+
+// Continuations up to this size live inside the shared state.
+inline constexpr std::size_t future_inline_continuation = 48;
+
+namespace detail {
+
+// Index 0: no result yet, 1: exception, 2: value (std::monostate for void).
+template <class T>
+using future_result = std::variant<std::monostate, std::exception_ptr, when_all_value_t<T>>;
+
+template <class T>
+struct is_future : std::false_type {};
+template <class T>
+struct is_future<future<T>> : std::true_type {};
+
+// The shared state is also the queue node that runs its continuation on an
+// executor; work_item::execute holds the type-erased continuation.
+struct future_state_base : work_item {
+  static constexpr std::uint32_t pending = 0;
+  static constexpr std::uint32_t continued = 1;  // continuation installed
+  static constexpr std::uint32_t ready = 2;
+
+  void dispatch() noexcept {
+    if (executor) {
+      enqueue(executor, this);
+    } else {
+      execute(this);
+    }
+  }
+
+  std::atomic<std::uint32_t> status{pending};
+  std::atomic<std::uint32_t> refs{1};
+  void* executor = nullptr;
+  void (*enqueue)(void*, work_item*) noexcept = nullptr;
+  alignas(std::max_align_t) std::byte continuation[future_inline_continuation];
+};
+
+template <class T>
+struct future_state : future_state_base {
+  static future_state* create() {
+    using pool = fixed_size_pool<sizeof(future_state), alignof(future_state)>;
+    return ::new (pool::allocate()) future_state();
+  }
+
+  void release() noexcept {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~future_state();
+      fixed_size_pool<sizeof(future_state), alignof(future_state)>::deallocate(this);
+    }
+  }
+
+  // Publishes the result and runs the continuation if one is waiting.
+  void complete() noexcept {
+    if (status.exchange(ready, std::memory_order_acq_rel) == continued) {
+      dispatch();
+    } else {
+      status.notify_all();
+    }
+  }
+
+  void wait() const noexcept {
+    for (std::uint32_t s; (s = status.load(std::memory_order_acquire)) != ready;) {
+      status.wait(s, std::memory_order_acquire);
+    }
+  }
+
+  future_result<T> result;
+};
+
+template <class Executor>
+void future_enqueue(void* ex, work_item* w) noexcept {
+  static_cast<Executor*>(ex)->enqueue(w);
+}
+
+// Calls f with the value held in r (index 2).
+template <class T, class F>
+decltype(auto) future_invoke(F& f, future_result<T>& r) {
+  if constexpr (std::is_void_v<T>) {
+    return std::invoke(f);
+  } else {
+    return std::invoke(f, std::move(std::get<2>(r)));
+  }
+}
+
+template <class T, class F>
+struct future_then_result {
+  using type = std::invoke_result_t<F&, T&&>;
+};
+template <class F>
+struct future_then_result<void, F> {
+  using type = std::invoke_result_t<F&>;
+};
+
+template <class T, class F>
+using future_then_result_t = typename future_then_result<T, F>::type;
+
+// Gives the free functions below access to the internals of future and
+// promise.
+struct future_access {
+  template <class T, class F>
+  static void subscribe(future<T>&& f, F&& cont, void* ex = nullptr,
+                        void (*enqueue)(void*, work_item*) noexcept = nullptr) {
+    std::move(f).subscribe(std::forward<F>(cont), ex, enqueue);
+  }
+  template <class T>
+  static void set_result(promise<T>& p, future_result<T>&& r) noexcept {
+    p.set_result(std::move(r));
+  }
+};
+
+}  // namespace detail
+
+template <class T>
+class promise {
+  static_assert(!std::is_reference_v<T>, "promise: reference types are not supported");
+
+ public:
+  promise() : state_(detail::future_state<T>::create()) {}
+  promise(promise&& other) noexcept
+      : state_(std::exchange(other.state_, nullptr)),
+        retrieved_(other.retrieved_),
+        satisfied_(other.satisfied_) {}
+  promise& operator=(promise&& other) noexcept {
+    if (this != &other) {
+      abandon();
+      state_ = std::exchange(other.state_, nullptr);
+      retrieved_ = other.retrieved_;
+      satisfied_ = other.satisfied_;
+    }
+    return *this;
+  }
+  ~promise() { abandon(); }
+
+  future<T> get_future() {
+    check_state();
+    if (retrieved_) throw std::future_error(std::future_errc::future_already_retrieved);
+    retrieved_ = true;
+    state_->refs.fetch_add(1, std::memory_order_relaxed);
+    return future<T>(state_);
+  }
+
+  template <class... Args>
+  void set_value(Args&&... args) {
+    check_satisfiable();
+    state_->result.template emplace<2>(std::forward<Args>(args)...);
+    satisfied_ = true;
+    state_->complete();
+  }
+
+  void set_exception(std::exception_ptr e) {
+    check_satisfiable();
+    set_result(detail::future_result<T>(std::in_place_index<1>, std::move(e)));
+  }
+
+ private:
+  friend struct detail::future_access;
+
+  void check_state() const {
+    if (!state_) throw std::future_error(std::future_errc::no_state);
+  }
+  void check_satisfiable() const {
+    check_state();
+    if (satisfied_) throw std::future_error(std::future_errc::promise_already_satisfied);
+  }
+
+  void set_result(detail::future_result<T>&& r) noexcept {
+    state_->result = std::move(r);
+    satisfied_ = true;
+    state_->complete();
+  }
+
+  void abandon() noexcept {
+    if (!state_) return;
+    if (!satisfied_) {
+      set_result(detail::future_result<T>(
+          std::in_place_index<1>,
+          std::make_exception_ptr(std::future_error(std::future_errc::broken_promise))));
+    }
+    std::exchange(state_, nullptr)->release();
+  }
+
+  detail::future_state<T>* state_;
+  bool retrieved_ = false;
+  bool satisfied_ = false;
+};
+
+template <class T>
+class future {
+  static_assert(!std::is_reference_v<T>, "future: reference types are not supported");
+
+ public:
+  using value_type = T;
+
+  future() noexcept = default;
+  future(future&& other) noexcept
+      : state_(std::exchange(other.state_, nullptr)), ready_(std::exchange(other.ready_, {})) {}
+  future& operator=(future&& other) noexcept {
+    if (this != &other) {
+      reset();
+      state_ = std::exchange(other.state_, nullptr);
+      ready_ = std::exchange(other.ready_, {});
+    }
+    return *this;
+  }
+  ~future() { reset(); }
+
+  bool valid() const noexcept { return state_ || ready_.index() != 0; }
+
+  bool is_ready() const noexcept {
+    if (!state_) return ready_.index() != 0;
+    return state_->status.load(std::memory_order_acquire) == detail::future_state_base::ready;
+  }
+
+  void wait() const noexcept {
+    if (state_) state_->wait();
+  }
+
+  // Blocks until the result is available, then returns the value or
+  // rethrows the exception. The future is invalid afterwards.
+  T get() {
+    take();
+    detail::future_result<T> r = std::exchange(ready_, {});
+    if (r.index() == 0) throw std::future_error(std::future_errc::no_state);
+    if (r.index() == 1) std::rethrow_exception(std::get<1>(std::move(r)));
+    if constexpr (!std::is_void_v<T>) return std::get<2>(std::move(r));
+  }
+
+  template <class F>
+  auto then(F&& f) && {
+    return std::move(*this).then_impl(std::forward<F>(f), nullptr, nullptr);
+  }
+
+  template <class Executor, class F>
+  auto then(Executor& ex, F&& f) && {
+    return std::move(*this).then_impl(std::forward<F>(f), &ex, &detail::future_enqueue<Executor>);
+  }
+
+ private:
+  template <class U>
+  friend class promise;
+  template <class U>
+  friend class future;
+  friend struct detail::future_access;
+  template <class U, class... Args>
+  friend future<U> make_ready_future(Args&&...);
+  template <class U>
+  friend future<U> make_exceptional_future(std::exception_ptr);
+
+  explicit future(detail::future_state<T>* s) noexcept : state_(s) {}
+  explicit future(detail::future_result<T>&& r) noexcept : ready_(std::move(r)) {}
+
+  void reset() noexcept {
+    if (state_) std::exchange(state_, nullptr)->release();
+    ready_.template emplace<0>();
+  }
+
+  // Moves a shared result into ready_ once it is available.
+  void take() noexcept {
+    if (!state_) return;
+    state_->wait();
+    ready_ = std::move(state_->result);
+    std::exchange(state_, nullptr)->release();
+  }
+
+  // Installs cont, called exactly once with the result; consumes the
+  // future. cont must not throw.
+  template <class F>
+  void subscribe(F&& cont, void* ex, void (*enqueue)(void*, detail::work_item*) noexcept) && {
+    using C = std::decay_t<F>;
+    if (!valid()) throw std::future_error(std::future_errc::no_state);
+    if (!state_) {
+      if (!ex) {
+        detail::future_result<T> r = std::exchange(ready_, {});
+        C(std::forward<F>(cont))(std::move(r));
+        return;
+      }
+      // Running on an executor needs a queue node, so a ready future gets
+      // a shared state after all.
+      auto* s = detail::future_state<T>::create();
+      s->result = std::exchange(ready_, {});
+      s->status.store(detail::future_state_base::ready, std::memory_order_relaxed);
+      state_ = s;
+    }
+    constexpr bool fits =
+        sizeof(C) <= future_inline_continuation && alignof(C) <= alignof(std::max_align_t);
+    detail::future_state<T>* s = state_;
+    if constexpr (fits) {
+      ::new (static_cast<void*>(s->continuation)) C(std::forward<F>(cont));
+      s->execute = [](detail::work_item* w) noexcept {
+        auto* st = static_cast<detail::future_state<T>*>(w);
+        C* c = std::launder(reinterpret_cast<C*>(st->continuation));
+        (*c)(std::move(st->result));
+        c->~C();
+        st->release();
+      };
+    } else {
+      ::new (static_cast<void*>(s->continuation)) C*(new C(std::forward<F>(cont)));
+      s->execute = [](detail::work_item* w) noexcept {
+        auto* st = static_cast<detail::future_state<T>*>(w);
+        C* c = *std::launder(reinterpret_cast<C**>(st->continuation));
+        (*c)(std::move(st->result));
+        delete c;
+        st->release();
+      };
+    }
+    state_ = nullptr;
+    s->executor = ex;
+    s->enqueue = enqueue;
+    std::uint32_t expected = detail::future_state_base::pending;
+    if (!s->status.compare_exchange_strong(expected, detail::future_state_base::continued,
+                                           std::memory_order_acq_rel, std::memory_order_acquire)) {
+      s->dispatch();
+    }
+  }
+
+  template <class F>
+  auto then_impl(F&& f, void* ex, void (*enqueue)(void*, detail::work_item*) noexcept) {
+    using Fn = std::decay_t<F>;
+    using U = detail::future_then_result_t<T, Fn>;
+    if (!valid()) throw std::future_error(std::future_errc::no_state);
+
+    if constexpr (detail::is_future<U>::value) {
+      using V = typename U::value_type;
+      promise<V> p;
+      future<V> out = p.get_future();
+      std::move(*this).subscribe(
+          [fn = Fn(std::forward<F>(f)),
+           p = std::move(p)](detail::future_result<T>&& r) mutable noexcept {
+            if (r.index() == 1) {
+              detail::future_access::set_result(
+                  p, detail::future_result<V>(std::in_place_index<1>, std::get<1>(std::move(r))));
+              return;
+            }
+            try {
+              U inner = detail::future_invoke<T>(fn, r);
+              std::move(inner).subscribe(
+                  [p = std::move(p)](detail::future_result<V>&& r2) mutable noexcept {
+                    detail::future_access::set_result(p, std::move(r2));
+                  },
+                  nullptr, nullptr);
+            } catch (...) {
+              detail::future_access::set_result(
+                  p, detail::future_result<V>(std::in_place_index<1>, std::current_exception()));
+            }
+          },
+          ex, enqueue);
+      return out;
+    } else {
+      using R = detail::future_result<U>;
+      auto run = [](Fn& fn, detail::future_result<T>& r) noexcept -> R {
+        if (r.index() == 1) return R(std::in_place_index<1>, std::get<1>(std::move(r)));
+        try {
+          if constexpr (std::is_void_v<U>) {
+            detail::future_invoke<T>(fn, r);
+            return R(std::in_place_index<2>);
+          } else {
+            return R(std::in_place_index<2>, detail::future_invoke<T>(fn, r));
+          }
+        } catch (...) {
+          return R(std::in_place_index<1>, std::current_exception());
+        }
+      };
+      // Already ready and nowhere else to go: run now, with no shared state.
+      if (!state_ && !ex) {
+        Fn fn(std::forward<F>(f));
+        detail::future_result<T> r = std::exchange(ready_, {});
+        return future<U>(run(fn, r));
+      }
+      promise<U> p;
+      future<U> out = p.get_future();
+      std::move(*this).subscribe(
+          [fn = Fn(std::forward<F>(f)), p = std::move(p),
+           run](detail::future_result<T>&& r) mutable noexcept {
+            detail::future_access::set_result(p, run(fn, r));
+          },
+          ex, enqueue);
+      return out;
+    }
+  }
+
+  detail::future_state<T>* state_ = nullptr;
+  detail::future_result<T> ready_;
+};
+
+// A future that already holds its value, without a shared state.
+template <class T, class... Args>
+future<T> make_ready_future(Args&&... args) {
+  return future<T>(detail::future_result<T>(std::in_place_index<2>, std::forward<Args>(args)...));
+}
+
+template <class T>
+future<std::decay_t<T>> make_ready_future(T&& value) {
+  return make_ready_future<std::decay_t<T>, T>(std::forward<T>(value));
+}
+
+inline future<void> make_ready_future() { return make_ready_future<void>(); }
+
+template <class T>
+future<T> make_exceptional_future(std::exception_ptr e) {
+  return future<T>(detail::future_result<T>(std::in_place_index<1>, std::move(e)));
+}
+
+namespace detail {
+
+// Collects the results of when_all's inputs; the last one to arrive
+// completes the output promise. Comes from the pool as well.
+template <class Results, class Out>
+struct future_when_all_state {
+  explicit future_when_all_state(std::size_t n) : remaining(n) {}
+
+  std::atomic<std::size_t> remaining;
+  Results results;
+  promise<Out> out;
+};
+
+template <class State>
+std::shared_ptr<State> make_when_all_state(std::size_t n) {
+  return std::allocate_shared<State>(pool_allocator<State>(), n);
+}
+
+template <class... Ts, std::size_t... I>
+future<std::tuple<when_all_value_t<Ts>...>> future_when_all(std::index_sequence<I...>,
+                                                            future<Ts>... fs) {
+  using out_t = std::tuple<when_all_value_t<Ts>...>;
+  using state_t = future_when_all_state<std::tuple<future_result<Ts>...>, out_t>;
+  auto st = make_when_all_state<state_t>(sizeof...(Ts));
+  future<out_t> out = st->out.get_future();
+  auto arrive = [](state_t& s) noexcept {
+    if (s.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    std::exception_ptr error;
+    ((!error && std::get<I>(s.results).index() == 1
+          ? (void)(error = std::get<1>(std::get<I>(s.results)))
+          : (void)0),
+     ...);
+    if (error) {
+      future_access::set_result(s.out,
+                                future_result<out_t>(std::in_place_index<1>, std::move(error)));
+      return;
+    }
+    try {
+      future_access::set_result(
+          s.out, future_result<out_t>(std::in_place_index<2>,
+                                      std::get<2>(std::move(std::get<I>(s.results)))...));
+    } catch (...) {
+      future_access::set_result(
+          s.out, future_result<out_t>(std::in_place_index<1>, std::current_exception()));
+    }
+  };
+  (future_access::subscribe(std::move(fs),
+                            [st, arrive](future_result<Ts>&& r) noexcept {
+                              std::get<I>(st->results) = std::move(r);
+                              arrive(*st);
+                            }),
+   ...);
+  return out;
+}
+
+}  // namespace detail
+
+// Completes with every input's value once all have completed, or with the
+// exception of the lowest-indexed input that failed. void values appear as
+// std::monostate.
+template <class... Ts>
+  requires(sizeof...(Ts) > 0)
+future<std::tuple<detail::when_all_value_t<Ts>...>> when_all(future<Ts>... fs) {
+  return detail::future_when_all(std::index_sequence_for<Ts...>{}, std::move(fs)...);
+}
+
+template <class T>
+future<std::vector<detail::when_all_value_t<T>>> when_all(std::vector<future<T>> fs) {
+  using out_t = std::vector<detail::when_all_value_t<T>>;
+  using result_t = detail::future_result<T>;
+  using state_t = detail::future_when_all_state<std::vector<result_t>, out_t>;
+  if (fs.empty()) return make_ready_future<out_t>();
+  auto st = detail::make_when_all_state<state_t>(fs.size());
+  st->results.resize(fs.size());
+  future<out_t> out = st->out.get_future();
+  for (std::size_t i = 0; i < fs.size(); ++i) {
+    detail::future_access::subscribe(std::move(fs[i]), [st, i](result_t&& r) noexcept {
+      state_t& s = *st;
+      s.results[i] = std::move(r);
+      if (s.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+      try {
+        out_t values;
+        values.reserve(s.results.size());
+        for (result_t& x : s.results) {
+          if (x.index() == 1) std::rethrow_exception(std::get<1>(x));
+          values.push_back(std::get<2>(std::move(x)));
+        }
+        detail::future_access::set_result(
+            s.out, detail::future_result<out_t>(std::in_place_index<2>, std::move(values)));
+      } catch (...) {
+        detail::future_access::set_result(
+            s.out, detail::future_result<out_t>(std::in_place_index<1>, std::current_exception()));
+      }
+    });
+  }
+  return out;
+}
+
+}  // namespace mystl
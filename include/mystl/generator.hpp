@@ -0,0 +1,214 @@
+#pragma once
+
+// Synchronous coroutine generator whose frames come from an allocator.
+//
+//   mystl::generator<int> iota(int n) {
+//     for (int i = 0; i < n; ++i) co_yield i;
+//   }
+//   for (int i : iota(10)) use(i);
+//
+//   // Frames carved from a stack arena instead of the heap:
+//   using arena_alloc = mystl::short_alloc<std::byte, 4096>;
+//   mystl::generator<int, arena_alloc> iota(std::allocator_arg_t, arena_alloc, int n);
+//   mystl::stack_arena<4096> arena;
+//   for (int i : iota(std::allocator_arg, arena, 10)) use(i);
+//
+// The frame is allocated with Allocator, rebound internally. A stateless
+// allocator is default-constructed. A stateful one is passed to the
+// coroutine as (std::allocator_arg, alloc, ...) and a copy is stored just
+// past the frame so that the frame can be freed with it. Yielded values are
+// not copied: the promise points at the yielded object, which stays alive
+// while the generator is suspended. Yielding a const lvalue is the only
+// case that copies.
+
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+
+namespace mystl {
+
+template <class T, class Allocator = std::allocator<std::byte>>
+class generator : public std::ranges::view_interface<generator<T, Allocator>> {
+ public:
+  using value_type = std::remove_cvref_t<T>;
+  using reference = std::conditional_t<std::is_reference_v<T>, T, value_type&>;
+
+  class promise_type;
+  class iterator;
+
+  generator() noexcept = default;
+  generator(generator&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+  generator& operator=(generator&& other) noexcept {
+    if (this != &other) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(other.h_, {});
+    }
+    return *this;
+  }
+  ~generator() {
+    if (h_) h_.destroy();
+  }
+
+  // Starts the generator; call at most once.
+  iterator begin() {
+    h_.resume();
+    h_.promise().rethrow_if_failed();
+    return iterator(h_);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+ private:
+  explicit generator(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+
+  std::coroutine_handle<promise_type> h_;
+};
+
+template <class T, class Allocator>
+class generator<T, Allocator>::promise_type {
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block {
+    std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+  };
+  using block_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  static constexpr bool stores_allocator =
+      !(std::is_empty_v<block_allocator> && std::default_initializable<block_allocator>);
+
+  static constexpr std::size_t allocator_offset(std::size_t frame) noexcept {
+    return (frame + alignof(block_allocator) - 1) & ~(alignof(block_allocator) - 1);
+  }
+  static constexpr std::size_t block_count(std::size_t frame) noexcept {
+    const std::size_t bytes =
+        stores_allocator ? allocator_offset(frame) + sizeof(block_allocator) : frame;
+    return (bytes + sizeof(block) - 1) / sizeof(block);
+  }
+
+  static void* allocate(block_allocator a, std::size_t frame) {
+    block* p = block_traits::allocate(a, block_count(frame));
+    if constexpr (stores_allocator) {
+      ::new (static_cast<void*>(reinterpret_cast<std::byte*>(p) + allocator_offset(frame)))
+          block_allocator(std::move(a));
+    }
+    return p;
+  }
+
+ public:
+  static void* operator new(std::size_t frame)
+    requires std::default_initializable<block_allocator>
+  {
+    return allocate(block_allocator(), frame);
+  }
+  template <class... Args>
+  static void* operator new(std::size_t frame, std::allocator_arg_t, const Allocator& a,
+                            const Args&...) {
+    return allocate(block_allocator(a), frame);
+  }
+  // Member-function coroutines see the object first.
+  template <class This, class... Args>
+  static void* operator new(std::size_t frame, const This&, std::allocator_arg_t,
+                            const Allocator& a, const Args&...) {
+    return allocate(block_allocator(a), frame);
+  }
+
+  static void operator delete(void* p, std::size_t frame) noexcept {
+    auto* blocks = static_cast<block*>(p);
+    if constexpr (stores_allocator) {
+      auto* stored = std::launder(
+          reinterpret_cast<block_allocator*>(static_cast<std::byte*>(p) + allocator_offset(frame)));
+      block_allocator a(std::move(*stored));
+      stored->~block_allocator();
+      block_traits::deallocate(a, blocks, block_count(frame));
+    } else {
+      block_allocator a;
+      block_traits::deallocate(a, blocks, block_count(frame));
+    }
+  }
+
+  generator get_return_object() noexcept {
+    return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+  }
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  std::suspend_always final_suspend() const noexcept { return {}; }
+
+  std::suspend_always yield_value(std::remove_reference_t<T>& v) noexcept {
+    value_ = std::addressof(v);
+    return {};
+  }
+  std::suspend_always yield_value(std::remove_reference_t<T>&& v) noexcept {
+    value_ = std::addressof(v);
+    return {};
+  }
+  // A const lvalue cannot be exposed through a mutable reference, so it is
+  // copied into the awaiter, which lives in the frame until resumption.
+  auto yield_value(const value_type& v)
+    requires(!std::is_reference_v<T> && std::copy_constructible<value_type>)
+  {
+    struct awaiter {
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+        h.promise().value_ = std::addressof(copy);
+      }
+      void await_resume() const noexcept {}
+
+      value_type copy;
+    };
+    return awaiter{v};
+  }
+
+  void await_transform() = delete;
+  void return_void() noexcept {}
+  void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+  void rethrow_if_failed() {
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+
+ private:
+  friend class iterator;
+
+  std::add_pointer_t<reference> value_ = nullptr;
+  std::exception_ptr error_;
+};
+
+template <class T, class Allocator>
+class generator<T, Allocator>::iterator {
+ public:
+  using value_type = generator::value_type;
+  using difference_type = std::ptrdiff_t;
+
+  iterator(iterator&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+  iterator& operator=(iterator&& other) noexcept {
+    h_ = std::exchange(other.h_, {});
+    return *this;
+  }
+
+  reference operator*() const noexcept { return static_cast<reference>(*h_.promise().value_); }
+
+  iterator& operator++() {
+    h_.resume();
+    h_.promise().rethrow_if_failed();
+    return *this;
+  }
+  void operator++(int) { ++*this; }
+
+  friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+    return it.h_.done();
+  }
+
+ private:
+  friend class generator;
+
+  explicit iterator(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+
+  std::coroutine_handle<promise_type> h_;
+};
+
+}  // namespace mystl
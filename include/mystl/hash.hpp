@@ -0,0 +1,132 @@
+#pragma once
+
+// Seeded 64-bit hashing for the library's probabilistic and perfect-hash
+// containers. Unlike std::hash these functions take a seed, produce the same
+// value on every platform and run, and are usable in constant expressions.
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "config.hpp"
+
+namespace mystl {
+
+// Full-avalanche 64-bit finaliser (the MurmurHash3 fmix64 constants).
+constexpr std::uint64_t mix64(std::uint64_t x) noexcept {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDull;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+namespace detail {
+
+struct uint128_halves {
+  std::uint64_t hi;
+  std::uint64_t lo;
+};
+
+// Full 64x64 -> 128 product, from 32-bit pieces where there is no 128-bit
+// integer type.
+constexpr uint128_halves mul_wide(std::uint64_t a, std::uint64_t b) noexcept {
+#if MYSTL_HAS_INT128
+  const uint128_t r = static_cast<uint128_t>(a) * b;
+  return {static_cast<std::uint64_t>(r >> 64), static_cast<std::uint64_t>(r)};
+#else
+  const std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+  const std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+  const std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+  const std::uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+  return {(hi_lo >> 32) + (cross >> 32) + hi_hi, (cross << 32) | (lo_lo & 0xFFFFFFFFu)};
+#endif
+}
+
+}  // namespace detail
+
+// 64x64 -> 128 multiply, folded by xoring the halves.
+constexpr std::uint64_t mul_fold64(std::uint64_t a, std::uint64_t b) noexcept {
+  const detail::uint128_halves r = detail::mul_wide(a, b);
+  return r.lo ^ r.hi;
+}
+
+// Maps a uniformly distributed h onto [0, n) without a division (Lemire's
+// multiply-shift range reduction). Uses the high bits of h.
+constexpr std::uint64_t fastrange64(std::uint64_t h, std::uint64_t n) noexcept {
+  return detail::mul_wide(h, n).hi;
+}
+
+namespace detail {
+
+inline constexpr std::uint64_t hash_k0 = 0xA0761D6478BD642Full;
+inline constexpr std::uint64_t hash_k1 = 0xE7037ED1A0B428DBull;
+inline constexpr std::uint64_t hash_k2 = 0x8EBC6AF09C88C6E3ull;
+
+constexpr std::uint64_t load_le(const char* p, std::size_t n) noexcept {
+  if (!std::is_constant_evaluated() && n == 8 && std::endian::native == std::endian::little) {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+  }
+  std::uint64_t v = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+  }
+  return v;
+}
+
+}  // namespace detail
+
+// Hashes n bytes with the given seed: eight bytes per multiply-fold round,
+// then a final avalanche. Good distribution, not cryptographic.
+constexpr std::uint64_t hash_bytes(const char* p, std::size_t n, std::uint64_t seed = 0) noexcept {
+  std::uint64_t h = seed ^ mul_fold64(seed ^ detail::hash_k0, n ^ detail::hash_k1);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    h = mul_fold64(detail::load_le(p + i, 8) ^ detail::hash_k1,
+                   detail::load_le(p + i + 8, 8) ^ h);
+  }
+  if (i + 8 <= n) {
+    h = mul_fold64(detail::load_le(p + i, 8) ^ detail::hash_k1, h ^ detail::hash_k2);
+    i += 8;
+  }
+  if (i < n) {
+    h = mul_fold64(detail::load_le(p + i, n - i) ^ detail::hash_k2, h ^ detail::hash_k0);
+  }
+  return mix64(h);
+}
+
+constexpr std::uint64_t hash_bytes(std::string_view s, std::uint64_t seed = 0) noexcept {
+  return hash_bytes(s.data(), s.size(), seed);
+}
+
+// seeded_hash<T>{}(value, seed) -> std::uint64_t. Specialised for integral
+// and enum types and for anything convertible to std::string_view;
+// specialise it for other key types.
+template <class T>
+struct seeded_hash;
+
+template <class T>
+  requires(std::is_integral_v<T> || std::is_enum_v<T>)
+struct seeded_hash<T> {
+  constexpr std::uint64_t operator()(T value, std::uint64_t seed = 0) const noexcept {
+    return mix64(static_cast<std::uint64_t>(value) ^ mix64(seed ^ detail::hash_k0));
+  }
+};
+
+template <class T>
+  requires std::is_convertible_v<const T&, std::string_view>
+struct seeded_hash<T> {
+  constexpr std::uint64_t operator()(std::string_view s, std::uint64_t seed = 0) const noexcept {
+    return hash_bytes(s, seed);
+  }
+};
+
+}  // namespace mystl
@@ -0,0 +1,296 @@
+#pragma once
+
+// High-dynamic-range histogram of unsigned values (latencies, sizes) with a
+// fixed relative precision, after Gil Tene's HdrHistogram.
+//
+//   mystl::hdr_histogram latency(3'600'000'000'000, 3);  // up to 1 h in ns, 3 digits
+//   latency.record(elapsed_ns);                          // any thread, wait-free
+//
+//   mystl::hdr_snapshot s = latency.snapshot();
+//   s += other_process_snapshot;                         // merge
+//   std::uint64_t p99 = s.value_at_percentile(99.0);
+//
+// Values are grouped into power-of-two ranges, each split into 2^p equal
+// buckets, where 2^-p is the largest power of two not above
+// 10^-significant_digits. Every value is therefore recorded to within that
+// relative error, and the bucket index is a few shifts away from the value.
+// Memory grows with the number of power-of-two ranges below the highest
+// trackable value: 3 digits up to one hour in nanoseconds is about 270 KiB.
+//
+// hdr_histogram is the concurrent recorder: record() is a single relaxed
+// fetch_add on the value's bucket. hdr_snapshot is a plain copy for
+// queries, merging and single-threaded recording. Values above the highest
+// trackable value are recorded as that value.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "config.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Maps values to bucket indices. Values below 2^p get a bucket each; above
+// that, the power-of-two range [2^h, 2^(h+1)) is split into 2^p buckets of
+// width 2^(h-p), indexed consecutively after the ranges below it.
+class hdr_layout {
+ public:
+  static constexpr int max_significant_digits = 5;
+
+  hdr_layout(std::uint64_t highest_trackable, int significant_digits)
+      : highest_(highest_trackable), digits_(significant_digits) {
+    if (significant_digits < 0 || significant_digits > max_significant_digits) {
+      throw std::invalid_argument("hdr_histogram: significant digits must be in [0, 5]");
+    }
+    if (highest_trackable < 1) {
+      throw std::invalid_argument("hdr_histogram: highest trackable value must be positive");
+    }
+    std::uint64_t power = 1;
+    for (int i = 0; i < significant_digits; ++i) power *= 10;
+    sub_bits_ = static_cast<unsigned>(std::bit_width(power - 1));
+    size_ = index_of(highest_trackable) + 1;
+  }
+
+  std::size_t size() const noexcept { return size_; }
+  std::uint64_t highest_trackable() const noexcept { return highest_; }
+  int significant_digits() const noexcept { return digits_; }
+
+  MYSTL_ALWAYS_INLINE std::size_t index_of(std::uint64_t v) const noexcept {
+    v = std::min(v, highest_);
+    if (v >> sub_bits_ == 0) return static_cast<std::size_t>(v);
+    const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - 1 - sub_bits_;
+    return static_cast<std::size_t>(((std::uint64_t{shift} + 1) << sub_bits_) + (v >> shift) -
+                                    (std::uint64_t{1} << sub_bits_));
+  }
+
+  std::uint64_t lowest_equivalent(std::size_t index) const noexcept {
+    const std::uint64_t range = index >> sub_bits_;
+    if (range == 0) return index;
+    const std::uint64_t sub = std::uint64_t{1} << sub_bits_;
+    const std::uint64_t mantissa = (index & (sub - 1)) | sub;
+    return mantissa << (range - 1);
+  }
+
+  std::uint64_t highest_equivalent(std::size_t index) const noexcept {
+    const std::uint64_t range = index >> sub_bits_;
+    return lowest_equivalent(index) + (range == 0 ? 0 : (std::uint64_t{1} << (range - 1)) - 1);
+  }
+
+  // Middle of the bucket, used when a bucket stands for its values.
+  std::uint64_t median_equivalent(std::size_t index) const noexcept {
+    const std::uint64_t lo = lowest_equivalent(index);
+    return lo + (highest_equivalent(index) - lo) / 2;
+  }
+
+  bool operator==(const hdr_layout& other) const noexcept {
+    return highest_ == other.highest_ && sub_bits_ == other.sub_bits_;
+  }
+
+ private:
+  std::uint64_t highest_;
+  int digits_;
+  unsigned sub_bits_ = 0;
+  std::size_t size_ = 0;
+};
+
+}  // namespace detail
+
+class hdr_histogram;
+
+// Single-threaded histogram: the result of hdr_histogram::snapshot(), or a
+// recorder in its own right.
+class hdr_snapshot {
+ public:
+  explicit hdr_snapshot(std::uint64_t highest_trackable = std::numeric_limits<std::uint64_t>::max(),
+                        int significant_digits = 3)
+      : layout_(highest_trackable, significant_digits), counts_(layout_.size()) {}
+
+  void record(std::uint64_t value, std::uint64_t count = 1) noexcept {
+    counts_[layout_.index_of(value)] += count;
+    total_ += count;
+  }
+
+  // Adds every value recorded in other. Histograms with a different range
+  // or precision are merged bucket by bucket at bucket midpoints.
+  hdr_snapshot& operator+=(const hdr_snapshot& other) {
+    if (layout_ == other.layout_) {
+      for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+      total_ += other.total_;
+    } else {
+      other.for_each([&](std::uint64_t lo, std::uint64_t hi, std::uint64_t n) {
+        record(lo + (hi - lo) / 2, n);
+      });
+    }
+    return *this;
+  }
+
+  void reset() noexcept {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_ = 0;
+  }
+
+  std::uint64_t total_count() const noexcept { return total_; }
+  bool empty() const noexcept { return total_ == 0; }
+
+  // Within the histogram's precision; 0 if empty.
+  std::uint64_t min() const noexcept {
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] != 0) return layout_.lowest_equivalent(i);
+    }
+    return 0;
+  }
+
+  std::uint64_t max() const noexcept {
+    for (std::size_t i = counts_.size(); i-- > 0;) {
+      if (counts_[i] != 0) {
+        return std::min(layout_.highest_equivalent(i), layout_.highest_trackable());
+      }
+    }
+    return 0;
+  }
+
+  double mean() const noexcept {
+    if (total_ == 0) return 0.0;
+    double sum = 0.0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] != 0) {
+        sum += static_cast<double>(layout_.median_equivalent(i)) * static_cast<double>(counts_[i]);
+      }
+    }
+    return sum / static_cast<double>(total_);
+  }
+
+  double stddev() const noexcept {
+    if (total_ == 0) return 0.0;
+    const double m = mean();
+    double sq = 0.0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] != 0) {
+        const double d = static_cast<double>(layout_.median_equivalent(i)) - m;
+        sq += d * d * static_cast<double>(counts_[i]);
+      }
+    }
+    return std::sqrt(sq / static_cast<double>(total_));
+  }
+
+  // Smallest recorded value v such that percentile% of all values are <= v
+  // (up to precision: the highest value of v's bucket). 0 if empty.
+  std::uint64_t value_at_percentile(double percentile) const noexcept {
+    if (total_ == 0) return 0;
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto rank =
+        static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total_)));
+    rank = std::clamp<std::uint64_t>(rank, 1, total_);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= rank) return std::min(layout_.highest_equivalent(i), layout_.highest_trackable());
+    }
+    return max();
+  }
+
+  // Number of recorded values equivalent to value.
+  std::uint64_t count_at(std::uint64_t value) const noexcept {
+    return counts_[layout_.index_of(value)];
+  }
+
+  // Calls f(lowest, highest, count) for every non-empty bucket, in order.
+  template <class F>
+  void for_each(F&& f) const {
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] != 0) {
+        f(layout_.lowest_equivalent(i),
+          std::min(layout_.highest_equivalent(i), layout_.highest_trackable()), counts_[i]);
+      }
+    }
+  }
+
+  std::uint64_t highest_trackable() const noexcept { return layout_.highest_trackable(); }
+  int significant_digits() const noexcept { return layout_.significant_digits(); }
+
+ private:
+  friend class hdr_histogram;
+
+  detail::hdr_layout layout_;
+  std::vector<std::uint64_t> counts_;
+  std::uint64_t total_ = 0;
+};
+
+// Concurrent recorder. record() is wait-free wherever fetch_add is (x86,
+// ARMv8.1 with LSE); reads take a snapshot.
+class hdr_histogram {
+ public:
+  explicit hdr_histogram(
+      std::uint64_t highest_trackable = std::numeric_limits<std::uint64_t>::max(),
+      int significant_digits = 3)
+      : layout_(highest_trackable, significant_digits),
+        counts_(new std::atomic<std::uint64_t>[layout_.size()]) {}
+  hdr_histogram(const hdr_histogram&) = delete;
+  hdr_histogram& operator=(const hdr_histogram&) = delete;
+
+  MYSTL_ALWAYS_INLINE void record(std::uint64_t value, std::uint64_t count = 1) noexcept {
+    counts_[layout_.index_of(value)].fetch_add(count, std::memory_order_relaxed);
+  }
+
+  // Adds every value recorded in s.
+  void add(const hdr_snapshot& s) noexcept {
+    if (layout_ == s.layout_) {
+      for (std::size_t i = 0; i < layout_.size(); ++i) {
+        if (s.counts_[i] != 0) counts_[i].fetch_add(s.counts_[i], std::memory_order_relaxed);
+      }
+    } else {
+      s.for_each([&](std::uint64_t lo, std::uint64_t hi, std::uint64_t n) {
+        record(lo + (hi - lo) / 2, n);
+      });
+    }
+  }
+
+  // Not atomic as a whole: values recorded concurrently may or may not be
+  // included, bucket by bucket.
+  hdr_snapshot snapshot() const {
+    hdr_snapshot out(layout_.highest_trackable(), layout_.significant_digits());
+    for (std::size_t i = 0; i < layout_.size(); ++i) {
+      out.counts_[i] = counts_[i].load(std::memory_order_relaxed);
+    }
+    out.total_ = total(out.counts_);
+    return out;
+  }
+
+  // Takes a snapshot and clears the buckets it read, for interval
+  // reporting. Each concurrent record() lands in exactly one interval.
+  hdr_snapshot snapshot_and_reset() {
+    hdr_snapshot out(layout_.highest_trackable(), layout_.significant_digits());
+    for (std::size_t i = 0; i < layout_.size(); ++i) {
+      // Skips the write for empty buckets, which are most of them.
+      if (counts_[i].load(std::memory_order_relaxed) != 0) {
+        out.counts_[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+      }
+    }
+    out.total_ = total(out.counts_);
+    return out;
+  }
+
+  std::uint64_t highest_trackable() const noexcept { return layout_.highest_trackable(); }
+  int significant_digits() const noexcept { return layout_.significant_digits(); }
+
+ private:
+  static std::uint64_t total(const std::vector<std::uint64_t>& counts) noexcept {
+    std::uint64_t sum = 0;
+    for (std::uint64_t c : counts) sum += c;
+    return sum;
+  }
+
+  detail::hdr_layout layout_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+};
+
+}  // namespace mystl
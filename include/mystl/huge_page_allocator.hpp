@@ -0,0 +1,242 @@
+#pragma once
+
+// Allocator that backs large allocations with 2 MiB pages.
+//
+//   mystl::huge_vector<std::uint64_t> table(std::size_t{1} << 30);
+//   mystl::huge_unordered_map<std::uint64_t, row_id> index;
+//
+// Requests of at least huge_page_size bytes get their own anonymous mapping,
+// rounded up to and aligned on a 2 MiB boundary. Under huge_page_mode::
+// transparent that mapping is marked MADV_HUGEPAGE so that the kernel backs
+// it with transparent huge pages. Under huge_page_mode::explicit_pages a
+// MAP_HUGETLB mapping from the reserved hugetlbfs pool is tried first.
+// Whatever is not available degrades quietly: an empty pool falls back to
+// transparent huge pages, and THP disabled falls back to ordinary 4 KiB
+// pages. Smaller requests go to operator new. Off Linux every request goes
+// to operator new.
+//
+// huge_node_allocator adds a node path for node-based containers: single
+// objects come from the object_pool machinery, per-thread magazines and
+// all, with its slabs taken from huge_page_allocate 2 MiB at a time. The
+// nodes of a huge_unordered_map thus sit on huge pages along with its
+// buckets. As with object_pool, slabs are never returned to the system.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "object_pool.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace mystl {
+
+inline constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+enum class huge_page_mode {
+  transparent,     // madvise(MADV_HUGEPAGE) on an aligned anonymous mapping
+  explicit_pages,  // MAP_HUGETLB first, then as transparent
+};
+
+namespace detail {
+
+inline void* operator_new_aligned(std::size_t bytes, std::size_t alignment) {
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    return ::operator new(bytes, std::align_val_t{alignment});
+  }
+  return ::operator new(bytes);
+}
+
+inline void operator_delete_aligned(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    ::operator delete(p, bytes, std::align_val_t{alignment});
+  } else {
+    ::operator delete(p, bytes);
+  }
+}
+
+#if defined(__linux__) && defined(MAP_HUGETLB)
+#if defined(MAP_HUGE_2MB)
+inline constexpr int map_huge_2mb = MAP_HUGE_2MB;
+#else
+inline constexpr int map_huge_2mb = 21 << 26;  // MAP_HUGE_SHIFT == 26
+#endif
+#endif
+
+constexpr std::size_t round_up_to_huge_page(std::size_t bytes) noexcept {
+  return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+}
+
+}  // namespace detail
+
+// Allocates bytes with the given alignment as described above. Throws
+// std::bad_alloc if no memory is available at all.
+inline void* huge_page_allocate(std::size_t bytes,
+                                std::size_t alignment = alignof(std::max_align_t),
+                                huge_page_mode mode = huge_page_mode::transparent) {
+#if defined(__linux__)
+  if (bytes >= huge_page_size && alignment <= huge_page_size) {
+    const std::size_t length = detail::round_up_to_huge_page(bytes);
+#if defined(MAP_HUGETLB)
+    if (mode == huge_page_mode::explicit_pages) {
+      // Ask for 2 MiB pages explicitly: the pool default may be 1 GiB, which
+      // would not match the rounding above or the munmap length.
+      void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | detail::map_huge_2mb, -1, 0);
+      if (p != MAP_FAILED) return p;
+    }
+#endif
+    // Over-map by one huge page and trim so the region starts on a 2 MiB
+    // boundary; THP can only back fully aligned 2 MiB ranges.
+    void* raw = ::mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    auto* first = static_cast<char*>(raw);
+    auto* aligned = reinterpret_cast<char*>(
+        detail::round_up_to_huge_page(reinterpret_cast<std::uintptr_t>(first)));
+    if (aligned != first) ::munmap(first, static_cast<std::size_t>(aligned - first));
+    const std::size_t tail = static_cast<std::size_t>(first + huge_page_size - aligned);
+    if (tail != 0) ::munmap(aligned + length, tail);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(aligned, length, MADV_HUGEPAGE);  // best effort: fails if THP is off
+#endif
+    return aligned;
+  }
+#else
+  (void)mode;
+#endif
+  return detail::operator_new_aligned(bytes, alignment);
+}
+
+// Releases memory from huge_page_allocate; bytes and alignment must match
+// the allocation.
+inline void huge_page_deallocate(void* p, std::size_t bytes,
+                                 std::size_t alignment = alignof(std::max_align_t)) noexcept {
+#if defined(__linux__)
+  if (bytes >= huge_page_size && alignment <= huge_page_size) {
+    ::munmap(p, detail::round_up_to_huge_page(bytes));
+    return;
+  }
+#endif
+  detail::operator_delete_aligned(p, bytes, alignment);
+}
+
+template <class T, huge_page_mode Mode = huge_page_mode::transparent>
+class huge_page_allocator {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template <class U>
+  struct rebind {
+    using other = huge_page_allocator<U, Mode>;
+  };
+
+  constexpr huge_page_allocator() noexcept = default;
+  template <class U>
+  constexpr huge_page_allocator(const huge_page_allocator<U, Mode>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_type n) {
+    if (n > max_size()) throw std::bad_array_new_length();
+    return static_cast<T*>(huge_page_allocate(n * sizeof(T), alignof(T), Mode));
+  }
+
+  void deallocate(T* p, size_type n) noexcept {
+    huge_page_deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  static constexpr size_type max_size() noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const huge_page_allocator&,
+                                   const huge_page_allocator<U, Mode>&) noexcept {
+    return true;
+  }
+};
+
+namespace detail {
+
+// object_pool slabs of one huge page each.
+template <huge_page_mode Mode>
+struct huge_slab_source {
+  static constexpr std::size_t slab_size = huge_page_size;
+  static void* allocate(std::size_t bytes, std::size_t alignment) {
+    return huge_page_allocate(bytes, alignment, Mode);
+  }
+};
+
+}  // namespace detail
+
+// huge_page_allocator whose single-object allocations come from an
+// object_pool-style pool for sizeof(T) backed by huge-page slabs; arrays
+// take the huge_page_allocate path.
+template <class T, huge_page_mode Mode = huge_page_mode::transparent>
+class huge_node_allocator {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template <class U>
+  struct rebind {
+    using other = huge_node_allocator<U, Mode>;
+  };
+
+  constexpr huge_node_allocator() noexcept = default;
+  template <class U>
+  constexpr huge_node_allocator(const huge_node_allocator<U, Mode>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_type n) {
+    if (n == 1) return static_cast<T*>(pool::allocate());
+    return huge_page_allocator<T, Mode>().allocate(n);
+  }
+
+  void deallocate(T* p, size_type n) noexcept {
+    if (n == 1) {
+      pool::deallocate(p);
+    } else {
+      huge_page_allocator<T, Mode>().deallocate(p, n);
+    }
+  }
+
+  static constexpr size_type max_size() noexcept {
+    return huge_page_allocator<T, Mode>::max_size();
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const huge_node_allocator&,
+                                   const huge_node_allocator<U, Mode>&) noexcept {
+    return true;
+  }
+
+ private:
+  using pool = detail::fixed_size_pool<sizeof(T), alignof(T), detail::huge_slab_source<Mode>>;
+};
+
+template <class T, huge_page_mode Mode = huge_page_mode::transparent>
+using huge_vector = std::vector<T, huge_page_allocator<T, Mode>>;
+
+// Buckets land on huge pages once the table outgrows 2 MiB of them; nodes
+// come from the huge-page node arena from the first insert.
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>,
+          huge_page_mode Mode = huge_page_mode::transparent>
+using huge_unordered_map =
+    std::unordered_map<Key, T, Hash, KeyEqual, huge_node_allocator<std::pair<const Key, T>, Mode>>;
+
+}  // namespace mystl
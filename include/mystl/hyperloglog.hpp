@@ -0,0 +1,247 @@
+#pragma once
+
+// HyperLogLog distinct-value counter.
+//
+//   mystl::hyperloglog<std::uint64_t> users(14);   // 2^14 registers, ~0.8% error
+//   users.insert(user_id);
+//   double n = users.estimate();
+//   users.merge(other_shard);                       // union of the streams
+//
+// A sketch starts sparse: it keeps a sorted list of (25-bit index, rank)
+// pairs, which is exact-ish and tiny for small cardinalities (HLL++, Heule
+// et al.). Once the list would outgrow the registers it converts itself to
+// the dense form, 2^precision byte-sized registers. Bytes rather than packed
+// 6-bit registers keep updates to a single store and let merge() and the
+// register histogram compile to plain SIMD max and compare loops.
+//
+// Dense estimates use Ertl's improved estimator ("New cardinality estimation
+// algorithms for HyperLogLog sketches", 2017), which is unbiased over the
+// whole range without HLL++'s empirical bias tables. The standard error is
+// about 1.04 / sqrt(2^precision).
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Sparse entries: the top 25 hash bits, then the rank of the remaining 39
+// bits in the low six bits. Sorting entries groups them by index.
+inline constexpr unsigned hll_sparse_precision = 25;
+
+constexpr std::uint32_t hll_sparse_entry(std::uint64_t h) noexcept {
+  const auto index = static_cast<std::uint32_t>(h >> (64 - hll_sparse_precision));
+  const std::uint64_t rest =
+      (h << hll_sparse_precision) | (std::uint64_t{1} << (hll_sparse_precision - 1));
+  return index << 6 | static_cast<std::uint32_t>(std::countl_zero(rest) + 1);
+}
+
+// sigma and tau from Ertl's estimator.
+inline double hll_sigma(double x) noexcept {
+  if (x == 1.0) return std::numeric_limits<double>::infinity();
+  double y = 1.0, z = x, prev;
+  do {
+    x *= x;
+    prev = z;
+    z += x * y;
+    y += y;
+  } while (z != prev);
+  return z;
+}
+
+inline double hll_tau(double x) noexcept {
+  if (x == 0.0 || x == 1.0) return 0.0;
+  double y = 1.0, z = 1.0 - x, prev;
+  do {
+    x = std::sqrt(x);
+    prev = z;
+    y *= 0.5;
+    z -= (1.0 - x) * (1.0 - x) * y;
+  } while (z != prev);
+  return z / 3.0;
+}
+
+}  // namespace detail
+
+template <class Key, class Hash = seeded_hash<Key>>
+class hyperloglog {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  static constexpr unsigned min_precision = 4;
+  static constexpr unsigned max_precision = 18;
+
+  explicit hyperloglog(unsigned precision = 14, const Hash& hash = Hash())
+      : precision_(precision), hash_(hash) {
+    if (precision < min_precision || precision > max_precision) {
+      throw std::invalid_argument("hyperloglog: precision must be in [4, 18]");
+    }
+  }
+
+  void insert(const Key& key) { insert_hash(hash_(key)); }
+
+  void insert_hash(std::uint64_t h) {
+    if (dense()) {
+      const std::size_t index = h >> (64 - precision_);
+      const std::uint64_t rest = (h << precision_) | (std::uint64_t{1} << (precision_ - 1));
+      const auto rank = static_cast<std::uint8_t>(std::countl_zero(rest) + 1);
+      registers_[index] = std::max(registers_[index], rank);
+      return;
+    }
+    pending_.push_back(detail::hll_sparse_entry(h));
+    if (pending_.size() >= pending_limit()) flush_pending();
+  }
+
+  void insert_batch(std::span<const Key> keys) {
+    std::uint64_t hs[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      for (std::size_t i = 0; i < g; ++i) {
+        hs[i] = hash_(keys[base + i]);
+        if (dense()) MYSTL_PREFETCH_WRITE(&registers_[hs[i] >> (64 - precision_)]);
+      }
+      for (std::size_t i = 0; i < g; ++i) insert_hash(hs[i]);
+    }
+  }
+
+  double estimate() const {
+    if (!dense()) {
+      // Linear counting over the 2^25 sparse indices: nearly exact while
+      // the sketch is sparse.
+      const double m = static_cast<double>(std::uint64_t{1} << detail::hll_sparse_precision);
+      const double v = m - static_cast<double>(distinct_sparse_indices());
+      return m * std::log(m / v);
+    }
+    const unsigned q = 64 - precision_;
+    std::uint32_t histogram[66] = {};
+    for (std::uint8_t r : registers_) ++histogram[r];
+    const double m = static_cast<double>(registers_.size());
+    double z = m * detail::hll_tau(1.0 - histogram[q + 1] / m);
+    for (unsigned k = q; k >= 1; --k) z = 0.5 * (z + histogram[k]);
+    z += m * detail::hll_sigma(histogram[0] / m);
+    return m * m / (2.0 * std::log(2.0)) / z;
+  }
+
+  // Union with a sketch of the same precision.
+  void merge(const hyperloglog& other) {
+    if (other.precision_ != precision_) {
+      throw std::invalid_argument("hyperloglog::merge: precision mismatch");
+    }
+    if (&other == this) return;
+    if (!dense() && !other.dense()) {
+      pending_.insert(pending_.end(), other.sparse_.begin(), other.sparse_.end());
+      pending_.insert(pending_.end(), other.pending_.begin(), other.pending_.end());
+      flush_pending();
+      return;
+    }
+    make_dense();
+    if (other.dense()) {
+      for (std::size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+      }
+    } else {
+      for (std::uint32_t e : other.sparse_) insert_sparse_entry(e);
+      for (std::uint32_t e : other.pending_) insert_sparse_entry(e);
+    }
+  }
+
+  void clear() noexcept {
+    registers_.clear();
+    registers_.shrink_to_fit();
+    sparse_.clear();
+    pending_.clear();
+  }
+
+  unsigned precision() const noexcept { return precision_; }
+  bool dense() const noexcept { return !registers_.empty(); }
+  std::size_t memory_usage() const noexcept {
+    return registers_.capacity() +
+           (sparse_.capacity() + pending_.capacity()) * sizeof(std::uint32_t);
+  }
+
+ private:
+  std::size_t register_count() const noexcept { return std::size_t{1} << precision_; }
+
+  // The sparse form gives way once it would take more memory than the
+  // registers; new entries are batched so that the sorted list is rebuilt
+  // in bulk rather than on every insertion.
+  std::size_t sparse_limit() const noexcept { return register_count() / sizeof(std::uint32_t); }
+  std::size_t pending_limit() const noexcept {
+    return std::max<std::size_t>(16, sparse_limit() / 8);
+  }
+
+  // Sorts pending entries into the sparse list, keeping the highest rank
+  // per index, and goes dense if the list grew too long.
+  void flush_pending() {
+    std::sort(pending_.begin(), pending_.end());
+    std::vector<std::uint32_t> merged;
+    merged.reserve(sparse_.size() + pending_.size());
+    std::merge(sparse_.begin(), sparse_.end(), pending_.begin(), pending_.end(),
+               std::back_inserter(merged));
+    // Equal indices are adjacent and ordered by rank: keep the last.
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < merged.size(); ++i) {
+      if (i + 1 < merged.size() && merged[i] >> 6 == merged[i + 1] >> 6) continue;
+      merged[out++] = merged[i];
+    }
+    merged.resize(out);
+    sparse_.swap(merged);
+    pending_.clear();
+    if (sparse_.size() > sparse_limit()) make_dense();
+  }
+
+  std::size_t distinct_sparse_indices() const {
+    if (pending_.empty()) return sparse_.size();
+    std::vector<std::uint32_t> indices;
+    indices.reserve(sparse_.size() + pending_.size());
+    for (std::uint32_t e : sparse_) indices.push_back(e >> 6);
+    for (std::uint32_t e : pending_) indices.push_back(e >> 6);
+    std::sort(indices.begin(), indices.end());
+    return static_cast<std::size_t>(std::unique(indices.begin(), indices.end()) - indices.begin());
+  }
+
+  void make_dense() {
+    if (dense()) return;
+    registers_.assign(register_count(), 0);
+    for (std::uint32_t e : sparse_) insert_sparse_entry(e);
+    for (std::uint32_t e : pending_) insert_sparse_entry(e);
+    sparse_ = {};
+    pending_ = {};
+  }
+
+  // Reconstructs the dense register update from a sparse entry: the bits
+  // after the dense index are the rest of the 25-bit index, then the bits
+  // the entry's rank was taken from.
+  void insert_sparse_entry(std::uint32_t e) noexcept {
+    constexpr unsigned sp = detail::hll_sparse_precision;
+    const std::uint32_t index25 = e >> 6;
+    const unsigned tail_bits = sp - precision_;
+    const std::uint32_t tail = index25 & ((std::uint32_t{1} << tail_bits) - 1);
+    const auto rank = static_cast<std::uint8_t>(
+        tail != 0 ? tail_bits - static_cast<unsigned>(std::bit_width(tail)) + 1
+                  : tail_bits + (e & 63));
+    const std::size_t index = index25 >> tail_bits;
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  unsigned precision_;
+  std::vector<std::uint8_t> registers_;  // empty while sparse
+  std::vector<std::uint32_t> sparse_;    // sorted, one entry per index
+  std::vector<std::uint32_t> pending_;   // unsorted recent insertions
+  [[no_unique_address]] Hash hash_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,390 @@
+#pragma once
+
+// Dynamically-resizable vector with fixed capacity and inline storage,
+// modelled after C++26 std::inplace_vector. Never allocates.
+//
+// For trivial T the storage is a plain T[N] and every member is usable in
+// constant expressions. The array is left uninitialised at run time, so an
+// empty vector costs nothing to create; during constant evaluation it is
+// value-initialised so that instances can be constexpr variables. For other T
+// the storage is raw bytes and elements are constructed in place.
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+template <class T, std::size_t N>
+inline constexpr int inplace_storage_kind = N == 0 ? 0 : std::is_trivial_v<T> ? 1 : 2;
+
+template <class T, std::size_t N, int Kind = inplace_storage_kind<T, N>>
+struct inplace_storage;
+
+template <class T, std::size_t N>
+struct inplace_storage<T, N, 0> {
+  constexpr T* data() noexcept { return nullptr; }
+  constexpr const T* data() const noexcept { return nullptr; }
+};
+
+template <class T, std::size_t N>
+struct inplace_storage<T, N, 1> {
+  constexpr inplace_storage() noexcept {
+    if (std::is_constant_evaluated()) std::fill_n(elems_, N, T());
+  }
+
+  T elems_[N];
+
+  constexpr T* data() noexcept { return elems_; }
+  constexpr const T* data() const noexcept { return elems_; }
+};
+
+template <class T, std::size_t N>
+struct inplace_storage<T, N, 2> {
+  alignas(T) unsigned char bytes_[N * sizeof(T)];
+
+  T* data() noexcept { return std::launder(reinterpret_cast<T*>(bytes_)); }
+  const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(bytes_)); }
+};
+
+[[noreturn]] inline void throw_capacity_exceeded() { throw std::bad_alloc(); }
+
+}  // namespace detail
+
+template <class T, std::size_t N>
+class inplace_vector {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // --- construction -------------------------------------------------------
+
+  constexpr inplace_vector() noexcept = default;
+
+  // These delegate to the default constructor so that, if an element
+  // constructor throws, the destructor destroys the elements built so far.
+  constexpr explicit inplace_vector(size_type n) : inplace_vector() {
+    check_capacity(n);
+    for (; size_ < n; ++size_) std::construct_at(data() + size_);
+  }
+
+  constexpr inplace_vector(size_type n, const T& value) : inplace_vector() { assign(n, value); }
+
+  template <std::input_iterator InputIt>
+  constexpr inplace_vector(InputIt first, InputIt last) : inplace_vector() {
+    assign(first, last);
+  }
+
+  constexpr inplace_vector(std::initializer_list<T> il) : inplace_vector() {
+    assign(il.begin(), il.end());
+  }
+
+  constexpr inplace_vector(const inplace_vector&)
+    requires std::is_trivially_copyable_v<T>
+  = default;
+
+  constexpr inplace_vector(const inplace_vector& other) noexcept(
+      std::is_nothrow_copy_constructible_v<T>)
+    requires(!std::is_trivially_copyable_v<T> && std::is_copy_constructible_v<T>)
+  {
+    std::uninitialized_copy(other.begin(), other.end(), data());
+    size_ = other.size_;
+  }
+
+  constexpr inplace_vector(inplace_vector&&)
+    requires std::is_trivially_copyable_v<T>
+  = default;
+
+  constexpr inplace_vector(inplace_vector&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T>)
+    requires(!std::is_trivially_copyable_v<T> && std::is_move_constructible_v<T>)
+  {
+    std::uninitialized_move(other.begin(), other.end(), data());
+    size_ = other.size_;
+  }
+
+  constexpr inplace_vector& operator=(const inplace_vector&)
+    requires std::is_trivially_copyable_v<T>
+  = default;
+
+  constexpr inplace_vector& operator=(const inplace_vector& other)
+    requires(!std::is_trivially_copyable_v<T> && std::is_copy_constructible_v<T>)
+  {
+    if (this != &other) assign(other.begin(), other.end());
+    return *this;
+  }
+
+  constexpr inplace_vector& operator=(inplace_vector&&)
+    requires std::is_trivially_copyable_v<T>
+  = default;
+
+  constexpr inplace_vector& operator=(inplace_vector&& other) noexcept(
+      std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>)
+    requires(!std::is_trivially_copyable_v<T> && std::is_move_constructible_v<T>)
+  {
+    if (this != &other) {
+      const size_type common = std::min(size_, other.size_);
+      std::move(other.begin(), other.begin() + common, begin());
+      if (other.size_ > size_) {
+        std::uninitialized_move(other.begin() + common, other.end(), end());
+      } else {
+        std::destroy(begin() + common, end());
+      }
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  constexpr inplace_vector& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+
+  constexpr ~inplace_vector()
+    requires std::is_trivially_destructible_v<T>
+  = default;
+
+  constexpr ~inplace_vector() { std::destroy(begin(), end()); }
+
+  constexpr void assign(size_type n, const T& value) {
+    check_capacity(n);
+    clear();
+    for (; size_ < n; ++size_) std::construct_at(data() + size_, value);
+  }
+
+  template <std::input_iterator InputIt>
+  constexpr void assign(InputIt first, InputIt last) {
+    clear();
+    for (; first != last; ++first) emplace_back(*first);
+  }
+
+  constexpr void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  // --- element access -----------------------------------------------------
+
+  constexpr reference at(size_type i) {
+    if (i >= size_) throw std::out_of_range("inplace_vector::at");
+    return data()[i];
+  }
+  constexpr const_reference at(size_type i) const {
+    if (i >= size_) throw std::out_of_range("inplace_vector::at");
+    return data()[i];
+  }
+
+  constexpr reference operator[](size_type i) noexcept { return data()[i]; }
+  constexpr const_reference operator[](size_type i) const noexcept { return data()[i]; }
+
+  constexpr reference front() noexcept { return data()[0]; }
+  constexpr const_reference front() const noexcept { return data()[0]; }
+  constexpr reference back() noexcept { return data()[size_ - 1]; }
+  constexpr const_reference back() const noexcept { return data()[size_ - 1]; }
+
+  constexpr T* data() noexcept { return storage_.data(); }
+  constexpr const T* data() const noexcept { return storage_.data(); }
+
+  // --- iterators ----------------------------------------------------------
+
+  constexpr iterator begin() noexcept { return data(); }
+  constexpr const_iterator begin() const noexcept { return data(); }
+  constexpr const_iterator cbegin() const noexcept { return data(); }
+  constexpr iterator end() noexcept { return data() + size_; }
+  constexpr const_iterator end() const noexcept { return data() + size_; }
+  constexpr const_iterator cend() const noexcept { return data() + size_; }
+
+  constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  constexpr const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // --- capacity -----------------------------------------------------------
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+  constexpr size_type size() const noexcept { return size_; }
+  static constexpr size_type max_size() noexcept { return N; }
+  static constexpr size_type capacity() noexcept { return N; }
+
+  constexpr void resize(size_type n) {
+    check_capacity(n);
+    if (n < size_) {
+      std::destroy(begin() + n, end());
+      size_ = n;
+    }
+    for (; size_ < n; ++size_) std::construct_at(data() + size_);
+  }
+
+  constexpr void resize(size_type n, const T& value) {
+    check_capacity(n);
+    if (n < size_) {
+      std::destroy(begin() + n, end());
+      size_ = n;
+    }
+    for (; size_ < n; ++size_) std::construct_at(data() + size_, value);
+  }
+
+  static constexpr void reserve(size_type n) { check_capacity(n); }
+  static constexpr void shrink_to_fit() noexcept {}
+
+  // --- modifiers ----------------------------------------------------------
+
+  // Throws std::bad_alloc when the vector is full.
+  template <class... Args>
+  constexpr reference emplace_back(Args&&... args) {
+    if (size_ == N) detail::throw_capacity_exceeded();
+    return unchecked_emplace_back(std::forward<Args>(args)...);
+  }
+  constexpr reference push_back(const T& value) { return emplace_back(value); }
+  constexpr reference push_back(T&& value) { return emplace_back(std::move(value)); }
+
+  // Return nullptr instead of throwing when the vector is full.
+  template <class... Args>
+  constexpr pointer try_emplace_back(Args&&... args) {
+    if (size_ == N) return nullptr;
+    return std::addressof(unchecked_emplace_back(std::forward<Args>(args)...));
+  }
+  constexpr pointer try_push_back(const T& value) { return try_emplace_back(value); }
+  constexpr pointer try_push_back(T&& value) { return try_emplace_back(std::move(value)); }
+
+  // Precondition: size() < capacity().
+  template <class... Args>
+  constexpr reference unchecked_emplace_back(Args&&... args) {
+    T* p = std::construct_at(data() + size_, std::forward<Args>(args)...);
+    ++size_;
+    return *p;
+  }
+  constexpr reference unchecked_push_back(const T& value) { return unchecked_emplace_back(value); }
+  constexpr reference unchecked_push_back(T&& value) {
+    return unchecked_emplace_back(std::move(value));
+  }
+
+  constexpr void pop_back() noexcept {
+    --size_;
+    std::destroy_at(data() + size_);
+  }
+
+  template <class... Args>
+  constexpr iterator emplace(const_iterator pos, Args&&... args) {
+    const auto i = static_cast<size_type>(pos - begin());
+    emplace_back(std::forward<Args>(args)...);
+    std::rotate(begin() + i, end() - 1, end());
+    return begin() + i;
+  }
+
+  constexpr iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+  constexpr iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  constexpr iterator insert(const_iterator pos, size_type n, const T& value) {
+    const auto i = static_cast<size_type>(pos - begin());
+    check_capacity(size_ + n);
+    const size_type old = size_;
+    for (size_type k = 0; k < n; ++k) unchecked_emplace_back(value);
+    std::rotate(begin() + i, begin() + old, end());
+    return begin() + i;
+  }
+
+  template <std::input_iterator InputIt>
+  constexpr iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    const auto i = static_cast<size_type>(pos - begin());
+    const size_type old = size_;
+    for (; first != last; ++first) emplace_back(*first);
+    std::rotate(begin() + i, begin() + old, end());
+    return begin() + i;
+  }
+
+  constexpr iterator insert(const_iterator pos, std::initializer_list<T> il) {
+    return insert(pos, il.begin(), il.end());
+  }
+
+  constexpr iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  constexpr iterator erase(const_iterator first, const_iterator last) {
+    const auto i = static_cast<size_type>(first - begin());
+    const auto j = static_cast<size_type>(last - begin());
+    if (i != j) {
+      iterator new_end = std::move(begin() + j, end(), begin() + i);
+      std::destroy(new_end, end());
+      size_ -= j - i;
+    }
+    return begin() + i;
+  }
+
+  constexpr void clear() noexcept {
+    std::destroy(begin(), end());
+    size_ = 0;
+  }
+
+  constexpr void swap(inplace_vector& other) noexcept(std::is_nothrow_swappable_v<T> &&
+                                                      std::is_nothrow_move_constructible_v<T>) {
+    inplace_vector& shorter = size_ < other.size_ ? *this : other;
+    inplace_vector& longer = size_ < other.size_ ? other : *this;
+    std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+    const size_type common = shorter.size_;
+    std::uninitialized_move(longer.begin() + common, longer.end(), shorter.end());
+    std::destroy(longer.begin() + common, longer.end());
+    shorter.size_ = longer.size_;
+    longer.size_ = common;
+  }
+
+  friend constexpr void swap(inplace_vector& a, inplace_vector& b) noexcept(noexcept(a.swap(b))) {
+    a.swap(b);
+  }
+
+  friend constexpr bool operator==(const inplace_vector& a, const inplace_vector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+  friend constexpr auto operator<=>(const inplace_vector& a, const inplace_vector& b)
+    requires std::three_way_comparable<T>
+  {
+    return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+ private:
+  static constexpr void check_capacity(size_type n) {
+    if (n > N) detail::throw_capacity_exceeded();
+  }
+
+  [[no_unique_address]] detail::inplace_storage<T, N> storage_;
+  size_type size_ = 0;
+};
+
+template <class T, std::size_t N, class U = T>
+constexpr typename inplace_vector<T, N>::size_type erase(inplace_vector<T, N>& v, const U& value) {
+  auto it = std::remove(v.begin(), v.end(), value);
+  const auto n = static_cast<std::size_t>(v.end() - it);
+  v.erase(it, v.end());
+  return n;
+}
+
+template <class T, std::size_t N, class Pred>
+constexpr typename inplace_vector<T, N>::size_type erase_if(inplace_vector<T, N>& v, Pred pred) {
+  auto it = std::remove_if(v.begin(), v.end(), pred);
+  const auto n = static_cast<std::size_t>(v.end() - it);
+  v.erase(it, v.end());
+  return n;
+}
+
+}  // namespace mystl
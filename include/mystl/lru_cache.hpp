@@ -0,0 +1,699 @@
+#pragma once
+
+// Bounded key-value caches with O(1) lookup, insertion and eviction.
+//
+//   mystl::lru_cache<std::string, profile> cache(10'000);
+//   if (profile* p = cache.find(user)) return *p;      // promotes to MRU
+//   cache.insert_or_assign(user, load_profile(user));  // evicts the LRU entry
+//
+//   mystl::concurrent_tinylfu_cache<std::uint64_t, blob> shared(1'000'000);
+//   if (auto b = shared.find(id)) use(*b);               // copy taken under the shard lock
+//
+//  - lru_cache: least-recently-used eviction.
+//  - tinylfu_cache: W-TinyLFU (Einziger, Friedman and Manes; Caffeine). A
+//    small LRU window admits new entries; an entry leaving the window only
+//    displaces the main region's eviction candidate if a frequency sketch
+//    has seen it more often. The main region is a segmented LRU, so entries
+//    hit twice are protected from scans. Hit ratios are close to optimal on
+//    skewed workloads and degrade gracefully under one-off scans that wipe
+//    out a plain LRU.
+//  - sharded_cache<Cache>: one of the above per shard, each behind its own
+//    adaptive_mutex; concurrent_lru_cache and concurrent_tinylfu_cache name
+//    the common cases.
+//
+// Every entry lives in a node array allocated once at construction, linked
+// into its recency list by 32-bit indices. The index is open addressing
+// with linear probing and backward-shift deletion, as in
+// static_unordered_map; each slot keeps 32 hash bits next to the node
+// index, so a miss rarely touches a node. Inserting or evicting never
+// allocates beyond what the key and value themselves do.
+//
+// All caches count hits, misses and evictions; find() counts, peek() and
+// contains() do not.
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "hash.hpp"
+#include "synchronization.hpp"
+
+namespace mystl {
+
+struct cache_stats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+
+  double hit_ratio() const noexcept {
+    const std::uint64_t lookups = hits + misses;
+    return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+  }
+
+  cache_stats& operator+=(const cache_stats& other) noexcept {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    return *this;
+  }
+};
+
+namespace detail {
+
+// Table size for a cache of capacity entries: one more, checked before the
+// addition can wrap.
+inline std::size_t cache_nodes(std::size_t capacity) {
+  if (capacity == 0) throw std::invalid_argument("cache: capacity must be positive");
+  if (capacity >= UINT32_MAX) throw std::length_error("cache: capacity too large");
+  return capacity + 1;
+}
+
+// Nodes, recency lists and hash index shared by the caches. Node indices
+// [0, capacity) hold entries; the next Lists indices are the sentinels of
+// circular doubly linked lists, front = most recently used.
+template <class Key, class T, class Hash, class KeyEqual, unsigned Lists>
+class cache_table {
+ public:
+  using value_type = std::pair<const Key, T>;
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  cache_table(std::size_t capacity, const Hash& hash, const KeyEqual& eq) : hash_(hash), eq_(eq) {
+    if (capacity == 0) throw std::invalid_argument("cache: capacity must be positive");
+    // Node indices, sentinels included, stay below npos.
+    if (capacity > UINT32_MAX - Lists - 1) throw std::length_error("cache: capacity too large");
+    capacity_ = static_cast<std::uint32_t>(capacity);
+    nodes_ = std::make_unique<node[]>(capacity + Lists);
+    for (std::uint32_t l = 0; l < Lists; ++l) {
+      node& s = nodes_[sentinel(l)];
+      s.prev = s.next = sentinel(l);
+    }
+    for (std::uint32_t i = 0; i < capacity_; ++i) nodes_[i].next = i + 1 < capacity_ ? i + 1 : npos;
+    free_ = 0;
+    const std::size_t slots = std::bit_ceil(capacity + (capacity + 3) / 4 + 1);
+    mask_ = slots - 1;
+    slots_.assign(slots, slot{npos, 0});
+  }
+
+  cache_table(cache_table&& other) noexcept
+      : nodes_(std::move(other.nodes_)),
+        slots_(std::move(other.slots_)),
+        mask_(other.mask_),
+        capacity_(std::exchange(other.capacity_, 0)),
+        size_(std::exchange(other.size_, 0)),
+        free_(std::exchange(other.free_, npos)),
+        hash_(other.hash_),
+        eq_(other.eq_) {
+    std::copy(other.counts_, other.counts_ + Lists, counts_);
+  }
+
+  cache_table& operator=(cache_table&& other) noexcept {
+    if (this != &other) {
+      destroy_all();
+      nodes_ = std::move(other.nodes_);
+      slots_ = std::move(other.slots_);
+      mask_ = other.mask_;
+      capacity_ = std::exchange(other.capacity_, 0);
+      size_ = std::exchange(other.size_, 0);
+      free_ = std::exchange(other.free_, npos);
+      std::copy(other.counts_, other.counts_ + Lists, counts_);
+      hash_ = other.hash_;
+      eq_ = other.eq_;
+    }
+    return *this;
+  }
+
+  ~cache_table() { destroy_all(); }
+
+  std::uint64_t hash(const Key& key) const { return mix64(static_cast<std::uint64_t>(hash_(key))); }
+
+  std::uint32_t lookup(const Key& key, std::uint64_t h) const {
+    const std::uint32_t t = tag(h);
+    for (std::size_t i = h & mask_; slots_[i].node != npos; i = (i + 1) & mask_) {
+      if (slots_[i].tag == t && eq_(nodes_[slots_[i].node].kv.first, key)) return slots_[i].node;
+    }
+    return npos;
+  }
+
+  // Stores a new entry at the front of list l. Requires a free node and
+  // that key is absent.
+  template <class K, class... Args>
+  std::uint32_t emplace(unsigned l, std::uint64_t h, K&& key, Args&&... args) {
+    const std::uint32_t n = free_;
+    std::construct_at(std::addressof(nodes_[n].kv), std::piecewise_construct,
+                      std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    free_ = nodes_[n].next;
+    nodes_[n].hash = h;
+    std::size_t i = h & mask_;
+    while (slots_[i].node != npos) i = (i + 1) & mask_;
+    slots_[i] = slot{n, tag(h)};
+    link_front(l, n);
+    ++size_;
+    return n;
+  }
+
+  void erase(std::uint32_t n) noexcept {
+    std::size_t hole = nodes_[n].hash & mask_;
+    while (slots_[hole].node != n) hole = (hole + 1) & mask_;
+    for (std::size_t j = (hole + 1) & mask_; slots_[j].node != npos; j = (j + 1) & mask_) {
+      const std::size_t home = nodes_[slots_[j].node].hash & mask_;
+      const bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+      if (stays) continue;
+      slots_[hole] = slots_[j];
+      hole = j;
+    }
+    slots_[hole] = slot{npos, 0};
+    unlink(n);
+    std::destroy_at(std::addressof(nodes_[n].kv));
+    nodes_[n].next = free_;
+    free_ = n;
+    --size_;
+  }
+
+  void move_to_front(unsigned l, std::uint32_t n) noexcept {
+    unlink(n);
+    link_front(l, n);
+  }
+
+  // Least recently used entry of list l, or npos.
+  std::uint32_t back(unsigned l) const noexcept {
+    const std::uint32_t b = nodes_[sentinel(l)].prev;
+    return b == sentinel(l) ? npos : b;
+  }
+
+  // Most recently used entry of list l and its successors, or npos.
+  std::uint32_t front(unsigned l) const noexcept {
+    const std::uint32_t f = nodes_[sentinel(l)].next;
+    return f == sentinel(l) ? npos : f;
+  }
+  std::uint32_t next(std::uint32_t n) const noexcept {
+    const std::uint32_t x = nodes_[n].next;
+    return x >= capacity_ ? npos : x;
+  }
+
+  void clear() noexcept {
+    for (unsigned l = 0; l < Lists; ++l) {
+      for (std::uint32_t n = back(l); n != npos; n = back(l)) erase(n);
+    }
+  }
+
+  value_type& value(std::uint32_t n) noexcept { return nodes_[n].kv; }
+  const value_type& value(std::uint32_t n) const noexcept { return nodes_[n].kv; }
+  unsigned list_of(std::uint32_t n) const noexcept { return nodes_[n].list; }
+  std::uint64_t hash_of(std::uint32_t n) const noexcept { return nodes_[n].hash; }
+  std::size_t count(unsigned l) const noexcept { return counts_[l]; }
+
+  std::size_t size() const noexcept { return size_; }
+  const Hash& hash_function() const noexcept { return hash_; }
+  const KeyEqual& key_eq() const noexcept { return eq_; }
+
+ private:
+  struct node {
+    union {
+      value_type kv;
+    };
+    std::uint64_t hash = 0;
+    std::uint32_t prev = npos;
+    std::uint32_t next = npos;  // free-list link while unused
+    std::uint8_t list = 0;
+
+    node() noexcept {}
+    ~node() {}
+  };
+
+  // Index slot: node index (npos if empty) and the high half of the hash,
+  // which the slot position does not already imply. Both in one word, so
+  // a probe costs one cache miss before the node is touched.
+  struct slot {
+    std::uint32_t node;
+    std::uint32_t tag;
+  };
+
+  static std::uint32_t tag(std::uint64_t h) noexcept { return static_cast<std::uint32_t>(h >> 32); }
+
+  std::uint32_t sentinel(unsigned l) const noexcept { return capacity_ + l; }
+
+  void link_front(unsigned l, std::uint32_t n) noexcept {
+    node& s = nodes_[sentinel(l)];
+    node& x = nodes_[n];
+    x.prev = sentinel(l);
+    x.next = s.next;
+    nodes_[s.next].prev = n;
+    s.next = n;
+    x.list = static_cast<std::uint8_t>(l);
+    ++counts_[l];
+  }
+
+  void unlink(std::uint32_t n) noexcept {
+    node& x = nodes_[n];
+    nodes_[x.prev].next = x.next;
+    nodes_[x.next].prev = x.prev;
+    --counts_[x.list];
+  }
+
+  void destroy_all() noexcept {
+    if (nodes_) clear();
+  }
+
+  std::unique_ptr<node[]> nodes_;
+  std::vector<slot> slots_;
+  std::size_t mask_ = 0;
+  std::uint32_t capacity_ = 0;
+  std::size_t size_ = 0;
+  std::uint32_t free_ = npos;
+  std::size_t counts_[Lists] = {};
+  [[no_unique_address]] Hash hash_{};
+  [[no_unique_address]] KeyEqual eq_{};
+};
+
+// TinyLFU's popularity estimate: a count-min sketch of 4-bit counters,
+// sixteen to a word, halved whenever the number of increments reaches ten
+// times the cache capacity so that old popularity fades.
+class frequency_sketch {
+ public:
+  explicit frequency_sketch(std::size_t capacity)
+      : words_(std::bit_ceil(std::max<std::size_t>(capacity, 16) / 4)),
+        sample_size_(10 * std::max<std::size_t>(capacity, 16)) {}
+
+  unsigned estimate(std::uint64_t h) const noexcept {
+    unsigned low = 15;
+    for (unsigned r = 0; r < rows; ++r) low = std::min(low, get(counter(h, r)));
+    return low;
+  }
+
+  void increment(std::uint64_t h) noexcept {
+    const unsigned low = estimate(h);
+    if (low < 15) {
+      for (unsigned r = 0; r < rows; ++r) {
+        const std::size_t c = counter(h, r);
+        if (get(c) == low) words_[c >> 4] += std::uint64_t{1} << ((c & 15) * 4);
+      }
+    }
+    if (++additions_ == sample_size_) halve();
+  }
+
+ private:
+  static constexpr unsigned rows = 4;
+
+  std::size_t counter(std::uint64_t h, unsigned r) const noexcept {
+    return static_cast<std::size_t>((h + r * (mix64(h) | 1)) & (words_.size() * 16 - 1));
+  }
+
+  unsigned get(std::size_t c) const noexcept {
+    return static_cast<unsigned>(words_[c >> 4] >> ((c & 15) * 4)) & 15;
+  }
+
+  void halve() noexcept {
+    for (std::uint64_t& w : words_) w = (w >> 1) & 0x7777777777777777ull;
+    additions_ /= 2;
+  }
+
+  std::vector<std::uint64_t> words_;
+  std::size_t sample_size_;
+  std::size_t additions_ = 0;
+};
+
+}  // namespace detail
+
+// ---------------------------------------------------------------------------
+// lru_cache
+// ---------------------------------------------------------------------------
+
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class lru_cache {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  // One spare node holds a new entry until the old one is evicted.
+  explicit lru_cache(std::size_t capacity, const Hash& hash = Hash(),
+                     const KeyEqual& eq = KeyEqual())
+      : table_(detail::cache_nodes(capacity), hash, eq), capacity_(capacity) {}
+
+  // The cached value, promoted to most recently used; nullptr on a miss.
+  T* find(const Key& key) {
+    const std::uint32_t n = table_.lookup(key, table_.hash(key));
+    if (n == table::npos) {
+      ++stats_.misses;
+      return nullptr;
+    }
+    ++stats_.hits;
+    table_.move_to_front(0, n);
+    return &table_.value(n).second;
+  }
+
+  // Looks without promoting or counting.
+  const T* peek(const Key& key) const {
+    const std::uint32_t n = table_.lookup(key, table_.hash(key));
+    return n == table::npos ? nullptr : &table_.value(n).second;
+  }
+  bool contains(const Key& key) const { return peek(key) != nullptr; }
+
+  // Inserts key if absent, evicting the least recently used entry when
+  // full. Either way the entry becomes most recently used. The new entry
+  // is constructed before anything is evicted, so if that throws the cache
+  // is unchanged.
+  template <class K, class... Args>
+    requires std::constructible_from<Key, K&&>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args) {
+    const std::uint64_t h = table_.hash(key);
+    std::uint32_t n = table_.lookup(key, h);
+    if (n != table::npos) {
+      table_.move_to_front(0, n);
+      return {&table_.value(n).second, false};
+    }
+    n = table_.emplace(0, h, std::forward<K>(key), std::forward<Args>(args)...);
+    if (table_.size() > capacity_) {
+      table_.erase(table_.back(0));
+      ++stats_.evictions;
+    }
+    return {&table_.value(n).second, true};
+  }
+
+  template <class K, class M>
+    requires std::constructible_from<Key, K&&>
+  T& insert_or_assign(K&& key, M&& value) {
+    auto [p, inserted] = try_emplace(std::forward<K>(key), std::forward<M>(value));
+    if (!inserted) *p = std::forward<M>(value);
+    return *p;
+  }
+
+  bool erase(const Key& key) {
+    const std::uint32_t n = table_.lookup(key, table_.hash(key));
+    if (n == table::npos) return false;
+    table_.erase(n);
+    return true;
+  }
+
+  void clear() noexcept { table_.clear(); }
+
+  // Calls f(key, value) from most to least recently used.
+  template <class F>
+  void for_each(F&& f) const {
+    for (std::uint32_t n = table_.front(0); n != table::npos; n = table_.next(n)) {
+      f(table_.value(n).first, table_.value(n).second);
+    }
+  }
+
+  std::size_t size() const noexcept { return table_.size(); }
+  bool empty() const noexcept { return table_.size() == 0; }
+  std::size_t capacity() const noexcept { return capacity_; }
+  const cache_stats& stats() const noexcept { return stats_; }
+  void reset_stats() noexcept { stats_ = {}; }
+
+ private:
+  using table = detail::cache_table<Key, T, Hash, KeyEqual, 1>;
+
+  table table_;
+  std::size_t capacity_;
+  cache_stats stats_;
+};
+
+// ---------------------------------------------------------------------------
+// tinylfu_cache
+// ---------------------------------------------------------------------------
+
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class tinylfu_cache {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  // The window takes 1% of the capacity, the protected segment 80% of the
+  // rest. One spare node holds a new entry while admission is decided.
+  explicit tinylfu_cache(std::size_t capacity, const Hash& hash = Hash(),
+                         const KeyEqual& eq = KeyEqual())
+      : table_(detail::cache_nodes(capacity), hash, eq),
+        sketch_(capacity),
+        capacity_(capacity),
+        window_capacity_(std::max<std::size_t>(1, capacity / 100)),
+        protected_capacity_((capacity - std::min(capacity, window_capacity_)) * 4 / 5) {}
+
+  T* find(const Key& key) {
+    const std::uint64_t h = table_.hash(key);
+    sketch_.increment(h);
+    const std::uint32_t n = table_.lookup(key, h);
+    if (n == table::npos) {
+      ++stats_.misses;
+      return nullptr;
+    }
+    ++stats_.hits;
+    touch(n);
+    return &table_.value(n).second;
+  }
+
+  const T* peek(const Key& key) const {
+    const std::uint32_t n = table_.lookup(key, table_.hash(key));
+    return n == table::npos ? nullptr : &table_.value(n).second;
+  }
+  bool contains(const Key& key) const { return peek(key) != nullptr; }
+
+  // A new entry enters the window and is always stored; what it displaces
+  // may be itself, later, if the sketch deems it less popular than the
+  // main region's victim. The returned pointer is valid until the next
+  // modification. Counts as an access in the sketch, as find() does.
+  template <class K, class... Args>
+    requires std::constructible_from<Key, K&&>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args) {
+    const std::uint64_t h = table_.hash(key);
+    sketch_.increment(h);
+    std::uint32_t n = table_.lookup(key, h);
+    if (n != table::npos) {
+      touch(n);
+      return {&table_.value(n).second, false};
+    }
+    n = table_.emplace(window, h, std::forward<K>(key), std::forward<Args>(args)...);
+    if (table_.count(window) > window_capacity_) {
+      table_.move_to_front(probation, table_.back(window));
+    }
+    if (table_.size() > capacity_) evict();
+    return {&table_.value(n).second, true};
+  }
+
+  template <class K, class M>
+    requires std::constructible_from<Key, K&&>
+  T& insert_or_assign(K&& key, M&& value) {
+    auto [p, inserted] = try_emplace(std::forward<K>(key), std::forward<M>(value));
+    if (!inserted) *p = std::forward<M>(value);
+    return *p;
+  }
+
+  bool erase(const Key& key) {
+    const std::uint32_t n = table_.lookup(key, table_.hash(key));
+    if (n == table::npos) return false;
+    table_.erase(n);
+    return true;
+  }
+
+  void clear() noexcept { table_.clear(); }
+
+  // Calls f(key, value) for every entry: window, then protected, then
+  // probation, each from most to least recently used.
+  template <class F>
+  void for_each(F&& f) const {
+    for (unsigned l : {window, protected_segment, probation}) {
+      for (std::uint32_t n = table_.front(l); n != table::npos; n = table_.next(n)) {
+        f(table_.value(n).first, table_.value(n).second);
+      }
+    }
+  }
+
+  std::size_t size() const noexcept { return table_.size(); }
+  bool empty() const noexcept { return table_.size() == 0; }
+  std::size_t capacity() const noexcept { return capacity_; }
+  const cache_stats& stats() const noexcept { return stats_; }
+  void reset_stats() noexcept { stats_ = {}; }
+
+ private:
+  using table = detail::cache_table<Key, T, Hash, KeyEqual, 3>;
+
+  static constexpr unsigned window = 0;
+  static constexpr unsigned probation = 1;
+  static constexpr unsigned protected_segment = 2;
+
+  // A hit in probation earns protection; protected overflow goes back to
+  // probation rather than out of the cache.
+  void touch(std::uint32_t n) noexcept {
+    const unsigned l = table_.list_of(n);
+    if (l != probation) {
+      table_.move_to_front(l, n);
+      return;
+    }
+    table_.move_to_front(protected_segment, n);
+    if (table_.count(protected_segment) > protected_capacity_) {
+      table_.move_to_front(probation, table_.back(protected_segment));
+    }
+  }
+
+  // The entry just moved out of the window (front of probation) competes
+  // with probation's LRU entry; the less frequent one leaves.
+  void evict() noexcept {
+    std::uint32_t victim = table_.back(probation);
+    if (victim == table::npos) victim = table_.back(protected_segment);
+    if (victim == table::npos) victim = table_.back(window);
+    const std::uint32_t candidate = table_.front(probation);
+    if (candidate != table::npos && candidate != victim &&
+        sketch_.estimate(table_.hash_of(candidate)) <= sketch_.estimate(table_.hash_of(victim))) {
+      victim = candidate;
+    }
+    table_.erase(victim);
+    ++stats_.evictions;
+  }
+
+  table table_;
+  detail::frequency_sketch sketch_;
+  std::size_t capacity_;
+  std::size_t window_capacity_;
+  std::size_t protected_capacity_;
+  cache_stats stats_;
+};
+
+// ---------------------------------------------------------------------------
+// sharded_cache
+// ---------------------------------------------------------------------------
+
+// Thread-safe cache made of independently locked shards of Cache. Lookups
+// return copies, or run a callback under the lock, since a reference into
+// a shard would not survive the next eviction by another thread.
+template <class Cache>
+class sharded_cache {
+ public:
+  using key_type = typename Cache::key_type;
+  using mapped_type = typename Cache::mapped_type;
+  using hasher = typename Cache::hasher;
+  using key_equal = typename Cache::key_equal;
+
+  // Capacity is split evenly; shards = 0 picks four per hardware thread,
+  // never more shards than entries.
+  explicit sharded_cache(std::size_t capacity, std::size_t shards = 0,
+                         const hasher& hash = hasher(), const key_equal& eq = key_equal())
+      : hash_(hash) {
+    if (capacity == 0) throw std::invalid_argument("cache: capacity must be positive");
+    if (shards == 0) shards = 4 * std::max(1u, std::thread::hardware_concurrency());
+    shards = std::bit_floor(std::min(shards, capacity));
+    shift_ = 64 - static_cast<unsigned>(std::countr_zero(shards));
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+      shards_.push_back(
+          std::make_unique<shard>(capacity / shards + (i < capacity % shards), hash, eq));
+    }
+  }
+
+  std::optional<mapped_type> find(const key_type& key) {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    if (mapped_type* p = s.cache.find(key)) return *p;
+    return std::nullopt;
+  }
+
+  // Calls f(value) under the shard lock if key is cached.
+  template <class F>
+  bool find(const key_type& key, F&& f) {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    mapped_type* p = s.cache.find(key);
+    if (p) std::forward<F>(f)(*p);
+    return p != nullptr;
+  }
+
+  bool contains(const key_type& key) const {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    return s.cache.contains(key);
+  }
+
+  // True if key was inserted, false if it was already cached.
+  template <class... Args>
+  bool try_emplace(const key_type& key, Args&&... args) {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    return s.cache.try_emplace(key, std::forward<Args>(args)...).second;
+  }
+
+  template <class M>
+  void insert_or_assign(const key_type& key, M&& value) {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    s.cache.insert_or_assign(key, std::forward<M>(value));
+  }
+
+  bool erase(const key_type& key) {
+    shard& s = shard_for(key);
+    std::lock_guard<adaptive_mutex> lock(s.mutex);
+    return s.cache.erase(key);
+  }
+
+  void clear() {
+    for (auto& s : shards_) {
+      std::lock_guard<adaptive_mutex> lock(s->mutex);
+      s->cache.clear();
+    }
+  }
+
+  // Sums over the shards, locking one at a time.
+  std::size_t size() const {
+    std::size_t n = 0;
+    for (auto& s : shards_) {
+      std::lock_guard<adaptive_mutex> lock(s->mutex);
+      n += s->cache.size();
+    }
+    return n;
+  }
+
+  cache_stats stats() const {
+    cache_stats total;
+    for (auto& s : shards_) {
+      std::lock_guard<adaptive_mutex> lock(s->mutex);
+      total += s->cache.stats();
+    }
+    return total;
+  }
+
+  std::size_t shard_count() const noexcept { return shards_.size(); }
+
+ private:
+  struct alignas(cache_line_size) shard {
+    shard(std::size_t capacity, const hasher& hash, const key_equal& eq)
+        : cache(capacity, hash, eq) {}
+
+    mutable adaptive_mutex mutex;
+    Cache cache;
+  };
+
+  // A differently seeded mix than the shard's own index, so that keys in
+  // one shard still spread over its slots.
+  shard& shard_for(const key_type& key) const {
+    const std::uint64_t h = mix64(static_cast<std::uint64_t>(hash_(key)) ^ detail::hash_k1);
+    return *shards_[shift_ == 64 ? 0 : h >> shift_];
+  }
+
+  std::vector<std::unique_ptr<shard>> shards_;
+  unsigned shift_ = 64;
+  [[no_unique_address]] hasher hash_{};
+};
+
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+using concurrent_lru_cache = sharded_cache<lru_cache<Key, T, Hash, KeyEqual>>;
+
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+using concurrent_tinylfu_cache = sharded_cache<tinylfu_cache<Key, T, Hash, KeyEqual>>;
+
+}  // namespace mystl
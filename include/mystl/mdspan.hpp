@@ -0,0 +1,880 @@
+#pragma once
+
+// Multidimensional non-owning view modelled after std::mdspan (C++23).
+//
+// Besides the standard layout_right / layout_left / layout_stride policies
+// this header provides two cache-friendly rank-2 layouts for matrix and image
+// kernels: layout_tiled (row-major tiles of a fixed size) and layout_morton
+// (Z-order curve), plus aligned_accessor and restrict_accessor.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+
+namespace mystl {
+
+inline constexpr std::size_t dynamic_extent = std::numeric_limits<std::size_t>::max();
+
+// ---------------------------------------------------------------------------
+// extents
+// ---------------------------------------------------------------------------
+
+template <class IndexType, std::size_t... Extents>
+class extents {
+  static_assert(std::is_integral_v<IndexType> && !std::is_same_v<IndexType, bool>,
+                "extents index type must be an integral type");
+
+ public:
+  using index_type = IndexType;
+  using size_type = std::make_unsigned_t<index_type>;
+  using rank_type = std::size_t;
+
+  static constexpr rank_type rank() noexcept { return sizeof...(Extents); }
+  static constexpr rank_type rank_dynamic() noexcept {
+    return ((Extents == dynamic_extent ? 1 : 0) + ... + 0);
+  }
+  static constexpr std::size_t static_extent(rank_type r) noexcept { return static_exts_[r]; }
+
+  constexpr index_type extent(rank_type r) const noexcept {
+    if constexpr (rank_dynamic() == 0) {
+      return static_cast<index_type>(static_exts_[r]);
+    } else {
+      if (static_exts_[r] != dynamic_extent) return static_cast<index_type>(static_exts_[r]);
+      return dyn_[dyn_index_[r]];
+    }
+  }
+
+  constexpr extents() noexcept = default;
+
+  // Either all extents or only the dynamic ones, in order.
+  template <class... OtherIndexTypes>
+    requires((std::convertible_to<OtherIndexTypes, index_type> && ...) &&
+             (sizeof...(OtherIndexTypes) == rank_dynamic() ||
+              sizeof...(OtherIndexTypes) == rank()))
+  constexpr explicit extents(OtherIndexTypes... exts) noexcept
+      : extents(std::array<index_type, sizeof...(OtherIndexTypes)>{
+            static_cast<index_type>(exts)...}) {}
+
+  template <class OtherIndexType, std::size_t N>
+    requires(std::convertible_to<const OtherIndexType&, index_type> &&
+             (N == rank_dynamic() || N == rank()))
+  constexpr explicit(N != rank_dynamic())
+      extents(const std::array<OtherIndexType, N>& exts) noexcept {
+    if constexpr (rank_dynamic() == 0) {
+      (void)exts;
+    } else if constexpr (N == rank_dynamic()) {
+      for (std::size_t i = 0; i < N; ++i) dyn_[i] = static_cast<index_type>(exts[i]);
+    } else {
+      for (std::size_t r = 0; r < rank(); ++r) {
+        if (static_exts_[r] == dynamic_extent) {
+          dyn_[dyn_index_[r]] = static_cast<index_type>(exts[r]);
+        }
+      }
+    }
+  }
+
+  template <class OtherIndexType, std::size_t... OtherExtents>
+    requires(sizeof...(OtherExtents) == sizeof...(Extents) &&
+             ((OtherExtents == dynamic_extent || Extents == dynamic_extent ||
+               OtherExtents == Extents) &&
+              ...))
+  constexpr explicit(((Extents != dynamic_extent && OtherExtents == dynamic_extent) || ...))
+      extents(const extents<OtherIndexType, OtherExtents...>& other) noexcept {
+    if constexpr (rank_dynamic() != 0) {
+      for (std::size_t r = 0; r < rank(); ++r) {
+        if (static_exts_[r] == dynamic_extent) {
+          dyn_[dyn_index_[r]] = static_cast<index_type>(other.extent(r));
+        }
+      }
+    }
+  }
+
+  template <class OtherIndexType, std::size_t... OtherExtents>
+  friend constexpr bool operator==(const extents& lhs,
+                                   const extents<OtherIndexType, OtherExtents...>& rhs) noexcept {
+    if constexpr (sizeof...(OtherExtents) != rank()) {
+      return false;
+    } else {
+      for (std::size_t r = 0; r < rank(); ++r) {
+        if (static_cast<std::intmax_t>(lhs.extent(r)) !=
+            static_cast<std::intmax_t>(rhs.extent(r))) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  // Product of all extents; the number of elements of an exhaustive mapping.
+  constexpr std::size_t product() const noexcept {
+    std::size_t n = 1;
+    for (std::size_t r = 0; r < rank(); ++r) n *= static_cast<std::size_t>(extent(r));
+    return n;
+  }
+
+ private:
+  static constexpr std::array<std::size_t, rank()> static_exts_{Extents...};
+
+  static constexpr std::array<std::size_t, rank()> dyn_index_ = [] {
+    std::array<std::size_t, rank()> idx{};
+    std::size_t d = 0;
+    for (std::size_t r = 0; r < rank(); ++r) {
+      idx[r] = d;
+      if (static_exts_[r] == dynamic_extent) ++d;
+    }
+    return idx;
+  }();
+
+  // std::array<T, 0> is not an empty class, so fully static extents store
+  // nothing at all and mdspan stays the size of its data handle.
+  struct no_dynamic_extents {};
+  [[no_unique_address]] std::conditional_t<rank_dynamic() == 0, no_dynamic_extents,
+                                           std::array<index_type, rank_dynamic()>> dyn_{};
+};
+
+namespace detail {
+
+template <class IndexType, std::size_t Rank, std::size_t... Is>
+auto make_dextents(std::index_sequence<Is...>)
+    -> extents<IndexType, ((void)Is, dynamic_extent)...>;
+
+template <class T>
+inline constexpr bool is_extents_v = false;
+
+template <class IndexType, std::size_t... Extents>
+inline constexpr bool is_extents_v<extents<IndexType, Extents...>> = true;
+
+}  // namespace detail
+
+template <class IndexType, std::size_t Rank>
+using dextents = decltype(detail::make_dextents<IndexType, Rank>(std::make_index_sequence<Rank>{}));
+
+template <std::size_t Rank, class IndexType = std::size_t>
+using dims = dextents<IndexType, Rank>;
+
+template <class... Integrals>
+  requires(std::convertible_to<Integrals, std::size_t> && ...)
+explicit extents(Integrals...)
+    -> extents<std::size_t, ((void)sizeof(Integrals), dynamic_extent)...>;
+
+// ---------------------------------------------------------------------------
+// Standard layouts
+// ---------------------------------------------------------------------------
+
+struct layout_right {
+  template <class Extents>
+  class mapping;
+};
+
+struct layout_left {
+  template <class Extents>
+  class mapping;
+};
+
+struct layout_stride {
+  template <class Extents>
+  class mapping;
+};
+
+template <class Extents>
+class layout_right::mapping {
+  static_assert(detail::is_extents_v<Extents>);
+
+ public:
+  using extents_type = Extents;
+  using index_type = typename extents_type::index_type;
+  using size_type = typename extents_type::size_type;
+  using rank_type = typename extents_type::rank_type;
+  using layout_type = layout_right;
+
+  constexpr mapping() noexcept = default;
+  constexpr mapping(const extents_type& e) noexcept : extents_(e) {}
+
+  template <class OtherExtents>
+    requires std::is_constructible_v<extents_type, OtherExtents>
+  constexpr explicit(!std::is_convertible_v<OtherExtents, extents_type>)
+      mapping(const layout_right::mapping<OtherExtents>& other) noexcept
+      : extents_(other.extents()) {}
+
+  template <class OtherExtents>
+    requires(extents_type::rank() <= 1 && std::is_constructible_v<extents_type, OtherExtents>)
+  constexpr explicit(!std::is_convertible_v<OtherExtents, extents_type>)
+      mapping(const layout_left::mapping<OtherExtents>& other) noexcept
+      : extents_(other.extents()) {}
+
+  constexpr const extents_type& extents() const noexcept { return extents_; }
+
+  constexpr index_type required_span_size() const noexcept {
+    return static_cast<index_type>(extents_.product());
+  }
+
+  template <class... Indices>
+    requires(sizeof...(Indices) == extents_type::rank() &&
+             (std::convertible_to<Indices, index_type> && ...))
+  constexpr index_type operator()(Indices... idxs) const noexcept {
+    index_type off = 0;
+    rank_type r = 0;
+    ((off = static_cast<index_type>(off * extents_.extent(r++) + static_cast<index_type>(idxs))),
+     ...);
+    return off;
+  }
+
+  static constexpr bool is_always_unique() noexcept { return true; }
+  static constexpr bool is_always_exhaustive() noexcept { return true; }
+  static constexpr bool is_always_strided() noexcept { return true; }
+  static constexpr bool is_unique() noexcept { return true; }
+  static constexpr bool is_exhaustive() noexcept { return true; }
+  static constexpr bool is_strided() noexcept { return true; }
+
+  constexpr index_type stride(rank_type r) const noexcept {
+    index_type s = 1;
+    for (rank_type k = r + 1; k < extents_type::rank(); ++k) s *= extents_.extent(k);
+    return s;
+  }
+
+  template <class OtherExtents>
+  friend constexpr bool operator==(const mapping& lhs,
+                                   const layout_right::mapping<OtherExtents>& rhs) noexcept {
+    return lhs.extents() == rhs.extents();
+  }
+
+ private:
+  [[no_unique_address]] extents_type extents_{};
+};
+
+template <class Extents>
+class layout_left::mapping {
+  static_assert(detail::is_extents_v<Extents>);
+
+ public:
+  using extents_type = Extents;
+  using index_type = typename extents_type::index_type;
+  using size_type = typename extents_type::size_type;
+  using rank_type = typename extents_type::rank_type;
+  using layout_type = layout_left;
+
+  constexpr mapping() noexcept = default;
+  constexpr mapping(const extents_type& e) noexcept : extents_(e) {}
+
+  template <class OtherExtents>
+    requires std::is_constructible_v<extents_type, OtherExtents>
+  constexpr explicit(!std::is_convertible_v<OtherExtents, extents_type>)
+      mapping(const layout_left::mapping<OtherExtents>& other) noexcept
+      : extents_(other.extents()) {}
+
+  template <class OtherExtents>
+    requires(extents_type::rank() <= 1 && std::is_constructible_v<extents_type, OtherExtents>)
+  constexpr explicit(!std::is_convertible_v<OtherExtents, extents_type>)
+      mapping(const layout_right::mapping<OtherExtents>& other) noexcept
+      : extents_(other.extents()) {}
+
+  constexpr const extents_type& extents() const noexcept { return extents_; }
+
+  constexpr index_type required_span_size() const noexcept {
+    return static_cast<index_type>(extents_.product());
+  }
+
+  template <class... Indices>
+    requires(sizeof...(Indices) == extents_type::rank() &&
+             (std::convertible_to<Indices, index_type> && ...))
+  constexpr index_type operator()(Indices... idxs) const noexcept {
+    const std::array<index_type, extents_type::rank()> i{static_cast<index_type>(idxs)...};
+    index_type off = 0;
+    for (rank_type r = extents_type::rank(); r-- > 0;) {
+      off = static_cast<index_type>(off * extents_.extent(r) + i[r]);
+    }
+    return off;
+  }
+
+  static constexpr bool is_always_unique() noexcept { return true; }
+  static constexpr bool is_always_exhaustive() noexcept { return true; }
+  static constexpr bool is_always_strided() noexcept { return true; }
+  static constexpr bool is_unique() noexcept { return true; }
+  static constexpr bool is_exhaustive() noexcept { return true; }
+  static constexpr bool is_strided() noexcept { return true; }
+
+  constexpr index_type stride(rank_type r) const noexcept {
+    index_type s = 1;
+    for (rank_type k = 0; k < r; ++k) s *= extents_.extent(k);
+    return s;
+  }
+
+  template <class OtherExtents>
+  friend constexpr bool operator==(const mapping& lhs,
+                                   const layout_left::mapping<OtherExtents>& rhs) noexcept {
+    return lhs.extents() == rhs.extents();
+  }
+
+ private:
+  [[no_unique_address]] extents_type extents_{};
+};
+
+template <class Extents>
+class layout_stride::mapping {
+  static_assert(detail::is_extents_v<Extents>);
+
+ public:
+  using extents_type = Extents;
+  using index_type = typename extents_type::index_type;
+  using size_type = typename extents_type::size_type;
+  using rank_type = typename extents_type::rank_type;
+  using layout_type = layout_stride;
+
+  // Defaults to the layout_right strides of a default-constructed extents.
+  constexpr mapping() noexcept
+      : mapping(layout_right::mapping<extents_type>()) {}
+
+  template <class OtherIndexType>
+    requires std::convertible_to<const OtherIndexType&, index_type>
+  constexpr mapping(const extents_type& e,
+                    const std::array<OtherIndexType, extents_type::rank()>& s) noexcept
+      : extents_(e) {
+    for (rank_type r = 0; r < extents_type::rank(); ++r) {
+      strides_[r] = static_cast<index_type>(s[r]);
+    }
+  }
+
+  // Any strided mapping (layout_right, layout_left, another layout_stride)
+  // converts to layout_stride.
+  template <class StridedMapping>
+    requires(StridedMapping::is_always_unique() && StridedMapping::is_always_strided() &&
+             std::is_constructible_v<extents_type, typename StridedMapping::extents_type> &&
+             !std::is_same_v<StridedMapping, mapping>)
+  constexpr explicit(!std::is_convertible_v<typename StridedMapping::extents_type, extents_type>)
+      mapping(const StridedMapping& other) noexcept
+      : extents_(other.extents()) {
+    for (rank_type r = 0; r < extents_type::rank(); ++r) {
+      strides_[r] = static_cast<index_type>(other.stride(r));
+    }
+  }
+
+  constexpr const extents_type& extents() const noexcept { return extents_; }
+  constexpr std::array<index_type, extents_type::rank()> strides() const noexcept {
+    return strides_;
+  }
+
+  constexpr index_type required_span_size() const noexcept {
+    index_type size = 1;
+    for (rank_type r = 0; r < extents_type::rank(); ++r) {
+      if (extents_.extent(r) == 0) return 0;
+      size += (extents_.extent(r) - 1) * strides_[r];
+    }
+    return size;
+  }
+
+  template <class... Indices>
+    requires(sizeof...(Indices) == extents_type::rank() &&
+             (std::convertible_to<Indices, index_type> && ...))
+  constexpr index_type operator()(Indices... idxs) const noexcept {
+    index_type off = 0;
+    rank_type r = 0;
+    ((off += static_cast<index_type>(idxs) * strides_[r++]), ...);
+    return off;
+  }
+
+  static constexpr bool is_always_unique() noexcept { return true; }
+  static constexpr bool is_always_exhaustive() noexcept { return false; }
+  static constexpr bool is_always_strided() noexcept { return true; }
+  static constexpr bool is_unique() noexcept { return true; }
+  constexpr bool is_exhaustive() const noexcept {
+    return static_cast<std::size_t>(required_span_size()) == extents_.product();
+  }
+  static constexpr bool is_strided() noexcept { return true; }
+
+  constexpr index_type stride(rank_type r) const noexcept { return strides_[r]; }
+
+  template <class OtherMapping>
+    requires(OtherMapping::is_always_strided() &&
+             OtherMapping::extents_type::rank() == extents_type::rank())
+  friend constexpr bool operator==(const mapping& lhs, const OtherMapping& rhs) noexcept {
+    if (!(lhs.extents() == rhs.extents())) return false;
+    for (rank_type r = 0; r < extents_type::rank(); ++r) {
+      if (lhs.stride(r) != static_cast<index_type>(rhs.stride(r))) return false;
+    }
+    return true;
+  }
+
+ private:
+  [[no_unique_address]] extents_type extents_{};
+  std::array<index_type, extents_type::rank()> strides_{};
+};
+
+// ---------------------------------------------------------------------------
+// Blocked layouts for rank-2 kernels
+// ---------------------------------------------------------------------------
+
+namespace detail {
+
+// Whether a rows x cols mapping, padded to whole tile_rows x tile_cols
+// tiles, has an area representable in IndexType.
+template <class IndexType>
+constexpr bool tiled_fits(std::uint64_t rows, std::uint64_t cols, std::uint64_t tile_rows,
+                          std::uint64_t tile_cols) noexcept {
+  const auto max = static_cast<std::uint64_t>(std::numeric_limits<IndexType>::max());
+  const std::uint64_t tile_size = tile_rows * tile_cols;
+  const std::uint64_t down = rows / tile_rows + (rows % tile_rows != 0);
+  const std::uint64_t across = cols / tile_cols + (cols % tile_cols != 0);
+  if (tile_size > max) return false;
+  return down == 0 || across <= max / tile_size / down;
+}
+
+}  // namespace detail
+
+// Row-major grid of TileRows x TileCols tiles, each tile stored contiguously
+// in row-major order. A tile of doubles sized to a few cache lines keeps both
+// row-wise and column-wise sweeps inside a small working set. The extents
+// are padded up to whole tiles, so the mapping is exhaustive only when both
+// extents are multiples of the tile size. The constructor throws
+// std::length_error if the padded area does not fit in index_type.
+template <std::size_t TileRows, std::size_t TileCols>
+struct layout_tiled {
+  static_assert(TileRows > 0 && TileCols > 0, "tile dimensions must be non-zero");
+
+  static constexpr std::size_t tile_rows = TileRows;
+  static constexpr std::size_t tile_cols = TileCols;
+
+  template <class Extents>
+  class mapping {
+    static_assert(detail::is_extents_v<Extents> && Extents::rank() == 2,
+                  "layout_tiled only supports rank-2 extents");
+    static_assert(Extents::rank_dynamic() != 0 ||
+                      detail::tiled_fits<typename Extents::index_type>(
+                          Extents::static_extent(0), Extents::static_extent(1), TileRows, TileCols),
+                  "layout_tiled: padded extents overflow index_type");
+
+   public:
+    using extents_type = Extents;
+    using index_type = typename extents_type::index_type;
+    using size_type = typename extents_type::size_type;
+    using rank_type = typename extents_type::rank_type;
+    using layout_type = layout_tiled;
+
+    constexpr mapping() : mapping(extents_type()) {}
+    constexpr mapping(const extents_type& e) : extents_(e) {
+      if (!detail::tiled_fits<index_type>(static_cast<std::uint64_t>(e.extent(0)),
+                                          static_cast<std::uint64_t>(e.extent(1)), TileRows,
+                                          TileCols)) {
+        throw std::length_error("layout_tiled: padded extents overflow index_type");
+      }
+      tiles_per_row_ = ceil_div(e.extent(1), TileCols);
+    }
+
+    constexpr const extents_type& extents() const noexcept { return extents_; }
+
+    constexpr index_type tiles_per_row() const noexcept { return tiles_per_row_; }
+    constexpr index_type tiles_per_col() const noexcept {
+      return ceil_div(extents_.extent(0), TileRows);
+    }
+
+    constexpr index_type required_span_size() const noexcept {
+      return static_cast<index_type>(tiles_per_col() * tiles_per_row_ * tile_size);
+    }
+
+    template <class I0, class I1>
+      requires(std::convertible_to<I0, index_type> && std::convertible_to<I1, index_type>)
+    constexpr index_type operator()(I0 i0, I1 i1) const noexcept {
+      const auto i = static_cast<index_type>(i0);
+      const auto j = static_cast<index_type>(i1);
+      const index_type tile = (i / TileRows) * tiles_per_row_ + j / TileCols;
+      return static_cast<index_type>(tile * tile_size + (i % TileRows) * TileCols + j % TileCols);
+    }
+
+    static constexpr bool is_always_unique() noexcept { return true; }
+    static constexpr bool is_always_exhaustive() noexcept { return false; }
+    static constexpr bool is_always_strided() noexcept { return false; }
+    static constexpr bool is_unique() noexcept { return true; }
+    constexpr bool is_exhaustive() const noexcept {
+      return extents_.extent(0) % TileRows == 0 && extents_.extent(1) % TileCols == 0;
+    }
+    static constexpr bool is_strided() noexcept { return false; }
+
+    template <class OtherExtents>
+    friend constexpr bool operator==(const mapping& lhs,
+                                     const mapping<OtherExtents>& rhs) noexcept {
+      return lhs.extents() == rhs.extents();
+    }
+
+   private:
+    static constexpr index_type tile_size = static_cast<index_type>(TileRows * TileCols);
+
+    static constexpr index_type ceil_div(index_type n, std::size_t d) noexcept {
+      const auto di = static_cast<index_type>(d);
+      return static_cast<index_type>(n / di + (n % di != 0));
+    }
+
+    [[no_unique_address]] extents_type extents_{};
+    index_type tiles_per_row_ = 0;
+  };
+};
+
+namespace detail {
+
+// Spreads the low 32 bits of x so that bit k moves to bit 2k.
+constexpr std::uint64_t spread_bits(std::uint64_t x) noexcept {
+  x &= 0xFFFFFFFFull;
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+  x = (x | (x << 2)) & 0x3333333333333333ull;
+  x = (x | (x << 1)) & 0x5555555555555555ull;
+  return x;
+}
+
+constexpr std::uint64_t morton_encode(std::uint64_t row, std::uint64_t col) noexcept {
+  return (spread_bits(row) << 1) | spread_bits(col);
+}
+
+// Whether a rows x cols Morton mapping, padded to a power-of-two square, has
+// an area representable in IndexType. This also keeps every index below the
+// 32 bits per dimension morton_encode interleaves.
+template <class IndexType>
+constexpr bool morton_fits(std::uint64_t rows, std::uint64_t cols) noexcept {
+  const std::uint64_t n = std::max(rows, cols);
+  if (n > (std::uint64_t{1} << 31)) return false;
+  const std::uint64_t side = std::bit_ceil(n);
+  return side * side <= static_cast<std::uint64_t>(std::numeric_limits<IndexType>::max());
+}
+
+}  // namespace detail
+
+// Z-order (Morton) layout: the bits of the row and column index are
+// interleaved, so every aligned 2^k x 2^k block is contiguous at every scale.
+// Good for recursive / cache-oblivious kernels such as transpose and matmul.
+//
+// The curve only tiles power-of-two squares, so the mapping pads the extents
+// to a square whose side is the larger extent rounded up to a power of two;
+// required_span_size() is that square's area. A 1000 x 1000 matrix needs
+// 1024 x 1024 elements, but a 1000 x 1 one needs as many, so prefer this
+// layout for roughly square matrices. The constructor throws
+// std::length_error if the padded area does not fit in index_type.
+struct layout_morton {
+  template <class Extents>
+  class mapping {
+    static_assert(detail::is_extents_v<Extents> && Extents::rank() == 2,
+                  "layout_morton only supports rank-2 extents");
+    static_assert(Extents::rank_dynamic() != 0 ||
+                      detail::morton_fits<typename Extents::index_type>(Extents::static_extent(0),
+                                                                      Extents::static_extent(1)),
+                  "layout_morton: padded extents overflow index_type");
+
+   public:
+    using extents_type = Extents;
+    using index_type = typename extents_type::index_type;
+    using size_type = typename extents_type::size_type;
+    using rank_type = typename extents_type::rank_type;
+    using layout_type = layout_morton;
+
+    constexpr mapping() : mapping(extents_type()) {}
+    constexpr mapping(const extents_type& e) : extents_(e) {
+      const auto rows = static_cast<std::uint64_t>(e.extent(0));
+      const auto cols = static_cast<std::uint64_t>(e.extent(1));
+      if (!detail::morton_fits<index_type>(rows, cols)) {
+        throw std::length_error("layout_morton: padded extents overflow index_type");
+      }
+      side_ = static_cast<index_type>(std::bit_ceil(std::max(rows, cols)));
+    }
+
+    constexpr const extents_type& extents() const noexcept { return extents_; }
+
+    // Side of the power-of-two square the extents are padded to.
+    constexpr index_type padded_extent() const noexcept { return side_; }
+
+    constexpr index_type required_span_size() const noexcept {
+      if (extents_.extent(0) == 0 || extents_.extent(1) == 0) return 0;
+      return static_cast<index_type>(side_ * side_);
+    }
+
+    template <class I0, class I1>
+      requires(std::convertible_to<I0, index_type> && std::convertible_to<I1, index_type>)
+    constexpr index_type operator()(I0 i0, I1 i1) const noexcept {
+      return static_cast<index_type>(
+          detail::morton_encode(static_cast<std::uint64_t>(static_cast<index_type>(i0)),
+                                static_cast<std::uint64_t>(static_cast<index_type>(i1))));
+    }
+
+    static constexpr bool is_always_unique() noexcept { return true; }
+    static constexpr bool is_always_exhaustive() noexcept { return false; }
+    static constexpr bool is_always_strided() noexcept { return false; }
+    static constexpr bool is_unique() noexcept { return true; }
+    constexpr bool is_exhaustive() const noexcept {
+      return static_cast<std::size_t>(required_span_size()) == extents_.product();
+    }
+    static constexpr bool is_strided() noexcept { return false; }
+
+    template <class OtherExtents>
+    friend constexpr bool operator==(const mapping& lhs,
+                                     const layout_morton::mapping<OtherExtents>& rhs) noexcept {
+      return lhs.extents() == rhs.extents();
+    }
+
+   private:
+    [[no_unique_address]] extents_type extents_{};
+    index_type side_ = 0;
+  };
+};
+
+// ---------------------------------------------------------------------------
+// Accessors
+// ---------------------------------------------------------------------------
+
+template <class ElementType>
+struct default_accessor {
+  using offset_policy = default_accessor;
+  using element_type = ElementType;
+  using reference = ElementType&;
+  using data_handle_type = ElementType*;
+
+  constexpr default_accessor() noexcept = default;
+
+  template <class OtherElementType>
+    requires std::is_convertible_v<OtherElementType (*)[], element_type (*)[]>
+  constexpr default_accessor(default_accessor<OtherElementType>) noexcept {}
+
+  constexpr reference access(data_handle_type p, std::size_t i) const noexcept { return p[i]; }
+  constexpr data_handle_type offset(data_handle_type p, std::size_t i) const noexcept {
+    return p + i;
+  }
+};
+
+// Promises the compiler that the data handle is aligned to ByteAlignment so
+// vectorised kernels can use aligned loads and skip peeling. Offsetting the
+// handle loses the guarantee, hence offset_policy is default_accessor.
+template <class ElementType, std::size_t ByteAlignment>
+struct aligned_accessor {
+  static_assert(ByteAlignment != 0 && (ByteAlignment & (ByteAlignment - 1)) == 0,
+                "alignment must be a power of two");
+  static_assert(ByteAlignment >= alignof(ElementType),
+                "alignment must be at least the element alignment");
+
+  using offset_policy = default_accessor<ElementType>;
+  using element_type = ElementType;
+  using reference = ElementType&;
+  using data_handle_type = ElementType*;
+
+  static constexpr std::size_t byte_alignment = ByteAlignment;
+
+  constexpr aligned_accessor() noexcept = default;
+
+  template <class OtherElementType, std::size_t OtherAlignment>
+    requires(std::is_convertible_v<OtherElementType (*)[], element_type (*)[]> &&
+             OtherAlignment >= ByteAlignment)
+  constexpr aligned_accessor(aligned_accessor<OtherElementType, OtherAlignment>) noexcept {}
+
+  constexpr operator default_accessor<element_type>() const noexcept { return {}; }
+
+  constexpr reference access(data_handle_type p, std::size_t i) const noexcept {
+    return std::assume_aligned<ByteAlignment>(p)[i];
+  }
+  constexpr typename offset_policy::data_handle_type offset(data_handle_type p,
+                                                            std::size_t i) const noexcept {
+    return p + i;
+  }
+};
+
+// Declares that, for the lifetime of the view, the elements are reached only
+// through this view. Kernels that read one mdspan and write another can then
+// be vectorised without runtime alias checks.
+template <class ElementType>
+struct restrict_accessor {
+  using offset_policy = restrict_accessor;
+  using element_type = ElementType;
+  using reference = ElementType&;
+  using data_handle_type = ElementType* MYSTL_RESTRICT;
+
+  constexpr restrict_accessor() noexcept = default;
+
+  template <class OtherElementType>
+    requires std::is_convertible_v<OtherElementType (*)[], element_type (*)[]>
+  constexpr restrict_accessor(restrict_accessor<OtherElementType>) noexcept {}
+
+  constexpr reference access(data_handle_type p, std::size_t i) const noexcept { return p[i]; }
+  constexpr ElementType* offset(data_handle_type p, std::size_t i) const noexcept {
+    return p + i;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// mdspan
+// ---------------------------------------------------------------------------
+
+template <class ElementType, class Extents, class LayoutPolicy = layout_right,
+          class AccessorPolicy = default_accessor<ElementType>>
+class mdspan {
+  static_assert(detail::is_extents_v<Extents>);
+  static_assert(std::is_same_v<ElementType, typename AccessorPolicy::element_type>);
+
+ public:
+  using extents_type = Extents;
+  using layout_type = LayoutPolicy;
+  using accessor_type = AccessorPolicy;
+  using mapping_type = typename layout_type::template mapping<extents_type>;
+  using element_type = ElementType;
+  using value_type = std::remove_cv_t<element_type>;
+  using index_type = typename extents_type::index_type;
+  using size_type = typename extents_type::size_type;
+  using rank_type = typename extents_type::rank_type;
+  using data_handle_type = typename accessor_type::data_handle_type;
+  using reference = typename accessor_type::reference;
+
+  static constexpr rank_type rank() noexcept { return extents_type::rank(); }
+  static constexpr rank_type rank_dynamic() noexcept { return extents_type::rank_dynamic(); }
+  static constexpr std::size_t static_extent(rank_type r) noexcept {
+    return extents_type::static_extent(r);
+  }
+  constexpr index_type extent(rank_type r) const noexcept { return extents().extent(r); }
+
+  constexpr mdspan() = default;
+
+  template <class... OtherIndexTypes>
+    requires((std::convertible_to<OtherIndexTypes, index_type> && ...) &&
+             (sizeof...(OtherIndexTypes) == rank() ||
+              sizeof...(OtherIndexTypes) == rank_dynamic()) &&
+             std::is_constructible_v<mapping_type, extents_type> &&
+             std::is_default_constructible_v<accessor_type>)
+  constexpr explicit mdspan(data_handle_type p, OtherIndexTypes... exts)
+      : ptr_(std::move(p)), map_(extents_type(static_cast<index_type>(std::move(exts))...)) {}
+
+  template <class OtherIndexType, std::size_t N>
+    requires(std::convertible_to<const OtherIndexType&, index_type> &&
+             (N == rank() || N == rank_dynamic()) &&
+             std::is_constructible_v<mapping_type, extents_type> &&
+             std::is_default_constructible_v<accessor_type>)
+  constexpr explicit(N != rank_dynamic())
+      mdspan(data_handle_type p, const std::array<OtherIndexType, N>& exts)
+      : ptr_(std::move(p)), map_(extents_type(exts)) {}
+
+  constexpr mdspan(data_handle_type p, const extents_type& e)
+    requires(std::is_constructible_v<mapping_type, const extents_type&> &&
+             std::is_default_constructible_v<accessor_type>)
+      : ptr_(std::move(p)), map_(e) {}
+
+  constexpr mdspan(data_handle_type p, const mapping_type& m)
+    requires std::is_default_constructible_v<accessor_type>
+      : ptr_(std::move(p)), map_(m) {}
+
+  constexpr mdspan(data_handle_type p, const mapping_type& m, const accessor_type& a)
+      : ptr_(std::move(p)), map_(m), acc_(a) {}
+
+  template <class OtherElementType, class OtherExtents, class OtherLayoutPolicy,
+            class OtherAccessor>
+    requires(std::is_constructible_v<
+                 mapping_type, const typename OtherLayoutPolicy::template mapping<OtherExtents>&> &&
+             std::is_constructible_v<accessor_type, const OtherAccessor&> &&
+             std::is_constructible_v<data_handle_type,
+                                     const typename OtherAccessor::data_handle_type&>)
+  constexpr explicit(
+      !std::is_convertible_v<const typename OtherLayoutPolicy::template mapping<OtherExtents>&,
+                             mapping_type> ||
+      !std::is_convertible_v<const OtherAccessor&, accessor_type>)
+      mdspan(const mdspan<OtherElementType, OtherExtents, OtherLayoutPolicy, OtherAccessor>& other)
+      : ptr_(other.data_handle()), map_(other.mapping()), acc_(other.accessor()) {}
+
+  template <class... OtherIndexTypes>
+    requires(sizeof...(OtherIndexTypes) == rank() &&
+             (std::convertible_to<OtherIndexTypes, index_type> && ...))
+  constexpr reference operator()(OtherIndexTypes... idxs) const {
+    return acc_.access(ptr_, static_cast<std::size_t>(map_(static_cast<index_type>(idxs)...)));
+  }
+
+#if defined(__cpp_multidimensional_subscript)
+  template <class... OtherIndexTypes>
+    requires(sizeof...(OtherIndexTypes) == rank() &&
+             (std::convertible_to<OtherIndexTypes, index_type> && ...))
+  constexpr reference operator[](OtherIndexTypes... idxs) const {
+    return (*this)(idxs...);
+  }
+#endif
+
+  template <class OtherIndexType>
+    requires std::convertible_to<const OtherIndexType&, index_type>
+  constexpr reference operator[](const std::array<OtherIndexType, rank()>& idxs) const {
+    return index_with(idxs, std::make_index_sequence<rank()>{});
+  }
+
+  template <class OtherIndexType>
+    requires std::convertible_to<const OtherIndexType&, index_type>
+  constexpr reference operator[](std::span<OtherIndexType, rank()> idxs) const {
+    return index_with(idxs, std::make_index_sequence<rank()>{});
+  }
+
+  constexpr size_type size() const noexcept {
+    return static_cast<size_type>(extents().product());
+  }
+  [[nodiscard]] constexpr bool empty() const noexcept {
+    for (rank_type r = 0; r < rank(); ++r) {
+      if (extent(r) == 0) return true;
+    }
+    return false;
+  }
+
+  friend constexpr void swap(mdspan& x, mdspan& y) noexcept {
+    using std::swap;
+    swap(x.ptr_, y.ptr_);
+    swap(x.map_, y.map_);
+    swap(x.acc_, y.acc_);
+  }
+
+  constexpr const extents_type& extents() const noexcept { return map_.extents(); }
+  constexpr const data_handle_type& data_handle() const noexcept { return ptr_; }
+  constexpr const mapping_type& mapping() const noexcept { return map_; }
+  constexpr const accessor_type& accessor() const noexcept { return acc_; }
+
+  static constexpr bool is_always_unique() { return mapping_type::is_always_unique(); }
+  static constexpr bool is_always_exhaustive() { return mapping_type::is_always_exhaustive(); }
+  static constexpr bool is_always_strided() { return mapping_type::is_always_strided(); }
+
+  constexpr bool is_unique() const { return map_.is_unique(); }
+  constexpr bool is_exhaustive() const { return map_.is_exhaustive(); }
+  constexpr bool is_strided() const { return map_.is_strided(); }
+  constexpr index_type stride(rank_type r) const
+    requires requires(const mapping_type& m) { m.stride(r); }
+  {
+    return map_.stride(r);
+  }
+
+ private:
+  template <class Indices, std::size_t... Is>
+  constexpr reference index_with(const Indices& idxs, std::index_sequence<Is...>) const {
+    return (*this)(static_cast<index_type>(idxs[Is])...);
+  }
+
+  data_handle_type ptr_{};
+  [[no_unique_address]] mapping_type map_{};
+  [[no_unique_address]] accessor_type acc_{};
+};
+
+template <class ElementType, class... Integrals>
+  requires(sizeof...(Integrals) > 0 && (std::convertible_to<Integrals, std::size_t> && ...))
+explicit mdspan(ElementType*, Integrals...)
+    -> mdspan<ElementType, dextents<std::size_t, sizeof...(Integrals)>>;
+
+template <class ElementType, class OtherIndexType, std::size_t N>
+mdspan(ElementType*, const std::array<OtherIndexType, N>&)
+    -> mdspan<ElementType, dextents<std::size_t, N>>;
+
+template <class ElementType, class IndexType, std::size_t... ExtentsPack>
+mdspan(ElementType*, const extents<IndexType, ExtentsPack...>&)
+    -> mdspan<ElementType, extents<IndexType, ExtentsPack...>>;
+
+template <class ElementType, class MappingType>
+mdspan(ElementType*, const MappingType&)
+    -> mdspan<ElementType, typename MappingType::extents_type,
+              typename MappingType::layout_type>;
+
+template <class MappingType, class AccessorType>
+mdspan(const typename AccessorType::data_handle_type&, const MappingType&, const AccessorType&)
+    -> mdspan<typename AccessorType::element_type, typename MappingType::extents_type,
+              typename MappingType::layout_type, AccessorType>;
+
+}  // namespace mystl
@@ -0,0 +1,553 @@
+#pragma once
+
+// Minimal perfect hash function over a large static key set, built at run
+// time. Maps each of the n build keys to a distinct integer in [0, n) using
+// roughly 2-3 bits per key; keys themselves are not stored, so a key outside
+// the build set maps to an arbitrary value in [0, n).
+//
+// The construction is partitioned PTHash:
+//  - keys are hashed to 64 bits and split into partitions of about
+//    mphf_config::partition_size keys, which are built independently on
+//    mphf_config::threads threads;
+//  - within a partition keys are assigned to c*n/log2(n) buckets with a
+//    skewed distribution (60% of keys into 30% of buckets), and buckets are
+//    processed largest first, searching the smallest "pilot" for which every
+//    key of the bucket lands on a free slot of a table of n/alpha slots;
+//  - pilots are stored bit-packed with a per-partition width chosen to
+//    minimise space; the ~1% of pilots that do not fit are escaped into a
+//    sorted exception list, and the few keys that land past slot n are
+//    remapped onto the holes below n.
+//
+// A lookup is three multiply-xorshift mixes, two bit-packed reads and, for
+// a few percent of the keys, one more read or a short binary search. The
+// structure serialises to a flat little-endian blob with save()/to_bytes().
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+struct mphf_config {
+  // Average bucket size is log2(n)/c. Larger c builds faster and uses more
+  // space; 5-7 is the useful range.
+  double c = 5.0;
+  // Load factor of the per-partition tables before remapping; < 1 makes the
+  // search for the last buckets cheap at a small remapping cost.
+  double alpha = 0.99;
+  // Target number of keys per independently built partition.
+  std::size_t partition_size = std::size_t{1} << 20;
+  // Worker threads for the build; 0 means std::thread::hardware_concurrency().
+  unsigned threads = 0;
+  std::uint64_t seed = 0x5EED5EED5EED5EEDull;
+};
+
+namespace detail {
+
+inline constexpr std::uint64_t mphf_bucket_salt = 0x9E3779B97F4A7C15ull;
+inline constexpr std::uint64_t mphf_pilot_salt = 0xD1B54A32D192ED03ull;
+inline constexpr std::uint64_t mphf_magic = 0x3146485048504D4Dull;  // "MMPHPHF1", little-endian
+// Pilots are searched below this bound so that an exception, packed as
+// bucket << 32 | pilot, has room for them.
+inline constexpr std::uint64_t mphf_pilot_limit = std::uint64_t{1} << 32;
+
+// Fixed-width integers packed into 64-bit words at arbitrary bit offsets.
+class bit_packed_words {
+ public:
+  std::uint64_t get(std::uint64_t bitpos, unsigned width) const noexcept {
+    if (width == 0) return 0;
+    const std::uint64_t word = bitpos >> 6;
+    const unsigned shift = static_cast<unsigned>(bitpos & 63);
+    std::uint64_t v = words_[word] >> shift;
+    if (shift + width > 64) v |= words_[word + 1] << (64 - shift);
+    return width == 64 ? v : v & ((std::uint64_t{1} << width) - 1);
+  }
+
+  // Appends values with the given width and returns the bit offset of the
+  // first one.
+  std::uint64_t append(std::span<const std::uint64_t> values, unsigned width) {
+    const std::uint64_t start = bits_;
+    words_.resize(static_cast<std::size_t>((bits_ + values.size() * width + 63) / 64) + 1, 0);
+    for (std::uint64_t v : values) {
+      if (width != 0) {
+        const std::uint64_t word = bits_ >> 6;
+        const unsigned shift = static_cast<unsigned>(bits_ & 63);
+        words_[word] |= v << shift;
+        if (shift + width > 64) words_[word + 1] |= v >> (64 - shift);
+        bits_ += width;
+      }
+    }
+    return start;
+  }
+
+  std::vector<std::uint64_t>& words() noexcept { return words_; }
+  const std::vector<std::uint64_t>& words() const noexcept { return words_; }
+  std::uint64_t& bit_size() noexcept { return bits_; }
+  std::uint64_t bit_size() const noexcept { return bits_; }
+
+ private:
+  std::vector<std::uint64_t> words_{0};
+  std::uint64_t bits_ = 0;
+};
+
+struct mphf_partition {
+  std::uint64_t key_offset = 0;
+  std::uint64_t num_keys = 0;
+  std::uint64_t table_size = 0;
+  std::uint64_t pilot_bitpos = 0;
+  std::uint64_t remap_bitpos = 0;
+  // Sorted (bucket << 32 | pilot) words for pilots stored as the escape
+  // value, i.e. all ones in pilot_width bits.
+  std::uint64_t exception_bitpos = 0;
+  std::uint32_t exception_count = 0;
+  std::uint32_t num_buckets = 1;
+  std::uint32_t dense_buckets = 0;
+  std::uint8_t pilot_width = 0;
+  std::uint8_t remap_width = 0;
+  std::uint8_t padding[2] = {};
+};
+
+static_assert(std::is_trivially_copyable_v<mphf_partition> && sizeof(mphf_partition) == 64);
+
+// Picks the pilot width that minimises width * buckets + 64 * exceptions.
+inline unsigned mphf_pilot_width(const std::vector<std::uint64_t>& pilots) {
+  std::uint64_t by_width[65] = {};
+  for (std::uint64_t v : pilots) ++by_width[std::bit_width(v)];
+  // A pilot of bit width k is escaped under width w iff k > w, or k == w
+  // and the pilot is all ones; the latter is rare enough to count as k > w.
+  unsigned best = 64;
+  std::uint64_t best_cost = ~std::uint64_t{0}, wider = 0;
+  for (unsigned w = 64; w >= 1; --w) {
+    wider += by_width[w];
+    const std::uint64_t cost = w * pilots.size() + 64 * (wider - by_width[w]);
+    if (cost <= best_cost) {
+      best_cost = cost;
+      best = w;
+    }
+  }
+  return best;
+}
+
+// Skewed bucket assignment: 60% of keys go to the first 30% of buckets.
+inline std::uint64_t mphf_bucket(std::uint64_t h, const mphf_partition& p) noexcept {
+  const std::uint64_t hb = mix64(h ^ mphf_bucket_salt);
+  const std::uint64_t hi = hb >> 32, lo = hb & 0xFFFFFFFFu;
+  constexpr std::uint64_t dense_fraction = 0x9999999Au;  // 0.6 * 2^32
+  if (hi < dense_fraction) return (lo * p.dense_buckets) >> 32;
+  return p.dense_buckets + ((lo * (p.num_buckets - p.dense_buckets)) >> 32);
+}
+
+inline std::uint64_t mphf_position(std::uint64_t h, std::uint64_t pilot,
+                                   std::uint64_t table_size) noexcept {
+  return fastrange64(mix64(h ^ mix64(pilot ^ mphf_pilot_salt)), table_size);
+}
+
+struct mphf_partition_result {
+  std::vector<std::uint64_t> pilots;
+  std::vector<std::uint64_t> remap;
+  bool duplicate = false;
+  // Some bucket had no pilot below mphf_pilot_limit; another seed may.
+  bool no_pilot = false;
+};
+
+inline mphf_partition_result mphf_build_partition(std::span<const std::uint64_t> hashes,
+                                                  mphf_partition& p, const mphf_config& cfg) {
+  mphf_partition_result r;
+  const std::uint64_t n = hashes.size();
+  p.num_keys = n;
+  if (n == 0) {
+    p.num_buckets = 1;
+    p.dense_buckets = 0;
+    p.table_size = 0;
+    r.pilots.assign(1, 0);
+    return r;
+  }
+  p.table_size = std::max<std::uint64_t>(
+      n, static_cast<std::uint64_t>(std::ceil(static_cast<double>(n) / cfg.alpha)));
+  const double log_n = std::max(1.0, std::log2(static_cast<double>(n)));
+  p.num_buckets = static_cast<std::uint32_t>(
+      std::max(1.0, std::ceil(cfg.c * static_cast<double>(n) / log_n)));
+  // mphf_bucket needs fewer dense buckets than buckets; a single bucket
+  // is all sparse.
+  p.dense_buckets = static_cast<std::uint32_t>(0.3 * p.num_buckets);
+  if (p.dense_buckets == 0 && p.num_buckets > 1) p.dense_buckets = 1;
+
+  // Group keys by bucket (counting sort).
+  std::vector<std::uint32_t> bucket_begin(p.num_buckets + 1, 0);
+  std::vector<std::uint32_t> bucket_of(n);
+  for (std::uint64_t i = 0; i < n; ++i) {
+    bucket_of[i] = static_cast<std::uint32_t>(mphf_bucket(hashes[i], p));
+    ++bucket_begin[bucket_of[i] + 1];
+  }
+  std::uint32_t max_size = 0;
+  for (std::uint32_t b = 0; b < p.num_buckets; ++b) {
+    max_size = std::max(max_size, bucket_begin[b + 1]);
+    bucket_begin[b + 1] += bucket_begin[b];
+  }
+  std::vector<std::uint64_t> grouped(n);
+  {
+    std::vector<std::uint32_t> fill(bucket_begin.begin(), bucket_begin.end() - 1);
+    for (std::uint64_t i = 0; i < n; ++i) grouped[fill[bucket_of[i]]++] = hashes[i];
+  }
+  bucket_of.clear();
+  bucket_of.shrink_to_fit();
+
+  // Bucket ids ordered by decreasing size (counting sort on size).
+  std::vector<std::uint32_t> size_begin(max_size + 2, 0);
+  for (std::uint32_t b = 0; b < p.num_buckets; ++b) {
+    ++size_begin[max_size - (bucket_begin[b + 1] - bucket_begin[b]) + 1];
+  }
+  for (std::uint32_t s = 0; s <= max_size; ++s) size_begin[s + 1] += size_begin[s];
+  std::vector<std::uint32_t> order(p.num_buckets);
+  for (std::uint32_t b = 0; b < p.num_buckets; ++b) {
+    order[size_begin[max_size - (bucket_begin[b + 1] - bucket_begin[b])]++] = b;
+  }
+
+  std::vector<std::uint64_t> taken((p.table_size + 63) / 64, 0);
+  r.pilots.assign(p.num_buckets, 0);
+  std::vector<std::uint64_t> positions(max_size);
+  for (std::uint32_t b : order) {
+    const std::uint32_t first = bucket_begin[b], size = bucket_begin[b + 1] - first;
+    if (size == 0) break;
+    std::uint64_t* keys = grouped.data() + first;
+    std::sort(keys, keys + size);
+    if (std::adjacent_find(keys, keys + size) != keys + size) {
+      r.duplicate = true;
+      return r;
+    }
+    std::uint64_t pilot = 0;
+    for (; pilot < mphf_pilot_limit; ++pilot) {
+      const std::uint64_t hp = mix64(pilot ^ mphf_pilot_salt);
+      std::uint32_t k = 0;
+      for (; k < size; ++k) {
+        const std::uint64_t pos = fastrange64(mix64(keys[k] ^ hp), p.table_size);
+        if ((taken[pos >> 6] >> (pos & 63)) & 1) break;
+        if (std::find(positions.data(), positions.data() + k, pos) != positions.data() + k) {
+          break;
+        }
+        positions[k] = pos;
+      }
+      if (k == size) {
+        for (std::uint32_t j = 0; j < size; ++j) {
+          taken[positions[j] >> 6] |= std::uint64_t{1} << (positions[j] & 63);
+        }
+        r.pilots[b] = pilot;
+        break;
+      }
+    }
+    if (pilot == mphf_pilot_limit) {
+      r.no_pilot = true;
+      return r;
+    }
+  }
+
+  // Slots past n are remapped, in order, onto the holes below n.
+  r.remap.assign(p.table_size - n, 0);
+  std::uint64_t hole = 0;
+  for (std::uint64_t pos = n; pos < p.table_size; ++pos) {
+    if ((taken[pos >> 6] >> (pos & 63)) & 1) {
+      while ((taken[hole >> 6] >> (hole & 63)) & 1) ++hole;
+      r.remap[pos - n] = hole++;
+    }
+  }
+  return r;
+}
+
+}  // namespace detail
+
+template <class Key, class Hash = seeded_hash<Key>>
+class mphf {
+ public:
+  using key_type = Key;
+  using hasher = Hash;
+
+  mphf() = default;
+
+  // Builds over the keys of a random-access range. Throws
+  // std::invalid_argument if the keys are not distinct, and
+  // std::runtime_error in the unlikely case that no seed yields a pilot
+  // below 2^32 for every bucket.
+  template <std::ranges::random_access_range R>
+  explicit mphf(const R& keys, const mphf_config& cfg = mphf_config(), const Hash& hash = Hash())
+      : hash_(hash) {
+    build(keys, cfg);
+  }
+
+  template <class K>
+  std::uint64_t operator()(const K& key) const noexcept {
+    const std::uint64_t h = hash_(key, seed_);
+    const detail::mphf_partition& p =
+        parts_[parts_.size() == 1 ? 0 : fastrange64(h, parts_.size())];
+    const std::uint64_t bucket = detail::mphf_bucket(h, p);
+    std::uint64_t pilot = bits_.get(p.pilot_bitpos + bucket * p.pilot_width, p.pilot_width);
+    if (MYSTL_UNLIKELY(pilot == escape(p.pilot_width))) pilot = exception(p, bucket);
+    const std::uint64_t pos = detail::mphf_position(h, pilot, p.table_size);
+    if (MYSTL_LIKELY(pos < p.num_keys)) return p.key_offset + pos;
+    return p.key_offset + bits_.get(p.remap_bitpos + (pos - p.num_keys) * p.remap_width,
+                                    p.remap_width);
+  }
+
+  std::uint64_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Footprint of the serialised form.
+  std::size_t num_bits() const noexcept {
+    return 8 * (sizeof(std::uint64_t) * (header_words + bits_.words().size()) +
+                sizeof(detail::mphf_partition) * parts_.size());
+  }
+  double bits_per_key() const noexcept {
+    return size_ == 0 ? 0.0 : static_cast<double>(num_bits()) / static_cast<double>(size_);
+  }
+
+  // --- serialisation ------------------------------------------------------
+  //
+  // Layout: magic, key count, seed, partition count, packed bit length,
+  // packed word count, then the partition table and the packed words. All
+  // integers are little-endian; the blob is only portable across
+  // little-endian hosts.
+
+  std::vector<std::byte> to_bytes() const {
+    std::vector<std::byte> out(num_bits() / 8);
+    std::byte* p = out.data();
+    const std::uint64_t header[header_words] = {detail::mphf_magic, size_, seed_, parts_.size(),
+                                                bits_.bit_size(), bits_.words().size()};
+    p = put(p, header, sizeof(header));
+    p = put(p, parts_.data(), parts_.size() * sizeof(detail::mphf_partition));
+    put(p, bits_.words().data(), bits_.words().size() * sizeof(std::uint64_t));
+    return out;
+  }
+
+  // Throws std::invalid_argument if the blob is truncated or inconsistent.
+  static mphf from_bytes(std::span<const std::byte> blob, const Hash& hash = Hash()) {
+    std::uint64_t header[header_words];
+    if (blob.size() < sizeof(header)) throw std::invalid_argument("mphf: truncated blob");
+    std::memcpy(header, blob.data(), sizeof(header));
+    if (header[0] != detail::mphf_magic) throw std::invalid_argument("mphf: bad magic");
+    if (header[3] == 0 || header[3] > blob.size() / sizeof(detail::mphf_partition) ||
+        header[5] > blob.size() / sizeof(std::uint64_t) ||
+        blob.size() < sizeof(header) + header[3] * sizeof(detail::mphf_partition) +
+                          header[5] * sizeof(std::uint64_t)) {
+      throw std::invalid_argument("mphf: truncated blob");
+    }
+    mphf f;
+    f.hash_ = hash;
+    f.size_ = header[1];
+    f.seed_ = header[2];
+    f.parts_.resize(header[3]);
+    f.bits_.bit_size() = header[4];
+    f.bits_.words().resize(header[5]);
+    const std::byte* p = blob.data() + sizeof(header);
+    std::memcpy(f.parts_.data(), p, f.parts_.size() * sizeof(detail::mphf_partition));
+    p += f.parts_.size() * sizeof(detail::mphf_partition);
+    std::memcpy(f.bits_.words().data(), p, f.bits_.words().size() * sizeof(std::uint64_t));
+    f.validate();
+    return f;
+  }
+
+  void save(std::ostream& os) const {
+    const std::vector<std::byte> blob = to_bytes();
+    os.write(reinterpret_cast<const char*>(blob.data()),
+             static_cast<std::streamsize>(blob.size()));
+  }
+
+  static mphf load(std::istream& is, const Hash& hash = Hash()) {
+    const std::vector<char> raw((std::istreambuf_iterator<char>(is)),
+                                std::istreambuf_iterator<char>());
+    return from_bytes(std::as_bytes(std::span(raw)), hash);
+  }
+
+ private:
+  static constexpr std::size_t header_words = 6;
+  static constexpr int max_seed_attempts = 3;
+
+  static constexpr std::uint64_t escape(unsigned width) noexcept {
+    return width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+  }
+
+  std::uint64_t exception(const detail::mphf_partition& p, std::uint64_t bucket) const noexcept {
+    std::uint32_t lo = 0, hi = p.exception_count;
+    while (hi - lo > 1) {
+      const std::uint32_t mid = lo + (hi - lo) / 2;
+      if ((bits_.get(p.exception_bitpos + 64 * std::uint64_t{mid}, 64) >> 32) <= bucket) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    return bits_.get(p.exception_bitpos + 64 * std::uint64_t{lo}, 64) & 0xFFFFFFFFu;
+  }
+
+  // Checks that every read a lookup can make stays inside the packed
+  // words, and that the partitions tile [0, size()), so that a corrupt blob
+  // is rejected rather than read out of bounds.
+  void validate() const {
+    const std::uint64_t bits = bits_.bit_size();
+    if (bits > 64 * std::uint64_t{bits_.words().size()}) {
+      throw std::invalid_argument("mphf: bad blob");
+    }
+    const auto fits = [bits](std::uint64_t bitpos, std::uint64_t count, unsigned width) {
+      if (width > 64 || (width != 0 && count > bits / width)) return false;
+      return bitpos <= bits - count * width;
+    };
+    std::uint64_t offset = 0;
+    for (const detail::mphf_partition& p : parts_) {
+      if (p.key_offset != offset || p.num_keys > size_ - offset || p.num_buckets == 0 ||
+          p.dense_buckets >= p.num_buckets || p.pilot_width == 0 ||
+          p.table_size < p.num_keys || (p.table_size == 0 && p.remap_width != 0) ||
+          !fits(p.pilot_bitpos, p.num_buckets, p.pilot_width) ||
+          !fits(p.exception_bitpos, p.exception_count, 64) ||
+          !fits(p.remap_bitpos, p.table_size - p.num_keys, p.remap_width)) {
+        throw std::invalid_argument("mphf: bad blob");
+      }
+      if (p.exception_count == 0) {
+        const std::uint64_t esc = escape(p.pilot_width);
+        for (std::uint64_t b = 0; b < p.num_buckets; ++b) {
+          if (bits_.get(p.pilot_bitpos + b * p.pilot_width, p.pilot_width) == esc) {
+            throw std::invalid_argument("mphf: bad blob");
+          }
+        }
+      }
+      offset += p.num_keys;
+    }
+    if (offset != size_) throw std::invalid_argument("mphf: bad blob");
+  }
+
+  static std::byte* put(std::byte* out, const void* src, std::size_t n) {
+    std::memcpy(out, src, n);
+    return out + n;
+  }
+
+  template <class R>
+  void build(const R& keys, const mphf_config& cfg) {
+    size_ = static_cast<std::uint64_t>(std::ranges::size(keys));
+    const std::size_t num_parts = static_cast<std::size_t>(
+        std::max<std::uint64_t>(1, (size_ + cfg.partition_size - 1) / cfg.partition_size));
+    unsigned threads = cfg.threads != 0 ? cfg.threads : std::thread::hardware_concurrency();
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(num_parts)));
+
+    std::vector<std::uint64_t> hashes(size_);
+    std::vector<std::uint64_t> grouped(size_);
+    bool last_failure_duplicate = true;
+    for (int attempt = 0; attempt < max_seed_attempts; ++attempt) {
+      seed_ = cfg.seed + static_cast<std::uint64_t>(attempt);
+      parallel_for(std::max<std::size_t>(1, std::min<std::size_t>(threads, size_ / 4096 + 1)),
+                   [&](std::size_t t, std::size_t nt) {
+                     const std::uint64_t lo = size_ * t / nt, hi = size_ * (t + 1) / nt;
+                     auto it = std::ranges::begin(keys) + static_cast<std::ptrdiff_t>(lo);
+                     for (std::uint64_t i = lo; i < hi; ++i, ++it) hashes[i] = hash_(*it, seed_);
+                   });
+
+      parts_.assign(num_parts, detail::mphf_partition{});
+      std::vector<std::uint64_t> fill(num_parts + 1, 0);
+      for (std::uint64_t h : hashes) {
+        ++fill[(num_parts == 1 ? 0 : fastrange64(h, num_parts)) + 1];
+      }
+      for (std::size_t i = 0; i < num_parts; ++i) {
+        fill[i + 1] += fill[i];
+        parts_[i].key_offset = fill[i];
+      }
+      for (std::uint64_t h : hashes) {
+        grouped[fill[num_parts == 1 ? 0 : fastrange64(h, num_parts)]++] = h;
+      }
+
+      std::vector<detail::mphf_partition_result> results(num_parts);
+      std::atomic<std::size_t> next{0};
+      std::atomic<bool> duplicate{false}, no_pilot{false};
+      parallel_for(threads, [&](std::size_t, std::size_t) {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < num_parts;) {
+          const std::uint64_t first = parts_[i].key_offset;
+          const std::uint64_t last = i + 1 < num_parts ? parts_[i + 1].key_offset : size_;
+          results[i] = detail::mphf_build_partition(
+              std::span<const std::uint64_t>(grouped.data() + first, last - first), parts_[i], cfg);
+          if (results[i].duplicate || results[i].no_pilot) {
+            (results[i].duplicate ? duplicate : no_pilot).store(true, std::memory_order_relaxed);
+            return;
+          }
+        }
+      });
+      if (duplicate.load() || no_pilot.load()) {
+        last_failure_duplicate = duplicate.load();
+        continue;
+      }
+
+      bits_ = detail::bit_packed_words();
+      for (std::size_t i = 0; i < num_parts; ++i) {
+        detail::mphf_partition& p = parts_[i];
+        std::vector<std::uint64_t>& pilots = results[i].pilots;
+        p.pilot_width = static_cast<std::uint8_t>(detail::mphf_pilot_width(pilots));
+        const std::uint64_t esc = escape(p.pilot_width);
+        std::vector<std::uint64_t> exceptions;
+        for (std::size_t b = 0; b < pilots.size(); ++b) {
+          if (pilots[b] >= esc) {
+            exceptions.push_back(static_cast<std::uint64_t>(b) << 32 | pilots[b]);
+            pilots[b] = esc;
+          }
+        }
+        p.pilot_bitpos = bits_.append(pilots, p.pilot_width);
+        p.exception_count = static_cast<std::uint32_t>(exceptions.size());
+        p.exception_bitpos = bits_.append(exceptions, 64);
+        p.remap_width = static_cast<std::uint8_t>(
+            std::bit_width(p.num_keys == 0 ? std::uint64_t{0} : p.num_keys - 1));
+        p.remap_bitpos = bits_.append(results[i].remap, p.remap_width);
+        results[i] = {};
+      }
+      return;
+    }
+    if (last_failure_duplicate) throw std::invalid_argument("mphf: keys are not distinct");
+    throw std::runtime_error("mphf: no pilot found for some bucket");
+  }
+
+  // Runs fn(t, nt) for t in [0, nt), on nt - 1 extra threads plus the
+  // calling thread, and rethrows the first exception. If a thread cannot be
+  // started, the calling thread also runs the slices that did not get one.
+  template <class Fn>
+  static void parallel_for(std::size_t nt, Fn fn) {
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(nt);
+    workers.reserve(nt - 1);
+    auto run = [&](std::size_t t) {
+      try {
+        fn(t, nt);
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+    };
+    std::size_t started = 1;
+    try {
+      for (; started < nt; ++started) workers.emplace_back(run, started);
+    } catch (const std::system_error&) {
+      // Out of threads: slices [started, nt) run on this thread below.
+    }
+    run(0);
+    for (std::size_t t = started; t < nt; ++t) run(t);
+    for (std::thread& w : workers) w.join();
+    for (const std::exception_ptr& e : errors) {
+      if (e) std::rethrow_exception(e);
+    }
+  }
+
+  std::uint64_t size_ = 0;
+  std::uint64_t seed_ = 0;
+  std::vector<detail::mphf_partition> parts_{detail::mphf_partition{}};
+  detail::bit_packed_words bits_;
+  [[no_unique_address]] Hash hash_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,292 @@
+#pragma once
+
+// NUMA placement for large arrays.
+//
+//   auto res = mystl::numa_memory_resource::interleaved();
+//   std::pmr::vector<double> v(&res);
+//
+//   double* a = static_cast<double*>(::operator new(n * sizeof(double)));
+//   mystl::parallel_uninitialized_value_construct(a, a + n);
+//
+// numa_memory_resource maps every allocation separately and attaches an
+// mbind() policy to it: node-local (preferred node, falling back to others
+// when that node is full) or interleaved page by page across a node set.
+// It is meant for large arrays or as the upstream of a pool resource, not
+// for small objects.
+//
+// parallel_uninitialized_value_construct splits a range into page-aligned
+// slices, one per worker, and has worker t prefer node t % numa_node_count()
+// while it touches its slice, so first-touch placement spreads fresh memory
+// over every node instead of the node of the constructing thread.
+//
+// Placement is best effort. Off Linux, or where the syscalls are refused
+// (containers, seccomp), the policies are skipped and both facilities still
+// work with whatever placement the kernel chooses; on a single node the
+// policies are accepted and have no effect.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mystl {
+
+namespace detail {
+
+inline std::size_t os_page_size() noexcept {
+#if defined(__linux__)
+  static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+// Node masks are limited to 64 nodes. The kernel reads maxnode - 1 bits.
+#if defined(__linux__)
+inline bool set_mempolicy_mask(int mode, std::uint64_t nodes) noexcept {
+  unsigned long mask[64 / (8 * sizeof(unsigned long))] = {};
+  for (std::size_t i = 0; i < std::size(mask); ++i) {
+    mask[i] = static_cast<unsigned long>(nodes >> (i * 8 * sizeof(unsigned long)));
+  }
+  return ::syscall(SYS_set_mempolicy, mode, nodes ? mask : nullptr, nodes ? 65ul : 0ul) == 0;
+}
+
+inline bool mbind_mask(void* addr, std::size_t length, int mode, std::uint64_t nodes) noexcept {
+  unsigned long mask[64 / (8 * sizeof(unsigned long))] = {};
+  for (std::size_t i = 0; i < std::size(mask); ++i) {
+    mask[i] = static_cast<unsigned long>(nodes >> (i * 8 * sizeof(unsigned long)));
+  }
+  return ::syscall(SYS_mbind, addr, length, mode, mask, 65ul, 0u) == 0;
+}
+#endif
+
+// Parses a sysfs node list such as "0-1,3".
+inline std::uint64_t parse_node_list(const std::string& list) noexcept {
+  std::uint64_t mask = 0;
+  std::size_t i = 0;
+  auto number = [&] {
+    unsigned v = 0;
+    while (i < list.size() && list[i] >= '0' && list[i] <= '9') {
+      v = v * 10 + unsigned(list[i++] - '0');
+    }
+    return v;
+  };
+  while (i < list.size()) {
+    const unsigned lo = number();
+    unsigned hi = lo;
+    if (i < list.size() && list[i] == '-') {
+      ++i;
+      hi = number();
+    }
+    for (unsigned n = lo; n <= hi && n < 64; ++n) mask |= std::uint64_t{1} << n;
+    if (i < list.size() && list[i] != ',') break;
+    ++i;
+  }
+  return mask;
+}
+
+}  // namespace detail
+
+// Bit n is set if NUMA node n is online. A machine without NUMA support
+// reports a single node 0.
+inline std::uint64_t numa_online_nodes() noexcept {
+  static const std::uint64_t nodes = [] {
+    std::uint64_t mask = 0;
+#if defined(__linux__)
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string list;
+    if (in && std::getline(in, list)) mask = detail::parse_node_list(list);
+#endif
+    return mask ? mask : std::uint64_t{1};
+  }();
+  return nodes;
+}
+
+inline std::size_t numa_node_count() noexcept {
+  return static_cast<std::size_t>(std::popcount(numa_online_nodes()));
+}
+
+enum class numa_policy {
+  node_local,  // prefer one node, spill to others when it is full
+  interleave,  // round-robin pages across a node set
+};
+
+class numa_memory_resource final : public std::pmr::memory_resource {
+ public:
+  // Node sets are 64-bit masks; throws std::invalid_argument for node >= 64.
+  static numa_memory_resource on_node(unsigned node) {
+    if (node >= 64) {
+      throw std::invalid_argument("numa_memory_resource::on_node: node must be below 64");
+    }
+    return numa_memory_resource(numa_policy::node_local, std::uint64_t{1} << node);
+  }
+  static numa_memory_resource interleaved(std::uint64_t nodes = numa_online_nodes()) {
+    return numa_memory_resource(numa_policy::interleave, nodes);
+  }
+
+  numa_memory_resource(numa_policy policy, std::uint64_t nodes) noexcept
+      : policy_(policy), nodes_(nodes) {}
+
+  numa_policy policy() const noexcept { return policy_; }
+  std::uint64_t nodes() const noexcept { return nodes_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+#if defined(__linux__)
+    const std::size_t page = detail::os_page_size();
+    const std::size_t length = round_up(std::max<std::size_t>(bytes, 1), page);
+    const std::size_t slack = alignment > page ? alignment : 0;
+    void* raw = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    auto* first = static_cast<char*>(raw);
+    auto* p = first;
+    if (slack != 0) {
+      p = reinterpret_cast<char*>(round_up(reinterpret_cast<std::uintptr_t>(first), alignment));
+      if (p != first) ::munmap(first, static_cast<std::size_t>(p - first));
+      const std::size_t tail = static_cast<std::size_t>(first + slack - p);
+      if (tail != 0) ::munmap(p + length, tail);
+    }
+    if (const std::uint64_t nodes = nodes_ & numa_online_nodes()) {
+      const int mode = policy_ == numa_policy::interleave ? MPOL_INTERLEAVE : MPOL_PREFERRED;
+      detail::mbind_mask(p, length, mode, nodes);
+    }
+    return p;
+#else
+    return ::operator new(bytes, std::align_val_t{alignment});
+#endif
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override {
+#if defined(__linux__)
+    (void)alignment;
+    ::munmap(p, round_up(std::max<std::size_t>(bytes, 1), detail::os_page_size()));
+#else
+    ::operator delete(p, bytes, std::align_val_t{alignment});
+#endif
+  }
+
+  // Deallocation does not depend on the policy, so any two instances can
+  // free each other's memory.
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return dynamic_cast<const numa_memory_resource*>(&other) != nullptr;
+  }
+
+  static constexpr std::size_t round_up(std::size_t n, std::size_t a) noexcept {
+    return (n + a - 1) & ~(a - 1);
+  }
+
+  numa_policy policy_;
+  std::uint64_t nodes_;
+};
+
+// Value-initialises the uninitialised range [first, last) on up to threads
+// workers (0: one per hardware thread, at most one per MiB of data), each
+// constructing a page-aligned slice. On more than one node, worker t prefers
+// the t-th online node while it runs, so fresh pages land evenly across
+// nodes. If a constructor throws, every element constructed so far is
+// destroyed and the first exception is rethrown; the same happens with the
+// std::system_error when a worker thread cannot be started.
+template <std::contiguous_iterator It>
+void parallel_uninitialized_value_construct(It first, It last, std::size_t threads = 0) {
+  using T = std::iter_value_t<It>;
+  T* const base = std::to_address(first);
+  const auto n = static_cast<std::size_t>(last - first);
+  if (n == 0) return;
+
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min(threads, n * sizeof(T) / (std::size_t{1} << 20) + 1);
+
+  // Slice t starts at the first element at or after the t-th page-aligned
+  // split point, so no page is touched by two workers' first writes.
+  const std::size_t page = detail::os_page_size();
+  std::vector<std::size_t> bounds(threads + 1, n);
+  bounds[0] = 0;
+  for (std::size_t t = 1; t < threads; ++t) {
+    const auto addr = reinterpret_cast<std::uintptr_t>(base) + n * sizeof(T) / threads * t;
+    const std::uintptr_t split = (addr + page - 1) & ~std::uintptr_t(page - 1);
+    const std::size_t offset = split - reinterpret_cast<std::uintptr_t>(base);
+    bounds[t] = std::min(n, std::max(bounds[t - 1], (offset + sizeof(T) - 1) / sizeof(T)));
+  }
+
+  std::vector<int> node_of(threads, -1);
+#if defined(__linux__)
+  if (numa_node_count() > 1) {
+    const std::uint64_t online = numa_online_nodes();
+    std::vector<int> nodes;
+    for (int i = 0; i < 64; ++i) {
+      if (online >> i & 1) nodes.push_back(i);
+    }
+    for (std::size_t t = 0; t < threads; ++t) node_of[t] = nodes[t % nodes.size()];
+  }
+#endif
+
+  std::vector<std::exception_ptr> errors(threads);
+  auto run = [&](std::size_t t) {
+#if defined(__linux__)
+    const bool placed = node_of[t] >= 0 &&
+                        detail::set_mempolicy_mask(MPOL_PREFERRED, std::uint64_t{1} << node_of[t]);
+#endif
+    try {
+      std::uninitialized_value_construct(base + bounds[t], base + bounds[t + 1]);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+#if defined(__linux__)
+    if (placed) detail::set_mempolicy_mask(MPOL_DEFAULT, 0);
+#endif
+  };
+
+  // With placement, every slice runs on its own thread so that the calling
+  // thread's memory policy is never changed.
+  const std::size_t inline_slices = node_of[0] >= 0 ? 0 : 1;
+  std::vector<std::thread> workers;
+  workers.reserve(threads - inline_slices);
+  // Only slices [first, last) are constructed; the others are left untouched.
+  auto unwind = [&](std::size_t first, std::size_t last) {
+    for (std::size_t t = first; t < last; ++t) {
+      if (!errors[t]) std::destroy(base + bounds[t], base + bounds[t + 1]);
+    }
+  };
+  std::size_t started = inline_slices;
+  try {
+    for (; started < threads; ++started) workers.emplace_back(run, started);
+  } catch (...) {
+    // A thread failed to start: wait for the ones that did and undo their
+    // slices before reporting the error.
+    for (std::thread& w : workers) w.join();
+    unwind(inline_slices, started);
+    throw;
+  }
+  if (inline_slices) run(0);
+  for (std::thread& w : workers) w.join();
+
+  const auto failed = std::find_if(errors.begin(), errors.end(),
+                                   [](const std::exception_ptr& e) { return e != nullptr; });
+  if (failed != errors.end()) {
+    unwind(0, threads);
+    std::rethrow_exception(*failed);
+  }
+}
+
+}  // namespace mystl
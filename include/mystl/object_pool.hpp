@@ -0,0 +1,323 @@
+#pragma once
+
+// Fixed-size block pools with per-thread magazines (Bonwick & Adams).
+//
+//   mystl::object_pool<message> pool;
+//   message* m = pool.create(id, payload);
+//   pool.destroy(m);
+//
+//   std::list<int, mystl::pool_allocator<int>> l;  // nodes come from the pool
+//
+// Every (size, alignment) class has one process-wide depot that carves
+// blocks out of 64 KiB slabs (huge_node_allocator plugs in 2 MiB huge-page
+// slabs instead). Each thread caches up to two magazines of 64
+// block pointers for each class it uses, so an allocation or a free is
+// normally a pop or a push on a thread-local array, with no atomics. Blocks
+// freed by a thread other than the one that allocated them simply enter the
+// freeing thread's magazine; they reach other threads 64 at a time when a
+// full magazine is exchanged with the depot, which is the only locked step.
+//
+// Slabs are never returned to the system. The depots are intentionally
+// immortal, so pooled objects may be freed from static destructors and from
+// other thread_local destructors.
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+inline constexpr std::size_t pool_magazine_capacity = 64;
+inline constexpr std::size_t pool_slab_size = std::size_t{64} << 10;
+
+struct pool_magazine {
+  std::size_t count = 0;
+  pool_magazine* next = nullptr;
+  void* items[pool_magazine_capacity];
+};
+
+// Where a depot's slabs come from: slab_size bytes at a time, or one block
+// when blocks are larger. Slabs are never freed.
+struct pool_slab_source {
+  static constexpr std::size_t slab_size = pool_slab_size;
+  static void* allocate(std::size_t bytes, std::size_t alignment) {
+    return ::operator new(bytes, std::align_val_t{alignment});
+  }
+};
+
+class pool_depot {
+ public:
+  using slab_allocate_fn = void* (*)(std::size_t bytes, std::size_t alignment);
+
+  pool_depot(std::size_t block_size, std::size_t alignment,
+             std::size_t slab_size = pool_slab_source::slab_size,
+             slab_allocate_fn allocate_slab = &pool_slab_source::allocate) noexcept
+      : block_size_(block_size),
+        alignment_(alignment),
+        slab_size_(slab_size),
+        allocate_slab_(allocate_slab) {}
+
+  pool_depot(const pool_depot&) = delete;
+  pool_depot& operator=(const pool_depot&) = delete;
+
+  // Takes back a drained magazine (or null) and hands out a non-empty one,
+  // carving fresh blocks if no full magazine is in stock.
+  pool_magazine* exchange_for_full(pool_magazine* drained) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (drained) push(empty_, drained);
+    if (full_) return pop(full_);
+    pool_magazine* m = empty_ ? pop(empty_) : new pool_magazine;
+    try {
+      while (m->count < pool_magazine_capacity) m->items[m->count++] = carve();
+    } catch (...) {
+      if (m->count == 0) {
+        push(empty_, m);
+        throw;
+      }
+    }
+    return m;
+  }
+
+  // Takes back a filled magazine (or null) and hands out an empty one.
+  pool_magazine* exchange_for_empty(pool_magazine* filled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (filled) push(full_, filled);
+    return empty_ ? pop(empty_) : new pool_magazine;
+  }
+
+  void release(pool_magazine* m) noexcept {
+    if (!m) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    push(m->count ? full_ : empty_, m);
+  }
+
+  // Single-block paths for threads whose cache has already been torn down.
+  void* allocate_one() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (full_) {
+      void* p = full_->items[--full_->count];
+      if (full_->count == 0) push(empty_, pop(full_));
+      return p;
+    }
+    return carve();
+  }
+
+  void deallocate_one(void* p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!full_ || full_->count == pool_magazine_capacity) {
+      push(full_, empty_ ? pop(empty_) : new pool_magazine);
+    }
+    full_->items[full_->count++] = p;
+  }
+
+ private:
+  static void push(pool_magazine*& list, pool_magazine* m) noexcept {
+    m->next = list;
+    list = m;
+  }
+  static pool_magazine* pop(pool_magazine*& list) noexcept {
+    pool_magazine* m = list;
+    list = m->next;
+    m->next = nullptr;
+    return m;
+  }
+
+  void* carve() {
+    if (static_cast<std::size_t>(slab_end_ - slab_cur_) < block_size_) {
+      const std::size_t size = std::max(slab_size_, block_size_);
+      slab_cur_ = static_cast<char*>(allocate_slab_(size, alignment_));
+      slab_end_ = slab_cur_ + size;
+    }
+    void* p = slab_cur_;
+    slab_cur_ += block_size_;
+    return p;
+  }
+
+  std::mutex mutex_;
+  pool_magazine* full_ = nullptr;
+  pool_magazine* empty_ = nullptr;
+  char* slab_cur_ = nullptr;
+  char* slab_end_ = nullptr;
+  std::size_t block_size_;
+  std::size_t alignment_;
+  std::size_t slab_size_;
+  slab_allocate_fn allocate_slab_;
+};
+
+// Per-thread cache state. Trivially destructible so that it stays usable
+// after the thread's cache_owner has flushed it during thread exit.
+struct pool_thread_cache {
+  pool_magazine* loaded = nullptr;
+  pool_magazine* previous = nullptr;
+  bool registered = false;
+  bool exiting = false;
+};
+
+template <std::size_t Size, std::size_t Align, class SlabSource = pool_slab_source>
+class fixed_size_pool {
+ public:
+  static constexpr std::size_t alignment = std::max(Align, alignof(void*));
+  static constexpr std::size_t block_size = (std::max(Size, sizeof(void*)) + alignment - 1) /
+                                            alignment * alignment;
+
+  static void* allocate() {
+    pool_thread_cache& c = cache_;
+    if (MYSTL_LIKELY(c.loaded && c.loaded->count != 0)) return c.loaded->items[--c.loaded->count];
+    return allocate_slow(c);
+  }
+
+  static void deallocate(void* p) noexcept {
+    pool_thread_cache& c = cache_;
+    if (MYSTL_LIKELY(c.loaded && c.loaded->count != pool_magazine_capacity)) {
+      c.loaded->items[c.loaded->count++] = p;
+      return;
+    }
+    deallocate_slow(c, p);
+  }
+
+ private:
+  static pool_depot& depot() {
+    static pool_depot* const d =
+        new pool_depot(block_size, alignment, SlabSource::slab_size, &SlabSource::allocate);
+    return *d;
+  }
+
+  // Returns the thread's magazines to the depot when the thread exits.
+  struct cache_owner {
+    ~cache_owner() {
+      pool_thread_cache& c = cache_;
+      depot().release(c.loaded);
+      depot().release(c.previous);
+      c.loaded = c.previous = nullptr;
+      c.exiting = true;
+    }
+  };
+
+  static void register_thread(pool_thread_cache& c) {
+    static thread_local cache_owner owner;
+    (void)owner;
+    c.registered = true;
+  }
+
+  static void* allocate_slow(pool_thread_cache& c) {
+    if (c.exiting) return depot().allocate_one();
+    if (!c.registered) register_thread(c);
+    if (c.previous && c.previous->count != 0) {
+      std::swap(c.loaded, c.previous);
+    } else {
+      pool_magazine* drained = c.previous;
+      c.previous = c.loaded;
+      c.loaded = nullptr;
+      c.loaded = depot().exchange_for_full(drained);
+    }
+    return c.loaded->items[--c.loaded->count];
+  }
+
+  static void deallocate_slow(pool_thread_cache& c, void* p) noexcept {
+    try {
+      if (c.exiting) return depot().deallocate_one(p);
+      if (!c.registered) register_thread(c);
+      if (c.previous && c.previous->count != pool_magazine_capacity) {
+        std::swap(c.loaded, c.previous);
+      } else {
+        pool_magazine* filled = c.previous;
+        c.previous = c.loaded;
+        c.loaded = nullptr;
+        c.loaded = depot().exchange_for_empty(filled);
+      }
+      c.loaded->items[c.loaded->count++] = p;
+    } catch (...) {
+      // Out of memory for a new magazine: the block is leaked rather than
+      // failing a noexcept free.
+    }
+  }
+
+  static inline thread_local pool_thread_cache cache_{};
+};
+
+}  // namespace detail
+
+// Allocator whose single-object allocations come from the pool for
+// sizeof(T); array allocations go to operator new. Node-based containers
+// rebind it to their node type, so every node is a pooled block.
+template <class T>
+class pool_allocator {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  constexpr pool_allocator() noexcept = default;
+  template <class U>
+  constexpr pool_allocator(const pool_allocator<U>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_type n) {
+    if (n == 1) return static_cast<T*>(pool::allocate());
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_type n) noexcept {
+    if (n == 1) {
+      pool::deallocate(p);
+    } else {
+      std::allocator<T>().deallocate(p, n);
+    }
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const pool_allocator&, const pool_allocator<U>&) noexcept {
+    return true;
+  }
+
+ private:
+  using pool = detail::fixed_size_pool<sizeof(T), alignof(T)>;
+};
+
+// Constructs and destroys T objects in pooled blocks. All object_pool<T>
+// instances share the pool for sizeof(T), so an object may be destroyed
+// through any instance and on any thread.
+template <class T>
+class object_pool {
+ public:
+  struct deleter {
+    void operator()(T* p) const noexcept { object_pool().destroy(p); }
+  };
+  using unique_ptr = std::unique_ptr<T, deleter>;
+
+  template <class... Args>
+  [[nodiscard]] T* create(Args&&... args) {
+    void* p = pool::allocate();
+    try {
+      return ::new (p) T(std::forward<Args>(args)...);
+    } catch (...) {
+      pool::deallocate(p);
+      throw;
+    }
+  }
+
+  void destroy(T* p) noexcept {
+    if (!p) return;
+    p->~T();
+    pool::deallocate(p);
+  }
+
+  template <class... Args>
+  [[nodiscard]] unique_ptr make_unique(Args&&... args) {
+    return unique_ptr(create(std::forward<Args>(args)...));
+  }
+
+ private:
+  using pool = detail::fixed_size_pool<sizeof(T), alignof(T)>;
+};
+
+}  // namespace mystl
@@ -0,0 +1,322 @@
+#pragma once
+
+// Immutable maps and sets over a key list that is known at compile time,
+// backed by a minimal perfect hash built in a constant expression.
+//
+//   constexpr auto keywords = mystl::make_perfect_hash_map<std::string_view, token>({
+//       {"if", token::kw_if}, {"else", token::kw_else}, {"while", token::kw_while}});
+//   static_assert(keywords.at("else") == token::kw_else);
+//
+// The hash follows the hash-and-displace scheme (CHD / PTHash): keys are
+// split into about N/2 buckets by one hash; buckets are placed largest first
+// by searching, per bucket, for a seed under which all of its keys land on
+// distinct free slots of an N-slot table. Single-key buckets are placed last
+// and store their slot directly. A lookup is two hashes, one table read and
+// one key comparison, with no probing.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "algorithm.hpp"
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Upper bound on seeds tried for one bucket before the whole build restarts
+// with a different bucket seed.
+inline constexpr std::int32_t phf_max_displacement = 1 << 16;
+
+template <class Key, std::size_t N, class Hash>
+class perfect_hash_index {
+ public:
+  static constexpr std::size_t bucket_count = N / 2 + 1;
+
+  constexpr explicit perfect_hash_index(const Hash& hash) : hash_(hash) {}
+
+  // Builds the index for keys and returns the table slot of every key.
+  // Throws std::invalid_argument (a compile error in a constant expression)
+  // if keys contains duplicates.
+  template <class KeyEqual>
+  constexpr std::array<std::size_t, N> build(const std::array<Key, N>& keys, const KeyEqual& eq) {
+    std::array<std::size_t, N> slot_of{};
+    for (bucket_seed_ = ~std::uint64_t{0};; --bucket_seed_) {
+      if (try_build(keys, slot_of, eq)) return slot_of;
+    }
+  }
+
+  template <class K>
+  constexpr std::size_t slot(const K& key) const noexcept {
+    return slot_in(key, disp_[bucket(key)]);
+  }
+
+  // Slots of up to batch_group_size keys. Every displacement is prefetched
+  // before the first one is read so that the table misses overlap.
+  template <class K>
+  constexpr void slots(std::span<const K> keys, std::size_t* out) const noexcept {
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      out[k] = bucket(keys[k]);
+      if (!std::is_constant_evaluated()) MYSTL_PREFETCH(&disp_[out[k]]);
+    }
+    for (std::size_t k = 0; k < keys.size(); ++k) out[k] = slot_in(keys[k], disp_[out[k]]);
+  }
+
+ private:
+  template <class K>
+  constexpr std::size_t bucket(const K& key) const noexcept {
+    return static_cast<std::size_t>(fastrange64(hash_(key, bucket_seed_), bucket_count));
+  }
+
+  template <class K>
+  constexpr std::size_t slot_in(const K& key, std::int32_t d) const noexcept {
+    if (d < 0) return static_cast<std::size_t>(-(d + 1));
+    return static_cast<std::size_t>(fastrange64(hash_(key, static_cast<std::uint64_t>(d)), N));
+  }
+
+  template <class KeyEqual>
+  constexpr bool try_build(const std::array<Key, N>& keys, std::array<std::size_t, N>& slot_of,
+                           const KeyEqual& eq) {
+    std::array<std::size_t, N> bucket_of{};
+    std::array<std::size_t, bucket_count> bucket_size{};
+    std::array<std::size_t, N> order{};
+    for (std::size_t i = 0; i < N; ++i) {
+      bucket_of[i] = bucket(keys[i]);
+      ++bucket_size[bucket_of[i]];
+      order[i] = i;
+    }
+    // Largest buckets first; keys of one bucket adjacent.
+    mystl::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      const std::size_t ba = bucket_of[a], bb = bucket_of[b];
+      if (bucket_size[ba] != bucket_size[bb]) return bucket_size[ba] > bucket_size[bb];
+      return ba < bb;
+    });
+
+    std::array<bool, N> taken{};
+    std::size_t i = 0;
+    for (; i < N && bucket_size[bucket_of[order[i]]] > 1; i += bucket_size[bucket_of[order[i]]]) {
+      const std::size_t b = bucket_of[order[i]];
+      const std::size_t size = bucket_size[b];
+      for (std::size_t x = i; x < i + size; ++x) {
+        for (std::size_t y = x + 1; y < i + size; ++y) {
+          if (eq(keys[order[x]], keys[order[y]])) {
+            throw std::invalid_argument("perfect_hash_map: duplicate key");
+          }
+        }
+      }
+      std::int32_t d = 0;
+      for (; d < phf_max_displacement; ++d) {
+        if (try_place(keys, order, i, size, d, taken, slot_of)) break;
+      }
+      if (d == phf_max_displacement) return false;
+      disp_[b] = d;
+    }
+    std::size_t free_slot = 0;
+    for (; i < N; ++i) {
+      while (taken[free_slot]) ++free_slot;
+      taken[free_slot] = true;
+      slot_of[order[i]] = free_slot;
+      disp_[bucket_of[order[i]]] = -static_cast<std::int32_t>(free_slot) - 1;
+    }
+    return true;
+  }
+
+  constexpr bool try_place(const std::array<Key, N>& keys, const std::array<std::size_t, N>& order,
+                           std::size_t first, std::size_t size, std::int32_t d,
+                           std::array<bool, N>& taken,
+                           std::array<std::size_t, N>& slot_of) const {
+    for (std::size_t x = first; x < first + size; ++x) {
+      const auto s = static_cast<std::size_t>(
+          fastrange64(hash_(keys[order[x]], static_cast<std::uint64_t>(d)), N));
+      if (taken[s]) {
+        for (std::size_t y = first; y < x; ++y) taken[slot_of[order[y]]] = false;
+        return false;
+      }
+      taken[s] = true;
+      slot_of[order[x]] = s;
+    }
+    return true;
+  }
+
+  std::uint64_t bucket_seed_ = 0;
+  std::array<std::int32_t, bucket_count> disp_{};
+  [[no_unique_address]] Hash hash_{};
+};
+
+// Shared body of perfect_hash_map/set::find_batch: slots for a group of keys,
+// then a prefetch of every candidate entry, then the key comparisons.
+template <class Index, class Entry, std::size_t N, class Key, class Match>
+constexpr std::size_t perfect_hash_find_batch(const Index& index,
+                                              const std::array<Entry, N>& entries,
+                                              std::span<const Key> keys,
+                                              std::span<const Entry*> out, Match match) noexcept {
+  std::size_t found = 0;
+  if constexpr (N == 0) {
+    for (std::size_t k = 0; k < keys.size(); ++k) out[k] = entries.data();
+  } else {
+    std::size_t s[batch_group_size];
+    for (std::size_t base = 0; base < keys.size(); base += batch_group_size) {
+      const std::size_t g = std::min(batch_group_size, keys.size() - base);
+      index.slots(keys.subspan(base, g), s);
+      if (!std::is_constant_evaluated()) {
+        for (std::size_t k = 0; k < g; ++k) MYSTL_PREFETCH(&entries[s[k]]);
+      }
+      for (std::size_t k = 0; k < g; ++k) {
+        const bool hit = match(entries[s[k]], keys[base + k]);
+        found += hit;
+        out[base + k] = hit ? &entries[s[k]] : entries.data() + N;
+      }
+    }
+  }
+  return found;
+}
+
+}  // namespace detail
+
+template <class Key, class T, std::size_t N, class Hash = seeded_hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class perfect_hash_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_reference = const value_type&;
+  using const_iterator = const value_type*;
+  using iterator = const_iterator;
+
+  constexpr explicit perfect_hash_map(const std::array<value_type, N>& items,
+                                      const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual())
+      : index_(hash), eq_(eq) {
+    std::array<Key, N> keys{};
+    for (std::size_t i = 0; i < N; ++i) keys[i] = items[i].first;
+    const std::array<std::size_t, N> slot_of = index_.build(keys, eq);
+    for (std::size_t i = 0; i < N; ++i) items_[slot_of[i]] = items[i];
+  }
+
+  constexpr const_iterator find(const Key& key) const noexcept {
+    if constexpr (N == 0) {
+      return end();
+    } else {
+      const value_type& v = items_[index_.slot(key)];
+      return eq_(v.first, key) ? &v : end();
+    }
+  }
+
+  // Writes find(keys[i]) to out[i] and returns the number of keys found.
+  // Lookups are resolved batch_group_size at a time with every table access
+  // of a group prefetched before any is used.
+  constexpr size_type find_batch(std::span<const Key> keys,
+                                 std::span<const_iterator> out) const noexcept {
+    return detail::perfect_hash_find_batch(index_, items_, keys, out,
+                                           [&](const value_type& v, const Key& key) {
+                                             return eq_(v.first, key);
+                                           });
+  }
+
+  constexpr bool contains(const Key& key) const noexcept { return find(key) != end(); }
+  constexpr size_type count(const Key& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  constexpr const T& at(const Key& key) const {
+    const_iterator it = find(key);
+    if (it == end()) throw std::out_of_range("perfect_hash_map::at");
+    return it->second;
+  }
+
+  // Iteration is in table order, not insertion order.
+  constexpr const_iterator begin() const noexcept { return items_.data(); }
+  constexpr const_iterator end() const noexcept { return items_.data() + N; }
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return N == 0; }
+  static constexpr size_type size() noexcept { return N; }
+
+ private:
+  detail::perfect_hash_index<Key, N, Hash> index_;
+  std::array<value_type, N> items_{};
+  [[no_unique_address]] KeyEqual eq_{};
+};
+
+template <class Key, std::size_t N, class Hash = seeded_hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class perfect_hash_set {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_reference = const value_type&;
+  using const_iterator = const value_type*;
+  using iterator = const_iterator;
+
+  constexpr explicit perfect_hash_set(const std::array<Key, N>& keys, const Hash& hash = Hash(),
+                                      const KeyEqual& eq = KeyEqual())
+      : index_(hash), eq_(eq) {
+    const std::array<std::size_t, N> slot_of = index_.build(keys, eq);
+    for (std::size_t i = 0; i < N; ++i) keys_[slot_of[i]] = keys[i];
+  }
+
+  constexpr const_iterator find(const Key& key) const noexcept {
+    if constexpr (N == 0) {
+      return end();
+    } else {
+      const value_type& k = keys_[index_.slot(key)];
+      return eq_(k, key) ? &k : end();
+    }
+  }
+
+  // Writes find(keys[i]) to out[i] and returns the number of keys found.
+  constexpr size_type find_batch(std::span<const Key> keys,
+                                 std::span<const_iterator> out) const noexcept {
+    const auto eq = [&](const Key& k, const Key& key) { return eq_(k, key); };
+    return detail::perfect_hash_find_batch(index_, keys_, keys, out, eq);
+  }
+
+  constexpr bool contains(const Key& key) const noexcept { return find(key) != end(); }
+  constexpr size_type count(const Key& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  // Dense index in [0, size()) of a member key; unspecified for non-members.
+  constexpr size_type index_of(const Key& key) const noexcept {
+    return N == 0 ? 0 : index_.slot(key);
+  }
+
+  constexpr const_iterator begin() const noexcept { return keys_.data(); }
+  constexpr const_iterator end() const noexcept { return keys_.data() + N; }
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return N == 0; }
+  static constexpr size_type size() noexcept { return N; }
+
+ private:
+  detail::perfect_hash_index<Key, N, Hash> index_;
+  std::array<Key, N> keys_{};
+  [[no_unique_address]] KeyEqual eq_{};
+};
+
+template <class Key, class T, std::size_t N, class Hash = seeded_hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+constexpr perfect_hash_map<Key, T, N, Hash, KeyEqual> make_perfect_hash_map(
+    const std::pair<Key, T> (&items)[N]) {
+  std::array<std::pair<Key, T>, N> a{};
+  for (std::size_t i = 0; i < N; ++i) a[i] = items[i];
+  return perfect_hash_map<Key, T, N, Hash, KeyEqual>(a);
+}
+
+template <class Key, std::size_t N, class Hash = seeded_hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+constexpr perfect_hash_set<Key, N, Hash, KeyEqual> make_perfect_hash_set(const Key (&keys)[N]) {
+  std::array<Key, N> a{};
+  for (std::size_t i = 0; i < N; ++i) a[i] = keys[i];
+  return perfect_hash_set<Key, N, Hash, KeyEqual>(a);
+}
+
+}  // namespace mystl
@@ -0,0 +1,1260 @@
+#pragma once
+
+// Persistent (immutable) containers with structural sharing.
+//
+//   mystl::persistent_vector<int> v0;
+//   auto v1 = v0.push_back(1).push_back(2);            // v0 is unchanged
+//   auto v2 = v1.set(0, 10) + v1.drop(1);              // O(log n) concatenation
+//
+//   mystl::persistent_map<std::string, setting> cfg;
+//   auto next = cfg.set("timeout", 30).erase("retries");  // cfg is unchanged
+//
+//   auto t = next.transient();                         // batch edits in place
+//   for (auto& [k, v] : overrides) t.set(k, v);
+//   next = t.persistent();
+//
+// Operations on a persistent container leave it untouched and return a new
+// version that shares every unchanged node with the old one, so keeping a
+// version per configuration change or MVCC snapshot costs O(log n) memory
+// per edit instead of a full copy. Copies are O(1). Nodes carry atomic
+// reference counts: versions may be shared between threads and released on
+// any of them.
+//
+// persistent_vector is a relaxed radix balanced (RRB) tree (Bagwell and
+// Rompf; Stucki et al.) of 32-way nodes with a tail buffer. Indexing and
+// set() are O(log32 n), push_back() is amortised O(1), and concatenation,
+// take() and drop() are O(log n). Every inner node keeps the cumulative
+// sizes of its children; nodes whose children are all full index by radix
+// alone, and the others ("relaxed", produced by concatenation and slicing)
+// correct the radix guess with a short scan of the sizes.
+//
+// persistent_map is a hash array mapped trie in the compact CHAMP layout
+// (Steindorfer and Vinju): each node has a bitmap of inline entries and a
+// bitmap of subnodes, so a lookup reads one node per 5 hash bits, and erase
+// pulls lone entries back up so that the trie stays canonical. Keys whose
+// 64-bit hashes collide share a small linear node.
+//
+// A transient is a mutable builder over a version. Nodes it creates belong
+// to it and are updated in place, so a batch of n edits costs about n
+// element writes rather than n path copies. persistent() hands out the
+// current version in O(1); the transient stays usable and copies shared
+// nodes again on its next write. Transients are not thread-safe.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Identifies the transient that may modify a node in place; nodes of
+// persistent versions carry 0 or the token of a finished batch.
+inline std::uint64_t new_edit_token() noexcept {
+  static std::atomic<std::uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+constexpr std::size_t round_up(std::size_t n, std::size_t align) noexcept {
+  return (n + align - 1) / align * align;
+}
+
+// Node storage; over-aligned only when the element type asks for it.
+inline void* allocate_node(std::size_t bytes, std::size_t align) {
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return ::operator new(bytes);
+  return ::operator new(bytes, std::align_val_t{align});
+}
+
+inline void deallocate_node(void* p, std::size_t align) noexcept {
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    ::operator delete(p);
+  } else {
+    ::operator delete(p, std::align_val_t{align});
+  }
+}
+
+// Owning pointer to a reference-counted node; Node provides refs and a
+// static destroy(Node*).
+template <class Node>
+class persistent_ref {
+ public:
+  persistent_ref() noexcept = default;
+  explicit persistent_ref(Node* n) noexcept : n_(n) {}  // adopts a reference
+  persistent_ref(const persistent_ref& o) noexcept : n_(retain(o.n_)) {}
+  persistent_ref(persistent_ref&& o) noexcept : n_(std::exchange(o.n_, nullptr)) {}
+  persistent_ref& operator=(persistent_ref o) noexcept {
+    swap(o);
+    return *this;
+  }
+  ~persistent_ref() { release(n_); }
+
+  static persistent_ref share(Node* n) noexcept { return persistent_ref(retain(n)); }
+
+  static Node* retain(Node* n) noexcept {
+    if (n) n->refs.fetch_add(1, std::memory_order_relaxed);
+    return n;
+  }
+  static void release(Node* n) noexcept {
+    if (n && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) Node::destroy(n);
+  }
+
+  Node* get() const noexcept { return n_; }
+  Node* operator->() const noexcept { return n_; }
+  explicit operator bool() const noexcept { return n_ != nullptr; }
+  Node* release() noexcept { return std::exchange(n_, nullptr); }
+  void swap(persistent_ref& o) noexcept { std::swap(n_, o.n_); }
+
+ private:
+  Node* n_ = nullptr;
+};
+
+}  // namespace detail
+
+// ----- persistent_vector -----
+
+template <class T>
+class persistent_vector {
+  struct node;
+  using node_ref = detail::persistent_ref<node>;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = const T&;
+  using const_reference = const T&;
+
+  class const_iterator;
+  using iterator = const_iterator;
+  class transient_type;
+
+  static constexpr unsigned bits = 5;
+  static constexpr size_type branching = size_type{1} << bits;
+
+  persistent_vector() noexcept = default;
+  persistent_vector(std::initializer_list<T> init) : persistent_vector(init.begin(), init.end()) {}
+  template <std::input_iterator It, std::sentinel_for<It> S>
+  persistent_vector(It first, S last) {
+    transient_type t = transient();
+    for (; first != last; ++first) t.push_back(*first);
+    *this = t.persistent();
+  }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  // O(log32 n).
+  const T& operator[](size_type i) const noexcept {
+    size_type base;
+    return elems(leaf_for(i, base))[i - base];
+  }
+  const T& at(size_type i) const {
+    if (i >= size_) throw std::out_of_range("persistent_vector::at");
+    return (*this)[i];
+  }
+  const T& front() const noexcept { return (*this)[0]; }
+  const T& back() const noexcept { return (*this)[size_ - 1]; }
+
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator end() const noexcept { return const_iterator(this, size_); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // --- versions -----------------------------------------------------------
+
+  [[nodiscard]] persistent_vector push_back(T value) const {
+    persistent_vector r(*this);
+    r.push_back_in(std::move(value), 0);
+    return r;
+  }
+
+  [[nodiscard]] persistent_vector set(size_type i, T value) const {
+    if (i >= size_) throw std::out_of_range("persistent_vector::set");
+    persistent_vector r(*this);
+    r.set_in(i, value, 0);
+    return r;
+  }
+
+  // Requires !empty().
+  [[nodiscard]] persistent_vector pop_back() const {
+    persistent_vector r(*this);
+    r.pop_back_in(0);
+    return r;
+  }
+
+  // The first min(n, size()) elements.
+  [[nodiscard]] persistent_vector take(size_type n) const {
+    if (n >= size_) return *this;
+    persistent_vector r;
+    if (n == 0) return r;
+    const size_type off = tail_offset();
+    if (n > off) {
+      r = *this;
+      r.tail_ = copy_leaf(tail_.get(), 0, n - off, 0);
+    } else {
+      r.root_ = take_tree(root_, shift_, n);
+      r.shift_ = shift_;
+      r.collapse();
+    }
+    r.size_ = n;
+    return r;
+  }
+
+  // All but the first n elements.
+  [[nodiscard]] persistent_vector drop(size_type n) const {
+    if (n == 0) return *this;
+    persistent_vector r;
+    if (n >= size_) return r;
+    const size_type off = tail_offset();
+    if (n >= off) {
+      r.tail_ = copy_leaf(tail_.get(), n - off, tail_->count, 0);
+    } else {
+      r.root_ = drop_tree(root_, shift_, n);
+      r.shift_ = shift_;
+      r.collapse();
+      r.tail_ = tail_;
+    }
+    r.size_ = size_ - n;
+    return r;
+  }
+
+  // O(log n); both operands stay valid and share their nodes with the
+  // result.
+  friend persistent_vector operator+(const persistent_vector& a, const persistent_vector& b) {
+    if (a.empty()) return b;
+    if (b.empty()) return a;
+    persistent_vector r(a);
+    if (!b.root_) {
+      const std::uint64_t edit = detail::new_edit_token();
+      for (size_type i = 0; i < b.tail_->count; ++i) {
+        r.push_back_in(T(elems(b.tail_.get())[i]), edit);
+      }
+      return r;
+    }
+    if (r.tail_) r.push_leaf(r.tail_, 0);
+    r.tail_ = b.tail_;
+    r.root_ = merge(r.root_, r.shift_, b.root_, b.shift_);
+    r.shift_ = std::max(r.shift_, b.shift_) + bits;
+    r.size_ = a.size_ + b.size_;
+    r.collapse();
+    return r;
+  }
+
+  // O(1).
+  transient_type transient() const { return transient_type(*this); }
+
+  // Mutable builder; see the header comment.
+  class transient_type {
+   public:
+    transient_type(const transient_type&) = delete;
+    transient_type& operator=(const transient_type&) = delete;
+    transient_type(transient_type&&) noexcept = default;
+    transient_type& operator=(transient_type&&) noexcept = default;
+
+    size_type size() const noexcept { return v_.size(); }
+    bool empty() const noexcept { return v_.empty(); }
+    const T& operator[](size_type i) const noexcept { return v_[i]; }
+    const T& at(size_type i) const { return v_.at(i); }
+
+    void push_back(T value) { v_.push_back_in(std::move(value), edit_); }
+    void set(size_type i, T value) {
+      if (i >= v_.size_) throw std::out_of_range("persistent_vector::transient_type::set");
+      v_.set_in(i, value, edit_);
+    }
+    // Requires !empty().
+    void pop_back() { v_.pop_back_in(edit_); }
+
+    // The current contents as a persistent version.
+    persistent_vector persistent() {
+      edit_ = detail::new_edit_token();
+      return v_;
+    }
+
+   private:
+    friend class persistent_vector;
+    explicit transient_type(const persistent_vector& v) : v_(v), edit_(detail::new_edit_token()) {}
+
+    persistent_vector v_;
+    std::uint64_t edit_;
+  };
+
+  // Random-access iterator; sequential access touches each leaf once.
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = const T&;
+    using pointer = const T*;
+
+    const_iterator() noexcept = default;
+
+    const T& operator*() const noexcept {
+      if (pos_ - leaf_begin_ >= leaf_size_) locate();
+      return leaf_[pos_ - leaf_begin_];
+    }
+    const T* operator->() const noexcept { return &**this; }
+    const T& operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    const_iterator& operator++() noexcept {
+      ++pos_;
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      const_iterator t = *this;
+      ++pos_;
+      return t;
+    }
+    const_iterator& operator--() noexcept {
+      --pos_;
+      return *this;
+    }
+    const_iterator operator--(int) noexcept {
+      const_iterator t = *this;
+      --pos_;
+      return t;
+    }
+    const_iterator& operator+=(difference_type n) noexcept {
+      pos_ += static_cast<size_type>(n);
+      return *this;
+    }
+    const_iterator& operator-=(difference_type n) noexcept {
+      pos_ -= static_cast<size_type>(n);
+      return *this;
+    }
+    friend const_iterator operator+(const_iterator it, difference_type n) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator+(difference_type n, const_iterator it) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator-(const_iterator it, difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept {
+      return static_cast<difference_type>(a.pos_ - b.pos_);
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+      return a.pos_ == b.pos_;
+    }
+    friend std::strong_ordering operator<=>(const const_iterator& a,
+                                            const const_iterator& b) noexcept {
+      return a.pos_ <=> b.pos_;
+    }
+
+   private:
+    friend class persistent_vector;
+    const_iterator(const persistent_vector* v, size_type pos) noexcept : v_(v), pos_(pos) {}
+
+    void locate() const noexcept {
+      const node* leaf = v_->leaf_for(pos_, leaf_begin_);
+      leaf_ = elems(leaf);
+      leaf_size_ = leaf->count;
+    }
+
+    const persistent_vector* v_ = nullptr;
+    size_type pos_ = 0;
+    mutable const T* leaf_ = nullptr;
+    mutable size_type leaf_begin_ = 0;
+    mutable size_type leaf_size_ = 0;
+  };
+
+ private:
+  // Leaves are followed by up to 32 elements; inner nodes by 32 child
+  // pointers and then the cumulative sizes of the children.
+  struct node {
+    std::atomic<std::uint32_t> refs{1};
+    std::uint32_t count = 0;  // elements or children
+    bool leaf = true;
+    bool relaxed = false;     // inner: children before the last are not all full
+    std::uint64_t owner = 0;  // edit token
+
+    static void destroy(node* n) noexcept {
+      if (n->leaf) {
+        std::destroy_n(elems(n), n->count);
+      } else {
+        for (std::uint32_t i = 0; i < n->count; ++i) node_ref::release(children(n)[i]);
+      }
+      n->~node();
+      detail::deallocate_node(n, node_align);
+    }
+  };
+
+  static constexpr std::size_t node_align =
+      std::max({alignof(node), alignof(T), alignof(node*), alignof(size_type)});
+  static constexpr std::size_t elems_offset = detail::round_up(sizeof(node), alignof(T));
+  static constexpr std::size_t children_offset = detail::round_up(sizeof(node), alignof(node*));
+  static_assert(alignof(size_type) <= alignof(node*));
+
+  static T* elems(node* n) noexcept {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(n) + elems_offset);
+  }
+  static const T* elems(const node* n) noexcept {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(n) + elems_offset);
+  }
+  static node** children(node* n) noexcept {
+    return reinterpret_cast<node**>(reinterpret_cast<char*>(n) + children_offset);
+  }
+  static node* const* children(const node* n) noexcept {
+    return reinterpret_cast<node* const*>(reinterpret_cast<const char*>(n) + children_offset);
+  }
+  static size_type* sizes(node* n) noexcept {
+    return reinterpret_cast<size_type*>(children(n) + branching);
+  }
+  static const size_type* sizes(const node* n) noexcept {
+    return reinterpret_cast<const size_type*>(children(n) + branching);
+  }
+
+  static size_type size_of(const node* n) noexcept {
+    return n->leaf ? n->count : sizes(n)[n->count - 1];
+  }
+  static bool owns(const node* n, std::uint64_t edit) noexcept {
+    return edit != 0 && n->owner == edit;
+  }
+
+  static node_ref new_node(bool leaf, std::uint64_t edit) {
+    const std::size_t bytes =
+        leaf ? elems_offset + branching * sizeof(T)
+             : children_offset + branching * (sizeof(node*) + sizeof(size_type));
+    node* x = ::new (detail::allocate_node(bytes, node_align)) node;
+    x->leaf = leaf;
+    x->owner = edit;
+    return node_ref(x);
+  }
+
+  // Leaf holding copies of n's elements [first, last).
+  static node_ref copy_leaf(const node* n, size_type first, size_type last, std::uint64_t edit) {
+    node_ref x = new_node(true, edit);
+    for (size_type i = first; i < last; ++i, ++x->count) {
+      ::new (elems(x.get()) + x->count) T(elems(n)[i]);
+    }
+    return x;
+  }
+
+  static node_ref copy_inner(const node* n, std::uint64_t edit) {
+    node_ref x = new_node(false, edit);
+    for (std::uint32_t i = 0; i < n->count; ++i) {
+      children(x.get())[i] = node_ref::retain(children(n)[i]);
+    }
+    std::copy_n(sizes(n), n->count, sizes(x.get()));
+    x->count = n->count;
+    x->relaxed = n->relaxed;
+    return x;
+  }
+
+  static node_ref copy_node(const node* n, std::uint64_t edit) {
+    return n->leaf ? copy_leaf(n, 0, n->count, edit) : copy_inner(n, edit);
+  }
+
+  // Recomputes the sizes of n's children from index `from` on; n is at
+  // `shift`, so full children hold 1 << shift elements.
+  static void fix_sizes(node* n, unsigned shift, size_type from) noexcept {
+    size_type* sz = sizes(n);
+    size_type total = from != 0 ? sz[from - 1] : 0;
+    for (size_type i = from; i < n->count; ++i) sz[i] = total += size_of(children(n)[i]);
+    n->relaxed = false;
+    for (size_type i = 0; i + 1 < n->count; ++i) {
+      if (sz[i] != (i + 1) << shift) {
+        n->relaxed = true;
+        break;
+      }
+    }
+  }
+
+  // Inner node at shift over kids[0, k), which it takes over.
+  static node_ref make_inner(node_ref* kids, size_type k, unsigned shift, std::uint64_t edit) {
+    node_ref x = new_node(false, edit);
+    for (size_type i = 0; i < k; ++i) children(x.get())[i] = kids[i].release();
+    x->count = static_cast<std::uint32_t>(k);
+    fix_sizes(x.get(), shift, 0);
+    return x;
+  }
+
+  // n with child idx replaced by c, or c appended if idx == count; in place
+  // if the transient owns n.
+  static node_ref with_child(const node_ref& n, unsigned shift, size_type idx, node_ref c,
+                             std::uint64_t edit) {
+    node_ref out = owns(n.get(), edit) ? n : copy_inner(n.get(), edit);
+    node*& slot = children(out.get())[idx];
+    if (idx == out->count) {
+      slot = c.release();
+      ++out->count;
+    } else {
+      node_ref::release(std::exchange(slot, c.release()));
+    }
+    fix_sizes(out.get(), shift, idx);
+    return out;
+  }
+
+  // Index of the child of n (at shift) holding element i; i becomes the
+  // offset within that child.
+  static size_type locate(const node* n, unsigned shift, size_type& i) noexcept {
+    size_type idx = i >> shift;
+    if (n->relaxed) {
+      const size_type* sz = sizes(n);
+      while (sz[idx] <= i) ++idx;
+      if (idx != 0) i -= sz[idx - 1];
+    } else {
+      i -= idx << shift;
+    }
+    return idx;
+  }
+
+  size_type tail_offset() const noexcept { return size_ - (tail_ ? tail_->count : 0); }
+
+  const node* leaf_for(size_type i, size_type& base) const noexcept {
+    const size_type off = tail_offset();
+    if (i >= off) {
+      base = off;
+      return tail_.get();
+    }
+    const size_type target = i;
+    const node* n = root_.get();
+    for (unsigned s = shift_; s != 0; s -= bits) n = children(n)[locate(n, s, i)];
+    base = target - i;
+    return n;
+  }
+
+  // ----- modification -----
+
+  void push_back_in(T&& value, std::uint64_t edit) {
+    if (tail_ && tail_->count < branching) {
+      if (!owns(tail_.get(), edit)) tail_ = copy_leaf(tail_.get(), 0, tail_->count, edit);
+      ::new (elems(tail_.get()) + tail_->count) T(std::move(value));
+      ++tail_->count;
+    } else {
+      node_ref leaf = new_node(true, edit);
+      ::new (elems(leaf.get())) T(std::move(value));
+      leaf->count = 1;
+      if (tail_) push_leaf(tail_, edit);
+      tail_ = std::move(leaf);
+    }
+    ++size_;
+  }
+
+  // Appends a leaf to the tree, growing it by a level when the right
+  // spine is full.
+  void push_leaf(const node_ref& leaf, std::uint64_t edit) {
+    if (!root_) {
+      root_ = leaf;
+      shift_ = 0;
+      return;
+    }
+    if (shift_ != 0) {
+      if (node_ref r = push_leaf(root_, shift_, leaf, edit)) {
+        root_ = std::move(r);
+        return;
+      }
+    }
+    node_ref kids[2] = {root_, make_path(leaf, shift_, edit)};
+    shift_ += bits;
+    root_ = make_inner(kids, 2, shift_, edit);
+  }
+
+  // n with leaf appended at its right edge; empty if n is full.
+  static node_ref push_leaf(const node_ref& n, unsigned shift, const node_ref& leaf,
+                            std::uint64_t edit) {
+    if (shift == bits) {
+      return n->count < branching ? with_child(n, shift, n->count, leaf, edit) : node_ref();
+    }
+    if (node_ref last = push_leaf(node_ref::share(children(n.get())[n->count - 1]),
+                                  shift - bits, leaf, edit)) {
+      return with_child(n, shift, n->count - 1, std::move(last), edit);
+    }
+    if (n->count == branching) return {};
+    return with_child(n, shift, n->count, make_path(leaf, shift - bits, edit), edit);
+  }
+
+  // leaf wrapped in single-child nodes up to shift.
+  static node_ref make_path(node_ref n, unsigned shift, std::uint64_t edit) {
+    for (unsigned s = bits; s <= shift; s += bits) n = make_inner(&n, 1, s, edit);
+    return n;
+  }
+
+  // Copies the path to element i, except for nodes the transient owns,
+  // and assigns it.
+  void set_in(size_type i, T& value, std::uint64_t edit) {
+    const size_type off = tail_offset();
+    if (i >= off) {
+      if (!owns(tail_.get(), edit)) tail_ = copy_leaf(tail_.get(), 0, tail_->count, edit);
+      elems(tail_.get())[i - off] = std::move(value);
+      return;
+    }
+    if (!owns(root_.get(), edit)) root_ = copy_node(root_.get(), edit);
+    node* n = root_.get();
+    for (unsigned s = shift_; s != 0; s -= bits) {
+      node*& c = children(n)[locate(n, s, i)];
+      if (!owns(c, edit)) node_ref::release(std::exchange(c, copy_node(c, edit).release()));
+      n = c;
+    }
+    elems(n)[i] = std::move(value);
+  }
+
+  void pop_back_in(std::uint64_t edit) {
+    if (!tail_) {
+      // Move the last leaf of the tree into the tail.
+      const node* n = root_.get();
+      while (!n->leaf) n = children(n)[n->count - 1];
+      node_ref leaf = node_ref::share(const_cast<node*>(n));
+      const size_type rest = size_ - leaf->count;
+      root_ = rest != 0 ? take_tree(root_, shift_, rest) : node_ref();
+      collapse();
+      tail_ = std::move(leaf);
+    }
+    if (tail_->count == 1) {
+      tail_ = {};
+    } else if (owns(tail_.get(), edit)) {
+      std::destroy_at(elems(tail_.get()) + --tail_->count);
+    } else {
+      tail_ = copy_leaf(tail_.get(), 0, tail_->count - 1, edit);
+    }
+    if (--size_ == 0) root_ = {};
+  }
+
+  // Drops single-child roots.
+  void collapse() noexcept {
+    if (!root_) shift_ = 0;
+    while (shift_ != 0 && root_->count == 1) {
+      root_ = node_ref::share(children(root_.get())[0]);
+      shift_ -= bits;
+    }
+  }
+
+  // The first k elements of n, 0 < k <= size_of(n).
+  static node_ref take_tree(const node_ref& n, unsigned shift, size_type k) {
+    if (k == size_of(n.get())) return n;
+    if (shift == 0) return copy_leaf(n.get(), 0, k, 0);
+    size_type i = k - 1;
+    const size_type idx = locate(n.get(), shift, i);
+    node_ref kids[branching];
+    for (size_type j = 0; j < idx; ++j) kids[j] = node_ref::share(children(n.get())[j]);
+    kids[idx] = take_tree(node_ref::share(children(n.get())[idx]), shift - bits, i + 1);
+    return make_inner(kids, idx + 1, shift, 0);
+  }
+
+  // n without its first k elements, 0 <= k < size_of(n).
+  static node_ref drop_tree(const node_ref& n, unsigned shift, size_type k) {
+    if (k == 0) return n;
+    if (shift == 0) return copy_leaf(n.get(), k, n->count, 0);
+    const size_type idx = locate(n.get(), shift, k);
+    node_ref kids[branching];
+    kids[0] = drop_tree(node_ref::share(children(n.get())[idx]), shift - bits, k);
+    for (size_type j = idx + 1; j < n->count; ++j) {
+      kids[j - idx] = node_ref::share(children(n.get())[j]);
+    }
+    return make_inner(kids, n->count - idx, shift, 0);
+  }
+
+  // ----- concatenation -----
+
+  // Concatenation of l (at ls) and r (at rs): a node at max(ls, rs) + bits
+  // with one or two children. The spines meeting in the middle are merged
+  // level by level, rebalancing each level's nodes.
+  static node_ref merge(const node_ref& l, unsigned ls, const node_ref& r, unsigned rs) {
+    const node* none = nullptr;
+    if (ls > rs) {
+      const node_ref mid =
+          merge(node_ref::share(children(l.get())[l->count - 1]), ls - bits, r, rs);
+      return rebalance(l.get(), 0, l->count - 1, mid.get(), none, 0, 0, ls);
+    }
+    if (ls < rs) {
+      const node_ref mid = merge(l, ls, node_ref::share(children(r.get())[0]), rs - bits);
+      return rebalance(none, 0, 0, mid.get(), r.get(), 1, r->count, rs);
+    }
+    if (ls == 0) {
+      node_ref kids[2] = {l, r};
+      return make_inner(kids, 2, bits, 0);
+    }
+    const node_ref mid = merge(node_ref::share(children(l.get())[l->count - 1]), ls - bits,
+                               node_ref::share(children(r.get())[0]), rs - bits);
+    return rebalance(l.get(), 0, l->count - 1, mid.get(), r.get(), 1, r->count, ls);
+  }
+
+  // Regroups the children of l [lb, le), of mid, and of r [rb, re) -- all
+  // at shift - bits -- under one or two nodes at shift, and returns their
+  // parent. Nodes are repacked only while there are more than two beyond
+  // the minimum needed (the RRB search-step invariant); the others are
+  // shared as they are.
+  static node_ref rebalance(const node* l, size_type lb, size_type le, const node* mid,
+                            const node* r, size_type rb, size_type re, unsigned shift) {
+    constexpr size_type extra = 2;
+    const node* in[2 * branching + 2];
+    size_type n = 0;
+    for (size_type i = lb; i < le; ++i) in[n++] = children(l)[i];
+    for (size_type i = 0; i < mid->count; ++i) in[n++] = children(mid)[i];
+    for (size_type i = rb; i < re; ++i) in[n++] = children(r)[i];
+
+    size_type counts[2 * branching + 2];
+    size_type total = 0;
+    for (size_type i = 0; i < n; ++i) total += counts[i] = in[i]->count;
+    const size_type optimal = (total + branching - 1) / branching;
+    size_type m = n;
+    for (size_type i = 0; m > optimal + extra;) {
+      while (counts[i] > branching - extra / 2) ++i;
+      // Pour node i into its successors until one of them absorbs the
+      // remainder, then drop the emptied slot.
+      size_type rest = counts[i];
+      do {
+        const size_type fill = std::min(rest + counts[i + 1], branching);
+        rest = rest + counts[i + 1] - fill;
+        counts[i++] = fill;
+      } while (rest != 0);
+      std::copy(counts + i + 1, counts + m, counts + i);
+      --m;
+      --i;
+    }
+
+    const unsigned child_shift = shift - bits;
+    node_ref out[2 * branching + 2];
+    size_type k = 0, offset = 0;
+    for (size_type j = 0; j < m; ++j) {
+      if (offset == 0 && in[k]->count == counts[j]) {
+        out[j] = node_ref::share(const_cast<node*>(in[k++]));
+        continue;
+      }
+      out[j] = new_node(child_shift == 0, 0);
+      node* x = out[j].get();
+      while (x->count < counts[j]) {
+        const size_type take = std::min<size_type>(counts[j] - x->count, in[k]->count - offset);
+        for (size_type t = 0; t < take; ++t, ++x->count) {
+          if (child_shift == 0) {
+            ::new (elems(x) + x->count) T(elems(in[k])[offset + t]);
+          } else {
+            children(x)[x->count] = node_ref::retain(children(in[k])[offset + t]);
+          }
+        }
+        offset += take;
+        if (offset == in[k]->count) {
+          ++k;
+          offset = 0;
+        }
+      }
+      if (child_shift != 0) fix_sizes(x, child_shift, 0);
+    }
+
+    node_ref groups[2];
+    const size_type first = std::min(m, branching);
+    groups[0] = make_inner(out, first, shift, 0);
+    if (m == first) return make_inner(groups, 1, shift + bits, 0);
+    groups[1] = make_inner(out + first, m - first, shift, 0);
+    return make_inner(groups, 2, shift + bits, 0);
+  }
+
+  node_ref root_;   // elements [0, tail_offset())
+  node_ref tail_;   // the remaining elements; may be empty
+  unsigned shift_ = 0;  // of root_; 0 when root_ is a leaf
+  size_type size_ = 0;
+};
+
+// ----- persistent_map -----
+
+template <class Key, class T, class Hash = seeded_hash<Key>, class KeyEqual = std::equal_to<Key>>
+class persistent_map {
+  struct node;
+  using node_ref = detail::persistent_ref<node>;
+
+  static constexpr unsigned bits = 5;
+  // 13 bitmap levels consume the 64 hash bits; collision nodes sit below.
+  static constexpr unsigned max_depth = 64 / bits + 2;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  class const_iterator;
+  using iterator = const_iterator;
+  class transient_type;
+
+  explicit persistent_map(const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual())
+      : hash_(hash), eq_(eq) {}
+  persistent_map(std::initializer_list<value_type> init, const Hash& hash = Hash(),
+                 const KeyEqual& eq = KeyEqual())
+      : persistent_map(hash, eq) {
+    transient_type t = transient();
+    for (const value_type& kv : init) t.set(kv.first, kv.second);
+    *this = t.persistent();
+  }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  // Pointer to the value for key, or nullptr.
+  const T* find(const Key& key) const { return find_in(root_.get(), hash_(key), key); }
+  bool contains(const Key& key) const { return find(key) != nullptr; }
+  size_type count(const Key& key) const { return contains(key) ? 1 : 0; }
+  const T& at(const Key& key) const {
+    if (const T* v = find(key)) return *v;
+    throw std::out_of_range("persistent_map::at");
+  }
+
+  const_iterator begin() const noexcept { return const_iterator(root_.get()); }
+  const_iterator end() const noexcept { return const_iterator(); }
+
+  // --- versions -----------------------------------------------------------
+
+  // Inserts or assigns.
+  [[nodiscard]] persistent_map set(Key key, T value) const {
+    persistent_map r(*this);
+    r.set_in(key, value, 0);
+    return r;
+  }
+
+  [[nodiscard]] persistent_map erase(const Key& key) const {
+    persistent_map r(*this);
+    r.erase_in(key, 0);
+    return r;
+  }
+
+  // O(1).
+  transient_type transient() const { return transient_type(*this); }
+
+  // Mutable builder; see the header comment.
+  class transient_type {
+   public:
+    transient_type(const transient_type&) = delete;
+    transient_type& operator=(const transient_type&) = delete;
+    transient_type(transient_type&&) noexcept = default;
+    transient_type& operator=(transient_type&&) noexcept = default;
+
+    size_type size() const noexcept { return m_.size(); }
+    bool empty() const noexcept { return m_.empty(); }
+    const T* find(const Key& key) const { return m_.find(key); }
+    bool contains(const Key& key) const { return m_.contains(key); }
+
+    // Inserts or assigns; true if key was new.
+    bool set(Key key, T value) { return m_.set_in(key, value, edit_); }
+    // True if key was present.
+    bool erase(const Key& key) { return m_.erase_in(key, edit_); }
+
+    // The current contents as a persistent version.
+    persistent_map persistent() {
+      edit_ = detail::new_edit_token();
+      return m_;
+    }
+
+   private:
+    friend class persistent_map;
+    explicit transient_type(const persistent_map& m) : m_(m), edit_(detail::new_edit_token()) {}
+
+    persistent_map m_;
+    std::uint64_t edit_;
+  };
+
+  // Forward iterator in hash order.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = persistent_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+
+    const_iterator() noexcept = default;
+
+    const value_type& operator*() const noexcept { return entries(nodes_[depth_ - 1])[entry_]; }
+    const value_type* operator->() const noexcept { return &**this; }
+
+    const_iterator& operator++() noexcept {
+      ++entry_;
+      settle();
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      const_iterator t = *this;
+      ++*this;
+      return t;
+    }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+      if (a.depth_ != b.depth_) return false;
+      return a.depth_ == 0 ||
+             (a.nodes_[a.depth_ - 1] == b.nodes_[b.depth_ - 1] && a.entry_ == b.entry_);
+    }
+
+   private:
+    friend class persistent_map;
+    explicit const_iterator(const node* root) noexcept {
+      if (!root) return;
+      nodes_[0] = root;
+      next_[0] = 0;
+      depth_ = 1;
+      settle();
+    }
+
+    // Moves to the next entry at or after the current position: the rest
+    // of the current node's entries, then its subtrees depth first.
+    void settle() noexcept {
+      while (depth_ != 0) {
+        const node* n = nodes_[depth_ - 1];
+        if (entry_ < data_count(n)) return;
+        if (next_[depth_ - 1] < node_count(n)) {
+          nodes_[depth_] = children(n)[next_[depth_ - 1]++];
+          next_[depth_] = 0;
+          ++depth_;
+          entry_ = 0;
+        } else {
+          --depth_;
+          entry_ = static_cast<std::uint32_t>(-1);
+        }
+      }
+    }
+
+    const node* nodes_[max_depth];
+    std::uint32_t next_[max_depth];  // next child to visit per level
+    std::uint32_t entry_ = 0;        // in nodes_[depth_ - 1]
+    std::uint32_t depth_ = 0;
+  };
+
+ private:
+  // Entries, then children. Collision nodes keep their entry count in
+  // datamap and have no children.
+  struct node {
+    std::atomic<std::uint32_t> refs{1};
+    std::uint32_t datamap = 0;
+    std::uint32_t nodemap = 0;
+    bool collision = false;
+    std::uint64_t owner = 0;  // edit token
+
+    static void destroy(node* n) noexcept {
+      std::destroy_n(entries(n), data_count(n));
+      for (size_type i = 0, c = node_count(n); i < c; ++i) node_ref::release(children(n)[i]);
+      n->~node();
+      detail::deallocate_node(n, node_align);
+    }
+  };
+
+  static constexpr std::size_t node_align =
+      std::max({alignof(node), alignof(value_type), alignof(node*)});
+  static constexpr std::size_t entries_offset = detail::round_up(sizeof(node), alignof(value_type));
+
+  static size_type data_count(const node* n) noexcept {
+    return n->collision ? n->datamap : static_cast<size_type>(std::popcount(n->datamap));
+  }
+  static size_type node_count(const node* n) noexcept {
+    return static_cast<size_type>(std::popcount(n->nodemap));
+  }
+  static std::size_t children_offset(size_type n_entries) noexcept {
+    return detail::round_up(entries_offset + n_entries * sizeof(value_type), alignof(node*));
+  }
+
+  static value_type* entries(node* n) noexcept {
+    return reinterpret_cast<value_type*>(reinterpret_cast<char*>(n) + entries_offset);
+  }
+  static const value_type* entries(const node* n) noexcept {
+    return reinterpret_cast<const value_type*>(reinterpret_cast<const char*>(n) + entries_offset);
+  }
+  static node** children(node* n) noexcept {
+    return reinterpret_cast<node**>(reinterpret_cast<char*>(n) + children_offset(data_count(n)));
+  }
+  static node* const* children(const node* n) noexcept {
+    return reinterpret_cast<node* const*>(reinterpret_cast<const char*>(n) +
+                                          children_offset(data_count(n)));
+  }
+
+  static std::uint32_t bit_at(std::uint64_t h, unsigned shift) noexcept {
+    return std::uint32_t{1} << ((h >> shift) & 31);
+  }
+  static size_type index_of(std::uint32_t map, std::uint32_t bit) noexcept {
+    return static_cast<size_type>(std::popcount(map & (bit - 1)));
+  }
+  static value_type& entry_at(node* n, std::uint32_t bit) noexcept {
+    return entries(n)[index_of(n->datamap, bit)];
+  }
+  static node*& child_at(node* n, std::uint32_t bit) noexcept {
+    return children(n)[index_of(n->nodemap, bit)];
+  }
+  static bool owns(const node* n, std::uint64_t edit) noexcept {
+    return edit != 0 && n->owner == edit;
+  }
+  static bool is_singleton(const node* n) noexcept {
+    return data_count(n) == 1 && n->nodemap == 0;
+  }
+
+  // Allocates a node owned by edit: entry(i, where) constructs the i-th
+  // entry and child(i) returns the i-th child, which the node adopts.
+  // Children are only taken once all entries are built.
+  template <class Entry, class Child>
+  static node_ref build(std::uint32_t datamap, std::uint32_t nodemap, bool collision,
+                        size_type n_entries, Entry&& entry, Child&& child, std::uint64_t edit) {
+    const size_type n_children = static_cast<size_type>(std::popcount(nodemap));
+    void* mem =
+        detail::allocate_node(children_offset(n_entries) + n_children * sizeof(node*), node_align);
+    node* x = ::new (mem) node;
+    x->datamap = collision ? static_cast<std::uint32_t>(n_entries) : datamap;
+    x->nodemap = nodemap;
+    x->collision = collision;
+    x->owner = edit;
+    size_type built = 0;
+    try {
+      for (; built < n_entries; ++built) entry(built, entries(x) + built);
+    } catch (...) {
+      std::destroy_n(entries(x), built);
+      x->~node();
+      detail::deallocate_node(mem, node_align);
+      throw;
+    }
+    for (size_type i = 0; i < n_children; ++i) children(x)[i] = child(i);
+    return node_ref(x);
+  }
+
+  // Copy of bitmap node n with the given maps. The entry for `bit`, if
+  // any, is constructed by make(where) and the child for `bit`, if any, is
+  // c; everything else is shared with n. A node the transient owns is
+  // about to be unlinked, so its children move instead of being shared,
+  // which saves a retain and a release per child.
+  template <class Make>
+  static node_ref rebuild(node* n, std::uint32_t datamap, std::uint32_t nodemap,
+                          std::uint32_t bit, node_ref c, Make&& make, std::uint64_t edit) {
+    std::uint32_t entry_bits[32], child_bits[32];
+    size_type ne = 0, nc = 0;
+    for (std::uint32_t m = datamap; m != 0; m &= m - 1) entry_bits[ne++] = m & (~m + 1);
+    for (std::uint32_t m = nodemap; m != 0; m &= m - 1) child_bits[nc++] = m & (~m + 1);
+    const bool steal = owns(n, edit);
+    node_ref x = build(
+        datamap, nodemap, false, ne,
+        [&](size_type i, value_type* where) {
+          if (entry_bits[i] == bit) {
+            make(where);
+          } else {
+            ::new (where) value_type(entry_at(n, entry_bits[i]));
+          }
+        },
+        [&](size_type i) {
+          if (child_bits[i] == bit) return c.release();
+          node* old = child_at(n, child_bits[i]);
+          return steal ? old : node_ref::retain(old);
+        },
+        edit);
+    if (steal) {
+      for (std::uint32_t m = n->nodemap; m != 0; m &= m - 1) {
+        const std::uint32_t b = m & (~m + 1);
+        if (b == bit || !(nodemap & b)) node_ref::release(child_at(n, b));
+      }
+      n->nodemap = 0;
+    }
+    return x;
+  }
+
+  // Copy of collision node n without entry `skip` (or none if skip is
+  // out of range), plus an entry from make(where) if `add`.
+  template <class Make>
+  static node_ref rebuild_collision(node* n, size_type skip, bool add, Make&& make,
+                                    std::uint64_t edit) {
+    const size_type old = data_count(n);
+    const size_type kept = old - (skip < old ? 1 : 0);
+    return build(
+        0, 0, true, kept + (add ? 1 : 0),
+        [&](size_type i, value_type* where) {
+          if (i == kept) {
+            make(where);
+          } else {
+            ::new (where) value_type(entries(n)[i < skip ? i : i + 1]);
+          }
+        },
+        [](size_type) -> node* { return nullptr; }, edit);
+  }
+
+  const T* find_in(const node* n, std::uint64_t h, const Key& key) const {
+    for (unsigned shift = 0; n != nullptr; shift += bits) {
+      if (n->collision) {
+        for (size_type i = 0; i < n->datamap; ++i) {
+          if (eq_(entries(n)[i].first, key)) return &entries(n)[i].second;
+        }
+        return nullptr;
+      }
+      const std::uint32_t bit = bit_at(h, shift);
+      if (n->datamap & bit) {
+        const value_type& e = entries(n)[index_of(n->datamap, bit)];
+        return eq_(e.first, key) ? &e.second : nullptr;
+      }
+      if (!(n->nodemap & bit)) return nullptr;
+      n = children(n)[index_of(n->nodemap, bit)];
+    }
+    return nullptr;
+  }
+
+  bool set_in(Key& key, T& value, std::uint64_t edit) {
+    bool added = false;
+    const std::uint64_t h = hash_(key);
+    if (!root_) {
+      const std::uint32_t bit = bit_at(h, 0);
+      root_ = build(
+          bit, 0, false, 1,
+          [&](size_type, value_type* where) {
+            ::new (where) value_type(std::move(key), std::move(value));
+          },
+          [](size_type) -> node* { return nullptr; }, edit);
+      added = true;
+    } else if (node_ref r = set_in(root_.get(), 0, h, key, value, added, edit)) {
+      root_ = std::move(r);
+    }
+    size_ += added;
+    return added;
+  }
+
+  // The replacement for n with key set to value, or an empty ref if n was
+  // updated in place.
+  node_ref set_in(node* n, unsigned shift, std::uint64_t h, Key& key, T& value, bool& added,
+                  std::uint64_t edit) const {
+    auto make_new = [&](value_type* where) {
+      ::new (where) value_type(std::move(key), std::move(value));
+    };
+    if (n->collision) {
+      for (size_type i = 0; i < n->datamap; ++i) {
+        value_type& e = entries(n)[i];
+        if (!eq_(e.first, key)) continue;
+        if (owns(n, edit)) {
+          e.second = std::move(value);
+          return {};
+        }
+        return rebuild_collision(
+            n, i, true,
+            [&](value_type* where) { ::new (where) value_type(e.first, std::move(value)); }, edit);
+      }
+      added = true;
+      return rebuild_collision(n, data_count(n), true, make_new, edit);
+    }
+    const std::uint32_t bit = bit_at(h, shift);
+    if (n->datamap & bit) {
+      value_type& e = entry_at(n, bit);
+      if (eq_(e.first, key)) {
+        if (owns(n, edit)) {
+          e.second = std::move(value);
+          return {};
+        }
+        return rebuild(
+            n, n->datamap, n->nodemap, bit, {},
+            [&](value_type* where) { ::new (where) value_type(e.first, std::move(value)); }, edit);
+      }
+      node_ref sub = make_pair(e, hash_(e.first), key, value, h, shift + bits, edit);
+      added = true;
+      return rebuild(n, n->datamap & ~bit, n->nodemap | bit, bit, std::move(sub),
+                     [](value_type*) {}, edit);
+    }
+    if (n->nodemap & bit) {
+      node*& slot = child_at(n, bit);
+      node_ref c = set_in(slot, shift + bits, h, key, value, added, edit);
+      if (!c) return {};  // a child the transient owns implies n is owned too
+      if (owns(n, edit)) {
+        node_ref::release(std::exchange(slot, c.release()));
+        return {};
+      }
+      return rebuild(n, n->datamap, n->nodemap, bit, std::move(c), [](value_type*) {}, edit);
+    }
+    added = true;
+    return rebuild(n, n->datamap | bit, n->nodemap, bit, {}, make_new, edit);
+  }
+
+  // Node at shift holding the existing entry e (hash h1) and the new
+  // (key, value) (hash h2).
+  static node_ref make_pair(const value_type& e, std::uint64_t h1, Key& key, T& value,
+                            std::uint64_t h2, unsigned shift, std::uint64_t edit) {
+    auto no_child = [](size_type) -> node* { return nullptr; };
+    if (shift >= 64) {
+      return build(
+          0, 0, true, 2,
+          [&](size_type i, value_type* where) {
+            if (i == 0) {
+              ::new (where) value_type(e);
+            } else {
+              ::new (where) value_type(std::move(key), std::move(value));
+            }
+          },
+          no_child, edit);
+    }
+    const std::uint32_t b1 = bit_at(h1, shift), b2 = bit_at(h2, shift);
+    if (b1 == b2) {
+      node_ref sub = make_pair(e, h1, key, value, h2, shift + bits, edit);
+      return build(
+          0, b1, false, 0, [](size_type, value_type*) {},
+          [&](size_type) { return sub.release(); }, edit);
+    }
+    return build(
+        b1 | b2, 0, false, 2,
+        [&](size_type i, value_type* where) {
+          if ((i == 0) == (b1 < b2)) {
+            ::new (where) value_type(e);
+          } else {
+            ::new (where) value_type(std::move(key), std::move(value));
+          }
+        },
+        no_child, edit);
+  }
+
+  bool erase_in(const Key& key, std::uint64_t edit) {
+    if (!root_) return false;
+    bool removed = false;
+    node_ref r = erase_in(root_, 0, hash_(key), key, removed, edit);
+    if (removed) {
+      root_ = std::move(r);
+      --size_;
+    }
+    return removed;
+  }
+
+  // nr without key; empty if nothing would be left. A subnode left with a
+  // single entry is folded into its parent.
+  node_ref erase_in(const node_ref& nr, unsigned shift, std::uint64_t h, const Key& key,
+                    bool& removed, std::uint64_t edit) const {
+    node* n = nr.get();
+    if (n->collision) {
+      for (size_type i = 0; i < n->datamap; ++i) {
+        if (!eq_(entries(n)[i].first, key)) continue;
+        removed = true;
+        if (n->datamap == 1) return {};
+        return rebuild_collision(n, i, false, [](value_type*) {}, edit);
+      }
+      return nr;
+    }
+    const std::uint32_t bit = bit_at(h, shift);
+    if (n->datamap & bit) {
+      if (!eq_(entry_at(n, bit).first, key)) return nr;
+      removed = true;
+      if (n->datamap == bit && n->nodemap == 0) return {};
+      return rebuild(n, n->datamap & ~bit, n->nodemap, bit, {}, [](value_type*) {}, edit);
+    }
+    if (!(n->nodemap & bit)) return nr;
+    node_ref c = erase_in(node_ref::share(child_at(n, bit)), shift + bits, h, key, removed, edit);
+    if (!removed) return nr;
+    if (!c) {
+      if (n->datamap == 0 && n->nodemap == bit) return {};
+      return rebuild(n, n->datamap, n->nodemap & ~bit, bit, {}, [](value_type*) {}, edit);
+    }
+    if (is_singleton(c.get())) {
+      const value_type& lone = entries(c.get())[0];
+      return rebuild(
+          n, n->datamap | bit, n->nodemap & ~bit, bit, {},
+          [&](value_type* where) { ::new (where) value_type(lone); }, edit);
+    }
+    if (owns(n, edit)) {
+      node_ref::release(std::exchange(child_at(n, bit), c.release()));
+      return nr;
+    }
+    return rebuild(n, n->datamap, n->nodemap, bit, std::move(c), [](value_type*) {}, edit);
+  }
+
+  node_ref root_;
+  size_type size_ = 0;
+  [[no_unique_address]] Hash hash_{};
+  [[no_unique_address]] KeyEqual eq_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,335 @@
+#pragma once
+
+// Read-copy-update: lock-free readers, deferred reclamation.
+//
+//   mystl::rcu_cell<snapshot> book(std::in_place, initial);
+//   {
+//     auto s = book.read();            // pins the current snapshot
+//     quote(s->bid, s->ask);
+//   }
+//   book.update([](snapshot& s) { s.bid = 101; });  // copy, modify, publish
+//   book.store(std::make_unique<snapshot>(fresh));
+//
+// A reader announces itself by storing the global epoch into a cache line
+// that only its thread writes, then loads the pointer. It takes no lock,
+// performs no read-modify-write, and writes no shared cache line. Where
+// the kernel supports membarrier(2), the reader's store needs only a
+// compiler barrier: the writer forces the ordering on all threads with one
+// system call instead.
+//
+// A writer publishes a new object with an atomic exchange and retires the
+// old one. The retired object is freed once every reader that might still
+// see it has left its read-side section. Writers check this without waiting
+// once every rcu_retire_batch retirements, so that one grace-period check
+// (and one membarrier call) covers the whole batch; rcu_barrier() waits for
+// readers and frees everything retired so far. All cells share one
+// process-wide domain.
+//
+// rcu_synchronize() and rcu_barrier() must not be called from inside a
+// read-side section on the same thread.
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "synchronization.hpp"
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mystl {
+
+// Retirements between two attempts to reclaim.
+inline constexpr std::size_t rcu_retire_batch = 64;
+
+namespace detail {
+
+struct alignas(cache_line_size) rcu_reader_record {
+  std::atomic<std::uint64_t> epoch{0};  // 0 outside a read-side section
+  std::atomic<bool> in_use{true};
+  rcu_reader_record* next = nullptr;  // immutable once published
+};
+
+// Trivially destructible so that read-side sections keep working during
+// thread exit, after the owner below has released the record.
+struct rcu_thread_state {
+  rcu_reader_record* record = nullptr;
+  const std::atomic<std::uint64_t>* global_epoch = nullptr;
+  unsigned nesting = 0;
+  bool asymmetric = false;
+  bool exiting = false;
+};
+
+inline thread_local rcu_thread_state rcu_this_thread;
+
+class rcu_domain {
+ public:
+  static rcu_domain& instance() {
+    // Immortal, so that cells may be used from static destructors.
+    static rcu_domain* const d = new rcu_domain();
+    return *d;
+  }
+
+  void attach(rcu_thread_state& t) {
+    t.record = acquire_record();
+    t.global_epoch = &epoch_;
+    t.asymmetric = asymmetric_;
+    if (!t.exiting) {
+      static thread_local thread_owner owner;
+      (void)owner;
+    }
+  }
+
+  void retire(void* p, void (*deleter)(void*)) {
+    const std::uint64_t e = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    bool due;
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      retired_.push_back({p, deleter, e});
+      due = ++since_reclaim_ >= rcu_retire_batch;
+      if (due) since_reclaim_ = 0;
+    }
+    if (due) reclaim();
+  }
+
+  // Gives the record back; used by a thread that attached after its
+  // thread_owner was destroyed, when it leaves its read-side section.
+  static void release(rcu_thread_state& t) noexcept {
+    t.record->in_use.store(false, std::memory_order_release);
+    t.record = nullptr;
+  }
+
+  // Waits until every read-side section that began before the call has
+  // ended.
+  void synchronize() noexcept {
+    const std::uint64_t e = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    heavy_fence();
+    for (rcu_reader_record* r = readers_.load(std::memory_order_acquire); r; r = r->next) {
+      detail::spin_backoff backoff;
+      for (std::uint64_t x; (x = r->epoch.load(std::memory_order_acquire)) != 0 && x < e;) {
+        backoff();
+      }
+    }
+  }
+
+  void barrier() {
+    synchronize();
+    reclaim();
+  }
+
+ private:
+  struct retired {
+    void* p;
+    void (*deleter)(void*);
+    std::uint64_t epoch;  // global epoch once p was unreachable
+  };
+
+  // Gives the thread's record back for reuse when the thread exits. A
+  // record acquired after this ran is released by rcu_read_unlock.
+  struct thread_owner {
+    ~thread_owner() {
+      rcu_thread_state& t = rcu_this_thread;
+      t.exiting = true;
+      if (t.record && t.nesting == 0) release(t);
+    }
+  };
+
+  rcu_domain() noexcept {
+#if defined(__linux__)
+    const long cmds = ::syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+    asymmetric_ = cmds > 0 && (cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED) &&
+                  ::syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#endif
+  }
+
+  // Pairs with the readers' light fence: either a full barrier on every
+  // running thread of the process, or, failing that, an ordinary fence
+  // matching the readers' own.
+  void heavy_fence() noexcept {
+#if defined(__linux__)
+    if (asymmetric_) {
+      ::syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+      return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  rcu_reader_record* acquire_record() {
+    for (rcu_reader_record* r = readers_.load(std::memory_order_acquire); r; r = r->next) {
+      bool free = false;
+      if (!r->in_use.load(std::memory_order_relaxed) &&
+          r->in_use.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+        return r;
+      }
+    }
+    auto* r = new rcu_reader_record;
+    r->next = readers_.load(std::memory_order_relaxed);
+    while (!readers_.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+    return r;
+  }
+
+  // Frees every retired object that no active reader can still reach.
+  void reclaim() {
+    heavy_fence();
+    std::uint64_t oldest = UINT64_MAX;
+    for (rcu_reader_record* r = readers_.load(std::memory_order_acquire); r; r = r->next) {
+      const std::uint64_t x = r->epoch.load(std::memory_order_acquire);
+      if (x != 0 && x < oldest) oldest = x;
+    }
+    std::vector<retired> ready;
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      auto keep = retired_.begin();
+      for (retired& item : retired_) {
+        if (item.epoch <= oldest) {
+          ready.push_back(item);
+        } else {
+          *keep++ = item;
+        }
+      }
+      retired_.erase(keep, retired_.end());
+    }
+    for (const retired& item : ready) item.deleter(item.p);
+  }
+
+  alignas(cache_line_size) std::atomic<std::uint64_t> epoch_{1};
+  alignas(cache_line_size) std::atomic<rcu_reader_record*> readers_{nullptr};
+  std::mutex retired_mutex_;
+  std::vector<retired> retired_;
+  std::size_t since_reclaim_ = 0;
+  bool asymmetric_ = false;
+};
+
+}  // namespace detail
+
+// Marks a read-side section. Sections nest.
+inline void rcu_read_lock() {
+  detail::rcu_thread_state& t = detail::rcu_this_thread;
+  if (t.nesting != 0) {
+    ++t.nesting;
+    return;
+  }
+  if (MYSTL_UNLIKELY(!t.record)) detail::rcu_domain::instance().attach(t);
+  t.nesting = 1;
+  t.record->epoch.store(t.global_epoch->load(std::memory_order_acquire), std::memory_order_relaxed);
+  if (t.asymmetric) {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } else {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+inline void rcu_read_unlock() noexcept {
+  detail::rcu_thread_state& t = detail::rcu_this_thread;
+  if (--t.nesting == 0) {
+    t.record->epoch.store(0, std::memory_order_release);
+    if (MYSTL_UNLIKELY(t.exiting)) detail::rcu_domain::release(t);
+  }
+}
+
+class rcu_read_guard {
+ public:
+  rcu_read_guard() { rcu_read_lock(); }
+  rcu_read_guard(const rcu_read_guard&) = delete;
+  rcu_read_guard& operator=(const rcu_read_guard&) = delete;
+  ~rcu_read_guard() { rcu_read_unlock(); }
+};
+
+// Frees p once no reader can reach it any more. p must already be
+// unreachable for new readers.
+template <class T>
+void rcu_retire(T* p) {
+  if (p) detail::rcu_domain::instance().retire(p, [](void* q) { delete static_cast<T*>(q); });
+}
+
+inline void rcu_synchronize() noexcept { detail::rcu_domain::instance().synchronize(); }
+
+// Waits for current readers, then frees everything retired so far.
+inline void rcu_barrier() { detail::rcu_domain::instance().barrier(); }
+
+// Pointer to an immutable T that readers access without locks and writers
+// replace wholesale.
+template <class T>
+class rcu_cell {
+ public:
+  // Keeps the object it points to alive until destroyed. Not movable: it
+  // pins a read-side section on the creating thread.
+  class read_ptr {
+   public:
+    read_ptr(const read_ptr&) = delete;
+    read_ptr& operator=(const read_ptr&) = delete;
+
+    const T& operator*() const noexcept { return *p_; }
+    const T* operator->() const noexcept { return p_; }
+    const T* get() const noexcept { return p_; }
+
+   private:
+    friend class rcu_cell;
+    explicit read_ptr(const std::atomic<T*>& src) : p_(src.load(std::memory_order_acquire)) {}
+
+    rcu_read_guard guard_;
+    const T* p_;
+  };
+
+  rcu_cell()
+    requires std::default_initializable<T>
+      : rcu_cell(std::make_unique<T>()) {}
+  template <class... Args>
+  explicit rcu_cell(std::in_place_t, Args&&... args)
+      : rcu_cell(std::make_unique<T>(std::forward<Args>(args)...)) {}
+  explicit rcu_cell(std::unique_ptr<T> p) : ptr_(checked(std::move(p))) {}
+  rcu_cell(const rcu_cell&) = delete;
+  rcu_cell& operator=(const rcu_cell&) = delete;
+
+  // No reader may still hold a read_ptr from this cell.
+  ~rcu_cell() { delete ptr_.load(std::memory_order_relaxed); }
+
+  read_ptr read() const { return read_ptr(ptr_); }
+
+  // Publishes p and retires the previous object.
+  void store(std::unique_ptr<T> p) {
+    T* old = ptr_.exchange(checked(std::move(p)), std::memory_order_acq_rel);
+    rcu_retire(old);
+  }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    store(std::make_unique<T>(std::forward<Args>(args)...));
+  }
+
+  // Copies the current object, applies f to the copy and publishes it.
+  // Concurrent updates are serialised, so none is lost.
+  template <class F>
+  void update(F&& f) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    auto copy = std::make_unique<T>(*ptr_.load(std::memory_order_acquire));
+    std::forward<F>(f)(*copy);
+    store(std::move(copy));
+  }
+
+ private:
+  static T* checked(std::unique_ptr<T> p) {
+    if (!p) throw std::invalid_argument("rcu_cell: null object");
+    return p.release();
+  }
+
+  // Readers only load this line; writers' bookkeeping lives on another.
+  alignas(cache_line_size) std::atomic<T*> ptr_;
+  alignas(cache_line_size) std::mutex update_mutex_;
+};
+
+}  // namespace mystl
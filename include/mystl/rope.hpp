@@ -0,0 +1,631 @@
+#pragma once
+
+// Rope: a string stored as a balanced tree of chunks, for large texts that
+// are edited in the middle.
+//
+//   mystl::rope doc(read_file("big.txt"));       // 100 MB, built bottom-up
+//   doc.insert(50'000'000, "inserted");           // O(log n)
+//   mystl::rope head = doc.substr(0, 1 << 20);    // O(log n), shares chunks
+//   doc.erase(10, 1'000'000);                     // O(log n)
+//   doc.for_each_chunk([&](std::string_view c) { out.write(c.data(), c.size()); });
+//
+// The tree is persistent: nodes are immutable once shared and reference
+// counted, so copying a rope is O(1) and edits copy only the O(log n) nodes
+// on the paths they touch. Leaves hold up to leaf_capacity characters;
+// concatenation merges adjacent small leaves, so repeated small edits do not
+// degrade into one node per character. Inner nodes are height-balanced
+// (AVL); split and concatenate are the join-based algorithms of Blelloch,
+// Ferizovic and Sun, each O(log n), and every edit is a few of them.
+// Appending to a rope whose right spine is not shared writes into the last
+// leaf in place.
+//
+// Ropes may be copied and read from several threads; iterators are
+// invalidated by any modification of the rope they came from.
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+namespace mystl {
+
+template <class CharT, class Traits = std::char_traits<CharT>>
+class basic_rope {
+  struct node;
+
+ public:
+  using traits_type = Traits;
+  using value_type = CharT;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using string_type = std::basic_string<CharT, Traits>;
+
+  static constexpr size_type npos = view_type::npos;
+  static constexpr size_type leaf_capacity = std::max<size_type>(16, 1024 / sizeof(CharT));
+
+  class const_iterator;
+  using iterator = const_iterator;
+
+  // --- construction -------------------------------------------------------
+
+  basic_rope() noexcept = default;
+  basic_rope(view_type s) : root_(build(s.data(), s.size())) {}
+  basic_rope(const CharT* s) : basic_rope(view_type(s)) {}
+  basic_rope(size_type n, CharT ch) : basic_rope(string_type(n, ch)) {}
+  basic_rope(std::nullptr_t) = delete;
+
+  basic_rope(const basic_rope& other) noexcept : root_(other.root_) {}
+  basic_rope(basic_rope&&) noexcept = default;
+  basic_rope& operator=(const basic_rope& other) noexcept {
+    root_ = other.root_;
+    return *this;
+  }
+  basic_rope& operator=(basic_rope&&) noexcept = default;
+  basic_rope& operator=(view_type s) { return *this = basic_rope(s); }
+
+  // --- access -------------------------------------------------------------
+
+  size_type size() const noexcept { return root_ ? root_->size : 0; }
+  size_type length() const noexcept { return size(); }
+  bool empty() const noexcept { return size() == 0; }
+
+  // O(log n).
+  CharT operator[](size_type pos) const noexcept {
+    const node* n = root_.get();
+    while (n->height != 0) {
+      if (pos < n->left->size) {
+        n = n->left;
+      } else {
+        pos -= n->left->size;
+        n = n->right;
+      }
+    }
+    return n->chars()[pos];
+  }
+
+  CharT at(size_type pos) const {
+    if (pos >= size()) throw std::out_of_range("rope::at");
+    return (*this)[pos];
+  }
+
+  CharT front() const noexcept { return (*this)[0]; }
+  CharT back() const noexcept { return (*this)[size() - 1]; }
+
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator end() const noexcept { return const_iterator(this, size()); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // Calls f(view) for each chunk, in order.
+  template <class F>
+  void for_each_chunk(F&& f) const {
+    for_each_chunk(0, npos, f);
+  }
+
+  // Calls f(view) for the chunks covering [pos, pos + n), trimmed to it.
+  template <class F>
+  void for_each_chunk(size_type pos, size_type n, F&& f) const {
+    check_pos(pos, "rope::for_each_chunk");
+    n = std::min(n, size() - pos);
+    if (n != 0) visit(root_.get(), pos, n, f);
+  }
+
+  string_type str() const {
+    string_type out;
+    out.reserve(size());
+    for_each_chunk([&](view_type c) { out.append(c); });
+    return out;
+  }
+  explicit operator string_type() const { return str(); }
+
+  size_type copy(CharT* dest, size_type n, size_type pos = 0) const {
+    check_pos(pos, "rope::copy");
+    size_type written = 0;
+    for_each_chunk(pos, n, [&](view_type c) {
+      Traits::copy(dest + written, c.data(), c.size());
+      written += c.size();
+    });
+    return written;
+  }
+
+  // O(log n); shares all but the boundary chunks with *this.
+  basic_rope substr(size_type pos = 0, size_type n = npos) const {
+    check_pos(pos, "rope::substr");
+    n = std::min(n, size() - pos);
+    auto [left, rest] = split(root_, pos);
+    auto [mid, right] = split(std::move(rest), n);
+    return basic_rope(std::move(mid));
+  }
+
+  // --- modification -------------------------------------------------------
+
+  void clear() noexcept { root_ = {}; }
+
+  basic_rope& append(view_type s) {
+    if (s.empty()) return *this;
+    if (!append_in_place(s)) root_ = concat(std::move(root_), build(s.data(), s.size()));
+    return *this;
+  }
+  basic_rope& append(const CharT* s) { return append(view_type(s)); }
+  basic_rope& append(const basic_rope& r) {
+    root_ = concat(std::move(root_), r.root_);
+    return *this;
+  }
+  basic_rope& operator+=(view_type s) { return append(s); }
+  basic_rope& operator+=(const CharT* s) { return append(view_type(s)); }
+  basic_rope& operator+=(const basic_rope& r) { return append(r); }
+  basic_rope& operator+=(CharT ch) { return append(view_type(&ch, 1)); }
+  void push_back(CharT ch) { append(view_type(&ch, 1)); }
+
+  basic_rope& insert(size_type pos, view_type s) {
+    check_pos(pos, "rope::insert");
+    if (s.empty()) return *this;
+    if (pos == size()) return append(s);
+    return insert(pos, basic_rope(s));
+  }
+  basic_rope& insert(size_type pos, const CharT* s) { return insert(pos, view_type(s)); }
+  basic_rope& insert(size_type pos, const basic_rope& r) {
+    check_pos(pos, "rope::insert");
+    auto [left, right] = split(std::move(root_), pos);
+    root_ = concat(concat(std::move(left), r.root_), std::move(right));
+    return *this;
+  }
+
+  basic_rope& erase(size_type pos = 0, size_type n = npos) {
+    check_pos(pos, "rope::erase");
+    n = std::min(n, size() - pos);
+    auto [left, rest] = split(std::move(root_), pos);
+    auto [mid, right] = split(std::move(rest), n);
+    root_ = concat(std::move(left), std::move(right));
+    return *this;
+  }
+
+  basic_rope& replace(size_type pos, size_type n, view_type s) {
+    return replace(pos, n, basic_rope(s));
+  }
+  basic_rope& replace(size_type pos, size_type n, const CharT* s) {
+    return replace(pos, n, view_type(s));
+  }
+  basic_rope& replace(size_type pos, size_type n, const basic_rope& r) {
+    check_pos(pos, "rope::replace");
+    n = std::min(n, size() - pos);
+    auto [left, rest] = split(std::move(root_), pos);
+    auto [mid, right] = split(std::move(rest), n);
+    root_ = concat(concat(std::move(left), r.root_), std::move(right));
+    return *this;
+  }
+
+  void swap(basic_rope& other) noexcept { root_.swap(other.root_); }
+  friend void swap(basic_rope& a, basic_rope& b) noexcept { a.swap(b); }
+
+  friend basic_rope operator+(const basic_rope& a, const basic_rope& b) {
+    basic_rope r(a);
+    r.append(b);
+    return r;
+  }
+
+  // --- comparison ---------------------------------------------------------
+
+  int compare(const basic_rope& other) const {
+    if (root_.get() == other.root_.get()) return 0;
+    return compare_chunks(other);
+  }
+  int compare(const CharT* s) const { return compare(view_type(s)); }
+  int compare(view_type s) const {
+    int result = 0;
+    size_type offset = 0;
+    for_each_chunk([&](view_type c) {
+      if (result != 0) return;
+      const view_type part = s.substr(std::min(offset, s.size()), c.size());
+      result = c.compare(part);
+      offset += c.size();
+    });
+    if (result != 0) return result;
+    return size() < s.size() ? -1 : 0;
+  }
+
+  friend bool operator==(const basic_rope& a, const basic_rope& b) {
+    return a.size() == b.size() && a.compare(b) == 0;
+  }
+  friend bool operator==(const basic_rope& a, view_type b) {
+    return a.size() == b.size() && a.compare(b) == 0;
+  }
+  friend std::strong_ordering operator<=>(const basic_rope& a, const basic_rope& b) {
+    return a.compare(b) <=> 0;
+  }
+  friend std::strong_ordering operator<=>(const basic_rope& a, view_type b) {
+    return a.compare(b) <=> 0;
+  }
+  friend bool operator==(const basic_rope& a, const CharT* b) { return a == view_type(b); }
+  friend std::strong_ordering operator<=>(const basic_rope& a, const CharT* b) {
+    return a <=> view_type(b);
+  }
+
+  friend std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                       const basic_rope& r) {
+    r.for_each_chunk(
+        [&](view_type c) { os.write(c.data(), static_cast<std::streamsize>(c.size())); });
+    return os;
+  }
+
+  // Height of the tree; 0 for a single chunk. For tests and tuning.
+  unsigned height() const noexcept { return root_ ? root_->height : 0; }
+
+  // Random-access iterator over the characters. Dereferencing outside the
+  // cached chunk descends from the root, so sequential access is amortised
+  // O(1) and random access O(log n).
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = CharT;
+    using difference_type = std::ptrdiff_t;
+    using reference = CharT;
+    using pointer = void;
+
+    const_iterator() noexcept = default;
+
+    CharT operator*() const noexcept {
+      if (pos_ - chunk_begin_ >= chunk_size_) locate();
+      return chunk_[pos_ - chunk_begin_];
+    }
+    CharT operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    const_iterator& operator++() noexcept {
+      ++pos_;
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      const_iterator t = *this;
+      ++pos_;
+      return t;
+    }
+    const_iterator& operator--() noexcept {
+      --pos_;
+      return *this;
+    }
+    const_iterator operator--(int) noexcept {
+      const_iterator t = *this;
+      --pos_;
+      return t;
+    }
+    const_iterator& operator+=(difference_type n) noexcept {
+      pos_ += static_cast<size_type>(n);
+      return *this;
+    }
+    const_iterator& operator-=(difference_type n) noexcept {
+      pos_ -= static_cast<size_type>(n);
+      return *this;
+    }
+    friend const_iterator operator+(const_iterator it, difference_type n) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator+(difference_type n, const_iterator it) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator-(const_iterator it, difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept {
+      return static_cast<difference_type>(a.pos_ - b.pos_);
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+      return a.pos_ == b.pos_;
+    }
+    friend std::strong_ordering operator<=>(const const_iterator& a,
+                                            const const_iterator& b) noexcept {
+      return a.pos_ <=> b.pos_;
+    }
+
+    // Position in the rope.
+    size_type index() const noexcept { return pos_; }
+
+   private:
+    friend class basic_rope;
+    const_iterator(const basic_rope* r, size_type pos) noexcept : rope_(r), pos_(pos) {}
+
+    void locate() const noexcept {
+      size_type p = pos_;
+      const node* n = rope_->root_.get();
+      while (n->height != 0) {
+        if (p < n->left->size) {
+          n = n->left;
+        } else {
+          p -= n->left->size;
+          n = n->right;
+        }
+      }
+      chunk_ = n->chars();
+      chunk_begin_ = pos_ - p;
+      chunk_size_ = n->size;
+    }
+
+    const basic_rope* rope_ = nullptr;
+    size_type pos_ = 0;
+    mutable const CharT* chunk_ = nullptr;
+    mutable size_type chunk_begin_ = 0;
+    mutable size_type chunk_size_ = 0;
+  };
+
+ private:
+  // Leaves (height 0) store their characters right after the node.
+  struct node {
+    std::atomic<std::uint32_t> refs{1};
+    std::uint8_t height = 0;
+    size_type size = 0;
+    size_type capacity = 0;  // leaves only
+    node* left = nullptr;    // inner nodes only
+    node* right = nullptr;
+
+    CharT* chars() noexcept { return reinterpret_cast<CharT*>(this + 1); }
+    const CharT* chars() const noexcept { return reinterpret_cast<const CharT*>(this + 1); }
+  };
+  static_assert(alignof(node) >= alignof(CharT));
+
+  // Owning reference to a node.
+  class node_ref {
+   public:
+    node_ref() noexcept = default;
+    explicit node_ref(node* n) noexcept : n_(n) {}
+    node_ref(const node_ref& o) noexcept : n_(retain(o.n_)) {}
+    node_ref(node_ref&& o) noexcept : n_(std::exchange(o.n_, nullptr)) {}
+    node_ref& operator=(node_ref o) noexcept {
+      swap(o);
+      return *this;
+    }
+    ~node_ref() { release(n_); }
+
+    node* get() const noexcept { return n_; }
+    node* operator->() const noexcept { return n_; }
+    explicit operator bool() const noexcept { return n_ != nullptr; }
+    node* detach() noexcept { return std::exchange(n_, nullptr); }
+    void swap(node_ref& o) noexcept { std::swap(n_, o.n_); }
+
+   private:
+    node* n_ = nullptr;
+  };
+
+  explicit basic_rope(node_ref root) noexcept : root_(std::move(root)) {}
+
+  static node* retain(node* n) noexcept {
+    if (n) n->refs.fetch_add(1, std::memory_order_relaxed);
+    return n;
+  }
+
+  static void release(node* n) noexcept {
+    while (n && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      node* right = n->right;
+      if (n->height != 0) release(n->left);
+      n->~node();
+      ::operator delete(n);
+      n = right;  // iterative on the right spine
+    }
+  }
+
+  static bool unique(const node* n) noexcept {
+    return n->refs.load(std::memory_order_acquire) == 1;
+  }
+
+  static node_ref make_leaf(const CharT* s, size_type n, size_type capacity) {
+    void* mem = ::operator new(sizeof(node) + capacity * sizeof(CharT));
+    node* x = ::new (mem) node;
+    x->size = n;
+    x->capacity = capacity;
+    Traits::copy(x->chars(), s, n);
+    return node_ref(x);
+  }
+
+  static node_ref make_leaf(const CharT* a, size_type na, const CharT* b, size_type nb) {
+    node_ref x = make_leaf(a, na, leaf_capacity);
+    Traits::copy(x->chars() + na, b, nb);
+    x->size = na + nb;
+    return x;
+  }
+
+  static int height_of(const node_ref& n) noexcept { return n ? n->height : -1; }
+
+  // Inner node over two non-empty subtrees whose heights differ by at most
+  // one.
+  static node_ref make_inner(node_ref l, node_ref r) {
+    void* mem = ::operator new(sizeof(node));
+    node* x = ::new (mem) node;
+    x->height = static_cast<std::uint8_t>(std::max(l->height, r->height) + 1);
+    x->size = l->size + r->size;
+    x->left = l.detach();
+    x->right = r.detach();
+    return node_ref(x);
+  }
+
+  static node_ref left_of(const node_ref& n) noexcept { return node_ref(retain(n->left)); }
+  static node_ref right_of(const node_ref& n) noexcept { return node_ref(retain(n->right)); }
+
+  // Inner node over l and r whose heights differ by at most two, rotated
+  // back into AVL balance.
+  static node_ref make_balanced(node_ref l, node_ref r) {
+    if (l->height > r->height + 1) {
+      node_ref ll = left_of(l), lr = right_of(l);
+      if (height_of(ll) >= height_of(lr)) {
+        return make_inner(std::move(ll), make_inner(std::move(lr), std::move(r)));
+      }
+      node_ref lrl = left_of(lr), lrr = right_of(lr);
+      return make_inner(make_inner(std::move(ll), std::move(lrl)),
+                        make_inner(std::move(lrr), std::move(r)));
+    }
+    if (r->height > l->height + 1) {
+      node_ref rl = left_of(r), rr = right_of(r);
+      if (height_of(rr) >= height_of(rl)) {
+        return make_inner(make_inner(std::move(l), std::move(rl)), std::move(rr));
+      }
+      node_ref rll = left_of(rl), rlr = right_of(rl);
+      return make_inner(make_inner(std::move(l), std::move(rll)),
+                        make_inner(std::move(rlr), std::move(rr)));
+    }
+    return make_inner(std::move(l), std::move(r));
+  }
+
+  // a followed by b; adjacent small leaves become one.
+  static node_ref concat(node_ref a, node_ref b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (b->height == 0) {
+      if (node_ref merged = merge_rightmost(a, b)) return merged;
+    } else if (a->height == 0) {
+      if (node_ref merged = merge_leftmost(a, b)) return merged;
+    }
+    return join(std::move(a), std::move(b));
+  }
+
+  // AVL join of two non-empty trees in O(|height(a) - height(b)| + 1).
+  static node_ref join(node_ref a, node_ref b) {
+    if (a->height > b->height + 1) {
+      return make_balanced(left_of(a), join(right_of(a), std::move(b)));
+    }
+    if (b->height > a->height + 1) {
+      return make_balanced(join(std::move(a), left_of(b)), right_of(b));
+    }
+    return make_inner(std::move(a), std::move(b));
+  }
+
+  // t with leaf b appended to its last leaf, if they fit in one; else null.
+  static node_ref merge_rightmost(const node_ref& t, const node_ref& b) {
+    if (t->height == 0) {
+      if (t->size + b->size > leaf_capacity) return {};
+      return make_leaf(t->chars(), t->size, b->chars(), b->size);
+    }
+    node_ref r = merge_rightmost(right_of(t), b);
+    if (!r) return {};
+    return make_inner(left_of(t), std::move(r));
+  }
+
+  static node_ref merge_leftmost(const node_ref& a, const node_ref& t) {
+    if (t->height == 0) {
+      if (a->size + t->size > leaf_capacity) return {};
+      return make_leaf(a->chars(), a->size, t->chars(), t->size);
+    }
+    node_ref l = merge_leftmost(a, left_of(t));
+    if (!l) return {};
+    return make_inner(std::move(l), right_of(t));
+  }
+
+  // [0, pos) and [pos, size).
+  static std::pair<node_ref, node_ref> split(node_ref t, size_type pos) {
+    if (!t || pos == 0) return {node_ref(), std::move(t)};
+    if (pos >= t->size) return {std::move(t), node_ref()};
+    if (t->height == 0) {
+      return {make_leaf(t->chars(), pos, pos),
+              make_leaf(t->chars() + pos, t->size - pos, t->size - pos)};
+    }
+    const size_type left_size = t->left->size;
+    if (pos < left_size) {
+      auto [ll, lr] = split(left_of(t), pos);
+      return {std::move(ll), concat(std::move(lr), right_of(t))};
+    }
+    if (pos == left_size) return {left_of(t), right_of(t)};
+    auto [rl, rr] = split(right_of(t), pos - left_size);
+    return {concat(left_of(t), std::move(rl)), std::move(rr)};
+  }
+
+  // Balanced tree over s, cut into equal leaves.
+  static node_ref build(const CharT* s, size_type n) {
+    if (n == 0) return {};
+    const size_type leaves = (n + leaf_capacity - 1) / leaf_capacity;
+    return build_leaves(s, n, leaves);
+  }
+
+  static node_ref build_leaves(const CharT* s, size_type n, size_type leaves) {
+    if (leaves == 1) return make_leaf(s, n, n < leaf_capacity ? leaf_capacity : n);
+    const size_type half = leaves / 2;
+    const size_type cut = n / leaves * half;
+    return make_inner(build_leaves(s, cut, half), build_leaves(s + cut, n - cut, leaves - half));
+  }
+
+  // Writes s into the last leaf if it and the path to it are unshared and
+  // the leaf has room.
+  bool append_in_place(view_type s) {
+    if (!root_) return false;
+    node* path[128];
+    std::size_t depth = 0;
+    node* n = root_.get();
+    for (;;) {
+      if (!unique(n)) return false;
+      path[depth++] = n;
+      if (n->height == 0) break;
+      n = n->right;
+    }
+    if (n->capacity - n->size < s.size()) return false;
+    Traits::copy(n->chars() + n->size, s.data(), s.size());
+    for (std::size_t i = 0; i < depth; ++i) path[i]->size += s.size();
+    return true;
+  }
+
+  template <class F>
+  static void visit(const node* n, size_type pos, size_type count, F& f) {
+    while (n->height != 0) {
+      const size_type left_size = n->left->size;
+      if (pos >= left_size) {
+        pos -= left_size;
+        n = n->right;
+        continue;
+      }
+      if (pos + count <= left_size) {
+        n = n->left;
+        continue;
+      }
+      const size_type in_left = left_size - pos;
+      visit(n->left, pos, in_left, f);
+      pos = 0;
+      count -= in_left;
+      n = n->right;
+    }
+    f(view_type(n->chars() + pos, count));
+  }
+
+  int compare_chunks(const basic_rope& other) const {
+    std::vector<view_type> theirs;
+    other.for_each_chunk([&](view_type c) { theirs.push_back(c); });
+    std::size_t j = 0;
+    view_type b = theirs.empty() ? view_type() : theirs[0];
+    int result = 0;
+    for_each_chunk([&](view_type a) {
+      while (result == 0 && !a.empty()) {
+        if (b.empty()) {
+          if (++j >= theirs.size()) {
+            result = 1;
+            return;
+          }
+          b = theirs[j];
+        }
+        const size_type k = std::min(a.size(), b.size());
+        result = Traits::compare(a.data(), b.data(), k);
+        a.remove_prefix(k);
+        b.remove_prefix(k);
+      }
+    });
+    if (result != 0) return result;
+    return size() < other.size() ? -1 : size() > other.size() ? 1 : 0;
+  }
+
+  void check_pos(size_type pos, const char* what) const {
+    if (pos > size()) throw std::out_of_range(what);
+  }
+
+  node_ref root_;
+};
+
+using rope = basic_rope<char>;
+using wrope = basic_rope<wchar_t>;
+
+}  // namespace mystl
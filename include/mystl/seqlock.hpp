@@ -0,0 +1,135 @@
+#pragma once
+
+// Sequence lock for small, trivially copyable values that are read far
+// more often than they are written.
+//
+//   mystl::seqlock<quote> q;
+//   q.store({101.5, 101.6});          // writer
+//   quote now = q.load();             // reader: never blocks the writer
+//   q.update([](quote& v) { v.bid += 0.1; });
+//
+// A reader copies the value and retries if a write overlapped the copy, so
+// readers only ever read shared memory; they never bounce a cache line
+// between cores the way a reader count does. Writers are serialised by the
+// sequence word itself (odd while a write is in progress) and never wait
+// for readers, so a steady stream of writes can starve readers.
+//
+// The value is stored as an array of relaxed atomic words, which keeps the
+// racing reads well-defined (Boehm, "Can Seqlocks Get Along With
+// Programming Language Memory Models?").
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "config.hpp"
+#include "synchronization.hpp"
+
+namespace mystl {
+
+template <class T>
+class seqlock {
+  static_assert(std::is_trivially_copyable_v<T>, "seqlock: T must be trivially copyable");
+
+  static constexpr std::size_t word_count =
+      (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+ public:
+  using value_type = T;
+
+  seqlock() noexcept
+    requires std::default_initializable<T>
+      : seqlock(T{}) {}
+  explicit seqlock(const T& value) noexcept { write_words(value); }
+  seqlock(const seqlock&) = delete;
+  seqlock& operator=(const seqlock&) = delete;
+
+  T load() const noexcept {
+    T out;
+    while (!try_load(out)) MYSTL_CPU_RELAX();
+    return out;
+  }
+
+  // Single attempt; false if a write was in progress or overlapped.
+  bool try_load(T& out) const noexcept {
+    const std::uint64_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1) return false;
+    std::uint64_t words[word_count];
+    for (std::size_t i = 0; i < word_count; ++i) {
+      words[i] = data_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before) return false;
+    std::memcpy(static_cast<void*>(&out), words, sizeof(T));
+    return true;
+  }
+
+  void store(const T& value) noexcept {
+    const std::uint64_t s = lock();
+    write_words(value);
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Calls f on a copy of the current value and publishes the result, with
+  // other writers excluded throughout.
+  template <class F>
+  void update(F&& f) {
+    const std::uint64_t s = lock();
+    T value;
+    read_words(value);
+    try {
+      f(value);
+    } catch (...) {
+      seq_.store(s + 2, std::memory_order_release);
+      throw;
+    }
+    write_words(value);
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Even while no write is in progress; changes with every write.
+  std::uint64_t version() const noexcept { return seq_.load(std::memory_order_acquire); }
+
+ private:
+  // Makes the sequence odd; returns the even value it had before.
+  std::uint64_t lock() noexcept {
+    std::uint64_t s = seq_.load(std::memory_order_relaxed);
+    detail::spin_backoff backoff;
+    for (;;) {
+      if (!(s & 1) && seq_.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+        break;
+      }
+      backoff();
+      s = seq_.load(std::memory_order_relaxed);
+    }
+    // Keeps the data stores below from becoming visible before the odd
+    // sequence number.
+    std::atomic_thread_fence(std::memory_order_release);
+    return s;
+  }
+
+  void write_words(const T& value) noexcept {
+    std::uint64_t words[word_count] = {};
+    std::memcpy(words, static_cast<const void*>(&value), sizeof(T));
+    for (std::size_t i = 0; i < word_count; ++i) {
+      data_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  void read_words(T& value) const noexcept {
+    std::uint64_t words[word_count];
+    for (std::size_t i = 0; i < word_count; ++i) {
+      words[i] = data_[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(static_cast<void*>(&value), words, sizeof(T));
+  }
+
+  alignas(cache_line_size) std::atomic<std::uint64_t> seq_{0};
+  std::atomic<std::uint64_t> data_[word_count];
+};
+
+}  // namespace mystl
@@ -0,0 +1,203 @@
+#pragma once
+
+// Counters and summary statistics for hot paths that many threads update
+// and few threads read.
+//
+//   mystl::sharded_counter requests;
+//   requests.add();                      // on every request, any thread
+//   std::uint64_t n = requests.load();   // from the metrics exporter
+//
+//   mystl::sharded_histogram latency_ns;
+//   latency_ns.record(elapsed);
+//   auto s = latency_ns.snapshot();     // count, sum, min, max, log2 buckets
+//   report(s.mean(), s.quantile(0.99));
+//
+// A single std::atomic counter bounces its cache line between every core
+// that increments it. These types keep one cache-line-padded slot per CPU
+// instead and sum the slots when read, so an update touches a line that
+// normally stays in the updating core's cache. Where glibc has registered
+// rseq (see detail::current_cpu), finding the slot is one thread-local
+// load. The update itself is still a relaxed atomic read-modify-write: a
+// thread can migrate or be preempted between choosing a slot and writing
+// it, so two threads may share a slot, but that only costs contention,
+// never a lost update. Off Linux the slot is chosen by thread id.
+//
+// Reads are not a consistent snapshot across slots: updates that race with
+// load() may or may not be included, exactly as if they had happened just
+// before or just after it.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "config.hpp"
+#include "synchronization.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// Number of per-CPU slots to allocate: a power of two so that the CPU id
+// can be masked. 0 picks one slot per hardware thread.
+inline std::size_t shard_count(std::size_t requested) noexcept {
+  constexpr std::size_t max_shards = 1024;
+  if (requested == 0) requested = std::thread::hardware_concurrency();
+  return std::bit_ceil(std::clamp<std::size_t>(requested, 1, max_shards));
+}
+
+}  // namespace detail
+
+class sharded_counter {
+ public:
+  explicit sharded_counter(std::size_t shards = 0)
+      : mask_(detail::shard_count(shards) - 1), slots_(new slot[mask_ + 1]) {}
+  sharded_counter(const sharded_counter&) = delete;
+  sharded_counter& operator=(const sharded_counter&) = delete;
+
+  void add(std::uint64_t n = 1) noexcept { local().fetch_add(n, std::memory_order_relaxed); }
+  // Wraps modulo 2^64, like an unsigned atomic; the total is what matters.
+  void sub(std::uint64_t n = 1) noexcept { local().fetch_sub(n, std::memory_order_relaxed); }
+
+  sharded_counter& operator++() noexcept {
+    add();
+    return *this;
+  }
+  sharded_counter& operator+=(std::uint64_t n) noexcept {
+    add(n);
+    return *this;
+  }
+
+  std::uint64_t load() const noexcept {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i <= mask_; ++i) sum += slots_[i].value.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  // Zeroes the counter and returns what it held. Concurrent updates are
+  // counted either in the result or in the new total, never lost.
+  std::uint64_t exchange_zero() noexcept {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      sum += slots_[i].value.exchange(0, std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  std::size_t shard_count() const noexcept { return mask_ + 1; }
+
+ private:
+  struct alignas(cache_line_size) slot {
+    std::atomic<std::uint64_t> value{0};
+  };
+
+  std::atomic<std::uint64_t>& local() noexcept {
+    return slots_[detail::current_cpu() & mask_].value;
+  }
+
+  std::size_t mask_;
+  std::unique_ptr<slot[]> slots_;
+};
+
+// Count, sum, min, max and a power-of-two histogram of unsigned samples.
+// Bucket 0 holds zeros; bucket i > 0 holds [2^(i-1), 2^i).
+class sharded_histogram {
+ public:
+  static constexpr std::size_t bucket_count = std::numeric_limits<std::uint64_t>::digits + 1;
+
+  struct summary {
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;  // wraps on overflow
+    std::uint64_t min = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t max = 0;
+    std::array<std::uint64_t, bucket_count> buckets{};
+
+    double mean() const noexcept {
+      return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+    }
+
+    // Upper bound of the bucket holding the q-th quantile, clamped to
+    // [min, max]; within a factor of two of the true value.
+    std::uint64_t quantile(double q) const noexcept {
+      if (count == 0) return 0;
+      q = std::clamp(q, 0.0, 1.0);
+      const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+      std::uint64_t seen = 0;
+      for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+          const std::uint64_t upper = i == bucket_count - 1 ? max : (std::uint64_t{1} << i) - 1;
+          return std::clamp(upper, min, max);
+        }
+      }
+      return max;
+    }
+
+    summary& operator+=(const summary& other) noexcept {
+      count += other.count;
+      sum += other.sum;
+      min = std::min(min, other.min);
+      max = std::max(max, other.max);
+      for (std::size_t i = 0; i < bucket_count; ++i) buckets[i] += other.buckets[i];
+      return *this;
+    }
+  };
+
+  explicit sharded_histogram(std::size_t shards = 0)
+      : mask_(detail::shard_count(shards) - 1), slots_(new slot[mask_ + 1]) {}
+  sharded_histogram(const sharded_histogram&) = delete;
+  sharded_histogram& operator=(const sharded_histogram&) = delete;
+
+  void record(std::uint64_t value) noexcept {
+    slot& s = slots_[detail::current_cpu() & mask_];
+    s.count.fetch_add(1, std::memory_order_relaxed);
+    s.sum.fetch_add(value, std::memory_order_relaxed);
+    s.buckets[std::bit_width(value)].fetch_add(1, std::memory_order_relaxed);
+    // Min and max change rarely once warmed up, so test before writing.
+    for (std::uint64_t m = s.min.load(std::memory_order_relaxed);
+         value < m && !s.min.compare_exchange_weak(m, value, std::memory_order_relaxed);) {
+    }
+    for (std::uint64_t m = s.max.load(std::memory_order_relaxed);
+         value > m && !s.max.compare_exchange_weak(m, value, std::memory_order_relaxed);) {
+    }
+  }
+
+  summary snapshot() const noexcept {
+    summary out;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      const slot& s = slots_[i];
+      out.count += s.count.load(std::memory_order_relaxed);
+      out.sum += s.sum.load(std::memory_order_relaxed);
+      out.min = std::min(out.min, s.min.load(std::memory_order_relaxed));
+      out.max = std::max(out.max, s.max.load(std::memory_order_relaxed));
+      for (std::size_t b = 0; b < bucket_count; ++b) {
+        out.buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+      }
+    }
+    if (out.count == 0) out.min = 0;
+    return out;
+  }
+
+  std::size_t shard_count() const noexcept { return mask_ + 1; }
+
+ private:
+  // The scalars share the first line with the low buckets; a slot spans
+  // nine lines, all owned by one CPU.
+  struct alignas(cache_line_size) slot {
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> min{std::numeric_limits<std::uint64_t>::max()};
+    std::atomic<std::uint64_t> max{0};
+    std::atomic<std::uint64_t> buckets[bucket_count] = {};
+  };
+
+  std::size_t mask_;
+  std::unique_ptr<slot[]> slots_;
+};
+
+}  // namespace mystl
@@ -0,0 +1,136 @@
+#pragma once
+
+// Allocator that carves from a caller-provided buffer, usually on the stack,
+// and overflows to the heap (after Howard Hinnant's short_alloc).
+//
+//   mystl::stack_arena<4096> arena;
+//   std::vector<int, mystl::short_alloc<int, 4096>> v{arena};
+//   std::basic_string<char, std::char_traits<char>, mystl::short_alloc<char, 4096>> s{arena};
+//
+// The arena is a bump allocator. Freeing the most recent allocation gives
+// its space back, which covers the grow-copy-free pattern of vector and
+// string. Any other free inside the arena is a no-op until reset() or
+// destruction. Requests that do not fit, and requests aligned more
+// strictly than the arena, go to operator new.
+//
+// The arena must outlive every container that uses it, and it is not
+// thread-safe.
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "config.hpp"
+
+namespace mystl {
+
+template <std::size_t N, std::size_t Align = alignof(std::max_align_t)>
+class stack_arena {
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                "stack_arena: Align must be a power of two");
+
+ public:
+  static constexpr std::size_t alignment = Align;
+
+  stack_arena() noexcept : ptr_(buf_) {}
+  stack_arena(const stack_arena&) = delete;
+  stack_arena& operator=(const stack_arena&) = delete;
+
+  // Requests aligned more strictly than the buffer always overflow.
+  template <std::size_t ReqAlign>
+  [[nodiscard]] void* allocate(std::size_t n) {
+    if constexpr (ReqAlign <= Align) {
+      const std::size_t rounded = align_up(n);
+      if (MYSTL_LIKELY(rounded <= static_cast<std::size_t>(buf_ + N - ptr_) && rounded >= n)) {
+        void* p = ptr_;
+        ptr_ += rounded;
+        return p;
+      }
+    }
+    ++overflows_;
+    if constexpr (ReqAlign > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(n, std::align_val_t{ReqAlign});
+    } else {
+      return ::operator new(n);
+    }
+  }
+
+  template <std::size_t ReqAlign>
+  void deallocate(void* p, std::size_t n) noexcept {
+    auto* c = static_cast<std::byte*>(p);
+    if (owns(c)) {
+      if (c + align_up(n) == ptr_) ptr_ = c;
+    } else if constexpr (ReqAlign > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, n, std::align_val_t{ReqAlign});
+    } else {
+      ::operator delete(p, n);
+    }
+  }
+
+  static constexpr std::size_t size() noexcept { return N; }
+  std::size_t used() const noexcept { return static_cast<std::size_t>(ptr_ - buf_); }
+  // Number of requests so far that did not fit and went to the heap.
+  std::size_t overflow_count() const noexcept { return overflows_; }
+
+  // Makes the whole buffer available again. Only valid once nothing
+  // allocated from the buffer is still in use.
+  void reset() noexcept { ptr_ = buf_; }
+
+ private:
+  static constexpr std::size_t align_up(std::size_t n) noexcept {
+    return (n + (Align - 1)) & ~(Align - 1);
+  }
+
+  // The end of the buffer is included: a zero-byte request on a full arena
+  // is handed out there.
+  bool owns(const std::byte* p) const noexcept {
+    const auto a = reinterpret_cast<std::uintptr_t>(p);
+    return a >= reinterpret_cast<std::uintptr_t>(buf_) &&
+           a <= reinterpret_cast<std::uintptr_t>(buf_ + N);
+  }
+
+  alignas(Align) std::byte buf_[N];
+  std::byte* ptr_;
+  std::size_t overflows_ = 0;
+};
+
+template <class T, std::size_t N, std::size_t Align = alignof(std::max_align_t)>
+class short_alloc {
+ public:
+  using value_type = T;
+  using arena_type = stack_arena<N, Align>;
+
+  template <class U>
+  struct rebind {
+    using other = short_alloc<U, N, Align>;
+  };
+
+  // Implicit, so that containers can be constructed directly from an arena.
+  short_alloc(arena_type& a) noexcept : arena_(&a) {}
+  template <class U>
+  short_alloc(const short_alloc<U, N, Align>& other) noexcept : arena_(other.arena_) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    if (n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+    return static_cast<T*>(arena_->template allocate<alignof(T)>(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    arena_->template deallocate<alignof(T)>(p, n * sizeof(T));
+  }
+
+  arena_type& arena() const noexcept { return *arena_; }
+
+  template <class U>
+  friend bool operator==(const short_alloc& a, const short_alloc<U, N, Align>& b) noexcept {
+    return a.arena_ == b.arena_;
+  }
+
+ private:
+  template <class U, std::size_t M, std::size_t A>
+  friend class short_alloc;
+
+  arena_type* arena_;
+};
+
+}  // namespace mystl
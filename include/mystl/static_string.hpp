@@ -0,0 +1,364 @@
+#pragma once
+
+// Fixed-capacity string with inline, null-terminated storage. Never
+// allocates; operations that would exceed the capacity throw
+// std::length_error. Everything is usable in constant expressions.
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "config.hpp"
+
+namespace mystl {
+
+template <class CharT, std::size_t N, class Traits = std::char_traits<CharT>>
+class basic_static_string {
+ public:
+  using traits_type = Traits;
+  using value_type = CharT;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = CharT&;
+  using const_reference = const CharT&;
+  using pointer = CharT*;
+  using const_pointer = const CharT*;
+  using iterator = CharT*;
+  using const_iterator = const CharT*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  static constexpr size_type npos = view_type::npos;
+
+  // --- construction -------------------------------------------------------
+
+  constexpr basic_static_string() noexcept = default;
+
+  constexpr basic_static_string(size_type n, CharT ch) { assign(n, ch); }
+  constexpr basic_static_string(const CharT* s) { assign(view_type(s)); }
+  constexpr basic_static_string(const CharT* s, size_type n) { assign(view_type(s, n)); }
+  basic_static_string(std::nullptr_t) = delete;
+
+  template <std::input_iterator InputIt>
+  constexpr basic_static_string(InputIt first, InputIt last) {
+    for (; first != last; ++first) push_back(*first);
+  }
+
+  constexpr basic_static_string(std::initializer_list<CharT> il)
+      : basic_static_string(il.begin(), il.end()) {}
+
+  // Explicit from anything convertible to a string_view (std::string,
+  // string_view, another static_string of a different capacity).
+  template <class StringViewLike>
+    requires(std::is_convertible_v<const StringViewLike&, view_type> &&
+             !std::is_convertible_v<const StringViewLike&, const CharT*>)
+  constexpr explicit basic_static_string(const StringViewLike& s) {
+    assign(view_type(s));
+  }
+
+  constexpr basic_static_string& operator=(view_type s) { return assign(s); }
+  constexpr basic_static_string& operator=(const CharT* s) { return assign(view_type(s)); }
+  constexpr basic_static_string& operator=(CharT ch) { return assign(1, ch); }
+
+  constexpr basic_static_string& assign(size_type n, CharT ch) {
+    check_length(n);
+    traits_type::assign(data_, n, ch);
+    set_size(n);
+    return *this;
+  }
+
+  constexpr basic_static_string& assign(view_type s) {
+    check_length(s.size());
+    // s may alias this string at run time; char_traits::move compares the
+    // two pointers, which is not allowed in a constant expression.
+    if (std::is_constant_evaluated()) {
+      traits_type::copy(data_, s.data(), s.size());
+    } else {
+      traits_type::move(data_, s.data(), s.size());
+    }
+    set_size(s.size());
+    return *this;
+  }
+
+  // --- element access -----------------------------------------------------
+
+  constexpr reference at(size_type i) {
+    if (i >= size_) throw std::out_of_range("basic_static_string::at");
+    return data_[i];
+  }
+  constexpr const_reference at(size_type i) const {
+    if (i >= size_) throw std::out_of_range("basic_static_string::at");
+    return data_[i];
+  }
+
+  constexpr reference operator[](size_type i) noexcept { return data_[i]; }
+  constexpr const_reference operator[](size_type i) const noexcept { return data_[i]; }
+  constexpr reference front() noexcept { return data_[0]; }
+  constexpr const_reference front() const noexcept { return data_[0]; }
+  constexpr reference back() noexcept { return data_[size_ - 1]; }
+  constexpr const_reference back() const noexcept { return data_[size_ - 1]; }
+
+  constexpr CharT* data() noexcept { return data_; }
+  constexpr const CharT* data() const noexcept { return data_; }
+  constexpr const CharT* c_str() const noexcept { return data_; }
+
+  constexpr operator view_type() const noexcept { return view_type(data_, size_); }
+  constexpr view_type view() const noexcept { return view_type(data_, size_); }
+
+  // --- iterators ----------------------------------------------------------
+
+  constexpr iterator begin() noexcept { return data_; }
+  constexpr const_iterator begin() const noexcept { return data_; }
+  constexpr const_iterator cbegin() const noexcept { return data_; }
+  constexpr iterator end() noexcept { return data_ + size_; }
+  constexpr const_iterator end() const noexcept { return data_ + size_; }
+  constexpr const_iterator cend() const noexcept { return data_ + size_; }
+
+  constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  // --- capacity -----------------------------------------------------------
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+  constexpr size_type size() const noexcept { return size_; }
+  constexpr size_type length() const noexcept { return size_; }
+  static constexpr size_type max_size() noexcept { return N; }
+  static constexpr size_type capacity() noexcept { return N; }
+  static constexpr void reserve(size_type n) { check_length(n); }
+
+  // --- modifiers ----------------------------------------------------------
+
+  constexpr void clear() noexcept { set_size(0); }
+
+  constexpr void push_back(CharT ch) {
+    check_length(size_ + 1);
+    data_[size_] = ch;
+    set_size(size_ + 1);
+  }
+
+  constexpr void pop_back() noexcept { set_size(size_ - 1); }
+
+  constexpr basic_static_string& append(size_type n, CharT ch) {
+    check_length(size_ + n);
+    traits_type::assign(data_ + size_, n, ch);
+    set_size(size_ + n);
+    return *this;
+  }
+
+  constexpr basic_static_string& append(view_type s) {
+    check_length(size_ + s.size());
+    traits_type::copy(data_ + size_, s.data(), s.size());
+    set_size(size_ + s.size());
+    return *this;
+  }
+
+  constexpr basic_static_string& operator+=(view_type s) { return append(s); }
+  constexpr basic_static_string& operator+=(const CharT* s) { return append(view_type(s)); }
+  constexpr basic_static_string& operator+=(CharT ch) {
+    push_back(ch);
+    return *this;
+  }
+
+  constexpr basic_static_string& insert(size_type pos, view_type s) {
+    if (pos > size_) throw std::out_of_range("basic_static_string::insert");
+    check_length(size_ + s.size());
+    if (aliases(s)) {
+      const basic_static_string tmp(s);
+      splice(pos, 0, tmp.view());
+    } else {
+      splice(pos, 0, s);
+    }
+    return *this;
+  }
+
+  constexpr basic_static_string& insert(size_type pos, size_type n, CharT ch) {
+    if (pos > size_) throw std::out_of_range("basic_static_string::insert");
+    check_length(size_ + n);
+    traits_type::move(data_ + pos + n, data_ + pos, size_ - pos);
+    traits_type::assign(data_ + pos, n, ch);
+    set_size(size_ + n);
+    return *this;
+  }
+
+  constexpr basic_static_string& erase(size_type pos = 0, size_type n = npos) {
+    if (pos > size_) throw std::out_of_range("basic_static_string::erase");
+    n = std::min(n, size_ - pos);
+    traits_type::move(data_ + pos, data_ + pos + n, size_ - pos - n);
+    set_size(size_ - n);
+    return *this;
+  }
+
+  constexpr iterator erase(const_iterator pos) {
+    const auto i = static_cast<size_type>(pos - begin());
+    erase(i, 1);
+    return begin() + i;
+  }
+
+  constexpr basic_static_string& replace(size_type pos, size_type n, view_type s) {
+    if (pos > size_) throw std::out_of_range("basic_static_string::replace");
+    n = std::min(n, size_ - pos);
+    check_length(size_ - n + s.size());
+    if (aliases(s)) {
+      const basic_static_string tmp(s);
+      splice(pos, n, tmp.view());
+    } else {
+      splice(pos, n, s);
+    }
+    return *this;
+  }
+
+  constexpr void resize(size_type n, CharT ch = CharT()) {
+    check_length(n);
+    if (n > size_) traits_type::assign(data_ + size_, n - size_, ch);
+    set_size(n);
+  }
+
+  constexpr void swap(basic_static_string& other) noexcept {
+    basic_static_string tmp = *this;
+    *this = other;
+    other = tmp;
+  }
+
+  friend constexpr void swap(basic_static_string& a, basic_static_string& b) noexcept {
+    a.swap(b);
+  }
+
+  // --- operations ---------------------------------------------------------
+
+  constexpr basic_static_string substr(size_type pos = 0, size_type n = npos) const {
+    if (pos > size_) throw std::out_of_range("basic_static_string::substr");
+    return basic_static_string(data_ + pos, std::min(n, size_ - pos));
+  }
+
+  constexpr size_type copy(CharT* dest, size_type n, size_type pos = 0) const {
+    return view().copy(dest, n, pos);
+  }
+
+  constexpr int compare(view_type s) const noexcept { return view().compare(s); }
+  constexpr bool starts_with(view_type s) const noexcept { return view().starts_with(s); }
+  constexpr bool starts_with(CharT ch) const noexcept { return view().starts_with(ch); }
+  constexpr bool ends_with(view_type s) const noexcept { return view().ends_with(s); }
+  constexpr bool ends_with(CharT ch) const noexcept { return view().ends_with(ch); }
+  constexpr bool contains(view_type s) const noexcept { return find(s) != npos; }
+  constexpr bool contains(CharT ch) const noexcept { return find(ch) != npos; }
+
+  constexpr size_type find(view_type s, size_type pos = 0) const noexcept {
+    return view().find(s, pos);
+  }
+  constexpr size_type find(CharT ch, size_type pos = 0) const noexcept {
+    return view().find(ch, pos);
+  }
+  constexpr size_type rfind(view_type s, size_type pos = npos) const noexcept {
+    return view().rfind(s, pos);
+  }
+  constexpr size_type rfind(CharT ch, size_type pos = npos) const noexcept {
+    return view().rfind(ch, pos);
+  }
+  constexpr size_type find_first_of(view_type s, size_type pos = 0) const noexcept {
+    return view().find_first_of(s, pos);
+  }
+  constexpr size_type find_last_of(view_type s, size_type pos = npos) const noexcept {
+    return view().find_last_of(s, pos);
+  }
+  constexpr size_type find_first_not_of(view_type s, size_type pos = 0) const noexcept {
+    return view().find_first_not_of(s, pos);
+  }
+  constexpr size_type find_last_not_of(view_type s, size_type pos = npos) const noexcept {
+    return view().find_last_not_of(s, pos);
+  }
+
+  friend constexpr bool operator==(const basic_static_string& a, view_type b) noexcept {
+    return a.view() == b;
+  }
+  friend constexpr auto operator<=>(const basic_static_string& a, view_type b) noexcept {
+    return a.view() <=> b;
+  }
+  template <std::size_t M>
+  friend constexpr bool operator==(const basic_static_string& a,
+                                   const basic_static_string<CharT, M, Traits>& b) noexcept {
+    return a.view() == b.view();
+  }
+  template <std::size_t M>
+  friend constexpr auto operator<=>(const basic_static_string& a,
+                                    const basic_static_string<CharT, M, Traits>& b) noexcept {
+    return a.view() <=> b.view();
+  }
+
+  friend constexpr basic_static_string operator+(const basic_static_string& a, view_type b) {
+    basic_static_string r = a;
+    r.append(b);
+    return r;
+  }
+  friend constexpr basic_static_string operator+(const basic_static_string& a, CharT b) {
+    basic_static_string r = a;
+    r.push_back(b);
+    return r;
+  }
+
+  friend std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                       const basic_static_string& s) {
+    return os << s.view();
+  }
+
+ private:
+  // True if s may point into our own buffer, in which case insert/replace
+  // copy it out first so the shift does not clobber the source. Constant
+  // evaluation cannot order unrelated pointers, so it always copies.
+  constexpr bool aliases(view_type s) const noexcept {
+    if (std::is_constant_evaluated()) return !s.empty();
+    const std::less_equal<const CharT*> le;
+    return !s.empty() && le(data_, s.data()) && le(s.data(), data_ + N);
+  }
+
+  // Replaces [pos, pos + n) with s; s must not point into data_.
+  constexpr void splice(size_type pos, size_type n, view_type s) noexcept {
+    traits_type::move(data_ + pos + s.size(), data_ + pos + n, size_ - pos - n);
+    traits_type::copy(data_ + pos, s.data(), s.size());
+    set_size(size_ - n + s.size());
+  }
+
+  static constexpr void check_length(size_type n) {
+    if (n > N) throw std::length_error("basic_static_string: capacity exceeded");
+  }
+
+  constexpr void set_size(size_type n) noexcept {
+    size_ = n;
+    data_[n] = CharT();
+  }
+
+  CharT data_[N + 1]{};
+  size_type size_ = 0;
+};
+
+// static_string s = "literal"; deduces a capacity equal to the literal length.
+template <class CharT, std::size_t M>
+basic_static_string(const CharT (&)[M]) -> basic_static_string<CharT, M - 1>;
+
+template <std::size_t N>
+using static_string = basic_static_string<char, N>;
+
+template <std::size_t N>
+using static_wstring = basic_static_string<wchar_t, N>;
+
+template <std::size_t N>
+using static_u8string = basic_static_string<char8_t, N>;
+
+}  // namespace mystl
+
+template <class CharT, std::size_t N, class Traits>
+struct std::hash<mystl::basic_static_string<CharT, N, Traits>> {
+  std::size_t operator()(const mystl::basic_static_string<CharT, N, Traits>& s) const noexcept {
+    return std::hash<std::basic_string_view<CharT, Traits>>{}(s.view());
+  }
+};
@@ -0,0 +1,411 @@
+#pragma once
+
+// Fixed-capacity hash map with inline storage. Never allocates.
+//
+// Open addressing with linear probing over a power-of-two slot array sized
+// for a load factor of at most 0.8 at full capacity. A parallel array of
+// one-byte control words (empty, or a 7-bit fragment of the hash) is probed
+// first so that most mismatching slots are rejected without touching the
+// key. Hash output is passed through mix64 first, so identity hashes such as
+// libstdc++'s std::hash<int> still spread over slots and fragments. Erasure
+// uses backward shifting instead of tombstones, so probe lengths do not
+// degrade under insert/erase churn.
+//
+// All members are constexpr; the map is usable in constant expressions when
+// Hash and KeyEqual are.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "hash.hpp"
+
+namespace mystl {
+
+template <class Key, class T, std::size_t N, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class static_unordered_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+ private:
+  static constexpr size_type slot_count = std::bit_ceil(N + (N + 3) / 4 + 1);
+  static constexpr size_type mask = slot_count - 1;
+  static constexpr std::uint8_t ctrl_empty = 0;
+
+  union slot {
+    constexpr slot() noexcept : empty_() {}
+    constexpr ~slot() {}
+
+    char empty_;
+    value_type value;
+  };
+
+  template <bool Const>
+  class basic_iterator {
+    using map_ptr = std::conditional_t<Const, const static_unordered_map*, static_unordered_map*>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename static_unordered_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    constexpr basic_iterator() noexcept = default;
+    template <bool C = Const>
+      requires C
+    constexpr basic_iterator(const basic_iterator<false>& other) noexcept
+        : map_(other.map_), i_(other.i_) {}
+
+    constexpr reference operator*() const noexcept { return map_->slots_[i_].value; }
+    constexpr pointer operator->() const noexcept { return std::addressof(**this); }
+
+    constexpr basic_iterator& operator++() noexcept {
+      i_ = map_->next_occupied(i_ + 1);
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) noexcept {
+      basic_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend constexpr bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept {
+      return a.i_ == b.i_;
+    }
+
+   private:
+    friend class static_unordered_map;
+    friend class basic_iterator<!Const>;
+
+    constexpr basic_iterator(map_ptr m, size_type i) noexcept : map_(m), i_(i) {}
+
+    map_ptr map_ = nullptr;
+    size_type i_ = 0;
+  };
+
+ public:
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  // --- construction -------------------------------------------------------
+
+  constexpr static_unordered_map() = default;
+
+  constexpr explicit static_unordered_map(const Hash& hash, const KeyEqual& eq = KeyEqual())
+      : hash_(hash), eq_(eq) {}
+
+  template <std::input_iterator InputIt>
+  constexpr static_unordered_map(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  constexpr static_unordered_map(std::initializer_list<value_type> il) {
+    insert(il.begin(), il.end());
+  }
+
+  constexpr static_unordered_map(const static_unordered_map& other)
+      : hash_(other.hash_), eq_(other.eq_) {
+    copy_from(other);
+  }
+
+  constexpr static_unordered_map(static_unordered_map&& other) noexcept(
+      std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<T>)
+      : hash_(other.hash_), eq_(other.eq_) {
+    move_from(other);
+  }
+
+  constexpr static_unordered_map& operator=(const static_unordered_map& other) {
+    if (this != &other) {
+      clear();
+      hash_ = other.hash_;
+      eq_ = other.eq_;
+      copy_from(other);
+    }
+    return *this;
+  }
+
+  constexpr static_unordered_map& operator=(static_unordered_map&& other) noexcept(
+      std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<T>) {
+    if (this != &other) {
+      clear();
+      hash_ = other.hash_;
+      eq_ = other.eq_;
+      move_from(other);
+    }
+    return *this;
+  }
+
+  constexpr ~static_unordered_map() { clear(); }
+
+  // --- iterators ----------------------------------------------------------
+
+  constexpr iterator begin() noexcept { return iterator(this, next_occupied(0)); }
+  constexpr const_iterator begin() const noexcept { return const_iterator(this, next_occupied(0)); }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr iterator end() noexcept { return iterator(this, slot_count); }
+  constexpr const_iterator end() const noexcept { return const_iterator(this, slot_count); }
+  constexpr const_iterator cend() const noexcept { return end(); }
+
+  // --- capacity -----------------------------------------------------------
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+  constexpr size_type size() const noexcept { return size_; }
+  static constexpr size_type max_size() noexcept { return N; }
+  static constexpr size_type capacity() noexcept { return N; }
+  static constexpr size_type bucket_count() noexcept { return slot_count; }
+
+  // --- lookup -------------------------------------------------------------
+
+  constexpr iterator find(const Key& key) noexcept {
+    return iterator(this, find_slot(key));
+  }
+  constexpr const_iterator find(const Key& key) const noexcept {
+    return const_iterator(this, find_slot(key));
+  }
+  constexpr bool contains(const Key& key) const noexcept { return find_slot(key) != slot_count; }
+  constexpr size_type count(const Key& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  constexpr T& at(const Key& key) {
+    const size_type i = find_slot(key);
+    if (i == slot_count) throw std::out_of_range("static_unordered_map::at");
+    return slots_[i].value.second;
+  }
+  constexpr const T& at(const Key& key) const {
+    const size_type i = find_slot(key);
+    if (i == slot_count) throw std::out_of_range("static_unordered_map::at");
+    return slots_[i].value.second;
+  }
+
+  // Looks up every key and writes its iterator (or end()) to the matching
+  // element of out; returns the number of keys found. Keys are hashed and
+  // their home slots prefetched batch_group_size at a time before any are
+  // probed, so the cache misses of independent lookups overlap.
+  constexpr size_type find_batch(std::span<const Key> keys, std::span<iterator> out) noexcept {
+    return batch_probe(keys, [&](size_type k, size_type i) { out[k] = iterator(this, i); });
+  }
+  constexpr size_type find_batch(std::span<const Key> keys,
+                                 std::span<const_iterator> out) const noexcept {
+    return batch_probe(keys, [&](size_type k, size_type i) { out[k] = const_iterator(this, i); });
+  }
+
+  constexpr T& operator[](const Key& key) { return try_emplace(key).first->second; }
+  constexpr T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+  // --- modifiers ----------------------------------------------------------
+  //
+  // Inserting a new key into a full map throws std::bad_alloc.
+
+  template <class K, class... Args>
+  constexpr std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    const std::size_t h = hash_of(key);
+    auto [i, found] = probe(key, h);
+    if (found) return {iterator(this, i), false};
+    if (size_ == N) throw std::bad_alloc();
+    std::construct_at(std::addressof(slots_[i].value), std::piecewise_construct,
+                      std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    ctrl_[i] = fragment(h);
+    ++size_;
+    return {iterator(this, i), true};
+  }
+
+  template <class... Args>
+  constexpr std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type v(std::forward<Args>(args)...);
+    return try_emplace(v.first, std::move(v.second));
+  }
+
+  constexpr std::pair<iterator, bool> insert(const value_type& v) {
+    return try_emplace(v.first, v.second);
+  }
+  constexpr std::pair<iterator, bool> insert(value_type&& v) {
+    return try_emplace(v.first, std::move(v.second));
+  }
+
+  template <std::input_iterator InputIt>
+  constexpr void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  template <class M>
+  constexpr std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+    auto r = try_emplace(key, std::forward<M>(obj));
+    if (!r.second) r.first->second = std::forward<M>(obj);
+    return r;
+  }
+
+  constexpr size_type erase(const Key& key) {
+    const size_type i = find_slot(key);
+    if (i == slot_count) return 0;
+    erase_slot(i);
+    return 1;
+  }
+
+  // Backward-shift deletion may move a later element into the erased slot,
+  // so unlike std::unordered_map no successor iterator is returned.
+  constexpr void erase(const_iterator pos) { erase_slot(pos.i_); }
+
+  constexpr void clear() noexcept {
+    for (size_type i = 0; i < slot_count; ++i) {
+      if (ctrl_[i] != ctrl_empty) {
+        std::destroy_at(std::addressof(slots_[i].value));
+        ctrl_[i] = ctrl_empty;
+      }
+    }
+    size_ = 0;
+  }
+
+  constexpr hasher hash_function() const { return hash_; }
+  constexpr key_equal key_eq() const { return eq_; }
+
+  friend constexpr bool operator==(const static_unordered_map& a, const static_unordered_map& b) {
+    if (a.size_ != b.size_) return false;
+    for (const auto& [k, v] : a) {
+      auto it = b.find(k);
+      if (it == b.end() || !(it->second == v)) return false;
+    }
+    return true;
+  }
+
+ private:
+  template <class K>
+  constexpr std::size_t hash_of(const K& key) const {
+    return static_cast<std::size_t>(mix64(static_cast<std::uint64_t>(hash_(key))));
+  }
+
+  static constexpr std::uint8_t fragment(std::size_t h) noexcept {
+    return static_cast<std::uint8_t>(0x80u | (h >> (sizeof(std::size_t) * 8 - 7)));
+  }
+
+  // Returns the slot holding key, or the empty slot that ends its probe
+  // sequence. The latter always exists because slot_count > N.
+  template <class K>
+  constexpr std::pair<size_type, bool> probe(const K& key, std::size_t h) const {
+    const std::uint8_t frag = fragment(h);
+    for (size_type i = h & mask;; i = (i + 1) & mask) {
+      if (ctrl_[i] == ctrl_empty) return {i, false};
+      if (ctrl_[i] == frag && eq_(slots_[i].value.first, key)) return {i, true};
+    }
+  }
+
+  constexpr size_type find_slot(const Key& key) const {
+    auto [i, found] = probe(key, hash_of(key));
+    return found ? i : slot_count;
+  }
+
+  template <class Emit>
+  constexpr size_type batch_probe(std::span<const Key> keys, Emit emit) const {
+    std::size_t hs[batch_group_size];
+    size_type found = 0;
+    for (size_type base = 0; base < keys.size(); base += batch_group_size) {
+      const size_type g = std::min(batch_group_size, keys.size() - base);
+      for (size_type k = 0; k < g; ++k) {
+        hs[k] = hash_of(keys[base + k]);
+        if (!std::is_constant_evaluated()) {
+          MYSTL_PREFETCH(&ctrl_[hs[k] & mask]);
+          MYSTL_PREFETCH(&slots_[hs[k] & mask]);
+        }
+      }
+      for (size_type k = 0; k < g; ++k) {
+        auto [i, hit] = probe(keys[base + k], hs[k]);
+        found += hit;
+        emit(base + k, hit ? i : slot_count);
+      }
+    }
+    return found;
+  }
+
+  constexpr size_type next_occupied(size_type i) const noexcept {
+    while (i < slot_count && ctrl_[i] == ctrl_empty) ++i;
+    return i;
+  }
+
+  constexpr void erase_slot(size_type hole) {
+    std::destroy_at(std::addressof(slots_[hole].value));
+    for (size_type j = (hole + 1) & mask; ctrl_[j] != ctrl_empty; j = (j + 1) & mask) {
+      const size_type home = hash_of(slots_[j].value.first) & mask;
+      // Element j may fill the hole only if its home slot is not cyclically
+      // within (hole, j].
+      const bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+      if (stays) continue;
+      relocate(j, hole);
+      ctrl_[hole] = ctrl_[j];
+      hole = j;
+    }
+    ctrl_[hole] = ctrl_empty;
+    --size_;
+  }
+
+  constexpr void relocate(size_type from, size_type to) {
+    value_type& src = slots_[from].value;
+    std::construct_at(std::addressof(slots_[to].value), std::move(const_cast<Key&>(src.first)),
+                      std::move(src.second));
+    std::destroy_at(std::addressof(src));
+  }
+
+  // If a copy throws, the entries copied so far are destroyed and the map
+  // is left empty.
+  constexpr void copy_from(const static_unordered_map& other) {
+    try {
+      for (size_type i = 0; i < slot_count; ++i) {
+        if (other.ctrl_[i] != ctrl_empty) {
+          std::construct_at(std::addressof(slots_[i].value), other.slots_[i].value);
+          ctrl_[i] = other.ctrl_[i];
+        }
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+    size_ = other.size_;
+  }
+
+  constexpr void move_from(static_unordered_map& other) {
+    try {
+      for (size_type i = 0; i < slot_count; ++i) {
+        if (other.ctrl_[i] != ctrl_empty) {
+          value_type& src = other.slots_[i].value;
+          std::construct_at(std::addressof(slots_[i].value),
+                            std::move(const_cast<Key&>(src.first)), std::move(src.second));
+          ctrl_[i] = other.ctrl_[i];
+        }
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+    size_ = other.size_;
+    other.clear();
+  }
+
+  std::uint8_t ctrl_[slot_count]{};
+  slot slots_[slot_count];
+  size_type size_ = 0;
+  [[no_unique_address]] Hash hash_{};
+  [[no_unique_address]] KeyEqual eq_{};
+};
+
+}  // namespace mystl
@@ -0,0 +1,407 @@
+#pragma once
+
+// Static string set as a succinct trie: membership, prefix enumeration and
+// key <-> id lookup at a few bytes per key, in a flat blob that can be
+// mmap'd and used in place.
+//
+//   mystl::succinct_trie dict(queries);              // any order, duplicates ignored
+//   dict.contains("weather tomorrow");
+//   std::size_t id = dict.id("weather tomorrow");     // in [0, size()) or npos
+//   std::string s = dict.key(id);
+//   dict.for_each_prefix("weath", [&](std::string_view key, std::size_t id) {
+//     suggest(key, score[id]);
+//     return ++shown < 10;                            // returning false stops
+//   });
+//
+//   out.write(dict.bytes());                          // later, without a copy:
+//   auto mapped = mystl::succinct_trie::view(mmapped_bytes);
+//
+// The trie is stored level by level in LOUDS-Sparse form (Zhang et al.,
+// SuRF, SIGMOD 2018). Every edge costs its label byte plus three bits:
+// whether it starts a node (louds), leads to an inner node (has_child),
+// and whether the path up to it is a key (terminal). Rank and select over
+// these bit vectors move between levels: the child of edge pos is node
+// has_child.rank1(pos + 1), which begins at edge louds.select1(node).
+// Subtrees holding a single key are cut off and their remaining bytes
+// are stored as a tail, with lengths coded in unary. A key costs its
+// unshared suffix plus about 11 bits per branching edge, much less than
+// the 40-60 bytes of a node in a std::set<std::string>.
+//
+// Ids are dense in [0, size()) and follow the trie's level order rather
+// than sorted order; for_each_prefix visits keys in sorted order and
+// reports each key's id, so per-key data can live in a parallel array.
+// Every section of the blob is a whole number of little-endian 64-bit
+// words, so a blob is only portable across little-endian hosts.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "rank_select.hpp"
+
+namespace mystl {
+
+namespace detail {
+
+// "SNCTRIE2" as little-endian bytes.
+inline constexpr std::uint64_t succinct_trie_magic = 0x3245495254434E53ull;
+
+// Bits appended one at a time.
+struct bit_builder {
+  void push(bool bit) {
+    if (size % 64 == 0) words.push_back(0);
+    words.back() |= std::uint64_t{bit} << (size % 64);
+    ++size;
+  }
+  std::vector<std::uint64_t> words;
+  std::uint64_t size = 0;
+};
+
+}  // namespace detail
+
+class succinct_trie {
+ public:
+  using size_type = std::size_t;
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  succinct_trie() { build({}); }
+
+  // Builds the set of the strings in keys, which must stay alive for the
+  // duration of the call (strings in a container, string_views, C strings).
+  template <std::ranges::input_range R>
+    requires std::is_convertible_v<std::ranges::range_reference_t<R>, std::string_view> &&
+             (!std::is_same_v<std::ranges::range_reference_t<R>, std::string>)
+  explicit succinct_trie(R&& keys) {
+    std::vector<std::string_view> sorted;
+    if constexpr (std::ranges::sized_range<R>) sorted.reserve(std::ranges::size(keys));
+    for (auto&& k : keys) sorted.emplace_back(std::string_view(k));
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    build(sorted);
+  }
+  succinct_trie(std::initializer_list<std::string_view> keys)
+      : succinct_trie(std::span(keys.begin(), keys.size())) {}
+
+  succinct_trie(const succinct_trie& other) : storage_(other.storage_) {
+    bind(storage_.empty() ? other.blob_ : std::span<const std::uint64_t>(storage_));
+  }
+  succinct_trie(succinct_trie&& other) noexcept
+      : storage_(std::move(other.storage_)),
+        blob_(std::exchange(other.blob_, {})),
+        s_(std::exchange(other.s_, {})) {}
+  succinct_trie& operator=(const succinct_trie& other) {
+    if (this != &other) succinct_trie(other).swap(*this);
+    return *this;
+  }
+  succinct_trie& operator=(succinct_trie&& other) noexcept {
+    succinct_trie(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void swap(succinct_trie& other) noexcept {
+    storage_.swap(other.storage_);
+    std::swap(blob_, other.blob_);
+    std::swap(s_, other.s_);
+  }
+
+  size_type size() const noexcept { return s_.size; }
+  [[nodiscard]] bool empty() const noexcept { return s_.size == 0; }
+
+  bool contains(std::string_view key) const noexcept { return id(key) != npos; }
+
+  // Id of key in [0, size()), or npos if it is not in the set.
+  size_type id(std::string_view key) const noexcept {
+    if (key.empty()) return s_.has_empty ? 0 : npos;
+    if (s_.louds.size() == 0) return npos;
+    std::uint64_t begin = 0;
+    for (std::size_t d = 0;;) {
+      const std::uint64_t pos = find_edge(begin, static_cast<unsigned char>(key[d++]));
+      if (pos == npos) return npos;
+      if (!s_.has_child[pos]) return tail(pos) == key.substr(d) ? ordinal(pos) : npos;
+      if (d == key.size()) return s_.terminal[pos] ? ordinal(pos) : npos;
+      begin = child_begin(pos);
+    }
+  }
+
+  // Key with the given id; throws std::out_of_range if id >= size().
+  std::string key(size_type id) const {
+    if (id >= s_.size) throw std::out_of_range("succinct_trie::key");
+    std::string out;
+    if (s_.has_empty && id-- == 0) return out;
+    std::uint64_t pos = s_.terminal.select1(id);
+    if (!s_.has_child[pos]) {
+      const std::string_view t = tail(pos);
+      out.assign(t.rbegin(), t.rend());
+    }
+    for (;;) {
+      out.push_back(static_cast<char>(s_.labels[pos]));
+      const std::uint64_t node = s_.louds.rank1(pos + 1) - 1;
+      if (node == 0) break;
+      pos = s_.has_child.select1(node - 1);
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+  }
+
+  // Calls f(std::string_view key, size_type id) for every key starting
+  // with prefix, in sorted order. f may return bool; false stops the scan.
+  template <class F>
+  void for_each_prefix(std::string_view prefix, F&& f) const {
+    std::string buf(prefix);
+    if (prefix.empty()) {
+      if (s_.has_empty && !emit(f, buf, 0)) return;
+      if (s_.louds.size() != 0) visit(0, buf, f);
+      return;
+    }
+    if (s_.louds.size() == 0) return;
+    std::uint64_t begin = 0;
+    for (std::size_t d = 0;;) {
+      const std::uint64_t pos = find_edge(begin, static_cast<unsigned char>(prefix[d++]));
+      if (pos == npos) return;
+      if (!s_.has_child[pos]) {
+        const std::string_view t = tail(pos);
+        if (t.starts_with(prefix.substr(d))) {
+          buf.resize(d);
+          buf.append(t);
+          emit(f, buf, ordinal(pos));
+        }
+        return;
+      }
+      if (d == prefix.size()) {
+        if (s_.terminal[pos] && !emit(f, buf, ordinal(pos))) return;
+        visit(child_begin(pos), buf, f);
+        return;
+      }
+      begin = child_begin(pos);
+    }
+  }
+
+  // Every key in sorted order; see for_each_prefix.
+  template <class F>
+  void for_each(F&& f) const {
+    for_each_prefix({}, f);
+  }
+
+  // ----- serialisation -----
+  //
+  // Layout: magic, key count, empty-key flag, then the labels, has_child,
+  // louds, terminal, tail bytes and tail-length sections. Bit sections are
+  // rank_select_bitvector sections; byte sections are (size, bytes padded
+  // to a word).
+
+  // The blob, for writing out or mapping back with view().
+  std::span<const std::byte> bytes() const noexcept { return std::as_bytes(blob_); }
+  std::vector<std::byte> to_bytes() const { return {bytes().begin(), bytes().end()}; }
+  std::size_t memory_usage() const noexcept { return bytes().size(); }
+
+  // Copies blob into a trie of its own.
+  static succinct_trie from_bytes(std::span<const std::byte> blob) {
+    succinct_trie t(uninitialized{});
+    t.storage_.resize(blob.size() / sizeof(std::uint64_t));
+    std::memcpy(t.storage_.data(), blob.data(), t.storage_.size() * sizeof(std::uint64_t));
+    t.bind(t.storage_);
+    return t;
+  }
+
+  // Uses blob in place, typically an mmap'd file. It must be 8-byte
+  // aligned and outlive the trie and its copies.
+  static succinct_trie view(std::span<const std::byte> blob) {
+    succinct_trie t(uninitialized{});
+    t.bind(detail::blob_words(blob, "succinct_trie"));
+    return t;
+  }
+
+  void save(std::ostream& os) const {
+    os.write(reinterpret_cast<const char*>(bytes().data()),
+             static_cast<std::streamsize>(bytes().size()));
+  }
+
+  static succinct_trie load(std::istream& is) {
+    const std::vector<char> raw((std::istreambuf_iterator<char>(is)),
+                                std::istreambuf_iterator<char>());
+    return from_bytes(std::as_bytes(std::span(raw)));
+  }
+
+ private:
+  struct uninitialized {};
+  explicit succinct_trie(uninitialized) noexcept {}
+
+  // The parsed blob.
+  struct sections {
+    std::uint64_t size = 0;
+    bool has_empty = false;
+    const unsigned char* labels = nullptr;
+    rank_select_bitvector has_child;
+    rank_select_bitvector louds;
+    rank_select_bitvector terminal;
+    const char* tails = nullptr;
+    std::uint64_t tail_bytes = 0;
+    rank_select_bitvector tail_ends;  // per tail: length zeros, then a one
+  };
+
+  void build(std::span<const std::string_view> keys) {
+    std::vector<unsigned char> labels;
+    detail::bit_builder has_child, louds, terminal, tail_ends;
+    std::string tails;
+
+    struct pending {
+      std::size_t lo, hi, depth;  // keys[lo, hi) share their first depth bytes and are longer
+    };
+    std::deque<pending> queue;
+    const bool has_empty = !keys.empty() && keys.front().empty();
+    queue.push_back({has_empty ? std::size_t{1} : std::size_t{0}, keys.size(), 0});
+    while (!queue.empty()) {
+      const pending n = queue.front();
+      queue.pop_front();
+      for (std::size_t i = n.lo; i < n.hi;) {
+        const char c = keys[i][n.depth];
+        std::size_t j = i + 1;
+        while (j < n.hi && keys[j][n.depth] == c) ++j;
+        labels.push_back(static_cast<unsigned char>(c));
+        louds.push(i == n.lo);
+        if (j - i == 1) {
+          has_child.push(false);
+          terminal.push(true);
+          const std::string_view rest = keys[i].substr(n.depth + 1);
+          tails.append(rest);
+          for (std::size_t k = 0; k < rest.size(); ++k) tail_ends.push(false);
+          tail_ends.push(true);
+        } else {
+          const bool ends_here = keys[i].size() == n.depth + 1;  // sorted: the shortest comes first
+          has_child.push(true);
+          terminal.push(ends_here);
+          queue.push_back({i + ends_here, j, n.depth + 1});
+        }
+        i = j;
+      }
+    }
+
+    std::vector<std::uint64_t> out = {detail::succinct_trie_magic, keys.size(), has_empty};
+    auto write_bytes = [&out](const void* data, std::size_t n) {
+      out.push_back(n);
+      const std::size_t at = out.size();
+      out.resize(at + (n + 7) / 8, 0);
+      if (n != 0) std::memcpy(out.data() + at, data, n);
+    };
+    write_bytes(labels.data(), labels.size());
+    rank_select_bitvector::append(out, has_child.words, has_child.size);
+    rank_select_bitvector::append(out, louds.words, louds.size);
+    rank_select_bitvector::append(out, terminal.words, terminal.size);
+    write_bytes(tails.data(), tails.size());
+    rank_select_bitvector::append(out, tail_ends.words, tail_ends.size);
+    storage_ = std::move(out);
+    bind(storage_);
+  }
+
+  void bind(std::span<const std::uint64_t> blob) {
+    constexpr const char* what = "succinct_trie";
+    std::span<const std::uint64_t> in = blob;
+    const std::uint64_t* head = detail::take_words(in, 4, what);
+    if (head[0] != detail::succinct_trie_magic) {
+      throw std::invalid_argument("succinct_trie: bad magic");
+    }
+    sections s;
+    s.size = head[1];
+    s.has_empty = head[2] != 0;
+    const std::uint64_t edges = head[3];
+    s.labels =
+        reinterpret_cast<const unsigned char*>(detail::take_words(in, (edges + 7) / 8, what));
+    s.has_child = rank_select_bitvector::view_front(in);
+    s.louds = rank_select_bitvector::view_front(in);
+    s.terminal = rank_select_bitvector::view_front(in);
+    s.tail_bytes = *detail::take_words(in, 1, what);
+    s.tails = reinterpret_cast<const char*>(detail::take_words(in, (s.tail_bytes + 7) / 8, what));
+    s.tail_ends = rank_select_bitvector::view_front(in);
+    if (s.has_child.size() != edges || s.louds.size() != edges || s.terminal.size() != edges ||
+        s.terminal.ones() + s.has_empty != s.size ||
+        s.tail_ends.size() != s.tail_bytes + s.tail_ends.ones() ||
+        s.tail_ends.ones() != edges - s.has_child.ones() ||
+        (edges != 0 && s.louds.ones() != s.has_child.ones() + 1)) {
+      throw std::invalid_argument("succinct_trie: bad blob");
+    }
+    blob_ = blob.first(blob.size() - in.size());
+    s_ = s;
+  }
+
+  // Edge labelled c in the node starting at edge begin, or npos.
+  std::uint64_t find_edge(std::uint64_t begin, unsigned char c) const noexcept {
+    const std::uint64_t end = s_.louds.next_one(begin + 1);
+    const unsigned char* first = s_.labels + begin;
+    const unsigned char* last = s_.labels + end;
+    const unsigned char* it =
+        end - begin <= 16 ? std::find(first, last, c) : std::lower_bound(first, last, c);
+    return it != last && *it == c ? static_cast<std::uint64_t>(it - s_.labels) : npos;
+  }
+
+  // First edge of the node below edge pos; the root is node 0, and node k
+  // hangs below the k-th edge with a child.
+  std::uint64_t child_begin(std::uint64_t pos) const noexcept {
+    return s_.louds.select1(s_.has_child.rank1(pos + 1));
+  }
+
+  size_type ordinal(std::uint64_t pos) const noexcept {
+    return s_.terminal.rank1(pos) + s_.has_empty;
+  }
+
+  // Remaining bytes of the key ending below leaf edge pos.
+  std::string_view tail(std::uint64_t pos) const noexcept {
+    const std::uint64_t leaf = pos - s_.has_child.rank1(pos);
+    const std::uint64_t begin = leaf == 0 ? 0 : s_.tail_ends.select1(leaf - 1) + 1 - leaf;
+    const std::uint64_t end = s_.tail_ends.select1(leaf) - leaf;
+    return {s_.tails + begin, end - begin};
+  }
+
+  template <class F>
+  static bool emit(F& f, std::string_view key, size_type id) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F&, std::string_view, size_type>, bool>) {
+      return std::invoke(f, key, id);
+    } else {
+      std::invoke(f, key, id);
+      return true;
+    }
+  }
+
+  // Emits the subtree of the node starting at edge begin, with buf holding
+  // the path to it; false if f asked to stop.
+  template <class F>
+  bool visit(std::uint64_t begin, std::string& buf, F& f) const {
+    const std::uint64_t end = s_.louds.next_one(begin + 1);
+    for (std::uint64_t pos = begin; pos < end; ++pos) {
+      buf.push_back(static_cast<char>(s_.labels[pos]));
+      bool more;
+      if (!s_.has_child[pos]) {
+        const std::size_t n = buf.size();
+        buf.append(tail(pos));
+        more = emit(f, buf, ordinal(pos));
+        buf.resize(n);
+      } else {
+        more = (!s_.terminal[pos] || emit(f, buf, ordinal(pos))) && visit(child_begin(pos), buf, f);
+      }
+      buf.pop_back();
+      if (!more) return false;
+    }
+    return true;
+  }
+
+  std::vector<std::uint64_t> storage_;  // empty for views
+  std::span<const std::uint64_t> blob_;
+  sections s_;
+};
+
+}  // namespace mystl
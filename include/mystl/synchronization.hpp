@@ -0,0 +1,549 @@
+#pragma once
+
+// Locks and thread coordination built directly on futexes.
+//
+//   mystl::adaptive_mutex m;           // drop-in for std::mutex
+//   std::lock_guard<mystl::adaptive_mutex> g(m);
+//
+//   mystl::mcs_lock q;
+//   { mystl::mcs_lock::guard g(q); ... }  // queue node lives in the guard
+//
+//   mystl::shared_mutex rw;            // drop-in for std::shared_mutex
+//   std::shared_lock<mystl::shared_mutex> r(rw);
+//
+// adaptive_mutex spins for a while before sleeping in the kernel, like
+// glibc's PTHREAD_MUTEX_ADAPTIVE_NP. The spin budget follows a running
+// average of how long recent acquisitions took to succeed. Unlocking only
+// makes a system call when a thread is actually asleep.
+//
+// ticket_lock and mcs_lock are FIFO spin locks for short critical sections
+// on dedicated cores. A ticket lock has every waiter poll one shared line.
+// An MCS lock has each waiter poll its own queue node, so a handoff touches
+// only the next waiter's cache line. Both yield the CPU after a short
+// exponential backoff, so oversubscription is slow but not a livelock.
+//
+// shared_mutex spreads its reader count over per-CPU cache lines, so
+// readers on different cores do not write to a shared line. A thread
+// counts its read locks in the line of the CPU it took the first of them
+// on, and releases them there, wherever it runs by then. Writers
+// announce themselves first; once a writer is waiting, new readers step
+// aside until no writer remains (writer preference). lock() therefore costs
+// a scan over one line per CPU, which suits read-mostly data.
+//
+// latch and barrier follow std::latch and std::barrier.
+//
+// Everything falls back to std::atomic wait/notify off Linux.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include "config.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// glibc 2.35 and later register a restartable-sequences area for every
+// thread, in which the kernel keeps the current CPU number up to date.
+#if defined(__linux__) && defined(__GLIBC__) && defined(__has_include) && defined(__has_builtin)
+#if (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35)) && __has_include(<sys/rseq.h>) && \
+    __has_builtin(__builtin_thread_pointer)
+#include <sys/rseq.h>
+#define MYSTL_HAS_RSEQ 1
+#endif
+#endif
+#ifndef MYSTL_HAS_RSEQ
+#define MYSTL_HAS_RSEQ 0
+#endif
+
+namespace mystl {
+
+namespace detail {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+// Sleeps while word == expected. May return spuriously.
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected,
+            nullptr, nullptr, 0);
+#else
+  word.wait(expected, std::memory_order_relaxed);
+#endif
+}
+
+inline void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept {
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr,
+            nullptr, 0);
+#else
+  word.notify_one();
+#endif
+}
+
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept {
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX,
+            nullptr, nullptr, 0);
+#else
+  word.notify_all();
+#endif
+}
+
+// CPU the calling thread is running on. Only a hint: the thread may have
+// migrated by the time the caller uses it. With rseq this is a single load
+// from thread-local memory; otherwise a vDSO or system call.
+inline unsigned current_cpu() noexcept {
+#if MYSTL_HAS_RSEQ
+  if (MYSTL_LIKELY(__rseq_size != 0)) {
+    const char* tp = static_cast<const char*>(__builtin_thread_pointer());
+    const auto* area = reinterpret_cast<const struct rseq*>(tp + __rseq_offset);
+    return __atomic_load_n(&area->cpu_id, __ATOMIC_RELAXED);
+  }
+#endif
+#if defined(__linux__)
+  const int cpu = ::sched_getcpu();
+  return cpu < 0 ? 0u : static_cast<unsigned>(cpu);
+#else
+  return static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+}
+
+// The CPU slot in which a thread's shared_mutex read locks are counted. It
+// is chosen when the thread takes its first read lock and kept until the
+// thread holds none, so an unlock always decrements the slot its lock
+// incremented, even after the thread has migrated.
+struct shared_reader_state {
+  unsigned cpu = 0;
+  unsigned held = 0;
+};
+
+inline thread_local shared_reader_state this_shared_reader;
+
+// Exponential backoff of pause instructions that turns into yielding once
+// the wait is clearly not short.
+class spin_backoff {
+ public:
+  void operator()() noexcept {
+    if (round_ < yield_after) {
+      for (unsigned i = 0; i < (1u << round_); ++i) MYSTL_CPU_RELAX();
+      ++round_;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  static constexpr unsigned yield_after = 8;
+  unsigned round_ = 0;
+};
+
+}  // namespace detail
+
+// Mutex that spins adaptively before sleeping on a futex (Drepper,
+// "Futexes Are Tricky", mutex 3). Meets Lockable.
+class adaptive_mutex {
+ public:
+  adaptive_mutex() noexcept = default;
+  adaptive_mutex(const adaptive_mutex&) = delete;
+  adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+  void lock() noexcept {
+    std::uint32_t c = unlocked;
+    if (MYSTL_LIKELY(state_.compare_exchange_strong(c, locked, std::memory_order_acquire,
+                                                    std::memory_order_relaxed))) {
+      return;
+    }
+    lock_slow();
+  }
+
+  bool try_lock() noexcept {
+    std::uint32_t c = unlocked;
+    return state_.compare_exchange_strong(c, locked, std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    if (state_.exchange(unlocked, std::memory_order_release) == contended) {
+      detail::futex_wake_one(state_);
+    }
+  }
+
+ private:
+  static constexpr std::uint32_t unlocked = 0;
+  static constexpr std::uint32_t locked = 1;
+  static constexpr std::uint32_t contended = 2;  // locked, and a thread may be asleep
+  static constexpr std::int32_t max_spins = 100;
+
+  void lock_slow() noexcept {
+    const std::int32_t estimate = spins_.load(std::memory_order_relaxed);
+    const std::int32_t limit = std::min(max_spins, estimate * 2 + 10);
+    for (std::int32_t i = 0; i < limit; ++i) {
+      MYSTL_CPU_RELAX();
+      std::uint32_t c = state_.load(std::memory_order_relaxed);
+      if (c == unlocked && state_.compare_exchange_weak(c, locked, std::memory_order_acquire,
+                                                        std::memory_order_relaxed)) {
+        spins_.store(estimate + (i - estimate) / 8, std::memory_order_relaxed);
+        return;
+      }
+    }
+    spins_.store(estimate + (limit - estimate) / 8, std::memory_order_relaxed);
+    // From here on the lock is marked contended, so the holder knows to
+    // wake someone on unlock.
+    while (state_.exchange(contended, std::memory_order_acquire) != unlocked) {
+      detail::futex_wait(state_, contended);
+    }
+  }
+
+  std::atomic<std::uint32_t> state_{unlocked};
+  std::atomic<std::int32_t> spins_{0};
+};
+
+// FIFO spin lock: take a ticket, wait until it is served. Meets Lockable.
+class ticket_lock {
+ public:
+  ticket_lock() noexcept = default;
+  ticket_lock(const ticket_lock&) = delete;
+  ticket_lock& operator=(const ticket_lock&) = delete;
+
+  void lock() noexcept {
+    const std::uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+    detail::spin_backoff backoff;
+    for (;;) {
+      const std::uint32_t serving = serving_.load(std::memory_order_acquire);
+      if (serving == ticket) return;
+      // Pause roughly in proportion to the number of threads ahead.
+      if (ticket - serving > 1) {
+        backoff();
+      } else {
+        MYSTL_CPU_RELAX();
+      }
+    }
+  }
+
+  bool try_lock() noexcept {
+    std::uint32_t serving = serving_.load(std::memory_order_acquire);
+    return next_.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  // Only the holder writes serving_, so a plain increment suffices.
+  void unlock() noexcept {
+    serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<std::uint32_t> next_{0};
+  std::atomic<std::uint32_t> serving_{0};
+};
+
+// Mellor-Crummey & Scott queue lock. Each acquisition supplies a node that
+// must stay put until the matching unlock; guard keeps it on the stack.
+class mcs_lock {
+ public:
+  struct alignas(cache_line_size) node {
+    std::atomic<node*> next{nullptr};
+    std::atomic<bool> waiting{false};
+  };
+
+  class guard {
+   public:
+    explicit guard(mcs_lock& l) noexcept : lock_(l) { lock_.lock(node_); }
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+    ~guard() { lock_.unlock(node_); }
+
+   private:
+    mcs_lock& lock_;
+    node node_;
+  };
+
+  mcs_lock() noexcept = default;
+  mcs_lock(const mcs_lock&) = delete;
+  mcs_lock& operator=(const mcs_lock&) = delete;
+
+  void lock(node& n) noexcept {
+    n.next.store(nullptr, std::memory_order_relaxed);
+    n.waiting.store(true, std::memory_order_relaxed);
+    node* pred = tail_.exchange(&n, std::memory_order_acq_rel);
+    if (!pred) return;
+    pred->next.store(&n, std::memory_order_release);
+    detail::spin_backoff backoff;
+    while (n.waiting.load(std::memory_order_acquire)) backoff();
+  }
+
+  bool try_lock(node& n) noexcept {
+    n.next.store(nullptr, std::memory_order_relaxed);
+    node* expected = nullptr;
+    return tail_.compare_exchange_strong(expected, &n, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock(node& n) noexcept {
+    node* succ = n.next.load(std::memory_order_acquire);
+    if (!succ) {
+      node* expected = &n;
+      if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        return;
+      }
+      // A successor has swapped itself in but not linked yet.
+      detail::spin_backoff backoff;
+      while (!(succ = n.next.load(std::memory_order_acquire))) backoff();
+    }
+    succ->waiting.store(false, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<node*> tail_{nullptr};
+};
+
+// Writer-preferring reader/writer lock with per-CPU reader counters. Meets
+// SharedLockable, so it works with std::shared_lock and std::unique_lock.
+class shared_mutex {
+ public:
+  shared_mutex()
+      : mask_(std::bit_ceil(std::clamp(std::thread::hardware_concurrency(), 1u, max_slots)) - 1),
+        slots_(new slot[mask_ + 1]) {}
+  shared_mutex(const shared_mutex&) = delete;
+  shared_mutex& operator=(const shared_mutex&) = delete;
+
+  void lock_shared() noexcept {
+    for (;;) {
+      enter_slot().readers.fetch_add(1, std::memory_order_seq_cst);
+      if (MYSTL_LIKELY(writers_.load(std::memory_order_seq_cst) == 0)) return;
+      // A writer holds or wants the lock: step aside until it is done.
+      unlock_shared();
+      wait_for_writers();
+    }
+  }
+
+  bool try_lock_shared() noexcept {
+    enter_slot().readers.fetch_add(1, std::memory_order_seq_cst);
+    if (writers_.load(std::memory_order_seq_cst) == 0) return true;
+    unlock_shared();
+    return false;
+  }
+
+  void unlock_shared() noexcept {
+    leave_slot().readers.fetch_sub(1, std::memory_order_seq_cst);
+    if (MYSTL_UNLIKELY(writers_.load(std::memory_order_seq_cst) != 0)) {
+      drained_.fetch_add(1, std::memory_order_release);
+      detail::futex_wake_all(drained_);
+    }
+  }
+
+  void lock() noexcept {
+    writers_.fetch_add(1, std::memory_order_seq_cst);
+    writer_mutex_.lock();
+    // Readers that arrived before the announcement are still inside; wait
+    // for the last of them to leave.
+    for (int i = 0; i < 64 && active_readers() != 0; ++i) MYSTL_CPU_RELAX();
+    for (;;) {
+      const std::uint32_t seen = drained_.load(std::memory_order_acquire);
+      if (active_readers() == 0) return;
+      detail::futex_wait(drained_, seen);
+    }
+  }
+
+  bool try_lock() noexcept {
+    writers_.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_mutex_.try_lock()) {
+      release_writer();
+      return false;
+    }
+    if (active_readers() != 0) {
+      writer_mutex_.unlock();
+      release_writer();
+      return false;
+    }
+    return true;
+  }
+
+  // The next waiting writer gets the lock before any reader gets back in.
+  void unlock() noexcept {
+    writer_mutex_.unlock();
+    release_writer();
+  }
+
+ private:
+  static constexpr unsigned max_slots = 256;
+  static constexpr std::uint32_t readers_parked = 0x80000000u;
+  static constexpr std::uint32_t writer_count_mask = ~readers_parked;
+
+  struct alignas(cache_line_size) slot {
+    std::atomic<std::int64_t> readers{0};
+  };
+
+  // Slots never go negative, so a single pass that reads them one at a
+  // time cannot add up to zero while a reader is inside.
+  slot& enter_slot() noexcept {
+    detail::shared_reader_state& r = detail::this_shared_reader;
+    if (r.held++ == 0) r.cpu = detail::current_cpu();
+    return slots_[r.cpu & mask_];
+  }
+
+  slot& leave_slot() noexcept {
+    detail::shared_reader_state& r = detail::this_shared_reader;
+    --r.held;
+    return slots_[r.cpu & mask_];
+  }
+
+  std::int64_t active_readers() const noexcept {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      sum += slots_[i].readers.load(std::memory_order_seq_cst);
+    }
+    return sum;
+  }
+
+  void wait_for_writers() noexcept {
+    for (int i = 0; i < 64; ++i) {
+      if ((writers_.load(std::memory_order_acquire) & writer_count_mask) == 0) return;
+      MYSTL_CPU_RELAX();
+    }
+    std::uint32_t w = writers_.load(std::memory_order_acquire);
+    while (w & writer_count_mask) {
+      if (!(w & readers_parked) &&
+          !writers_.compare_exchange_weak(w, w | readers_parked, std::memory_order_acquire)) {
+        continue;
+      }
+      detail::futex_wait(writers_, w | readers_parked);
+      w = writers_.load(std::memory_order_acquire);
+    }
+  }
+
+  void release_writer() noexcept {
+    std::uint32_t w = writers_.load(std::memory_order_relaxed);
+    std::uint32_t next;
+    do {
+      next = w - 1;
+      if ((next & writer_count_mask) == 0) next = 0;
+    } while (!writers_.compare_exchange_weak(w, next, std::memory_order_seq_cst,
+                                             std::memory_order_relaxed));
+    if (next == 0 && (w & readers_parked)) detail::futex_wake_all(writers_);
+  }
+
+  std::size_t mask_;
+  std::unique_ptr<slot[]> slots_;
+  // Number of writers holding or waiting for the lock, plus a flag for
+  // readers asleep until it drops to zero.
+  alignas(cache_line_size) std::atomic<std::uint32_t> writers_{0};
+  // Bumped by readers leaving while a writer waits.
+  std::atomic<std::uint32_t> drained_{0};
+  adaptive_mutex writer_mutex_;
+};
+
+// Single-use countdown, as std::latch.
+class latch {
+ public:
+  explicit latch(std::ptrdiff_t expected) noexcept : count_(static_cast<std::uint32_t>(expected)) {}
+  latch(const latch&) = delete;
+  latch& operator=(const latch&) = delete;
+
+  static constexpr std::ptrdiff_t max() noexcept { return UINT32_MAX; }
+
+  void count_down(std::ptrdiff_t n = 1) noexcept {
+    const auto d = static_cast<std::uint32_t>(n);
+    if (count_.fetch_sub(d, std::memory_order_release) == d) detail::futex_wake_all(count_);
+  }
+
+  bool try_wait() const noexcept { return count_.load(std::memory_order_acquire) == 0; }
+
+  void wait() const noexcept {
+    for (std::uint32_t c; (c = count_.load(std::memory_order_acquire)) != 0;) {
+      detail::futex_wait(const_cast<std::atomic<std::uint32_t>&>(count_), c);
+    }
+  }
+
+  void arrive_and_wait(std::ptrdiff_t n = 1) noexcept {
+    count_down(n);
+    wait();
+  }
+
+ private:
+  std::atomic<std::uint32_t> count_;
+};
+
+namespace detail {
+
+struct barrier_no_completion {
+  void operator()() const noexcept {}
+};
+
+}  // namespace detail
+
+// Reusable phase barrier, as std::barrier. The last thread to arrive runs
+// the completion function, then releases the phase.
+template <class CompletionFunction = detail::barrier_no_completion>
+class barrier {
+  static_assert(std::is_nothrow_invocable_v<CompletionFunction&>,
+                "barrier: the completion function must be noexcept");
+
+ public:
+  class arrival_token {
+   private:
+    friend class barrier;
+    explicit arrival_token(std::uint32_t phase) noexcept : phase_(phase) {}
+    std::uint32_t phase_;
+  };
+
+  explicit barrier(std::ptrdiff_t expected, CompletionFunction f = CompletionFunction())
+      : expected_(static_cast<std::uint32_t>(expected)),
+        remaining_(static_cast<std::uint32_t>(expected)),
+        completion_(std::move(f)) {}
+  barrier(const barrier&) = delete;
+  barrier& operator=(const barrier&) = delete;
+
+  static constexpr std::ptrdiff_t max() noexcept { return UINT32_MAX; }
+
+  [[nodiscard]] arrival_token arrive(std::ptrdiff_t n = 1) noexcept {
+    // The phase cannot move on before this thread has arrived.
+    const std::uint32_t phase = phase_.load(std::memory_order_relaxed);
+    const auto d = static_cast<std::uint32_t>(n);
+    if (remaining_.fetch_sub(d, std::memory_order_acq_rel) == d) {
+      completion_();
+      remaining_.store(expected_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      phase_.store(phase + 1, std::memory_order_release);
+      detail::futex_wake_all(phase_);
+    }
+    return arrival_token(phase);
+  }
+
+  void wait(arrival_token&& token) const noexcept {
+    for (int i = 0; i < 64; ++i) {
+      if (phase_.load(std::memory_order_acquire) != token.phase_) return;
+      MYSTL_CPU_RELAX();
+    }
+    while (phase_.load(std::memory_order_acquire) == token.phase_) {
+      detail::futex_wait(const_cast<std::atomic<std::uint32_t>&>(phase_), token.phase_);
+    }
+  }
+
+  void arrive_and_wait() noexcept { wait(arrive()); }
+
+  // Arrives at this phase and leaves the barrier for all later ones.
+  void arrive_and_drop() noexcept {
+    expected_.fetch_sub(1, std::memory_order_relaxed);
+    (void)arrive();
+  }
+
+ private:
+  std::atomic<std::uint32_t> expected_;
+  std::atomic<std::uint32_t> remaining_;
+  std::atomic<std::uint32_t> phase_{0};
+  [[no_unique_address]] CompletionFunction completion_;
+};
+
+}  // namespace mystl
@@ -0,0 +1,549 @@
+#pragma once
+
+// Lazily started coroutine task with symmetric transfer.
+//
+//   mystl::task<int> answer() { co_return 42; }
+//   mystl::task<int> twice() { co_return 2 * co_await answer(); }
+//   int v = mystl::sync_wait(twice());
+//
+// A task does nothing until it is awaited. Awaiting it transfers control
+// straight into the task, and the task's completion transfers straight
+// back to its awaiter, so a chain of tasks that complete synchronously
+// runs in constant stack depth.
+//
+// when_all(tasks...) runs tasks concurrently and produces a tuple of their
+// results, with void results as std::monostate. when_all(vector) produces a
+// vector. when_any(vector) completes with the index and result of the first
+// task to finish; the others keep running to completion in the background,
+// as tasks cannot be cancelled. when_all rethrows the exception of the
+// lowest-indexed task that failed, when_any that of the winner.
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "config.hpp"
+
+namespace mystl {
+
+template <class T = void>
+class task;
+
+namespace detail {
+
+struct task_promise_base {
+  struct final_awaiter {
+    bool await_ready() const noexcept { return false; }
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+      return h.promise().continuation_;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  final_awaiter final_suspend() const noexcept { return {}; }
+
+  std::coroutine_handle<> continuation_ = std::noop_coroutine();
+};
+
+template <class T>
+class task_promise : public task_promise_base {
+ public:
+  task<T> get_return_object() noexcept;
+
+  template <class U = T>
+    requires std::is_convertible_v<U&&, T>
+  void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+    result_.template emplace<1>(std::forward<U>(value));
+  }
+  void unhandled_exception() noexcept { result_.template emplace<2>(std::current_exception()); }
+
+  T& result() & {
+    if (result_.index() == 2) std::rethrow_exception(std::get<2>(result_));
+    return std::get<1>(result_);
+  }
+  T&& result() && { return std::move(result()); }
+
+ private:
+  std::variant<std::monostate, T, std::exception_ptr> result_;
+};
+
+template <class T>
+class task_promise<T&> : public task_promise_base {
+ public:
+  task<T&> get_return_object() noexcept;
+
+  void return_value(T& value) noexcept { value_ = std::addressof(value); }
+  void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+  T& result() {
+    if (error_) std::rethrow_exception(error_);
+    return *value_;
+  }
+
+ private:
+  T* value_ = nullptr;
+  std::exception_ptr error_;
+};
+
+template <>
+class task_promise<void> : public task_promise_base {
+ public:
+  task<void> get_return_object() noexcept;
+
+  void return_void() noexcept {}
+  void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+  void result() {
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  std::exception_ptr error_;
+};
+
+}  // namespace detail
+
+template <class T>
+class [[nodiscard]] task {
+ public:
+  using promise_type = detail::task_promise<T>;
+  using value_type = T;
+
+  task() noexcept = default;
+  explicit task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+  task(task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+  task& operator=(task&& other) noexcept {
+    if (this != &other) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(other.h_, {});
+    }
+    return *this;
+  }
+  ~task() {
+    if (h_) h_.destroy();
+  }
+
+  bool valid() const noexcept { return static_cast<bool>(h_); }
+  bool is_ready() const noexcept { return !h_ || h_.done(); }
+
+  auto operator co_await() & noexcept {
+    struct awaiter : base_awaiter {
+      decltype(auto) await_resume() { return this->h_.promise().result(); }
+    };
+    return awaiter{{h_}};
+  }
+  auto operator co_await() && noexcept {
+    struct awaiter : base_awaiter {
+      decltype(auto) await_resume() { return std::move(this->h_.promise()).result(); }
+    };
+    return awaiter{{h_}};
+  }
+
+ private:
+  struct base_awaiter {
+    bool await_ready() const noexcept { return !h_ || h_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+      h_.promise().continuation_ = awaiting;
+      return h_;
+    }
+
+    std::coroutine_handle<promise_type> h_;
+  };
+
+  std::coroutine_handle<promise_type> h_;
+};
+
+namespace detail {
+
+template <class T>
+task<T> task_promise<T>::get_return_object() noexcept {
+  return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+template <class T>
+task<T&> task_promise<T&>::get_return_object() noexcept {
+  return task<T&>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+inline task<void> task_promise<void>::get_return_object() noexcept {
+  return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+template <class T>
+using when_all_value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// when_all children and the awaiter that starts them each decrement the
+// counter once; whoever brings it to zero resumes the awaiting coroutine.
+struct when_all_counter {
+  explicit when_all_counter(std::size_t n) noexcept : count(n + 1) {}
+
+  std::atomic<std::size_t> count;
+  std::coroutine_handle<> waiter;
+};
+
+class when_all_child {
+ public:
+  struct promise_type {
+    when_all_child get_return_object() noexcept {
+      return when_all_child(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    auto final_suspend() const noexcept {
+      struct awaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+          when_all_counter& c = *h.promise().counter;
+          if (c.count.fetch_sub(1, std::memory_order_acq_rel) == 1) return c.waiter;
+          return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }  // bodies catch everything
+
+    when_all_counter* counter = nullptr;
+  };
+
+  explicit when_all_child(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+  when_all_child(when_all_child&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+  when_all_child& operator=(when_all_child&&) = delete;
+  ~when_all_child() {
+    if (h_) h_.destroy();
+  }
+
+  void start(when_all_counter& c) noexcept {
+    h_.promise().counter = &c;
+    h_.resume();
+  }
+
+ private:
+  std::coroutine_handle<promise_type> h_;
+};
+
+template <class T>
+when_all_child run_when_all_child(task<T>& t, std::optional<when_all_value_t<T>>& out,
+                                  std::exception_ptr& error) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(t);
+      out.emplace();
+    } else {
+      out.emplace(co_await std::move(t));
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+// Starts every child and suspends the awaiting coroutine unless they have
+// all finished by the time the last one is started.
+template <class Children>
+struct when_all_awaiter {
+  bool await_ready() const noexcept { return false; }
+  bool await_suspend(std::coroutine_handle<> h) noexcept {
+    counter.waiter = h;
+    for (when_all_child& c : children) c.start(counter);
+    return counter.count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+  void await_resume() const noexcept {}
+
+  when_all_counter& counter;
+  Children& children;
+};
+
+template <class... Ts, std::size_t... I>
+task<std::tuple<when_all_value_t<Ts>...>> when_all_impl(std::index_sequence<I...>,
+                                                        task<Ts>... tasks) {
+  std::tuple<std::optional<when_all_value_t<Ts>>...> results;
+  std::exception_ptr errors[sizeof...(Ts)];
+  when_all_counter counter(sizeof...(Ts));
+  when_all_child children[] = {run_when_all_child(tasks, std::get<I>(results), errors[I])...};
+  co_await when_all_awaiter<decltype(children)>{counter, children};
+  for (const std::exception_ptr& e : errors) {
+    if (e) std::rethrow_exception(e);
+  }
+  co_return std::tuple<when_all_value_t<Ts>...>(std::move(*std::get<I>(results))...);
+}
+
+}  // namespace detail
+
+template <class... Ts>
+  requires(sizeof...(Ts) > 0 && (!std::is_reference_v<Ts> && ...))
+task<std::tuple<detail::when_all_value_t<Ts>...>> when_all(task<Ts>... tasks) {
+  return detail::when_all_impl(std::index_sequence_for<Ts...>{}, std::move(tasks)...);
+}
+
+template <class T>
+  requires(!std::is_reference_v<T>)
+task<std::vector<detail::when_all_value_t<T>>> when_all(std::vector<task<T>> tasks) {
+  const std::size_t n = tasks.size();
+  std::vector<std::optional<detail::when_all_value_t<T>>> results(n);
+  std::vector<std::exception_ptr> errors(n);
+  detail::when_all_counter counter(n);
+  std::vector<detail::when_all_child> children;
+  children.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    children.push_back(detail::run_when_all_child(tasks[i], results[i], errors[i]));
+  }
+  co_await detail::when_all_awaiter<std::vector<detail::when_all_child>>{counter, children};
+  for (const std::exception_ptr& e : errors) {
+    if (e) std::rethrow_exception(e);
+  }
+  std::vector<detail::when_all_value_t<T>> out;
+  out.reserve(n);
+  for (auto& r : results) out.push_back(std::move(*r));
+  co_return out;
+}
+
+template <class T>
+struct when_any_result {
+  std::size_t index;
+  detail::when_all_value_t<T> value;
+};
+
+namespace detail {
+
+inline constexpr std::size_t when_any_undecided = static_cast<std::size_t>(-1);
+
+template <class T>
+struct when_any_state {
+  explicit when_any_state(std::vector<task<T>> t) : tasks(std::move(t)) {}
+
+  std::vector<task<T>> tasks;
+  std::atomic<std::size_t> winner{when_any_undecided};
+  // The waiter resumes once both the winner and the awaiter that starts the
+  // children have arrived.
+  std::atomic<int> arrivals{2};
+  std::coroutine_handle<> waiter;
+  std::optional<when_any_result<T>> result;
+  std::exception_ptr error;
+};
+
+// Self-destroying coroutine for one when_any child. The frame holds a
+// reference to the shared state, so losers keep it alive until they finish.
+template <class T>
+struct when_any_child {
+  struct promise_type {
+    promise_type(const std::shared_ptr<when_any_state<T>>& s, std::size_t i) noexcept
+        : state(s.get()), index(i) {}
+
+    when_any_child get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    auto final_suspend() const noexcept {
+      struct awaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+          when_any_state<T>* s = h.promise().state;
+          std::coroutine_handle<> next = std::noop_coroutine();
+          // The waiter's own reference keeps s alive past destroy() below
+          // whenever it is resumed from here.
+          if (s->winner.load(std::memory_order_relaxed) == h.promise().index &&
+              s->arrivals.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            next = s->waiter;
+          }
+          h.destroy();
+          return next;
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }  // the body catches everything
+
+    when_any_state<T>* state;
+    std::size_t index;
+  };
+
+  std::coroutine_handle<promise_type> h;
+};
+
+template <class T>
+when_any_child<T> run_when_any_child(std::shared_ptr<when_any_state<T>> s, std::size_t i) {
+  std::optional<when_all_value_t<T>> value;
+  std::exception_ptr error;
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(s->tasks[i]);
+      value.emplace();
+    } else {
+      value.emplace(co_await std::move(s->tasks[i]));
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  std::size_t expected = when_any_undecided;
+  if (s->winner.compare_exchange_strong(expected, i, std::memory_order_acq_rel)) {
+    if (error) {
+      s->error = error;
+    } else {
+      s->result.emplace(when_any_result<T>{i, std::move(*value)});
+    }
+  }
+}
+
+// Starts children in order until one has won, then suspends the awaiting
+// coroutine unless the winner already finished during the loop.
+template <class T>
+struct when_any_awaiter {
+  bool await_ready() const noexcept { return false; }
+  bool await_suspend(std::coroutine_handle<> h) noexcept {
+    s->waiter = h;
+    for (std::size_t i = 0; i < s->tasks.size(); ++i) {
+      if (s->winner.load(std::memory_order_acquire) != when_any_undecided) break;
+      run_when_any_child(owner, i).h.resume();
+    }
+    return s->arrivals.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+  void await_resume() const noexcept {}
+
+  // Trivially destructible on purpose: the awaiting coroutine owns the
+  // state, and GCC has mis-destroyed non-trivial co_await temporaries.
+  const std::shared_ptr<when_any_state<T>>& owner;
+  when_any_state<T>* s;
+};
+
+}  // namespace detail
+
+// Completes with the first task to finish; rethrows if that task threw.
+// Tasks after the winner that had not been started yet are never run.
+template <class T>
+  requires(!std::is_reference_v<T>)
+task<when_any_result<T>> when_any(std::vector<task<T>> tasks) {
+  if (tasks.empty()) throw std::invalid_argument("when_any: no tasks");
+  auto s = std::make_shared<detail::when_any_state<T>>(std::move(tasks));
+  co_await detail::when_any_awaiter<T>{s, s.get()};
+  if (s->error) std::rethrow_exception(s->error);
+  co_return std::move(*s->result);
+}
+
+namespace detail {
+
+// Root coroutine that drives a task from non-coroutine code. Completion
+// wakes wait() and then invokes an optional callback, so a caller can either
+// block in wait() or be woken some other way (see run_loop::block_on).
+class sync_wait_task {
+ public:
+  struct promise_type {
+    sync_wait_task get_return_object() noexcept {
+      return sync_wait_task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    auto final_suspend() const noexcept {
+      struct awaiter {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> h) const noexcept {
+          promise_type& p = h.promise();
+          void (*notify)(void*) noexcept = p.notify;
+          void* context = p.context;
+          {
+            // Notify under the lock: the waiter destroys this frame as soon
+            // as it can reacquire the mutex.
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.done = true;
+            p.cv.notify_one();
+          }
+          if (notify) notify(context);
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }  // the body catches everything
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    void (*notify)(void*) noexcept = nullptr;
+    void* context = nullptr;
+  };
+
+  explicit sync_wait_task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+  sync_wait_task(const sync_wait_task&) = delete;
+  sync_wait_task& operator=(const sync_wait_task&) = delete;
+  ~sync_wait_task() { h_.destroy(); }
+
+  void start(void (*notify)(void*) noexcept = nullptr, void* context = nullptr) noexcept {
+    h_.promise().notify = notify;
+    h_.promise().context = context;
+    h_.resume();
+  }
+  void wait() const noexcept {
+    promise_type& p = h_.promise();
+    std::unique_lock<std::mutex> lock(p.mutex);
+    p.cv.wait(lock, [&] { return p.done; });
+  }
+
+ private:
+  std::coroutine_handle<promise_type> h_;
+};
+
+template <class T, class Out>
+sync_wait_task run_sync_wait(task<T>& t, Out& out, std::exception_ptr& error) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(t);
+    } else if constexpr (std::is_reference_v<T>) {
+      out = std::addressof(co_await std::move(t));
+    } else {
+      out.emplace(co_await std::move(t));
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+// Runs t under a sync_wait_task. drive(w) must start w and return once it
+// has completed.
+template <class T, class Drive>
+T drive_to_completion(task<T> t, Drive drive) {
+  std::exception_ptr error;
+  if constexpr (std::is_void_v<T>) {
+    std::monostate unused;
+    sync_wait_task w = run_sync_wait(t, unused, error);
+    drive(w);
+    if (error) std::rethrow_exception(error);
+  } else if constexpr (std::is_reference_v<T>) {
+    std::remove_reference_t<T>* out = nullptr;
+    sync_wait_task w = run_sync_wait(t, out, error);
+    drive(w);
+    if (error) std::rethrow_exception(error);
+    return *out;
+  } else {
+    std::optional<T> out;
+    sync_wait_task w = run_sync_wait(t, out, error);
+    drive(w);
+    if (error) std::rethrow_exception(error);
+    return std::move(*out);
+  }
+}
+
+}  // namespace detail
+
+// Runs t and blocks the calling thread until it has finished, wherever its
+// continuations end up running.
+template <class T>
+T sync_wait(task<T> t) {
+  return detail::drive_to_completion(std::move(t), [](detail::sync_wait_task& w) {
+    w.start();
+    w.wait();
+  });
+}
+
+}  // namespace mystl
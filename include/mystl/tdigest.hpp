@@ -0,0 +1,217 @@
+#pragma once
+
+// t-digest: streaming quantile estimates of real-valued data, most accurate
+// in the tails.
+//
+//   mystl::tdigest latencies;            // compression 200: about 35 KiB
+//   for (double ms : samples) latencies.insert(ms);
+//   double p999 = latencies.quantile(0.999);
+//   latencies.merge(digest_from_another_host);
+//
+// This is Dunning's merging digest. Values are appended to a buffer; when
+// it fills, buffer and centroids are sorted together and adjacent points
+// are merged into centroids whose size is bounded by the k2 (logistic)
+// scale function. Centroid size shrinks towards q = 0 and q = 1 in
+// proportion to q(1 - q), so extreme quantiles such as p99.99 stay close to
+// exact, while the middle is summarised more coarsely: at the default
+// compression the median is within about half a percent in rank. The
+// number of centroids stays below about the compression.
+//
+// Queries on a digest with buffered values work on a compressed copy, so
+// call compress() first when running many queries. NaNs are ignored.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "config.hpp"
+
+namespace mystl {
+
+class tdigest {
+ public:
+  struct centroid {
+    double mean;
+    double weight;
+  };
+
+  explicit tdigest(double compression = 200.0) : compression_(compression) {
+    if (!(compression >= 1.0 && compression <= 1e6)) {
+      throw std::invalid_argument("tdigest: compression must be in [1, 1e6]");
+    }
+    buffer_limit_ = static_cast<std::size_t>(std::ceil(5.0 * compression));
+    buffer_.reserve(buffer_limit_);
+  }
+
+  // weight must be positive.
+  void insert(double x, double weight = 1.0) {
+    if (std::isnan(x)) return;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+    buffer_.push_back({x, weight});
+    if (buffer_.size() >= buffer_limit_) compress();
+  }
+
+  // Digest of both streams.
+  void merge(const tdigest& other) {
+    if (other.empty()) return;
+    if (&other == this) {
+      const tdigest copy(other);
+      merge(copy);
+      return;
+    }
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    for (const std::vector<centroid>* part : {&other.centroids_, &other.buffer_}) {
+      for (const centroid& c : *part) {
+        buffer_.push_back(c);
+        if (buffer_.size() >= buffer_limit_) compress();
+      }
+    }
+  }
+
+  // Folds buffered values into the centroids.
+  void compress() {
+    if (buffer_.empty()) return;
+    buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+    std::sort(buffer_.begin(), buffer_.end(),
+              [](const centroid& a, const centroid& b) { return a.mean < b.mean; });
+    double total = 0.0;
+    for (const centroid& c : buffer_) total += c.weight;
+
+    centroids_.clear();
+    centroid cur = buffer_.front();
+    double before = 0.0;  // weight of the centroids already emitted
+    double limit = total * k_inverse(k(0.0, total) + 1.0, total);
+    for (std::size_t i = 1; i < buffer_.size(); ++i) {
+      const centroid& next = buffer_[i];
+      if (before + cur.weight + next.weight <= limit) {
+        cur.weight += next.weight;
+        cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+      } else {
+        before += cur.weight;
+        centroids_.push_back(cur);
+        limit = total * k_inverse(k(before / total, total) + 1.0, total);
+        cur = next;
+      }
+    }
+    centroids_.push_back(cur);
+    total_ = total;
+    buffer_.clear();
+  }
+
+  // Estimated value below which a fraction q of the data lies; NaN if
+  // empty.
+  double quantile(double q) const {
+    std::optional<tdigest> copy;
+    const tdigest& d = compressed(copy);
+    if (d.centroids_.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0.0) return d.min_;
+    if (q >= 1.0) return d.max_;
+    const std::vector<centroid>& c = d.centroids_;
+    const double index = q * d.total_;
+    // The first and last half-centroids interpolate towards the exact
+    // extremes.
+    if (index < c.front().weight / 2) {
+      return d.min_ + (c.front().mean - d.min_) * index / (c.front().weight / 2);
+    }
+    if (index > d.total_ - c.back().weight / 2) {
+      return d.max_ - (d.max_ - c.back().mean) * (d.total_ - index) / (c.back().weight / 2);
+    }
+    double left = c.front().weight / 2;  // rank of centroid i's centre
+    for (std::size_t i = 0; i + 1 < c.size(); ++i) {
+      const double right = left + (c[i].weight + c[i + 1].weight) / 2;
+      if (index <= right) {
+        return c[i].mean + (c[i + 1].mean - c[i].mean) * (index - left) / (right - left);
+      }
+      left = right;
+    }
+    return d.max_;
+  }
+
+  // Estimated fraction of the data <= x; NaN if empty.
+  double cdf(double x) const {
+    std::optional<tdigest> copy;
+    const tdigest& d = compressed(copy);
+    if (d.centroids_.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if (x < d.min_) return 0.0;
+    if (x >= d.max_) return 1.0;
+    const std::vector<centroid>& c = d.centroids_;
+    if (x < c.front().mean) {
+      return (x - d.min_) / (c.front().mean - d.min_) * (c.front().weight / 2) / d.total_;
+    }
+    if (x >= c.back().mean) {
+      const double tail = (d.max_ - x) / (d.max_ - c.back().mean) * (c.back().weight / 2);
+      return 1.0 - tail / d.total_;
+    }
+    double left = c.front().weight / 2;
+    for (std::size_t i = 0; i + 1 < c.size(); ++i) {
+      const double right = left + (c[i].weight + c[i + 1].weight) / 2;
+      if (x < c[i + 1].mean) {
+        const double within = (x - c[i].mean) / (c[i + 1].mean - c[i].mean);
+        return (left + within * (right - left)) / d.total_;
+      }
+      left = right;
+    }
+    return 1.0;
+  }
+
+  void clear() noexcept {
+    centroids_.clear();
+    buffer_.clear();
+    total_ = 0.0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+  }
+
+  bool empty() const noexcept { return centroids_.empty() && buffer_.empty(); }
+  // Total weight inserted.
+  double count() const noexcept {
+    double n = total_;
+    for (const centroid& c : buffer_) n += c.weight;
+    return n;
+  }
+  double min() const noexcept { return min_; }
+  double max() const noexcept { return max_; }
+  double compression() const noexcept { return compression_; }
+  // Centroids as of the last compress(), ordered by mean.
+  const std::vector<centroid>& centroids() const noexcept { return centroids_; }
+  std::size_t memory_usage() const noexcept {
+    return (centroids_.capacity() + buffer_.capacity()) * sizeof(centroid);
+  }
+
+ private:
+  // k2 scale function and its inverse, normalised for total weight n: a
+  // centroid may span at most one unit of k.
+  double k(double q, double n) const noexcept {
+    q = std::clamp(q, 1e-15, 1 - 1e-15);
+    return compression_ / normalizer(n) * std::log(q / (1 - q));
+  }
+  double k_inverse(double k, double n) const noexcept {
+    return 1 / (1 + std::exp(-k * normalizer(n) / compression_));
+  }
+  double normalizer(double n) const noexcept {
+    return 4 * std::log(std::max(n / compression_, 1.0)) + 24;
+  }
+
+  const tdigest& compressed(std::optional<tdigest>& copy) const {
+    if (buffer_.empty()) return *this;
+    copy.emplace(*this);
+    copy->compress();
+    return *copy;
+  }
+
+  double compression_;
+  std::size_t buffer_limit_ = 0;
+  std::vector<centroid> centroids_;
+  std::vector<centroid> buffer_;
+  double total_ = 0.0;  // weight of centroids_
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+};
+
+}  // namespace mystl
@@ -0,0 +1,50 @@
+#include <mystl/algorithm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+constexpr bool sorts_at_compile_time() {
+  std::array<int, 64> a{};
+  for (int i = 0; i < 64; ++i) a[static_cast<std::size_t>(i)] = (i * 37) % 64;
+  mystl::sort(a);
+  return mystl::is_sorted(a) && a.front() == 0 && a.back() == 63;
+}
+static_assert(sorts_at_compile_time());
+
+int main() {
+  std::mt19937 rng(3);
+  for (int n : {0, 1, 2, 5, 16, 17, 100, 1000, 5000}) {
+    std::vector<int> random(static_cast<std::size_t>(n));
+    for (int& x : random) x = static_cast<int>(rng() % 100);
+    std::vector<int> expected = random;
+    std::sort(expected.begin(), expected.end());
+    mystl::sort(random.begin(), random.end());
+    CHECK(random == expected);
+
+    std::vector<int> descending(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) descending[static_cast<std::size_t>(i)] = n - i;
+    mystl::sort(descending, std::less<>{});
+    CHECK(mystl::is_sorted(descending));
+
+    std::vector<int> heap = expected;
+    std::shuffle(heap.begin(), heap.end(), rng);
+    mystl::heap_sort(heap.begin(), heap.end(), std::greater<>{});
+    CHECK(std::is_sorted(heap.begin(), heap.end(), std::greater<>{}));
+
+    std::vector<int> small(expected.begin(), expected.begin() + std::min(n, 20));
+    std::reverse(small.begin(), small.end());
+    mystl::insertion_sort(small.begin(), small.end());
+    CHECK(std::is_sorted(small.begin(), small.end()));
+  }
+
+  std::vector<std::string> words{"pear", "apple", "fig"};
+  mystl::sort(words);
+  CHECK((words == std::vector<std::string>{"apple", "fig", "pear"}));
+  CHECK(!mystl::is_sorted(std::vector<int>{2, 1}));
+}
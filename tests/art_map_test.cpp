@@ -0,0 +1,131 @@
+#include <mystl/art_map.hpp>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+std::mt19937_64 rng(42);
+
+// Shared prefixes, embedded NULs, 0xff bytes and long runs, to exercise
+// path compression and keys that are prefixes of others.
+std::string random_string() {
+  static const std::string prefixes[] = {"",
+                                         "a",
+                                         "ab",
+                                         "abcdefghijklmnopqrstuvwxyz0123",
+                                         "abcdefghijklmnopqrstuvwxyz0124",
+                                         std::string("x\0y", 3)};
+  static const char alphabet[] = {'a', 'b', '\0', '\xff', 'c', 'z'};
+  std::string s = prefixes[rng() % 6];
+  const int n = static_cast<int>(rng() % 6);
+  for (int i = 0; i < n; ++i) s += alphabet[rng() % 6];
+  if (rng() % 8 == 0) s.append(300, 'q');
+  return s;
+}
+
+// Random operations against std::map.
+template <class K, class Gen>
+void fuzz(Gen gen, int iterations) {
+  mystl::art_map<K, int> a;
+  std::map<K, int> m;
+  for (int it = 0; it < iterations; ++it) {
+    const K k = gen();
+    const int op = static_cast<int>(rng() % 10);
+    if (op < 4) {
+      auto [p, inserted] = a.try_emplace(k, it);
+      auto r = m.try_emplace(k, it);
+      CHECK(inserted == r.second && *p == r.first->second);
+    } else if (op < 7) {
+      CHECK(a.erase(k) == (m.erase(k) == 1));
+    } else if (op == 7) {
+      const int* p = a.find(k);
+      auto mi = m.find(k);
+      CHECK((p != nullptr) == (mi != m.end()));
+      if (p) CHECK(*p == mi->second);
+      auto lb = a.lower_bound(k);
+      auto ml = m.lower_bound(k);
+      CHECK((lb == a.end()) == (ml == m.end()));
+      if (ml != m.end()) CHECK(lb->first == ml->first && lb->second == ml->second);
+      for (int steps = 0; lb != a.end() && steps < 5; ++lb, ++ml, ++steps) {
+        CHECK(ml != m.end() && lb->first == ml->first);
+      }
+    } else if (op == 8) {
+      a.insert_or_assign(k, -it);
+      m.insert_or_assign(k, -it);
+    } else if (it % 50 == 0) {
+      CHECK(a.size() == m.size());
+      auto mi = m.begin();
+      for (const auto& kv : a) {
+        CHECK(mi != m.end() && kv.first == mi->first && kv.second == mi->second);
+        ++mi;
+      }
+      CHECK(mi == m.end());
+      const mystl::art_map<K, int> c = a;
+      auto ci = c.begin();
+      for (const auto& kv : m) {
+        CHECK(ci->first == kv.first);
+        ++ci;
+      }
+
+      std::vector<K> keys;
+      for (int i = 0; i < 37; ++i) keys.push_back(gen());
+      std::vector<const int*> out(keys.size());
+      const auto& ca = a;
+      const std::size_t found = ca.find_batch(keys, out);
+      std::size_t expected = 0;
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        CHECK(out[i] == ca.find(keys[i]));
+        expected += out[i] != nullptr;
+      }
+      CHECK(found == expected);
+
+      if constexpr (std::is_same_v<K, std::string>) {
+        std::string prefix = gen();
+        prefix.resize(rng() % (prefix.size() + 1));
+        std::vector<std::string> got, want;
+        a.for_each_prefix(prefix, [&](const auto& kv) { got.push_back(kv.first); });
+        for (const auto& kv : m) {
+          if (kv.first.starts_with(prefix)) want.push_back(kv.first);
+        }
+        CHECK(got == want);
+      }
+    }
+  }
+  std::size_t n = 0;
+  a.for_each([&](const auto&) { ++n; });
+  CHECK(n == m.size());
+  for (const auto& kv : m) CHECK(a.erase(kv.first));
+  CHECK(a.empty() && a.begin() == a.end());
+}
+
+}  // namespace
+
+int main() {
+  fuzz<std::string>(random_string, 50000);
+  fuzz<long long>(
+      [] {
+        return rng() % 3 == 0 ? static_cast<long long>(rng())
+                              : static_cast<long long>(rng() % 2000) - 1000;
+      },
+      50000);
+  fuzz<unsigned>([] { return static_cast<unsigned>(rng() % 5000) * 977u; }, 50000);
+  fuzz<std::uint64_t>([] { return rng() % 300; }, 50000);
+
+  // Dense integers fill Node256s.
+  mystl::art_map<std::uint32_t, int> dense;
+  for (std::uint32_t i = 0; i < 100000; ++i) dense[i] = static_cast<int>(i);
+  for (std::uint32_t i = 0; i < 100000; i += 2) CHECK(dense.erase(i));
+  std::uint32_t expect = 1;
+  for (const auto& kv : dense) {
+    CHECK(kv.first == expect);
+    expect += 2;
+  }
+  CHECK(expect == 100001);
+}
@@ -0,0 +1,117 @@
+#include <mystl/async_io.hpp>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+using mystl::io_context;
+using mystl::task;
+
+task<std::size_t> copy_block(io_context& io, int in, int out, std::span<std::byte> buf,
+                             std::uint64_t offset) {
+  const std::size_t n = co_await mystl::async_read(io, in, buf, offset);
+  co_return co_await mystl::async_write(io, out, buf.first(n), offset);
+}
+
+task<std::size_t> read_at(io_context& io, int fd, std::span<std::byte> buf, std::uint64_t offset) {
+  co_return co_await mystl::async_read(io, fd, buf, offset);
+}
+
+// More reads in flight than the ring has entries.
+task<std::size_t> read_many(io_context& io, int fd, int count) {
+  std::vector<std::vector<std::byte>> bufs(count, std::vector<std::byte>(100));
+  std::vector<task<std::size_t>> reads;
+  for (int i = 0; i < count; ++i) {
+    reads.push_back(read_at(io, fd, bufs[i], static_cast<std::uint64_t>(i) * 100));
+  }
+  const auto sizes = co_await mystl::when_all(std::move(reads));
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    total += sizes[i];
+    for (std::size_t j = 0; j < 100; ++j) {
+      CHECK(bufs[i][j] == static_cast<std::byte>((i * 100 + j) & 0xff));
+    }
+  }
+  co_return total;
+}
+
+task<void> read_bad_fd(io_context& io) {
+  std::byte b[4];
+  try {
+    co_await mystl::async_read(io, -1, b, 0);
+    CHECK(false);
+  } catch (const std::system_error& e) {
+    CHECK(e.code().value() == EBADF);
+  }
+}
+
+// Submits from a thread that is not running the context.
+task<std::size_t> read_from_pool(io_context& io, mystl::thread_pool& pool, int fd) {
+  co_await pool.schedule();
+  std::byte b[10];
+  co_return co_await mystl::async_read(io, fd, b, 5);
+}
+
+task<std::size_t> round_trip_fixed(io_context& io, int fd, std::span<std::byte> registered) {
+  co_await mystl::async_write_fixed(io, fd, registered.first(64), 0, 0);
+  co_return co_await mystl::async_read_fixed(io, fd, registered.subspan(64, 64), 0, 0);
+}
+
+int make_temp(std::string& path) {
+  path = (std::filesystem::temp_directory_path() / "mystl_async_io_XXXXXX").string();
+  const int fd = ::mkstemp(path.data());
+  CHECK(fd >= 0);
+  return fd;
+}
+
+void run(mystl::io_backend backend) {
+  io_context io(backend, 8);
+  std::string in_path, out_path;
+  const int in = make_temp(in_path), out = make_temp(out_path);
+  std::vector<unsigned char> data(100 * 50);
+  for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<unsigned char>(i & 0xff);
+  CHECK(::write(in, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+
+  std::vector<std::byte> buf(4096);
+  CHECK(io.block_on(copy_block(io, in, out, buf, 0)) == 4096);
+  CHECK(io.block_on(read_many(io, in, 50)) == 5000);
+  io.block_on(read_bad_fd(io));
+
+  mystl::thread_pool pool(2);
+  for (int i = 0; i < 100; ++i) CHECK(io.block_on(read_from_pool(io, pool, in)) == 10);
+
+  // Works whether or not registration succeeds.
+  alignas(4096) static std::byte registered[4096];
+  std::memset(registered, 7, 64);
+  iovec v{registered, sizeof registered};
+  (void)io.register_buffers({&v, 1});
+  CHECK(io.block_on(round_trip_fixed(io, out, registered)) == 64);
+  CHECK(registered[64] == std::byte{7});
+
+  ::close(in);
+  ::close(out);
+  ::unlink(in_path.c_str());
+  ::unlink(out_path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  run(mystl::io_backend::io_uring);
+  run(mystl::io_backend::thread_pool);
+}
@@ -0,0 +1,60 @@
+#include <mystl/bloom_filter.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "check.hpp"
+
+constexpr std::size_t n = 100000;
+
+std::uint64_t key(std::size_t i) { return i * 2654435761ull; }
+
+// Inserted keys are always found, singly or batched, and the false positive
+// rate stays near the target.
+template <class Filter>
+void check_filter(Filter& f, double max_fpp) {
+  std::vector<std::uint64_t> in(n), out(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    in[i] = key(i);
+    out[i] = key(i) + 1;
+  }
+  f.insert_batch(std::span<const std::uint64_t>(in));
+  std::unique_ptr<bool[]> hit(new bool[n]);
+  CHECK(f.contains_batch(std::span<const std::uint64_t>(in), std::span<bool>(hit.get(), n)) == n);
+  for (std::uint64_t k : in) CHECK(f.contains(k));
+  const std::size_t fp =
+      f.contains_batch(std::span<const std::uint64_t>(out), std::span<bool>(hit.get(), n));
+  std::size_t single = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    CHECK(hit[i] == f.contains(out[i]));
+    single += hit[i];
+  }
+  CHECK(fp == single);
+  CHECK(static_cast<double>(fp) / n < max_fpp);
+}
+
+int main() {
+  {
+    mystl::bloom_filter<std::uint64_t> f(n, 0.01);
+    check_filter(f, 0.02);
+  }
+  {
+    mystl::blocked_bloom_filter<std::uint64_t> f(n, 0.01);
+    check_filter(f, 0.03);
+  }
+  {
+    mystl::counting_bloom_filter<std::uint64_t> f(n, 0.01);
+    check_filter(f, 0.02);
+    for (std::size_t i = 0; i < n; i += 2) f.erase(key(i));
+    for (std::size_t i = 1; i < n; i += 2) CHECK(f.contains(key(i)));
+    std::size_t residual = 0;
+    for (std::size_t i = 0; i < n; i += 2) residual += f.contains(key(i));
+    CHECK(residual < n / 20);
+  }
+  mystl::blocked_bloom_filter<std::string_view> words(10, 0.01);
+  words.insert("abc");
+  CHECK(words.contains("abc"));
+}
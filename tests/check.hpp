@@ -0,0 +1,33 @@
+#pragma once
+
+// Assertions for the tests: unlike assert(), they stay on in every build
+// type. A test is a program; the first failed check aborts it.
+
+#include <cstdio>
+#include <cstdlib>
+
+#define MYSTL_CHECK(cond)                                                            \
+  do {                                                                               \
+    if (!(cond)) {                                                                   \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      std::abort();                                                                  \
+    }                                                                                \
+  } while (0)
+
+#define MYSTL_CHECK_THROWS(expr, exception)                                           \
+  do {                                                                                \
+    bool mystl_thrown_ = false;                                                       \
+    try {                                                                             \
+      (void)(expr);                                                                   \
+    } catch (const exception&) {                                                      \
+      mystl_thrown_ = true;                                                           \
+    }                                                                                 \
+    if (!mystl_thrown_) {                                                             \
+      std::fprintf(stderr, "%s:%d: %s did not throw %s\n", __FILE__, __LINE__, #expr, \
+                   #exception);                                                       \
+      std::abort();                                                                   \
+    }                                                                                 \
+  } while (0)
+
+#define CHECK(cond) MYSTL_CHECK(cond)
+#define CHECK_THROWS(expr, exception) MYSTL_CHECK_THROWS(expr, exception)
@@ -0,0 +1,23 @@
+#include <mystl/config.hpp>
+
+#include <cstdint>
+
+#include "check.hpp"
+
+static_assert(mystl::cache_line_size >= 32 &&
+              (mystl::cache_line_size & (mystl::cache_line_size - 1)) == 0);
+static_assert(mystl::batch_group_size > 0);
+
+MYSTL_ALWAYS_INLINE int twice(int x) { return 2 * x; }
+
+int main() {
+  int data[4] = {1, 2, 3, 4};
+  MYSTL_PREFETCH(&data[0]);
+  MYSTL_PREFETCH_WRITE(&data[1]);
+  MYSTL_CPU_RELAX();
+  int* MYSTL_RESTRICT p = data;
+  CHECK(MYSTL_LIKELY(p[3] == 4));
+  CHECK(!MYSTL_UNLIKELY(p[0] == 2));
+  CHECK(twice(data[2]) == 6);
+  CHECK(MYSTL_HAS_INT128 == 0 || MYSTL_HAS_INT128 == 1);
+}
@@ -0,0 +1,43 @@
+#include <mystl/count_min_sketch.hpp>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  std::mt19937_64 rng(1);
+  mystl::count_min_sketch<std::uint64_t> cm(1e-4, 1e-3), second(1e-4, 1e-3);
+  std::unordered_map<std::uint64_t, std::uint32_t> exact;
+  std::vector<std::uint64_t> keys;
+  for (int i = 0; i < 200000; ++i) {
+    const auto x = std::uniform_real_distribution<>(1, 1e3)(rng);
+    const auto k = static_cast<std::uint64_t>(x * x) % 50000;
+    keys.push_back(k);
+    ++exact[k];
+  }
+  cm.add_batch(std::span<const std::uint64_t>(keys.data(), keys.size() / 2));
+  for (std::size_t i = keys.size() / 2; i < keys.size(); ++i) second.add(keys[i]);
+  cm.merge(second);
+
+  // Never undercounts; overcounts by at most the bound for nearly all keys.
+  std::size_t beyond = 0;
+  for (const auto& [k, c] : exact) {
+    const auto e = cm.estimate(k);
+    CHECK(e >= c);
+    beyond += static_cast<double>(e - c) > cm.error_bound();
+  }
+  CHECK(beyond <= exact.size() / 100);
+
+  std::vector<std::uint32_t> est(keys.size());
+  cm.estimate_batch(keys, est);
+  for (std::size_t i = 0; i < keys.size(); i += 997) CHECK(est[i] == cm.estimate(keys[i]));
+
+  // Narrow counters saturate instead of wrapping.
+  mystl::count_min_sketch<int, mystl::seeded_hash<int>, std::uint8_t> small(0.1, 0.1);
+  for (int i = 0; i < 1000; ++i) small.add(7);
+  CHECK(small.estimate(7) == 255);
+}
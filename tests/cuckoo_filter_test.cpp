@@ -0,0 +1,38 @@
+#include <mystl/cuckoo_filter.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "check.hpp"
+
+std::uint64_t key(std::size_t i) { return i * 2654435761ull; }
+
+int main() {
+  constexpr std::size_t n = 100000;
+  mystl::cuckoo_filter<std::uint64_t> f(n);
+  std::vector<std::uint64_t> in(n), out(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    in[i] = key(i);
+    out[i] = key(i) + 1;
+  }
+  CHECK(f.insert_batch(std::span<const std::uint64_t>(in)) == n);
+  CHECK(f.size() == n);
+  std::unique_ptr<bool[]> hit(new bool[n]);
+  CHECK(f.contains_batch(std::span<const std::uint64_t>(in), std::span<bool>(hit.get(), n)) == n);
+  const std::size_t fp =
+      f.contains_batch(std::span<const std::uint64_t>(out), std::span<bool>(hit.get(), n));
+  CHECK(static_cast<double>(fp) / n < 0.005);
+
+  for (std::size_t i = 0; i < n; i += 2) CHECK(f.erase(key(i)));
+  for (std::size_t i = 1; i < n; i += 2) CHECK(f.contains(key(i)));
+  CHECK(f.size() == n / 2);
+
+  // Filling past capacity fails cleanly and keeps every stored key.
+  mystl::cuckoo_filter<std::uint64_t> small(1000);
+  std::uint64_t stored = 0;
+  while (stored < 100000 && small.insert(stored)) ++stored;
+  CHECK(stored >= 900 && stored <= small.slot_count());
+  for (std::uint64_t i = 0; i < stored; ++i) CHECK(small.contains(i));
+}
@@ -0,0 +1,165 @@
+#include <mystl/execution.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace ex = mystl::execution;
+
+// Counts heap allocations, to check that connect() and start() make none.
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t n) {
+  ++allocations;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct int_receiver {
+  int* out;
+  void set_value(int v) noexcept { *out = v; }
+  void set_error(std::exception_ptr) noexcept { *out = -1; }
+};
+
+// Reports nothing once moved from.
+struct move_only_receiver {
+  explicit move_only_receiver(int* o) noexcept : out(o) {}
+  move_only_receiver(move_only_receiver&& other) noexcept
+      : out(std::exchange(other.out, nullptr)) {}
+  void set_value(int v) noexcept {
+    if (out) *out = v;
+  }
+  void set_error(std::exception_ptr) noexcept {
+    if (out) *out = -1;
+  }
+  int* out;
+};
+
+struct throwing_connect_sender {
+  using value_types = ex::value_list<int>;
+  template <ex::receiver R>
+  auto connect(R r) && {
+    if (fail) throw std::runtime_error("connect");
+    return ex::just(0).connect(std::move(r));
+  }
+  bool fail = true;
+};
+
+}  // namespace
+
+int main() {
+  static_assert(std::is_same_v<decltype(ex::sync_wait(ex::just(1))), int>);
+  CHECK(ex::sync_wait(ex::just(20) | ex::then([](int v) { return v + 1; }) |
+                     ex::then([](int v) { return v * 2; })) == 42);
+  ex::sync_wait(ex::just() | ex::then([] {}));
+  // A potentially throwing callable may return a reference; the value is copied.
+  std::string name = "ref";
+  CHECK(ex::sync_wait(ex::just() | ex::then([&]() -> std::string& { return name; })) == "ref");
+  auto [a, s] = ex::sync_wait(ex::just(1, std::string("x")));
+  CHECK(a == 1 && s == "x");
+
+  {
+    int out = 0;
+    auto snd = ex::just(3) | ex::then([](int v) { return v * 3; }) |
+               ex::let_value([](int& v) { return ex::just(v + 1); }) |
+               ex::bulk(4, [](int i, int& v) { v += i; });
+    const long before = allocations;
+    auto op = std::move(snd).connect(int_receiver{&out});
+    op.start();
+    CHECK(allocations == before);
+    CHECK(out == 16);
+  }
+
+  try {
+    ex::sync_wait(ex::just(1) | ex::then([](int) -> int { throw std::runtime_error("boom"); }) |
+                  ex::then([](int v) { return v; }));
+    CHECK(false);
+  } catch (const std::runtime_error& e) {
+    CHECK(std::string(e.what()) == "boom");
+  }
+
+  // A second sender that fails to connect reports to the downstream receiver.
+  {
+    int out = 0;
+    auto op = (ex::just(1) | ex::let_value([](int&) { return throwing_connect_sender{}; }))
+                  .connect(move_only_receiver(&out));
+    op.start();
+    CHECK(out == -1);
+  }
+
+  // let_value's function gets a reference to a value that outlives the
+  // sender it returns.
+  const auto sum_of = [](std::vector<int>* p) { return std::accumulate(p->begin(), p->end(), 0); };
+  CHECK(ex::sync_wait(ex::just(std::vector<int>{1, 2, 3}) |
+                      ex::let_value([&](std::vector<int>& v) {
+                        return ex::just(&v) | ex::then(sum_of);
+                      })) == 6);
+
+  mystl::thread_pool pool(4);
+  ex::thread_pool_scheduler sch(pool);
+  const std::thread::id main_id = std::this_thread::get_id();
+  CHECK(ex::sync_wait(ex::schedule(sch) | ex::then([] { return std::this_thread::get_id(); })) !=
+        main_id);
+  std::atomic<bool> off_main{false};
+  CHECK(ex::sync_wait(ex::schedule_on(sch, ex::just(5) | ex::then([&](int v) {
+                                             off_main = std::this_thread::get_id() != main_id;
+                                             return v;
+                                           }))) == 5);
+  CHECK(off_main);
+
+  for (int rep = 0; rep < 20; ++rep) {
+    const int n = 10000;
+    const long long sum =
+        ex::sync_wait(ex::schedule(sch) | ex::then([&] { return std::vector<int>(n); }) |
+                      ex::bulk(n, [](int i, std::vector<int>& v) { v[i] = i; }) |
+                      ex::then([](const std::vector<int>& v) {
+                        return std::accumulate(v.begin(), v.end(), 0LL);
+                      }));
+    CHECK(sum == 1LL * n * (n - 1) / 2);
+  }
+  static_assert(mystl::detail::completes_on_thread_pool<decltype(ex::schedule(sch) |
+                                                                ex::then([] { return 1; }))>);
+  const auto fail_at_500 = [](int i) {
+    if (i == 500) throw std::logic_error("b");
+  };
+  CHECK_THROWS(ex::sync_wait(ex::schedule(sch) | ex::bulk(1000, fail_at_500)), std::logic_error);
+
+  {
+    auto [x, y, z] = ex::sync_wait(
+        ex::when_all(ex::schedule(sch) | ex::then([] { return 1; }), ex::just(2.5),
+                     ex::schedule(sch) | ex::then([] { return std::string("s"); }),
+                     ex::schedule(sch)));
+    CHECK(x == 1 && y == 2.5 && z == "s");
+    ex::sync_wait(ex::when_all());
+    for (int i = 0; i < 200; ++i) {
+      try {
+        ex::sync_wait(ex::when_all(ex::schedule(sch) | ex::then([] { throw 1; }),
+                                   ex::schedule(sch) | ex::then([] { return 2; })));
+        CHECK(false);
+      } catch (int v) {
+        CHECK(v == 1);
+      }
+    }
+  }
+
+  mystl::run_loop loop;
+  std::thread t([&] { loop.run(); });
+  CHECK(ex::sync_wait(ex::schedule_on(ex::run_loop_scheduler(loop), ex::just(7))) == 7);
+  loop.finish();
+  t.join();
+  CHECK(ex::sync_wait(ex::schedule(ex::inline_scheduler{}) | ex::then([] { return 9; })) == 9);
+}
@@ -0,0 +1,62 @@
+#include <mystl/executor.hpp>
+#include <mystl/task.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+mystl::task<int> loop_work(mystl::run_loop& loop) {
+  int steps = 0;
+  for (int i = 0; i < 100; ++i) {
+    co_await loop.schedule();
+    ++steps;
+  }
+  co_return steps;
+}
+
+mystl::task<std::thread::id> where(mystl::thread_pool& pool) {
+  co_await pool.schedule();
+  co_return std::this_thread::get_id();
+}
+
+mystl::task<int> sleepy(mystl::thread_pool& pool, int ms, int v) {
+  co_await pool.schedule();
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  co_return v;
+}
+
+std::atomic<int> spawned{0};
+mystl::task<void> bump() {
+  ++spawned;
+  co_return;
+}
+
+}  // namespace
+
+int main() {
+  mystl::run_loop loop;
+  CHECK(loop.block_on(loop_work(loop)) == 100);
+  CHECK(loop.block_on(loop_work(loop)) == 100);
+
+  mystl::thread_pool pool(2);
+  CHECK(mystl::sync_wait(where(pool)) != std::this_thread::get_id());
+
+  std::vector<mystl::task<int>> race;
+  race.push_back(sleepy(pool, 300, 1));
+  race.push_back(sleepy(pool, 1, 2));
+  const auto first = mystl::sync_wait(mystl::when_any(std::move(race)));
+  CHECK(first.index == 1 && first.value == 2);
+
+  for (int i = 0; i < 1000; ++i) mystl::spawn(pool, bump());
+  for (int i = 0; i < 500 && spawned != 1000; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  CHECK(spawned == 1000);
+}
@@ -0,0 +1,162 @@
+#include <mystl/future.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+// Counts heap allocations, to check that state is pooled.
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t n) {
+  ++allocations;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using mystl::future;
+using mystl::promise;
+
+int main() {
+  {
+    promise<int> p;
+    future<std::string> f = p.get_future()
+                                .then([](int v) { return v * 2; })
+                                .then([](int v) { return std::to_string(v); });
+    p.set_value(21);
+    CHECK(f.get() == "42");
+  }
+
+  // After warming the pool, a promise with one continuation allocates
+  // nothing, and neither does a continuation on a ready future.
+  for (int i = 0; i < 100; ++i) {
+    promise<int> p;
+    auto f = p.get_future().then([](int v) { return v + 1; });
+    p.set_value(i);
+    CHECK(f.get() == i + 1);
+  }
+  {
+    const long before = allocations;
+    for (int i = 0; i < 1000; ++i) {
+      promise<int> p;
+      auto f = p.get_future().then([](int v) { return v + 1; });
+      p.set_value(i);
+      CHECK(f.get() == i + 1);
+    }
+    CHECK(allocations == before);
+    auto r = mystl::make_ready_future(5).then([](int v) { return v * 3; });
+    CHECK(allocations == before);
+    CHECK(r.is_ready() && r.get() == 15);
+  }
+
+  {
+    promise<void> p;
+    bool ran = false;
+    auto f = p.get_future().then([&] { ran = true; });
+    p.set_value();
+    f.get();
+    CHECK(ran);
+
+    promise<int> q;
+    auto g = q.get_future()
+                 .then([](int) -> int { throw std::runtime_error("x"); })
+                 .then([](int v) { return v; });
+    q.set_value(1);
+    CHECK_THROWS(g.get(), std::runtime_error);
+
+    future<int> h;
+    {
+      promise<int> dead;
+      h = dead.get_future();
+    }
+    try {
+      h.get();
+      CHECK(false);
+    } catch (const std::future_error& e) {
+      CHECK(e.code() == std::future_errc::broken_promise);
+    }
+
+    promise<int> twice;
+    (void)twice.get_future();
+    CHECK_THROWS(twice.get_future(), std::future_error);
+    twice.set_value(1);
+    CHECK_THROWS(twice.set_value(2), std::future_error);
+
+    future<int> empty;
+    CHECK(!empty.valid());
+    CHECK_THROWS(std::move(empty).then([](int v) { return v; }), std::future_error);
+  }
+
+  // A continuation returning a future is unwrapped.
+  {
+    promise<int> inner;
+    future<int> fi = inner.get_future();
+    promise<int> p;
+    auto f = p.get_future().then(
+        [&](int v) { return std::move(fi).then([v](int w) { return v + w; }); });
+    p.set_value(1);
+    CHECK(!f.is_ready());
+    inner.set_value(2);
+    CHECK(f.get() == 3);
+  }
+
+  // Too large to store inline.
+  {
+    promise<int> p;
+    char big[200] = {1};
+    auto f = p.get_future().then([big](int v) { return v + big[0]; });
+    p.set_value(1);
+    CHECK(f.get() == 2);
+  }
+
+  {
+    mystl::thread_pool pool(2);
+    for (int i = 0; i < 500; ++i) {
+      promise<int> p;
+      auto f =
+          p.get_future().then(pool, [](int v) { return v + 1; }).then([](int v) { return v * 2; });
+      std::thread t([&] { p.set_value(i); });
+      CHECK(f.get() == (i + 1) * 2);
+      t.join();
+    }
+    CHECK(mystl::make_ready_future(1).then(pool, [](int v) { return v; }).get() == 1);
+  }
+
+  {
+    promise<int> a;
+    promise<void> b;
+    promise<std::string> c;
+    auto all = mystl::when_all(a.get_future(), b.get_future(), c.get_future());
+    std::thread t1([&] { a.set_value(1); });
+    std::thread t2([&] { c.set_value("c"); });
+    b.set_value();
+    t1.join();
+    t2.join();
+    auto [x, y, z] = all.get();
+    (void)y;
+    CHECK(x == 1 && z == "c");
+
+    std::vector<future<int>> v;
+    std::vector<promise<int>> ps(10);
+    for (auto& p : ps) v.push_back(p.get_future());
+    auto av = mystl::when_all(std::move(v));
+    for (int i = 0; i < 10; ++i) {
+      if (i == 3) {
+        ps[i].set_exception(std::make_exception_ptr(std::logic_error("e")));
+      } else {
+        ps[i].set_value(i);
+      }
+    }
+    CHECK_THROWS(av.get(), std::logic_error);
+    CHECK(mystl::when_all(std::vector<future<int>>{}).get().empty());
+  }
+}
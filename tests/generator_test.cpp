@@ -0,0 +1,70 @@
+#include <mystl/generator.hpp>
+#include <mystl/short_alloc.hpp>
+
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+
+#include "check.hpp"
+
+namespace {
+
+mystl::generator<int> iota(int n) {
+  for (int i = 0; i < n; ++i) co_yield i;
+}
+
+mystl::generator<std::string> words() {
+  std::string a = "a";
+  co_yield a;
+  co_yield std::string("b");
+  const std::string c = "c";
+  co_yield c;
+}
+
+using arena_alloc = mystl::short_alloc<std::byte, 4096>;
+mystl::generator<int, arena_alloc> squares(std::allocator_arg_t, arena_alloc, int n) {
+  for (int i = 0; i < n; ++i) co_yield i * i;
+}
+
+mystl::generator<int> throws_after_one() {
+  co_yield 1;
+  throw std::logic_error("generator");
+}
+
+}  // namespace
+
+static_assert(std::ranges::input_range<mystl::generator<int>>);
+static_assert(std::ranges::view<mystl::generator<int>>);
+
+int main() {
+  int sum = 0;
+  for (int i : iota(10)) sum += i;
+  CHECK(sum == 45);
+
+  std::string joined;
+  for (const std::string& w : words()) joined += w;
+  CHECK(joined == "abc");
+
+  // The frame comes from the arena.
+  mystl::stack_arena<4096> arena;
+  {
+    auto g = squares(std::allocator_arg, arena, 5);
+    CHECK(arena.used() > 0);
+    sum = 0;
+    for (int i : g) sum += i;
+  }
+  CHECK(sum == 30 && arena.overflow_count() == 0);
+
+  int seen = 0;
+  CHECK_THROWS(
+      [&] {
+        for (int i : throws_after_one()) seen += i;
+      }(),
+      std::logic_error);
+  CHECK(seen == 1);
+
+  sum = 0;
+  for (int x : iota(10) | std::views::filter([](int x) { return x % 2 != 0; })) sum += x;
+  CHECK(sum == 25);
+}
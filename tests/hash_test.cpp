@@ -0,0 +1,48 @@
+#include <mystl/hash.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+
+enum class colour { red, green };
+
+static_assert(mystl::mix64(0) == 0);
+static_assert(mystl::mix64(1) != 1);
+static_assert(mystl::hash_bytes("abc") == mystl::hash_bytes(std::string_view("abc")));
+static_assert(mystl::hash_bytes("abc", 1) != mystl::hash_bytes("abc", 2));
+static_assert(mystl::seeded_hash<int>{}(5, 7) == mystl::seeded_hash<int>{}(5, 7));
+static_assert(mystl::seeded_hash<colour>{}(colour::red) !=
+              mystl::seeded_hash<colour>{}(colour::green));
+static_assert(mystl::fastrange64(~std::uint64_t{0}, 10) == 9);
+static_assert(mystl::fastrange64(0, 10) == 0);
+static_assert(mystl::detail::mul_wide(~std::uint64_t{0}, ~std::uint64_t{0}).hi ==
+              ~std::uint64_t{0} - 1);
+static_assert(mystl::detail::mul_wide(~std::uint64_t{0}, ~std::uint64_t{0}).lo == 1);
+static_assert(mystl::detail::mul_wide(std::uint64_t{1} << 40, std::uint64_t{1} << 30).hi == 64);
+
+int main() {
+  // Every length up to a few words, so the tail handling is covered.
+  std::set<std::uint64_t> seen;
+  std::string s;
+  for (int i = 0; i < 40; ++i) {
+    s.push_back(static_cast<char>('a' + i % 26));
+    CHECK(seen.insert(mystl::hash_bytes(s)).second);
+    CHECK(mystl::seeded_hash<std::string>{}(s) == mystl::hash_bytes(s));
+  }
+
+  // Flipping one input bit flips about half of the output bits.
+  int flipped = 0;
+  for (int bit = 0; bit < 64; ++bit) {
+    const std::uint64_t flip = std::uint64_t{1} << bit;
+    flipped += std::popcount(mystl::mix64(0x1234567) ^ mystl::mix64(0x1234567 ^ flip));
+  }
+  CHECK(flipped > 64 * 24 && flipped < 64 * 40);
+
+  std::uint64_t buckets[10] = {};
+  for (std::uint64_t i = 0; i < 100000; ++i) ++buckets[mystl::fastrange64(mystl::mix64(i + 1), 10)];
+  for (std::uint64_t b : buckets) CHECK(b > 9000 && b < 11000);
+}
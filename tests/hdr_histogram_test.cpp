@@ -0,0 +1,81 @@
+#include <mystl/hdr_histogram.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  // Buckets tile the value range and stay within the relative precision.
+  for (int d = 0; d <= 5; ++d) {
+    mystl::detail::hdr_layout layout(~std::uint64_t{0}, d);
+    double eps = 1.0;
+    for (int i = 0; i < d; ++i) eps /= 10;
+    std::mt19937_64 rng(d);
+    for (int i = 0; i < 20000; ++i) {
+      const std::uint64_t v = rng() >> (rng() % 64);
+      const std::size_t idx = layout.index_of(v);
+      const std::uint64_t lo = layout.lowest_equivalent(idx), hi = layout.highest_equivalent(idx);
+      CHECK(idx < layout.size());
+      CHECK(lo <= v && v <= hi);
+      CHECK(static_cast<double>(hi - lo) <= eps * static_cast<double>(v));
+      if (idx + 1 < layout.size()) CHECK(hi + 1 == layout.lowest_equivalent(idx + 1));
+    }
+  }
+
+  mystl::hdr_histogram h(3'600'000'000'000, 3);
+  std::vector<std::vector<std::uint64_t>> per(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937_64 rng(t);
+      std::lognormal_distribution<double> dist(10, 2);
+      for (int i = 0; i < 50000; ++i) {
+        const auto v = static_cast<std::uint64_t>(dist(rng));
+        per[t].push_back(v);
+        h.record(v);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  std::vector<std::uint64_t> all;
+  for (auto& p : per) all.insert(all.end(), p.begin(), p.end());
+  std::sort(all.begin(), all.end());
+
+  const mystl::hdr_snapshot s = h.snapshot();
+  CHECK(s.total_count() == all.size());
+  for (double p : {0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+    const auto rank =
+        std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(p / 100 * all.size())));
+    const std::uint64_t exact = all[rank - 1], got = s.value_at_percentile(p);
+    CHECK(got >= exact &&
+          static_cast<double>(got - exact) <= 1e-3 * static_cast<double>(exact) + 1);
+  }
+  CHECK(s.min() <= all.front() && s.max() >= all.back());
+
+  mystl::hdr_snapshot other(1000000, 2);
+  other.record(5);
+  other += s;
+  CHECK(other.total_count() == s.total_count() + 1);
+  mystl::hdr_snapshot twice = s;
+  twice += s;
+  CHECK(twice.total_count() == 2 * s.total_count());
+  CHECK(twice.value_at_percentile(50) == s.value_at_percentile(50));
+
+  h.add(s);
+  CHECK(h.snapshot().total_count() == 2 * all.size());
+  CHECK(h.snapshot_and_reset().total_count() == 2 * all.size());
+  CHECK(h.snapshot().empty());
+  h.record(~std::uint64_t{0});
+  CHECK(h.snapshot().max() == 3'600'000'000'000);
+
+  CHECK_THROWS(mystl::hdr_histogram(100, 6), std::invalid_argument);
+  CHECK_THROWS(mystl::hdr_histogram(0, 3), std::invalid_argument);
+  const mystl::hdr_snapshot empty;
+  CHECK(empty.value_at_percentile(50) == 0 && empty.min() == 0 && empty.mean() == 0);
+}
@@ -0,0 +1,62 @@
+#include <mystl/huge_page_allocator.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+#include "check.hpp"
+
+bool huge_aligned(const void* p) {
+  return reinterpret_cast<std::uintptr_t>(p) % mystl::huge_page_size == 0;
+}
+
+int main() {
+  // Large blocks start on a huge page boundary whether or not the kernel
+  // backs them with huge pages.
+  mystl::huge_vector<std::uint64_t> v(std::size_t{8} << 20 >> 3, 1);
+  CHECK(huge_aligned(v.data()));
+  for (int i = 0; i < 1000; ++i) v.push_back(static_cast<std::uint64_t>(i));
+  CHECK(v.back() == 999 && v.front() == 1);
+
+  // Explicit pages fall back to transparent ones when the pool is empty.
+  mystl::huge_vector<int, mystl::huge_page_mode::explicit_pages> w(3 << 20, 2);
+  CHECK(huge_aligned(w.data()) && w[(3 << 20) - 1] == 2);
+
+  for (std::size_t bytes :
+       {std::size_t{1}, std::size_t{4096}, mystl::huge_page_size, mystl::huge_page_size * 3 + 5}) {
+    void* p = mystl::huge_page_allocate(bytes, 64);
+    CHECK(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+    std::memset(p, 0xAB, bytes);
+    mystl::huge_page_deallocate(p, bytes, 64);
+  }
+
+  mystl::huge_vector<int> small(10, 3);
+  CHECK(small[9] == 3);
+  // Nodes are carved back to back out of huge-page slabs, and freed ones
+  // are handed out again.
+  struct node {
+    char bytes[48];
+  };
+  mystl::huge_node_allocator<node> na;
+  node* first = na.allocate(1);
+  node* second = na.allocate(1);
+  CHECK(second + 1 == first || first + 1 == second);
+  na.deallocate(first, 1);
+  CHECK(na.allocate(1) == first);
+  node* many = na.allocate(100000);
+  CHECK(huge_aligned(many));
+  na.deallocate(many, 100000);
+
+  // 200000 nodes of 16 bytes fill less than two slabs; from operator new
+  // they would spread over at least three 2 MiB regions.
+  mystl::huge_unordered_map<int, int> m;
+  for (int i = 0; i < 200000; ++i) m[i] = i;
+  CHECK(m.size() == 200000 && m.at(777) == 777);
+  std::set<std::uintptr_t> regions;
+  for (const auto& kv : m) {
+    regions.insert(reinterpret_cast<std::uintptr_t>(&kv) / mystl::huge_page_size);
+  }
+  CHECK(regions.size() <= 3);
+  CHECK(mystl::huge_page_allocator<int>() == mystl::huge_page_allocator<long>());
+  CHECK(mystl::huge_node_allocator<int>() == mystl::huge_node_allocator<long>());
+}
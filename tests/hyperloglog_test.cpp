@@ -0,0 +1,34 @@
+#include <mystl/hyperloglog.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "check.hpp"
+
+int main() {
+  for (unsigned p : {4u, 10u, 14u}) {
+    mystl::hyperloglog<std::uint64_t> h(p), odd(p), even(p);
+    const double se = 1.04 / std::sqrt(static_cast<double>(1u << p));
+    for (std::uint64_t n = 1, i = 0; n <= 500000; n *= 4) {
+      for (; i < n; ++i) {
+        h.insert(i);
+        (i & 1 ? odd : even).insert(i);
+      }
+      const double e = h.estimate();
+      CHECK(std::abs(e - static_cast<double>(n)) <= std::max(6 * se * static_cast<double>(n), 1.0));
+    }
+    odd.merge(even);
+    CHECK(std::abs(odd.estimate() - h.estimate()) <= 1e-9 * h.estimate());
+    if (p == 14) CHECK(h.dense());
+  }
+
+  // Sparse merges, including with itself.
+  mystl::hyperloglog<std::string> a(12), b(12);
+  for (int i = 0; i < 300; ++i) a.insert(std::to_string(i));
+  for (int i = 200; i < 3000; ++i) b.insert(std::to_string(i));
+  a.merge(a);
+  a.merge(b);
+  CHECK(std::abs(a.estimate() - 3000) < 3000 * 0.05);
+}
@@ -0,0 +1,93 @@
+#include <mystl/inplace_vector.hpp>
+
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "check.hpp"
+
+constexpr int edits() {
+  mystl::inplace_vector<int, 8> v{3, 1, 2};
+  v.push_back(5);
+  v.insert(v.begin(), 9);
+  v.erase(v.begin() + 1);
+  int sum = 0;
+  for (int x : v) sum += x;
+  return sum * 10 + static_cast<int>(v.size());
+}
+static_assert(edits() == (9 + 1 + 2 + 5) * 10 + 4);
+
+constexpr mystl::inplace_vector<int, 4> constant{1, 2};
+static_assert(constant.size() == 2 && constant[1] == 2);
+static_assert(std::is_trivially_copyable_v<mystl::inplace_vector<int, 4>>);
+static_assert(!std::is_trivially_copyable_v<mystl::inplace_vector<std::string, 4>>);
+static_assert(sizeof(mystl::inplace_vector<int, 0>) <= sizeof(std::size_t));
+
+struct counted {
+  static inline int live = 0;
+  static inline int fail_after = -1;  // constructions until one throws, or -1
+  int v;
+  counted() : v(0) {
+    if (fail_now()) throw std::runtime_error("default");
+    ++live;
+  }
+  explicit counted(int x) : v(x) { ++live; }
+  counted(const counted& o) : v(o.v) {
+    if (v < 0 || fail_now()) throw std::runtime_error("copy");
+    ++live;
+  }
+  ~counted() { --live; }
+
+  static bool fail_now() { return fail_after >= 0 && fail_after-- == 0; }
+};
+
+int main() {
+  mystl::inplace_vector<std::string, 4> v;
+  v.push_back("a");
+  v.emplace_back(3, 'b');
+  v.insert(v.begin(), "z");
+  CHECK(v.size() == 3 && v[0] == "z" && v[2] == "bbb");
+  auto copy = v;
+  CHECK(copy == v);
+  v.emplace_back("q");
+  CHECK_THROWS(v.push_back("x"), std::bad_alloc);
+  CHECK(v.try_push_back("x") == nullptr);
+  CHECK_THROWS(v.at(4), std::out_of_range);
+
+  mystl::inplace_vector<std::string, 4> u{"1"};
+  u.swap(v);
+  CHECK(u.size() == 4 && v.size() == 1 && v[0] == "1");
+  CHECK(erase_if(u, [](const std::string& s) { return s == "a"; }) == 1);
+  CHECK(u.size() == 3);
+  u.resize(1);
+  CHECK(u.size() == 1 && u[0] == "z");
+
+  {
+    mystl::inplace_vector<counted, 4> c;
+    c.emplace_back(1);
+    c.emplace_back(-1);
+    CHECK_THROWS((mystl::inplace_vector<counted, 4>(c)), std::runtime_error);
+    CHECK(counted::live == 2);
+  }
+  CHECK(counted::live == 0);
+
+  // A constructor that throws part-way destroys the elements it built.
+  {
+    counted::fail_after = 2;
+    CHECK_THROWS((mystl::inplace_vector<counted, 4>(3)), std::runtime_error);
+    CHECK(counted::live == 0);
+    const counted src[] = {counted(1), counted(2), counted(-1)};
+    counted::fail_after = 2;
+    CHECK_THROWS((mystl::inplace_vector<counted, 4>(3, src[0])), std::runtime_error);
+    CHECK(counted::live == 3);
+    CHECK_THROWS((mystl::inplace_vector<counted, 4>(src, src + 3)), std::runtime_error);
+    CHECK(counted::live == 3);
+  }
+  CHECK(counted::live == 0);
+
+  // Trivial element types are not initialised up front.
+  mystl::inplace_vector<int, 1 << 16> large;
+  large.push_back(7);
+  CHECK(large.size() == 1 && large.back() == 7);
+}
@@ -0,0 +1,145 @@
+#include <mystl/lru_cache.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+// Reference LRU built from the standard containers.
+struct reference_lru {
+  std::size_t capacity;
+  std::list<std::pair<int, int>> order;
+  std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index;
+
+  int* find(int k) {
+    auto it = index.find(k);
+    if (it == index.end()) return nullptr;
+    order.splice(order.begin(), order, it->second);
+    return &it->second->second;
+  }
+  void put(int k, int v) {
+    if (int* p = find(k)) {
+      *p = v;
+      return;
+    }
+    if (order.size() == capacity) {
+      index.erase(order.back().first);
+      order.pop_back();
+    }
+    order.emplace_front(k, v);
+    index[k] = order.begin();
+  }
+  bool erase(int k) {
+    auto it = index.find(k);
+    if (it == index.end()) return false;
+    order.erase(it->second);
+    index.erase(it);
+    return true;
+  }
+};
+
+struct throwing {
+  int v;
+  explicit throwing(int x) : v(x) {
+    if (x < 0) throw std::runtime_error("negative");
+  }
+};
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(3);
+  for (std::size_t cap : {1u, 2u, 7u, 100u}) {
+    mystl::lru_cache<int, int> c(cap);
+    reference_lru r{cap, {}, {}};
+    for (int i = 0; i < 50000; ++i) {
+      const int k = static_cast<int>(rng() % (cap * 3 + 2));
+      const int op = static_cast<int>(rng() % 10);
+      if (op < 5) {
+        int* a = c.find(k);
+        int* b = r.find(k);
+        CHECK(!a == !b && (!a || *a == *b));
+      } else if (op < 9) {
+        c.insert_or_assign(k, i);
+        r.put(k, i);
+      } else {
+        CHECK(c.erase(k) == r.erase(k));
+      }
+      CHECK(c.size() == r.order.size());
+    }
+    auto it = r.order.begin();
+    c.for_each([&](int k, int v) {
+      CHECK(it->first == k && it->second == v);
+      ++it;
+    });
+  }
+
+  {
+    mystl::lru_cache<std::string, std::string> s(2);
+    s.insert_or_assign("a", "1");
+    s.insert_or_assign(std::string("b"), "2");
+    CHECK(s.find("a"));
+    s.try_emplace("c", 3, 'x');
+    CHECK(!s.contains("b") && *s.peek("c") == "xxx");
+    CHECK(s.stats().hits == 1 && s.stats().evictions == 1);
+    auto moved = std::move(s);
+    CHECK(moved.size() == 2);
+    mystl::lru_cache<std::string, std::string> t(5);
+    t.insert_or_assign("z", "q");
+    t = std::move(moved);
+    CHECK(t.size() == 2 && t.contains("a"));
+  }
+
+  // A throwing constructor leaves a full cache as it was.
+  {
+    mystl::lru_cache<int, throwing> c(3);
+    for (int i = 0; i < 3; ++i) c.try_emplace(i, i);
+    CHECK_THROWS(c.try_emplace(9, -1), std::runtime_error);
+    CHECK(c.size() == 3 && c.contains(0) && c.contains(1) && c.contains(2) && !c.contains(9));
+    c.try_emplace(3, 3);
+    CHECK(c.size() == 3 && !c.contains(0) && c.stats().evictions == 1 && c.capacity() == 3);
+  }
+  CHECK_THROWS((mystl::lru_cache<int, int>(0)), std::invalid_argument);
+  CHECK_THROWS((mystl::lru_cache<int, int>(SIZE_MAX)), std::length_error);
+  CHECK_THROWS((mystl::lru_cache<int, int>(std::size_t{UINT32_MAX} + 1)), std::length_error);
+  CHECK_THROWS((mystl::lru_cache<int, int>(UINT32_MAX - 2)), std::length_error);
+  CHECK_THROWS((mystl::tinylfu_cache<int, int>(SIZE_MAX)), std::length_error);
+
+  // Scans through a Zipf workload: TinyLFU admission keeps the hot keys.
+  {
+    const std::size_t cap = 1000;
+    mystl::lru_cache<std::uint64_t, int> l(cap);
+    mystl::tinylfu_cache<std::uint64_t, int> t(cap);
+    std::vector<double> w(100000);
+    for (std::size_t i = 0; i < w.size(); ++i) {
+      w[i] = 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+    }
+    std::discrete_distribution<std::uint64_t> zipf(w.begin(), w.end());
+    std::uint64_t scan = 1'000'000;
+    for (int i = 0; i < 300000; ++i) {
+      const std::uint64_t k = (i % 10000 < 2000) ? scan++ : zipf(rng);
+      if (!l.find(k)) l.insert_or_assign(k, 1);
+      if (!t.find(k)) t.insert_or_assign(k, 1);
+      CHECK(t.size() <= cap);
+    }
+    CHECK(t.stats().hit_ratio() > l.stats().hit_ratio());
+    std::size_t n = 0;
+    t.for_each([&](std::uint64_t, int) { ++n; });
+    CHECK(n == t.size());
+
+    mystl::tinylfu_cache<int, int> one(1);
+    one.insert_or_assign(1, 1);
+    one.insert_or_assign(2, 2);
+    CHECK(one.size() == 1);
+  }
+}
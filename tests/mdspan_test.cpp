@@ -0,0 +1,85 @@
+#include <mystl/mdspan.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "check.hpp"
+
+using mystl::dims;
+using mystl::extents;
+using mystl::mdspan;
+
+constexpr extents<int, 3, mystl::dynamic_extent> mixed(5);
+static_assert(mixed.extent(0) == 3 && mixed.extent(1) == 5);
+static_assert(sizeof(mdspan<int, extents<int, 3, 4>>) == sizeof(int*));
+
+int main() {
+  std::vector<int> v(12);
+  for (int i = 0; i < 12; ++i) v[i] = i;
+
+  mdspan m(v.data(), 3, 4);
+  static_assert(decltype(m)::rank() == 2);
+  CHECK(m(1, 2) == 6 && m.size() == 12 && m.stride(0) == 4);
+  CHECK((m[std::array<int, 2>{2, 3}] == 11));
+
+  mdspan<int, extents<int, 3, 4>, mystl::layout_left> left(v.data());
+  CHECK(left(1, 2) == 7);
+
+  using strided = mystl::layout_stride::mapping<dims<2>>;
+  mdspan<int, dims<2>, mystl::layout_stride> s(v.data(),
+                                                strided(dims<2>(3, 4), std::array<int, 2>{1, 3}));
+  CHECK(s(1, 2) == 7 && s.mapping().is_exhaustive());
+  const strided from_right(m.mapping());
+  CHECK(from_right.stride(0) == 4 && from_right == m.mapping());
+
+  // Tiles are padded to whole tiles and never overlap.
+  std::vector<double> t(64);
+  mdspan<double, dims<2>, mystl::layout_tiled<4, 4>> tiled(t.data(), 5, 6);
+  CHECK(tiled.mapping().required_span_size() == 2 * 2 * 16);
+  std::vector<int> seen(64);
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 6; ++j) ++seen[tiled.mapping()(i, j)];
+  }
+  for (int x : seen) CHECK(x <= 1);
+  // Static extents need no constructor argument.
+  const mdspan<double, extents<int, 8, 8>, mystl::layout_tiled<4, 4>> static_tiled;
+  CHECK(static_tiled.mapping().tiles_per_row() == 2);
+  CHECK(static_tiled.mapping().required_span_size() == 64 && static_tiled.mapping()(4, 0) == 32);
+  bool tiled_threw = false;
+  try {
+    (void)mystl::layout_tiled<4, 4>::mapping<dims<2, int>>(dims<2, int>(50000, 50000));
+  } catch (const std::length_error&) {
+    tiled_threw = true;
+  }
+  CHECK(tiled_threw);
+
+  mdspan<double, dims<2>, mystl::layout_morton> morton(t.data(), 4, 4);
+  CHECK(morton.mapping()(1, 1) == 3 && morton.mapping()(2, 0) == 8);
+  CHECK(morton.mapping().required_span_size() == 16 && morton.mapping().is_exhaustive());
+  // Other shapes are padded to a power-of-two square.
+  using morton_map = mystl::layout_morton::mapping<dims<2>>;
+  const morton_map tall(dims<2>(1000, 1));
+  CHECK(tall.padded_extent() == 1024 && tall.required_span_size() == 1024 * 1024);
+  CHECK(tall(999, 0) < tall.required_span_size() && !tall.is_exhaustive());
+  const morton_map odd(dims<2>(3, 5));
+  CHECK(odd.required_span_size() == 64 && odd(2, 4) < 64);
+  bool threw = false;
+  try {
+    (void)mystl::layout_morton::mapping<dims<2, int>>(dims<2, int>(50000, 1));
+  } catch (const std::length_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  alignas(64) float a[16]{};
+  using square = extents<int, 4, 4>;
+  mdspan<float, square, mystl::layout_right, mystl::aligned_accessor<float, 64>> aligned(a);
+  aligned(1, 1) = 2;
+  CHECK(a[5] == 2);
+  mdspan<float, square, mystl::layout_right, mystl::restrict_accessor<float>> restricted(a);
+  restricted(0, 1) = 3;
+  CHECK(a[1] == 3);
+  const mdspan<float, extents<int, 4, 4>> plain(aligned);
+  CHECK(plain(1, 1) == 2);
+}
@@ -0,0 +1,84 @@
+#include <mystl/mphf.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+template <class Key>
+void check_bijective(const mystl::mphf<Key>& f, const std::vector<Key>& keys) {
+  std::vector<char> seen(keys.size());
+  for (const Key& k : keys) {
+    const std::uint64_t v = f(k);
+    CHECK(v < keys.size());
+    CHECK(!seen[v]);
+    seen[v] = 1;
+  }
+}
+
+int main() {
+  std::vector<std::uint64_t> keys(200000);
+  std::mt19937_64 rng(7);
+  for (auto& k : keys) k = rng();
+  // Small partitions so that the build splits the keys across dozens of
+  // partitions and all four threads.
+  mystl::mphf_config cfg;
+  cfg.partition_size = 5000;
+  cfg.threads = 4;
+  mystl::mphf<std::uint64_t> f(keys, cfg);
+  check_bijective(f, keys);
+  CHECK(f.bits_per_key() < 5.0);
+
+  const auto blob = f.to_bytes();
+  std::uint64_t parts = 0;
+  std::memcpy(&parts, blob.data() + 24, sizeof parts);
+  CHECK(parts == 40);
+  const auto copy = mystl::mphf<std::uint64_t>::from_bytes(blob);
+  std::stringstream ss;
+  f.save(ss);
+  const auto loaded = mystl::mphf<std::uint64_t>::load(ss);
+  for (std::size_t i = 0; i < keys.size(); i += 97) {
+    CHECK(copy(keys[i]) == f(keys[i]) && loaded(keys[i]) == f(keys[i]));
+  }
+
+  // Truncated and corrupt blobs are rejected. The first partition follows
+  // the 48-byte header; its pilot_bitpos is at byte 24 of it.
+  using blob_mphf = mystl::mphf<std::uint64_t>;
+  CHECK_THROWS(blob_mphf::from_bytes(std::span(blob).first(blob.size() - 8)),
+               std::invalid_argument);
+  auto bad = blob;
+  bad[48 + 24 + 7] = std::byte{0x40};
+  CHECK_THROWS(blob_mphf::from_bytes(bad), std::invalid_argument);
+  bad = blob;
+  bad[24] = std::byte{0xff};  // partition count
+  CHECK_THROWS(blob_mphf::from_bytes(bad), std::invalid_argument);
+  bad = blob;
+  bad[8] = static_cast<std::byte>(static_cast<unsigned>(bad[8]) + 1);  // key count
+  CHECK_THROWS(blob_mphf::from_bytes(bad), std::invalid_argument);
+
+  std::vector<std::string> urls;
+  for (int i = 0; i < 5000; ++i) urls.push_back("https://example.com/" + std::to_string(i));
+  check_bijective(mystl::mphf<std::string>(urls), urls);
+
+  const std::vector<int> duplicate{1, 2, 3, 2};
+  CHECK_THROWS(mystl::mphf<int>(duplicate), std::invalid_argument);
+  const std::vector<int> none;
+  const mystl::mphf<int> empty(none);
+  (void)empty(5);
+  const std::vector<int> one{42};
+  CHECK(mystl::mphf<int>(one)(42) == 0);
+
+  // Few enough buckets that there is only one.
+  mystl::mphf_config sparse;
+  sparse.c = 0.01;
+  const std::vector<int> three{1, 2, 3};
+  const mystl::mphf<int> single(three, sparse);
+  check_bijective(single, three);
+  CHECK(mystl::mphf<int>::from_bytes(single.to_bytes())(2) == single(2));
+}
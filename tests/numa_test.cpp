@@ -0,0 +1,56 @@
+#include <mystl/numa.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "check.hpp"
+
+struct thrower {
+  static inline std::atomic<int> constructed{0};
+  static inline std::atomic<int> live{0};
+  int pad[3];
+  thrower() {
+    if (++constructed == 300000) throw std::runtime_error("construct");
+    ++live;
+  }
+  ~thrower() { --live; }
+};
+
+int main() {
+  CHECK(mystl::detail::parse_node_list("0-1,3") == 0b1011);
+  CHECK(mystl::detail::parse_node_list("0\n") == 1);
+  CHECK(mystl::numa_node_count() >= 1);
+  CHECK((mystl::numa_online_nodes() & 1) != 0);
+
+  auto interleaved = mystl::numa_memory_resource::interleaved();
+  auto local = mystl::numa_memory_resource::on_node(0);
+  CHECK(local.nodes() == 1 && local.policy() == mystl::numa_policy::node_local);
+  CHECK(mystl::numa_memory_resource::on_node(63).nodes() == std::uint64_t{1} << 63);
+  CHECK_THROWS(mystl::numa_memory_resource::on_node(64), std::invalid_argument);
+  {
+    std::pmr::vector<double> a(1 << 18, 1.0, &interleaved);
+    std::pmr::vector<double> b(1 << 18, 2.0, &local);
+    CHECK(a.back() + b.back() == 3.0);
+    void* big = local.allocate(100, 1 << 21);
+    CHECK(reinterpret_cast<std::uintptr_t>(big) % (1 << 21) == 0);
+    local.deallocate(big, 100, 1 << 21);
+    CHECK(interleaved.is_equal(local));
+  }
+
+  const std::size_t n = 4'000'000;
+  auto* values = static_cast<std::uint64_t*>(::operator new(n * sizeof(std::uint64_t)));
+  mystl::parallel_uninitialized_value_construct(values, values + n, 4);
+  for (std::size_t i = 0; i < n; i += 4097) CHECK(values[i] == 0);
+  ::operator delete(values);
+
+  // A throwing constructor on one worker destroys what every worker built.
+  auto* objects = static_cast<thrower*>(::operator new(n / 4 * sizeof(thrower)));
+  CHECK_THROWS(mystl::parallel_uninitialized_value_construct(objects, objects + n / 4, 4),
+               std::runtime_error);
+  CHECK(thrower::live == 0);
+  ::operator delete(objects);
+}
@@ -0,0 +1,54 @@
+#include <mystl/object_pool.hpp>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "check.hpp"
+
+struct message {
+  long a, b, c;
+  explicit message(long x) : a(x), b(x + 1), c(x + 2) {}
+};
+
+struct alignas(64) wide {
+  char d[100];
+};
+
+struct throws_on_negative {
+  int v;
+  explicit throws_on_negative(int x) : v(x) {
+    if (x < 0) throw 1;
+  }
+};
+
+int main() {
+  mystl::object_pool<message> pool;
+  std::vector<message*> live;
+  for (int i = 0; i < 100000; ++i) live.push_back(pool.create(i));
+  for (int i = 0; i < 100000; ++i) CHECK(live[static_cast<std::size_t>(i)]->b == i + 1);
+  for (message* p : live) pool.destroy(p);
+  {
+    auto u = pool.make_unique(5);
+    CHECK(u->c == 7);
+  }
+
+  mystl::object_pool<wide> wide_pool;
+  wide* w = wide_pool.create();
+  CHECK(reinterpret_cast<std::uintptr_t>(w) % 64 == 0);
+  wide_pool.destroy(w);
+
+  mystl::object_pool<throws_on_negative> throwing;
+  CHECK_THROWS(throwing.create(-1), int);
+  throwing.destroy(throwing.create(1));
+
+  std::list<int, mystl::pool_allocator<int>> l;
+  for (int i = 0; i < 1000; ++i) l.push_back(i);
+  CHECK(l.size() == 1000 && l.back() == 999);
+  std::map<int, int, std::less<int>, mystl::pool_allocator<std::pair<const int, int>>> m;
+  for (int i = 0; i < 1000; ++i) m[i] = i;
+  CHECK(m.size() == 1000 && m.at(500) == 500);
+  std::vector<int, mystl::pool_allocator<int>> arrays(100, 1);  // arrays bypass the pool
+  CHECK(arrays.size() == 100);
+}
@@ -0,0 +1,56 @@
+#include <mystl/perfect_hash_map.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+
+enum class tok { kw_if, kw_else, kw_while, kw_for, kw_return, kw_int };
+
+constexpr auto keywords = mystl::make_perfect_hash_map<std::string_view, tok>(
+    {{"if", tok::kw_if},
+     {"else", tok::kw_else},
+     {"while", tok::kw_while},
+     {"for", tok::kw_for},
+     {"return", tok::kw_return},
+     {"int", tok::kw_int}});
+static_assert(keywords.at("else") == tok::kw_else && keywords.at("int") == tok::kw_int);
+static_assert(!keywords.contains("foo") && !keywords.contains("els"));
+
+constexpr auto ints = mystl::make_perfect_hash_set<int>({5, 17, 99, -3, 1000000, 42, 7});
+static_assert(ints.contains(99) && ints.contains(-3) && !ints.contains(98));
+
+constexpr auto big = [] {
+  std::array<int, 300> a{};
+  for (int i = 0; i < 300; ++i) a[static_cast<std::size_t>(i)] = i * 7919;
+  return mystl::perfect_hash_set<int, 300>(a);
+}();
+static_assert(big.contains(7919 * 299) && !big.contains(1));
+
+constexpr mystl::perfect_hash_set<int, 0> empty_set(std::array<int, 0>{});
+static_assert(!empty_set.contains(1));
+
+constexpr int batch() {
+  std::string_view q[] = {"for", "x", "if"};
+  const std::pair<std::string_view, tok>* out[3]{};
+  const auto found = keywords.find_batch(q, out);
+  return static_cast<int>(found) * 100 + (out[0]->second == tok::kw_for) * 10 +
+         (out[1] == keywords.end());
+}
+static_assert(batch() == 211);
+
+int main() {
+  CHECK(keywords.at("while") == tok::kw_while);
+  const std::string runtime_key = "return";
+  CHECK(keywords.contains(runtime_key));
+  CHECK(keywords.find("goto") == keywords.end());
+  int count = 0;
+  for (const auto& [key, value] : keywords) {
+    CHECK(keywords.at(key) == value);
+    ++count;
+  }
+  CHECK(count == 6);
+  CHECK_THROWS(keywords.at("goto"), std::out_of_range);
+}
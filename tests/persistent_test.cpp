@@ -0,0 +1,207 @@
+#include <mystl/persistent.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+using string_vector = mystl::persistent_vector<std::string>;
+using string_map = mystl::persistent_map<std::string, int>;
+
+void check_equal(const string_vector& v, const std::vector<std::string>& r) {
+  CHECK(v.size() == r.size());
+  for (std::size_t i = 0; i < r.size(); ++i) CHECK(v[i] == r[i]);
+  CHECK(std::equal(v.begin(), v.end(), r.begin(), r.end()));
+}
+
+// Every key lands in one of three hash buckets.
+struct colliding_hash {
+  std::uint64_t operator()(int k) const noexcept { return static_cast<std::uint64_t>(k % 3); }
+};
+
+}  // namespace
+
+int main() {
+  std::mt19937_64 rng(3);
+  auto rnd = [&](std::size_t n) { return n ? static_cast<std::size_t>(rng() % n) : 0; };
+  int counter = 0;
+  auto value = [&] { return "s" + std::to_string(counter++) + std::string(rng() % 20, 'x'); };
+
+  // Edits applied to random earlier versions, checked against std::vector
+  // copies; every kept version must stay as it was.
+  std::vector<std::pair<string_vector, std::vector<std::string>>> history{{string_vector{}, {}}};
+  for (int it = 0; it < 3000; ++it) {
+    const auto& [v, r] = history[rnd(history.size())];
+    string_vector nv;
+    std::vector<std::string> nr = r;
+    const int op = static_cast<int>(rng() % 9);
+    if (op < 3) {
+      const std::size_t k = 1 + rnd(it % 50 == 0 ? 3000 : 40);
+      nv = v;
+      auto t = nv.transient();
+      for (std::size_t i = 0; i < k; ++i) {
+        auto s = value();
+        if (rng() & 1) {
+          nv = t.persistent().push_back(s);
+          t = nv.transient();
+        } else {
+          t.push_back(s);
+        }
+        nr.push_back(s);
+      }
+      nv = t.persistent();
+    } else if (op < 4 && !r.empty()) {
+      const auto i = rnd(r.size());
+      auto s = value();
+      nv = v.set(i, s);
+      nr[i] = s;
+    } else if (op < 5 && !r.empty()) {
+      auto t = v.transient();
+      const std::size_t k = 1 + rnd(std::min<std::size_t>(r.size(), 100));
+      for (std::size_t j = 0; j < k; ++j) {
+        t.pop_back();
+        nr.pop_back();
+        if (!nr.empty() && (j & 3) == 0) {
+          const auto i = rnd(nr.size());
+          auto s = value();
+          t.set(i, s);
+          nr[i] = s;
+        }
+      }
+      nv = t.persistent();
+    } else if (op < 6) {
+      const auto n = rnd(r.size() + 1);
+      nv = v.take(n);
+      nr.resize(n);
+    } else if (op < 7) {
+      const auto n = rnd(r.size() + 1);
+      nv = v.drop(n);
+      nr.erase(nr.begin(), nr.begin() + static_cast<std::ptrdiff_t>(n));
+    } else {
+      const auto& [w, q] = history[rnd(history.size())];
+      if (r.size() + q.size() > 100000) continue;
+      nv = v + w;
+      nr.insert(nr.end(), q.begin(), q.end());
+    }
+    check_equal(nv, nr);
+    if (history.size() < 64) {
+      history.emplace_back(nv, nr);
+    } else {
+      history[rnd(history.size())] = {nv, nr};
+    }
+  }
+  for (const auto& [v, r] : history) check_equal(v, r);
+
+  // Many small concatenations leave a relaxed tree that still indexes right.
+  {
+    mystl::persistent_vector<int> v;
+    std::vector<int> r;
+    for (int i = 0; i < 5000; ++i) {
+      mystl::persistent_vector<int> w;
+      const int k = static_cast<int>(rng() % 40);
+      for (int j = 0; j < k; ++j) {
+        w = w.push_back(i);
+        r.push_back(i);
+      }
+      v = (rng() & 1) ? v + w : v + w.drop(0);
+    }
+    CHECK(v.size() == r.size());
+    for (std::size_t i = 0; i < r.size(); ++i) CHECK(v[i] == r[i]);
+  }
+
+  std::vector<std::pair<string_map, std::map<std::string, int>>> maps{{string_map{}, {}}};
+  for (int it = 0; it < 5000; ++it) {
+    auto [m, r] = maps[rnd(maps.size())];
+    const int op = static_cast<int>(rng() % 6);
+    auto key = [&] { return "k" + std::to_string(rnd(3000)); };
+    if (op < 2) {
+      const auto k = key();
+      const int v = static_cast<int>(rng());
+      m = m.set(k, v);
+      r[k] = v;
+    } else if (op < 3) {
+      const auto k = key();
+      m = m.erase(k);
+      r.erase(k);
+    } else {
+      auto t = m.transient();
+      for (int j = 0; j < 50; ++j) {
+        const auto k = key();
+        if (rng() % 3) {
+          const int v = static_cast<int>(rng());
+          CHECK(t.set(k, v) == !r.count(k));
+          r[k] = v;
+        } else {
+          CHECK(t.erase(k) == (r.erase(k) == 1));
+        }
+      }
+      m = t.persistent();
+    }
+    CHECK(m.size() == r.size());
+    if (maps.size() < 32) {
+      maps.emplace_back(m, r);
+    } else {
+      maps[rnd(maps.size())] = {m, r};
+    }
+  }
+  for (const auto& [m, r] : maps) {
+    std::size_t n = 0;
+    for (const auto& [k, v] : m) {
+      CHECK(r.at(k) == v);
+      ++n;
+    }
+    CHECK(n == r.size());
+    for (const auto& [k, v] : r) CHECK(m.at(k) == v);
+  }
+
+  {
+    mystl::persistent_map<int, int, colliding_hash> c;
+    std::map<int, int> r;
+    for (int i = 0; i < 3000; ++i) {
+      const int k = static_cast<int>(rnd(300));
+      if (rng() % 3) {
+        c = c.set(k, i);
+        r[k] = i;
+      } else {
+        c = c.erase(k);
+        r.erase(k);
+      }
+      CHECK(c.size() == r.size());
+    }
+    for (int k = 0; k < 300; ++k) {
+      CHECK((c.find(k) != nullptr) == (r.count(k) == 1));
+      if (r.count(k)) CHECK(*c.find(k) == r[k]);
+    }
+    for (const auto& [k, v] : r) c = c.erase(k);
+    CHECK(c.empty() && c.begin() == c.end());
+  }
+
+  // Versions are safe to read from another thread while the original
+  // handle is dropped.
+  {
+    auto t = mystl::persistent_map<std::uint64_t, int>().transient();
+    for (int i = 0; i < 100000; ++i) t.set(static_cast<std::uint64_t>(i) * 7, i);
+    auto m = t.persistent();
+    std::thread reader([m] {
+      long sum = 0;
+      for (const auto& kv : m) sum += kv.second;
+      CHECK(sum == 100000L * 99999 / 2);
+    });
+    m = decltype(m)();
+    reader.join();
+  }
+
+  const mystl::persistent_vector<int> il{1, 2, 3};
+  const string_map im{{"a", 1}, {"b", 2}};
+  CHECK(il.back() == 3 && im.at("b") == 2 && im.count("c") == 0);
+  CHECK_THROWS(il.at(3), std::out_of_range);
+}
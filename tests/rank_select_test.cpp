@@ -0,0 +1,170 @@
+#include <mystl/rank_select.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+std::mt19937_64 rng(11);
+
+void check_bitvector(std::uint64_t n, double density) {
+  std::vector<bool> bits(n);
+  std::bernoulli_distribution d(density);
+  for (std::uint64_t i = 0; i < n; ++i) bits[i] = d(rng);
+  if (n > 200000 && rng() % 2) {
+    for (std::uint64_t i = n / 3; i < n / 3 + 150000; ++i) bits[i] = false;
+  }
+  const mystl::rank_select_bitvector bv(bits);
+  std::vector<std::uint64_t> one, zero;
+  for (std::uint64_t i = 0; i < n; ++i) (bits[i] ? one : zero).push_back(i);
+  CHECK(bv.size() == n && bv.ones() == one.size() && bv.zeros() == zero.size());
+
+  std::uint64_t r = 0;
+  for (std::uint64_t i = 0; i <= n; ++i) {
+    if (i % 7 == 0 || i == n) CHECK(bv.rank1(i) == r);
+    if (i < n) {
+      CHECK(bv[i] == bits[i]);
+      r += bits[i];
+    }
+  }
+  for (std::uint64_t k = 0; k < one.size(); ++k) CHECK(bv.select1(k) == one[k]);
+  for (std::uint64_t k = 0; k < zero.size(); ++k) CHECK(bv.select0(k) == zero[k]);
+  for (int t = 0; t < 1000 && n; ++t) {
+    const std::uint64_t i = rng() % (n + 2);
+    const auto it = std::lower_bound(one.begin(), one.end(), i);
+    CHECK(bv.next_one(i) == (it == one.end() ? n : *it));
+  }
+
+  const auto blob = bv.to_bytes();
+  const auto copy = mystl::rank_select_bitvector::from_bytes(blob);
+  std::vector<std::uint64_t> aligned(blob.size() / 8);
+  std::memcpy(aligned.data(), blob.data(), blob.size());
+  auto view = mystl::rank_select_bitvector::view(std::as_bytes(std::span(aligned)));
+  auto view_copy = view;
+  const auto moved = std::move(view_copy);
+  for (int t = 0; t < 100 && !one.empty(); ++t) {
+    const auto k = rng() % one.size();
+    CHECK(copy.select1(k) == one[k] && view.select1(k) == one[k] && moved.select1(k) == one[k]);
+  }
+  CHECK(view_copy.size() == 0 && view_copy.rank1(0) == 0);
+}
+
+void check_elias_fano(std::vector<std::uint64_t> vals) {
+  std::sort(vals.begin(), vals.end());
+  const mystl::elias_fano ef(vals);
+  CHECK(ef.size() == vals.size());
+  for (std::size_t i = 0; i < vals.size(); ++i) CHECK(ef[i] == vals[i]);
+  mystl::elias_fano::cursor c(ef);
+  for (std::size_t i = 0; i < vals.size(); ++i, c.next()) {
+    CHECK(!c.done() && c.value() == vals[i] && c.index() == i);
+  }
+  CHECK(c.done());
+
+  const std::uint64_t limit = vals.empty() ? 10 : vals.back() + 10;
+  for (int t = 0; t < 3000; ++t) {
+    std::uint64_t x =
+        t % 3 == 0 && !vals.empty() ? vals[rng() % vals.size()] : (limit ? rng() % limit : 0);
+    if (t == 0) x = 0;
+    if (t == 1) x = ~std::uint64_t{0};
+    const auto it = std::lower_bound(vals.begin(), vals.end(), x);
+    const auto [i, v] = ef.next_geq(x);
+    CHECK(i == static_cast<std::size_t>(it - vals.begin()));
+    if (it != vals.end()) CHECK(v == *it);
+  }
+
+  // A skipping cursor, as used to intersect posting lists.
+  mystl::elias_fano::cursor skip(ef);
+  std::uint64_t x = 0;
+  for (int guard = 0; !skip.done() && guard < 100000; ++guard) {
+    x += rng() % (limit / 50 + 2);
+    skip.next_geq(x);
+    const auto it = std::lower_bound(vals.begin(), vals.end(), x);
+    CHECK(skip.index() == static_cast<std::size_t>(it - vals.begin()));
+    if (!skip.done()) CHECK(skip.value() == *it);
+  }
+
+  std::vector<std::uint64_t> file;
+  ef.append(file);
+  ef.append(file);
+  std::span<const std::uint64_t> in(file);
+  const auto a = mystl::elias_fano::view_front(in);
+  const auto b = mystl::elias_fano::view_front(in);
+  CHECK(in.empty());
+  const auto b_copy = b;
+  for (std::size_t i = 0; i < vals.size(); i += 1 + vals.size() / 100) {
+    CHECK(a[i] == vals[i] && b_copy[i] == vals[i]);
+  }
+  CHECK(mystl::elias_fano::from_bytes(ef.to_bytes()).size() == vals.size());
+}
+
+}  // namespace
+
+int main() {
+  for (std::uint64_t n : {0, 1, 63, 64, 65, 511, 512, 513, 4096, 65535, 65536, 65537, 200000}) {
+    for (double d : {0.0, 0.01, 0.5, 0.99, 1.0}) check_bitvector(n, d);
+  }
+  check_bitvector(1'500'000, 0.3);
+  check_bitvector(1'500'000, 0.001);
+  // One sample range spans more than select_sparse_bits, so its positions
+  // are stored explicitly.
+  for (double d : {0.0002, 0.9995}) check_bitvector(5'000'000, d);
+
+  // Samples pointing past the blocks or the explicit positions are
+  // rejected. The ones' samples follow the header, words and counts.
+  {
+    const auto sample_at = [](std::uint64_t size) {
+      return 6 + (size + 63) / 64 + size / 65536 + 1 + (size / 512 + 1 + 3) / 4;
+    };
+    std::vector<std::uint64_t> words((20000 + 63) / 64, 0x5555555555555555ull);
+    std::vector<std::uint64_t> blob;
+    mystl::rank_select_bitvector::append(blob, words, 20000);
+    const std::vector<std::uint64_t> good = blob;
+    blob[sample_at(20000)] = 20000 / 512 + 1;
+    std::span<const std::uint64_t> in(blob);
+    CHECK_THROWS(mystl::rank_select_bitvector::view_front(in), std::invalid_argument);
+
+    // So are block samples that go backwards, and bits that disagree with
+    // the count of ones.
+    blob = good;
+    std::swap(blob[sample_at(20000)], blob[sample_at(20000) + 1]);
+    in = blob;
+    CHECK_THROWS(mystl::rank_select_bitvector::view_front(in), std::invalid_argument);
+    blob = good;
+    blob[6 + (20000 + 63) / 64 - 1] ^= 2;
+    in = blob;
+    CHECK_THROWS(mystl::rank_select_bitvector::view_front(in), std::invalid_argument);
+
+    const std::uint64_t size = 4'200'001;
+    std::vector<std::uint64_t> sparse((size + 63) / 64);
+    sparse[0] = 1;
+    sparse[(size - 1) / 64] |= std::uint64_t{1} << ((size - 1) % 64);
+    blob.clear();
+    mystl::rank_select_bitvector::append(blob, sparse, size);
+    CHECK(blob[sample_at(size)] == std::uint64_t{1} << 63);
+    in = blob;
+    CHECK(mystl::rank_select_bitvector::view_front(in).select1(1) == size - 1);
+    blob[sample_at(size)] |= 1;
+    in = blob;
+    CHECK_THROWS(mystl::rank_select_bitvector::view_front(in), std::invalid_argument);
+  }
+
+  check_elias_fano({});
+  check_elias_fano({0});
+  check_elias_fano({5, 5, 5});
+  check_elias_fano({~std::uint64_t{0} - 1, ~std::uint64_t{0}});
+  for (int r = 0; r < 30; ++r) {
+    std::vector<std::uint64_t> v(rng() % 5000);
+    const std::uint64_t u = 1 + rng() % (r % 2 ? 1'000'000'000'000 : 10000);
+    for (auto& x : v) x = rng() % u;
+    check_elias_fano(v);
+  }
+  CHECK_THROWS(mystl::elias_fano(std::vector<std::uint64_t>{3, 2}), std::invalid_argument);
+}
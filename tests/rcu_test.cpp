@@ -0,0 +1,73 @@
+#include <mystl/rcu.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "check.hpp"
+
+namespace {
+
+struct tracked {
+  static inline std::atomic<long> live{0};
+  long value;
+  explicit tracked(long v) : value(v) { ++live; }
+  tracked(const tracked& o) : value(o.value) { ++live; }
+  ~tracked() { --live; }
+};
+
+mystl::rcu_cell<int> global_cell(std::in_place, 1);
+
+// Reads from a thread_local destructor, after the thread's RCU state has
+// been torn down.
+struct reads_at_exit {
+  ~reads_at_exit() { CHECK(*global_cell.read() >= 0); }
+};
+
+}  // namespace
+
+int main() {
+  {
+    mystl::rcu_cell<tracked> cell(std::in_place, 1);
+    {
+      auto outer = cell.read();
+      cell.update([](tracked& t) { ++t.value; });
+      auto inner = cell.read();
+      // The old object stays alive while it is pinned.
+      CHECK(outer->value == 1 && inner->value == 2);
+      CHECK(tracked::live >= 2);
+    }
+    for (long i = 0; i < 3 * static_cast<long>(mystl::rcu_retire_batch); ++i) cell.emplace(i);
+    // Retirements are reclaimed in batches without a barrier.
+    CHECK(tracked::live <= static_cast<long>(mystl::rcu_retire_batch) + 1);
+    mystl::rcu_barrier();
+    CHECK(tracked::live == 1);
+    CHECK(cell.read()->value == 3 * static_cast<long>(mystl::rcu_retire_batch) - 1);
+    CHECK_THROWS(cell.store(nullptr), std::invalid_argument);
+  }
+  CHECK(tracked::live == 0);
+
+  // Records of exited threads are reused, also by threads that read from
+  // thread_local destructors.
+  {
+    (void)*global_cell.read();
+    const void* main_record = mystl::detail::rcu_this_thread.record;
+    std::set<const void*> records;
+    for (int k = 0; k < 20; ++k) {
+      std::thread([&] {
+        thread_local reads_at_exit late;
+        (void)late;
+        CHECK(*global_cell.read() >= 0);
+        records.insert(mystl::detail::rcu_this_thread.record);
+      }).join();
+    }
+    CHECK(records.size() == 1 && !records.count(main_record));
+  }
+  for (int i = 0; i < 1000; ++i) global_cell.emplace(i);
+  mystl::rcu_synchronize();
+  mystl::rcu_barrier();
+  CHECK(*global_cell.read() == 999);
+}
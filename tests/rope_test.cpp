@@ -0,0 +1,118 @@
+#include <mystl/rope.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  std::mt19937_64 rng(7);
+  auto rnd = [&](std::size_t n) { return n ? static_cast<std::size_t>(rng() % n) : 0; };
+  auto text = [&](std::size_t n) {
+    std::string s(n, ' ');
+    for (auto& c : s) c = static_cast<char>('a' + rng() % 26);
+    return s;
+  };
+
+  // Random edits against std::string; snapshots must not change later.
+  mystl::rope r;
+  std::string ref;
+  std::vector<std::pair<mystl::rope, std::string>> snapshots;
+  for (int i = 0; i < 10000; ++i) {
+    const int op = static_cast<int>(rng() % 10);
+    if (op < 3) {
+      const auto s = text(rnd(i % 50 == 0 ? 5000 : 40));
+      const auto p = rnd(ref.size() + 1);
+      r.insert(p, s);
+      ref.insert(p, s);
+    } else if (op < 5) {
+      const auto s = text(rnd(10));
+      r.append(s);
+      ref.append(s);
+    } else if (op < 6) {
+      r.push_back('!');
+      ref.push_back('!');
+    } else if (op < 8) {
+      const auto p = rnd(ref.size() + 1), n = rnd(200);
+      r.erase(p, n);
+      ref.erase(p, n);
+    } else if (op < 9) {
+      const auto p = rnd(ref.size() + 1), n = rnd(50);
+      const auto s = text(rnd(30));
+      r.replace(p, n, s);
+      ref.replace(p, n, s);
+    } else {
+      const auto p = rnd(ref.size() + 1), n = rnd(3000);
+      const mystl::rope sub = r.substr(p, n);
+      CHECK(sub == ref.substr(p, n));
+      r.insert(0, sub);
+      ref.insert(0, ref.substr(p, n));
+    }
+    CHECK(r.size() == ref.size());
+    if (i % 997 == 0) {
+      CHECK(r.str() == ref);
+      snapshots.emplace_back(r, ref);
+    }
+    if (!ref.empty() && i % 13 == 0) {
+      const auto p = rnd(ref.size());
+      CHECK(r[p] == ref[p]);
+    }
+  }
+  for (const auto& [sr, ss] : snapshots) CHECK(sr.str() == ss);
+
+  CHECK(std::equal(r.begin(), r.end(), ref.begin(), ref.end()));
+  {
+    auto it = r.end();
+    std::string reversed;
+    while (it != r.begin()) reversed.push_back(*--it);
+    CHECK(std::string(reversed.rbegin(), reversed.rend()) == ref);
+    CHECK(r.end() - r.begin() == static_cast<std::ptrdiff_t>(ref.size()) && r.begin()[5] == ref[5]);
+  }
+  {
+    std::ostringstream os;
+    os << r;
+    CHECK(os.str() == ref);
+    std::string buf(100, '\0');
+    CHECK(r.copy(buf.data(), 100, 7) == 100 && buf == ref.substr(7, 100));
+  }
+  {
+    mystl::rope a("abc"), b("abd");
+    CHECK(a < b && a == "abc" && a != "ab");
+    CHECK((a <=> "abcd") < 0 && a.compare(std::string_view("abb")) > 0);
+    a += b;
+    CHECK(a == "abcabd" && a + b == "abcabdabd");
+  }
+  {
+    const mystl::rope empty;
+    CHECK(empty.empty() && empty == "" && empty.substr(0).empty());
+    mystl::rope e;
+    CHECK_THROWS(e.insert(1, "x"), std::out_of_range);
+  }
+
+  // Appending one character at a time keeps the tree shallow, and a copy
+  // is unaffected by edits to the original.
+  {
+    mystl::rope p;
+    for (int i = 0; i < 200000; ++i) p.push_back(static_cast<char>('0' + i % 10));
+    CHECK(p.size() == 200000 && p[199999] == '9');
+    CHECK(p.height() <= 16);
+    mystl::rope q = p;
+    q.push_back('x');
+    CHECK(p.size() == 200000 && q.size() == 200001 && q.back() == 'x' && p.back() == '9');
+
+    std::thread reader([c = p] {
+      std::size_t n = 0;
+      c.for_each_chunk([&](std::string_view v) { n += v.size(); });
+      CHECK(n == c.size());
+    });
+    p.insert(5, "concurrent");
+    reader.join();
+  }
+}
@@ -0,0 +1,44 @@
+#include <mystl/seqlock.hpp>
+
+#include <stdexcept>
+
+#include "check.hpp"
+
+namespace {
+
+// Not a multiple of the word size.
+struct quote {
+  double bid, ask;
+  int size;
+};
+
+}  // namespace
+
+int main() {
+  mystl::seqlock<quote> q({1.0, 2.0, 3});
+  const auto v0 = q.version();
+  CHECK(v0 % 2 == 0);
+  quote got = q.load();
+  CHECK(got.bid == 1.0 && got.ask == 2.0 && got.size == 3);
+
+  q.store({4.0, 5.0, 6});
+  CHECK(q.version() == v0 + 2);
+  CHECK(q.try_load(got));
+  CHECK(got.bid == 4.0 && got.size == 6);
+
+  q.update([](quote& v) { v.size += 10; });
+  CHECK(q.load().size == 16 && q.version() == v0 + 4);
+
+  // A throwing update publishes nothing but leaves the lock usable.
+  CHECK_THROWS(q.update([](quote& v) {
+    v.size = -1;
+    throw std::runtime_error("abandon");
+  }),
+               std::runtime_error);
+  CHECK(q.load().size == 16 && q.version() % 2 == 0);
+  q.store({0, 0, 0});
+  CHECK(q.load().size == 0);
+
+  const mystl::seqlock<int> zero;
+  CHECK(zero.load() == 0);
+}
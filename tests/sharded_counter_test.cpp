@@ -0,0 +1,34 @@
+#include <mystl/sharded_counter.hpp>
+
+#include <cstdint>
+#include <thread>
+
+#include "check.hpp"
+
+int main() {
+  mystl::sharded_counter c;
+  ++c;
+  c += 5;
+  c.sub(2);
+  CHECK(c.load() == 4);
+  std::thread t([&] { c.add(10); });
+  t.join();
+  CHECK(c.load() == 14);
+  CHECK(c.exchange_zero() == 14);
+  CHECK(c.load() == 0);
+
+  mystl::sharded_histogram h;
+  for (std::uint64_t v = 1; v <= 1000; ++v) h.record(v);
+  auto s = h.snapshot();
+  CHECK(s.count == 1000 && s.min == 1 && s.max == 1000);
+  CHECK(s.quantile(0) >= 1 && s.quantile(1) == 1000);
+  CHECK(s.quantile(0.5) >= 256 && s.quantile(0.5) <= 1023);
+
+  // The top bucket holds values with bit 63 set.
+  h.record(~std::uint64_t{0});
+  s = h.snapshot();
+  CHECK(s.buckets[64] == 1 && s.quantile(1) == ~std::uint64_t{0});
+
+  const mystl::sharded_histogram empty;
+  CHECK(empty.snapshot().min == 0 && empty.snapshot().quantile(0.5) == 0);
+}
@@ -0,0 +1,67 @@
+#include <mystl/short_alloc.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+struct alignas(64) wide {
+  char c[64];
+};
+
+int main() {
+  {
+    mystl::stack_arena<4096> arena;
+    std::vector<int, mystl::short_alloc<int, 4096>> v{arena};
+    for (int i = 0; i < 200; ++i) v.push_back(i);
+    CHECK(arena.overflow_count() == 0 && arena.used() > 0);
+    using map_alloc = mystl::short_alloc<std::pair<const int, int>, 4096>;
+    std::map<int, int, std::less<int>, map_alloc> m{arena};
+    for (int i = 0; i < 20; ++i) m[i] = i;
+    CHECK(arena.overflow_count() == 0);
+
+    // Growth past the buffer goes to the heap and is counted.
+    for (int i = 0; i < 2000; ++i) v.push_back(i);
+    CHECK(v[2100] == 1900);
+    CHECK(arena.overflow_count() > 0);
+  }
+  {
+    mystl::stack_arena<256, 64> arena;
+    std::vector<wide, mystl::short_alloc<wide, 256, 64>> v{arena};
+    v.resize(2);
+    CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % 64 == 0 && arena.used() == 128);
+    v.resize(10);
+    CHECK(arena.overflow_count() == 1);
+  }
+  {
+    // Types aligned beyond the arena always come from the heap, and count.
+    mystl::stack_arena<1024, 16> arena;
+    std::vector<wide, mystl::short_alloc<wide, 1024, 16>> v{arena};
+    v.resize(2);
+    CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % 64 == 0);
+    CHECK(arena.overflow_count() == 1 && arena.used() == 0);
+  }
+  {
+    // A zero-byte request on a full arena points one past the buffer and
+    // must not be passed to operator delete.
+    mystl::stack_arena<64> arena;
+    mystl::short_alloc<char, 64> a{arena};
+    char* all = a.allocate(64);
+    char* none = a.allocate(0);
+    CHECK(none == all + 64 && arena.overflow_count() == 0);
+    a.deallocate(none, 0);
+    a.deallocate(all, 64);
+    CHECK(arena.used() == 0);
+  }
+  {
+    mystl::stack_arena<128> arena;
+    std::basic_string<char, std::char_traits<char>, mystl::short_alloc<char, 128>> s{arena};
+    s.assign(40, 'x');
+    s.clear();
+    s.shrink_to_fit();
+    arena.reset();
+    CHECK(arena.used() == 0);
+  }
+}
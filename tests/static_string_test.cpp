@@ -0,0 +1,55 @@
+#include <mystl/static_string.hpp>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+
+constexpr mystl::static_string<16> greeting = [] {
+  mystl::static_string<16> s("hello");
+  s += ' ';
+  s += "world";
+  return s;
+}();
+static_assert(greeting == "hello world" && greeting.size() == 11);
+
+constexpr auto literal = mystl::basic_static_string("abc");
+static_assert(literal.capacity() == 3);
+
+constexpr bool self_insert() {
+  mystl::static_string<16> s("abcd");
+  s.insert(0, s.view());
+  s.replace(1, 2, std::string_view(s).substr(2));
+  return s == "acdabcddabcd";
+}
+static_assert(self_insert());
+
+int main() {
+  mystl::static_string<5> s("abc");
+  CHECK_THROWS(s.append("xyz"), std::length_error);
+  CHECK(s == "abc");
+  CHECK(std::hash<mystl::static_string<5>>{}(s) == std::hash<std::string_view>{}("abc"));
+  CHECK_THROWS(s.insert(4, "x"), std::out_of_range);
+
+  mystl::static_string<32> t("abcdef");
+  t.insert(0, t.view());
+  CHECK(t == "abcdefabcdef");
+  t.erase(3, 6);
+  CHECK(t == "abcdef");
+  t.replace(1, 2, std::string_view(t).substr(2));
+  CHECK(t == "acdefdef");
+  t.insert(2, std::string_view(t).substr(1, 3));
+  CHECK(t == "accdedefdef");
+  t.insert(0, 2, '-');
+  CHECK(t.view().starts_with("--a") && t.size() == 13);
+  t.resize(3);
+  CHECK(t == "--a" && t.c_str()[3] == '\0');
+
+  mystl::static_string<8> a("one"), b("two");
+  swap(a, b);
+  CHECK(a == "two" && b == "one" && b < a);
+  CHECK((a + '!') == "two!");
+  CHECK(std::string(a.begin(), a.end()) == "two");
+}
@@ -0,0 +1,103 @@
+#include <mystl/static_unordered_map.hpp>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "check.hpp"
+
+struct multiplicative_hash {
+  constexpr std::size_t operator()(int x) const {
+    return static_cast<std::size_t>(x) * 0x9E3779B97F4A7C15ull;
+  }
+};
+
+constexpr int compile_time() {
+  mystl::static_unordered_map<int, int, 16, multiplicative_hash> m;
+  for (int i = 0; i < 16; ++i) m[i] = i * i;
+  m.erase(3);
+  m.erase(7);
+  int sum = 0;
+  for (const auto& [k, v] : m) sum += v;
+  return sum + (m.contains(3) ? 1000 : 0);
+}
+static_assert(compile_time() == 1240 - 9 - 49);
+
+constexpr int batch() {
+  mystl::static_unordered_map<int, int, 8, mystl::seeded_hash<int>> m;
+  m[3] = 4;
+  m[5] = 6;
+  int keys[] = {3, 4, 5};
+  decltype(m)::const_iterator out[3];
+  const auto found = std::as_const(m).find_batch(keys, out);
+  return static_cast<int>(found) * 100 + out[2]->second * 10 + (out[1] == m.end());
+}
+static_assert(batch() == 261);
+
+struct throwing_copy {
+  static inline int live = 0;
+  int v;
+  explicit throwing_copy(int x) : v(x) { ++live; }
+  throwing_copy(const throwing_copy& o) : v(o.v) {
+    if (v == 7) throw std::runtime_error("copy");
+    ++live;
+  }
+  ~throwing_copy() { --live; }
+};
+
+int main() {
+  // Against std::unordered_map under random inserts, erases and lookups.
+  mystl::static_unordered_map<int, std::string, 1000> m;
+  std::unordered_map<int, std::string> ref;
+  std::mt19937 rng(1);
+  for (int it = 0; it < 200000; ++it) {
+    const int k = static_cast<int>(rng() % 1500);
+    switch (rng() % 3) {
+      case 0:
+        if (ref.count(k) || ref.size() < 1000) m[k] = ref[k] = std::to_string(it);
+        break;
+      case 1:
+        CHECK(m.erase(k) == ref.erase(k));
+        break;
+      default: {
+        auto f = m.find(k);
+        auto g = ref.find(k);
+        CHECK((f == m.end()) == (g == ref.end()));
+        if (g != ref.end()) CHECK(f->second == g->second);
+      }
+    }
+    CHECK(m.size() == ref.size());
+  }
+  std::size_t n = 0;
+  for (const auto& kv : m) {
+    CHECK(ref.at(kv.first) == kv.second);
+    ++n;
+  }
+  CHECK(n == ref.size());
+  auto m2 = m;
+  CHECK(m2 == m);
+  auto m3 = std::move(m2);
+  CHECK(m3 == m);
+
+  // An identity hash (std::hash<int> in libstdc++) with keys that are all
+  // multiples of the capacity still spreads.
+  mystl::static_unordered_map<int, int, 64> strided;
+  for (int i = 0; i < 48; ++i) strided.try_emplace(i * 64, i);
+  for (int i = 0; i < 48; i += 2) strided.erase(i * 64);
+  for (int i = 0; i < 48; ++i) CHECK(strided.contains(i * 64) == (i % 2 == 1));
+
+  mystl::static_unordered_map<int, int, 4> full;
+  for (int i = 0; i < 4; ++i) full[i] = i;
+  CHECK_THROWS(full[4], std::bad_alloc);
+  CHECK_THROWS(full.at(9), std::out_of_range);
+
+  {
+    mystl::static_unordered_map<int, throwing_copy, 16> src;
+    for (int i = 0; i < 10; ++i) src.try_emplace(i, i);
+    CHECK_THROWS((mystl::static_unordered_map<int, throwing_copy, 16>(src)), std::runtime_error);
+    CHECK(throwing_copy::live == 10);
+  }
+  CHECK(throwing_copy::live == 0);
+}
@@ -0,0 +1,37 @@
+// Four threads insert, look up and erase overlapping keys in a sharded
+// TinyLFU cache and a tiny sharded LRU cache.
+
+#include <mystl/lru_cache.hpp>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  mystl::concurrent_tinylfu_cache<int, std::string> tiny(10000, 8);
+  mystl::concurrent_lru_cache<int, int> lru(3);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      for (int i = 0; i < 50000; ++i) {
+        const int k = static_cast<int>(rng() % 20000);
+        if (auto v = tiny.find(k)) {
+          CHECK(*v == std::to_string(k));
+        } else {
+          tiny.insert_or_assign(k, std::to_string(k));
+        }
+        if (i % 7 == 0) tiny.erase(k);
+        lru.try_emplace(k, k);
+        lru.find(k, [&](int& v) { CHECK(v == k); });
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  CHECK(tiny.size() <= 10000 && lru.size() <= 3);
+  const auto s = tiny.stats();
+  CHECK(s.hits + s.misses == 4 * 50000);
+}
@@ -0,0 +1,46 @@
+// Tasks hop onto a thread pool and are joined with when_all and when_any
+// from the main thread, many times over.
+
+#include <mystl/executor.hpp>
+#include <mystl/task.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+mystl::task<std::string> on_pool(mystl::thread_pool& pool, int i) {
+  co_await pool.schedule();
+  co_return std::to_string(i);
+}
+
+mystl::task<int> fan_out(mystl::thread_pool& pool, int width) {
+  std::vector<mystl::task<std::string>> children;
+  for (int i = 0; i < width; ++i) children.push_back(on_pool(pool, i));
+  const auto results = co_await mystl::when_all(std::move(children));
+  int sum = 0;
+  for (const std::string& s : results) sum += std::stoi(s);
+  co_return sum;
+}
+
+}  // namespace
+
+int main() {
+  mystl::thread_pool pool(4);
+  for (int rep = 0; rep < 200; ++rep) {
+    std::vector<mystl::task<std::string>> tasks;
+    for (int i = 0; i < 50; ++i) tasks.push_back(on_pool(pool, i));
+    const auto v = mystl::sync_wait(mystl::when_all(std::move(tasks)));
+    for (int i = 0; i < 50; ++i) CHECK(v[static_cast<std::size_t>(i)] == std::to_string(i));
+  }
+  for (int rep = 0; rep < 500; ++rep) {
+    std::vector<mystl::task<std::string>> tasks;
+    for (int i = 0; i < 8; ++i) tasks.push_back(on_pool(pool, i));
+    const auto r = mystl::sync_wait(mystl::when_any(std::move(tasks)));
+    CHECK(r.value == std::to_string(r.index));
+  }
+  for (int rep = 0; rep < 100; ++rep) CHECK(mystl::sync_wait(fan_out(pool, 20)) == 190);
+}
@@ -0,0 +1,48 @@
+// Promises are fulfilled on one thread while continuations are attached on
+// another and run on a thread pool, so completion races attachment.
+
+#include <mystl/future.hpp>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  mystl::thread_pool pool(3);
+  constexpr int rounds = 200, batch = 100;
+  for (int round = 0; round < rounds; ++round) {
+    std::vector<mystl::promise<int>> promises(batch);
+    std::vector<mystl::future<int>> futures;
+    for (auto& p : promises) futures.push_back(p.get_future());
+    std::thread producer([&] {
+      for (int i = 0; i < batch; ++i) promises[i].set_value(i);
+    });
+    std::vector<mystl::future<int>> chained;
+    for (auto& f : futures) {
+      chained.push_back(
+          std::move(f).then(pool, [](int v) { return v + 1; }).then([](int v) { return v * 2; }));
+    }
+    auto all = mystl::when_all(std::move(chained));
+    producer.join();
+    const auto values = all.get();
+    for (int i = 0; i < batch; ++i) CHECK(values[i] == (i + 1) * 2);
+  }
+
+  // Futures are dropped while their promises complete; the continuations
+  // still run. Destroying the pool drains its queue.
+  std::atomic<int> ran{0};
+  {
+    mystl::thread_pool drained(2);
+    for (int i = 0; i < 2000; ++i) {
+      mystl::promise<int> p;
+      auto f = p.get_future().then(drained, [&](int) { ++ran; });
+      std::thread t([&] { p.set_value(i); });
+      if (i % 2) f = {};
+      t.join();
+    }
+  }
+  CHECK(ran == 2000);
+}
@@ -0,0 +1,63 @@
+// Blocks allocated on four producer threads are freed on two consumer
+// threads, so magazines and depots trade blocks across threads all the time.
+
+#include <mystl/object_pool.hpp>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+struct message {
+  long a, b, c;
+  explicit message(long x) : a(x), b(x + 1), c(x + 2) {}
+};
+
+int main() {
+  constexpr long per_producer = 100000;
+  std::mutex mu;
+  std::deque<message*> queue;
+  std::atomic<int> producers_left{4};
+  std::atomic<long> sum{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < 4; ++p) {
+    threads.emplace_back([&] {
+      mystl::object_pool<message> pool;
+      for (long i = 0; i < per_producer; ++i) {
+        message* m = pool.create(i);
+        std::lock_guard<std::mutex> lock(mu);
+        queue.push_back(m);
+      }
+      --producers_left;
+    });
+  }
+  for (int c = 0; c < 2; ++c) {
+    threads.emplace_back([&] {
+      mystl::object_pool<message> pool;
+      for (;;) {
+        message* m = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(mu);
+          if (!queue.empty()) {
+            m = queue.front();
+            queue.pop_front();
+          } else if (producers_left == 0) {
+            break;
+          }
+        }
+        if (m) {
+          CHECK(m->b == m->a + 1 && m->c == m->a + 2);
+          sum += m->a;
+          pool.destroy(m);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  CHECK(sum == 4 * (per_producer - 1) * per_producer / 2);
+}
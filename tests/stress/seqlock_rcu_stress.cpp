@@ -0,0 +1,101 @@
+// Three readers spin on a seqlock and on an rcu_cell while the main thread
+// writes; readers must never see a torn value or a freed snapshot, and
+// values must never go backwards.
+
+#include <mystl/rcu.hpp>
+#include <mystl/seqlock.hpp>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+struct quote {
+  double bid, ask;
+  long seq;
+  int pad[3];
+};
+
+struct snapshot {
+  static inline std::atomic<long> live{0};
+  long a, b;
+  std::vector<int> v;
+  explicit snapshot(long x) : a(x), b(-x), v(16, static_cast<int>(x)) { ++live; }
+  snapshot(const snapshot& o) : a(o.a), b(o.b), v(o.v) { ++live; }
+  ~snapshot() { --live; }
+};
+
+constexpr long writes = 100000;
+
+}  // namespace
+
+int main() {
+  {
+    mystl::seqlock<quote> q({1, 2, 0, {}});
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+      readers.emplace_back([&] {
+        long last = 0;
+        while (!stop) {
+          const quote v = q.load();
+          CHECK(v.ask == v.bid + 1 && v.seq == static_cast<long>(v.bid) - 1);
+          CHECK(v.seq >= last);
+          last = v.seq;
+        }
+      });
+    }
+    for (long i = 1; i < writes; ++i) {
+      if (i & 1) {
+        q.store({static_cast<double>(i + 1), static_cast<double>(i + 2), i, {}});
+      } else {
+        q.update([](quote& v) {
+          v.bid += 1;
+          v.ask += 1;
+          v.seq += 1;
+        });
+      }
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+    CHECK(q.load().seq == writes - 1);
+  }
+
+  {
+    mystl::rcu_cell<snapshot> cell(std::in_place, 0);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+      readers.emplace_back([&] {
+        long last = 0;
+        while (!stop) {
+          auto s = cell.read();
+          CHECK(s->a == -s->b && s->v[15] == static_cast<int>(s->a));
+          CHECK(s->a >= last);
+          last = s->a;
+          auto inner = cell.read();
+          CHECK(inner->a >= s->a);
+        }
+      });
+    }
+    for (long i = 1; i < writes / 10; ++i) {
+      if (i & 1) {
+        cell.emplace(i);
+      } else {
+        cell.update([](snapshot& s) {
+          ++s.a;
+          --s.b;
+          s.v.assign(16, static_cast<int>(s.a));
+        });
+      }
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+    mystl::rcu_barrier();
+    CHECK(snapshot::live == 1);
+  }
+}
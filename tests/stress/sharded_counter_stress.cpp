@@ -0,0 +1,31 @@
+// Four threads update one counter and one histogram from whichever CPU
+// they are scheduled on; the totals must come out exact.
+
+#include <mystl/sharded_counter.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  mystl::sharded_counter c;
+  mystl::sharded_histogram h(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 100000; ++i) {
+        ++c;
+        c += 2;
+        c.sub();
+        h.record(static_cast<std::uint64_t>(i + t));
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  CHECK(c.load() == 800000);
+  const auto s = h.snapshot();
+  CHECK(s.count == 400000 && s.min == 0 && s.max == 100002);
+  CHECK(c.exchange_zero() == 800000 && c.load() == 0);
+}
@@ -0,0 +1,83 @@
+// Readers hop between CPUs while holding shared_mutex read locks, and a
+// writer checks that it never gets in while one of them is still inside.
+// A reader that released its lock in another CPU's slot than it took it in
+// could let the writer's scan over the slots add up to zero too early.
+
+#include <mystl/synchronization.hpp>
+
+#include <sched.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+std::vector<int> allowed_cpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof set, &set) == 0) {
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+      if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    }
+  }
+  return cpus;
+}
+
+// Moves the calling thread to cpu and gives up the processor, so that it
+// resumes there.
+void move_to(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  (void)::sched_setaffinity(0, sizeof set, &set);
+  std::this_thread::yield();
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<int> cpus = allowed_cpus();
+  CHECK(!cpus.empty());
+  mystl::shared_mutex m;
+  std::atomic<int> readers_inside{0};
+  std::atomic<bool> writer_inside{false};
+  std::atomic<bool> stop{false};
+  std::atomic<long> reads{0};
+  long value = 0;  // written only under the write lock
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t] {
+      std::size_t next = static_cast<std::size_t>(t);
+      while (!stop.load(std::memory_order_relaxed)) {
+        std::shared_lock outer(m);
+        CHECK(!writer_inside.load());
+        readers_inside.fetch_add(1);
+        const long seen = value;
+        move_to(cpus[next++ % cpus.size()]);
+        CHECK(!writer_inside.load() && value == seen);
+        readers_inside.fetch_sub(1);
+        reads.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  long writes = 0;
+  for (; writes < 2000 || reads.load(std::memory_order_relaxed) < 20000; ++writes) {
+    std::unique_lock g(m);
+    CHECK(readers_inside.load() == 0);
+    writer_inside.store(true);
+    ++value;
+    CHECK(readers_inside.load() == 0);
+    writer_inside.store(false);
+  }
+  stop = true;
+  for (auto& t : readers) t.join();
+  CHECK(value == writes);
+}
@@ -0,0 +1,101 @@
+// Six threads contend for each lock, the shared_mutex with a writer among
+// readers, and meet at a barrier and a latch over many rounds.
+
+#include <mystl/synchronization.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+constexpr int threads = 6;
+constexpr int iterations = 20000;
+
+template <class Fn>
+void run(Fn fn) {
+  std::vector<std::thread> ts;
+  for (int t = 0; t < threads; ++t) ts.emplace_back(fn, t);
+  for (auto& t : ts) t.join();
+}
+
+template <class Lock>
+void counter() {
+  Lock m;
+  long count = 0;
+  run([&](int) {
+    for (int i = 0; i < iterations; ++i) {
+      std::lock_guard g(m);
+      ++count;
+    }
+  });
+  CHECK(count == long{threads} * iterations);
+}
+
+}  // namespace
+
+int main() {
+  counter<mystl::adaptive_mutex>();
+  counter<mystl::ticket_lock>();
+
+  {
+    mystl::mcs_lock m;
+    long count = 0;
+    run([&](int) {
+      for (int i = 0; i < iterations; ++i) {
+        mystl::mcs_lock::guard g(m);
+        ++count;
+      }
+    });
+    CHECK(count == long{threads} * iterations);
+  }
+
+  // Readers must never see a half-done write.
+  {
+    mystl::shared_mutex m;
+    long a = 0, b = 0;
+    run([&](int t) {
+      for (int i = 0; i < iterations; ++i) {
+        if (t == 0 && i % 16 == 0) {
+          std::unique_lock g(m);
+          ++a;
+          ++b;
+        } else {
+          std::shared_lock g(m);
+          CHECK(a == b);
+        }
+      }
+    });
+    CHECK(a == (iterations + 15) / 16);
+  }
+
+  {
+    int counters[threads] = {};
+    std::atomic<int> phases{0};
+    auto done = [&]() noexcept { ++phases; };
+    mystl::barrier b(threads, done);
+    run([&](int t) {
+      for (int p = 0; p < 500; ++p) {
+        counters[t] = p;
+        b.arrive_and_wait();
+        for (int u = 0; u < threads; ++u) CHECK(counters[u] == p);
+        b.arrive_and_wait();
+      }
+    });
+    CHECK(phases == 1000);
+  }
+
+  for (int round = 0; round < 200; ++round) {
+    mystl::latch l(threads);
+    std::atomic<int> arrived{0};
+    run([&](int) {
+      ++arrived;
+      l.arrive_and_wait();
+      CHECK(arrived == threads);
+    });
+  }
+}
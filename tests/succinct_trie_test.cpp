@@ -0,0 +1,101 @@
+#include <mystl/succinct_trie.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+std::mt19937_64 rng(7);
+
+// Up to max_len characters from the first alphabet letters, or any byte
+// when alphabet is 256.
+std::string random_key(int max_len, int alphabet) {
+  std::string s;
+  const int n = static_cast<int>(rng() % (max_len + 1));
+  for (int i = 0; i < n; ++i) {
+    s += static_cast<char>(alphabet == 256 ? rng() % 256 : 'a' + rng() % alphabet);
+  }
+  return s;
+}
+
+void check_set(const std::vector<std::string>& keys) {
+  const std::set<std::string> ref(keys.begin(), keys.end());
+  const mystl::succinct_trie t(keys);
+  CHECK(t.size() == ref.size());
+
+  std::vector<std::string> all;
+  std::vector<bool> seen(t.size());
+  t.for_each([&](std::string_view k, std::size_t id) {
+    all.emplace_back(k);
+    CHECK(id < t.size() && !seen[id]);
+    seen[id] = true;
+    CHECK(t.key(id) == k && t.id(k) == id);
+  });
+  CHECK(std::vector<std::string>(ref.begin(), ref.end()) == all);
+
+  for (int i = 0; i < 200; ++i) {
+    std::string q = rng() % 2 && !keys.empty() ? keys[rng() % keys.size()] : random_key(8, 3);
+    if (rng() % 3 == 0 && !q.empty()) q.pop_back();
+    CHECK(t.contains(q) == (ref.count(q) == 1));
+    std::vector<std::string> got, want;
+    t.for_each_prefix(q, [&](std::string_view k, std::size_t) { got.emplace_back(k); });
+    for (auto it = ref.lower_bound(q); it != ref.end() && it->starts_with(q); ++it) {
+      want.push_back(*it);
+    }
+    CHECK(got == want);
+  }
+
+  const auto blob = t.to_bytes();
+  const auto copy = mystl::succinct_trie::from_bytes(blob);
+  std::vector<std::uint64_t> aligned(blob.size() / 8);
+  std::memcpy(aligned.data(), blob.data(), blob.size());
+  auto view = mystl::succinct_trie::view(std::as_bytes(std::span(aligned)));
+  auto view_copy = view;
+  const mystl::succinct_trie moved = std::move(view_copy);
+  std::stringstream ss;
+  t.save(ss);
+  const auto loaded = mystl::succinct_trie::load(ss);
+  for (const auto& k : ref) {
+    const std::size_t id = t.id(k);
+    CHECK(copy.id(k) == id && view.id(k) == id && moved.id(k) == id && loaded.id(k) == id);
+  }
+
+  // Returning false stops the enumeration.
+  int n = 0;
+  t.for_each([&](std::string_view, std::size_t) { return ++n < 3; });
+  CHECK(n == std::min<int>(3, static_cast<int>(ref.size())));
+}
+
+}  // namespace
+
+int main() {
+  check_set({});
+  check_set({""});
+  check_set({"a"});
+  check_set({"", "a", "ab", "abc", "abd", "b"});
+  for (int r = 0; r < 200; ++r) {
+    std::vector<std::string> keys;
+    const int n = static_cast<int>(rng() % 300);
+    const int alphabet = r % 3 == 0 ? 256 : 2 + r % 5;
+    for (int i = 0; i < n; ++i) keys.push_back(random_key(r % 4 == 0 ? 40 : 8, alphabet));
+    check_set(keys);
+  }
+  std::vector<std::string> big;
+  for (int i = 0; i < 20000; ++i) big.push_back(random_key(12, 26));
+  check_set(big);
+
+  const std::vector<std::byte> junk(40);
+  CHECK_THROWS(mystl::succinct_trie::from_bytes(junk), std::invalid_argument);
+}
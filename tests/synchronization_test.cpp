@@ -0,0 +1,105 @@
+#include <mystl/synchronization.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+template <class Lock>
+void check_exclusive() {
+  Lock m;
+  long count = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; ++i) {
+        std::lock_guard g(m);
+        ++count;
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  CHECK(count == 20000);
+  CHECK(m.try_lock());
+  CHECK(!m.try_lock());
+  m.unlock();
+}
+
+}  // namespace
+
+int main() {
+  check_exclusive<mystl::adaptive_mutex>();
+  check_exclusive<mystl::ticket_lock>();
+
+  {
+    mystl::mcs_lock m;
+    long count = 0;
+    std::thread t([&] {
+      for (int i = 0; i < 10000; ++i) {
+        mystl::mcs_lock::guard g(m);
+        ++count;
+      }
+    });
+    for (int i = 0; i < 10000; ++i) {
+      mystl::mcs_lock::guard g(m);
+      ++count;
+    }
+    t.join();
+    CHECK(count == 20000);
+    mystl::mcs_lock::node a, b;
+    CHECK(m.try_lock(a));
+    CHECK(!m.try_lock(b));
+    m.unlock(a);
+  }
+
+  {
+    mystl::shared_mutex m;
+    CHECK(m.try_lock());
+    CHECK(!m.try_lock_shared());
+    m.unlock();
+    CHECK(m.try_lock_shared());
+    CHECK(m.try_lock_shared());
+    CHECK(!m.try_lock());
+    m.unlock_shared();
+    m.unlock_shared();
+    CHECK(m.try_lock());
+    m.unlock();
+  }
+
+  {
+    mystl::latch l(3);
+    CHECK(!l.try_wait());
+    std::atomic<int> arrived{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+      threads.emplace_back([&] {
+        ++arrived;
+        l.arrive_and_wait();
+        CHECK(arrived == 3);
+      });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(l.try_wait());
+  }
+
+  {
+    int phases = 0;
+    auto done = [&]() noexcept { ++phases; };
+    mystl::barrier b(2, done);
+    std::thread t([&] {
+      b.arrive_and_wait();
+      b.arrive_and_drop();
+    });
+    b.arrive_and_wait();
+    b.arrive_and_wait();
+    t.join();
+    // With one participant left, every arrival completes a phase.
+    b.arrive_and_wait();
+    CHECK(phases == 3);
+  }
+}
@@ -0,0 +1,55 @@
+#include <mystl/task.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+
+namespace {
+
+mystl::task<int> answer() { co_return 42; }
+mystl::task<int> twice() { co_return 2 * co_await answer(); }
+mystl::task<int> deep(int n) {
+  if (n == 0) co_return 0;
+  co_return 1 + co_await deep(n - 1);
+}
+mystl::task<void> boom() {
+  throw std::runtime_error("boom");
+  co_return;
+}
+mystl::task<void> nothing() { co_return; }
+
+int global = 7;
+mystl::task<int&> reference() { co_return global; }
+
+mystl::task<std::string> text(int i) { co_return std::to_string(i); }
+
+}  // namespace
+
+int main() {
+  CHECK(mystl::sync_wait(twice()) == 84);
+  CHECK(mystl::sync_wait(deep(1000)) == 1000);
+  CHECK_THROWS(mystl::sync_wait(boom()), std::runtime_error);
+  CHECK(&mystl::sync_wait(reference()) == &global);
+  mystl::sync_wait(nothing());
+
+  auto [a, b, c] = mystl::sync_wait(mystl::when_all(text(1), answer(), nothing()));
+  CHECK(a == "1" && b == 42);
+  (void)c;
+  CHECK_THROWS(mystl::sync_wait(mystl::when_all(answer(), boom())), std::runtime_error);
+
+  std::vector<mystl::task<std::string>> many;
+  for (int i = 0; i < 50; ++i) many.push_back(text(i));
+  const auto all = mystl::sync_wait(mystl::when_all(std::move(many)));
+  CHECK(all.size() == 50);
+  for (int i = 0; i < 50; ++i) CHECK(all[static_cast<std::size_t>(i)] == std::to_string(i));
+
+  std::vector<mystl::task<int>> race;
+  race.push_back(answer());
+  race.push_back(answer());
+  const auto first = mystl::sync_wait(mystl::when_any(std::move(race)));
+  CHECK(first.index == 0 && first.value == 42);
+}
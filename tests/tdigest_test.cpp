@@ -0,0 +1,40 @@
+#include <mystl/tdigest.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+
+int main() {
+  std::mt19937_64 rng(1);
+  std::lognormal_distribution<> dist(0, 1.5);
+  std::vector<double> xs;
+  mystl::tdigest td, other(200);
+  for (int i = 0; i < 300000; ++i) {
+    const double x = dist(rng);
+    xs.push_back(x);
+    (i % 3 ? td : other).insert(x);
+  }
+  td.merge(other);
+  std::sort(xs.begin(), xs.end());
+
+  CHECK(td.quantile(0) == xs.front() && td.quantile(1) == xs.back());
+  for (double q : {0.001, 0.01, 0.5, 0.9, 0.99, 0.999, 0.9999}) {
+    const double got = td.quantile(q);
+    const auto below = std::lower_bound(xs.begin(), xs.end(), got) - xs.begin();
+    const double rank = static_cast<double>(below) / xs.size();
+    CHECK(std::abs(rank - q) < 0.005);
+    const double exact = xs[static_cast<std::size_t>(q * xs.size())];
+    CHECK(std::abs(td.cdf(exact) - q) < 0.005);
+  }
+
+  td.merge(td);
+  CHECK(td.count() == 600000);
+
+  mystl::tdigest one;
+  one.insert(3);
+  CHECK(one.quantile(0.5) == 3 && one.cdf(3) == 1 && one.cdf(2) == 0);
+  CHECK(std::isnan(mystl::tdigest().quantile(0.5)));
+}